@@ -63,6 +63,7 @@
 #include <storage/ramdisk.h>
 #include <storage/sd.h>
 #include <storage/sdmmc.h>
+#include <storage/sdmmc_stats.h>
 #include <thermal/fan.h>
 #include <thermal/tmp451.h>
 #include <usb/usbd.h>
@@ -74,6 +75,7 @@
 #include <utils/sprintf.h>
 #include <utils/tegra_bct.h>
 #include <utils/tegra_bit.h>
+#include <utils/trace.h>
 #include <utils/types.h>
 #include <utils/util.h>
 
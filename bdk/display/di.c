@@ -28,6 +28,7 @@
 #include <soc/pmc.h>
 #include <soc/timer.h>
 #include <soc/t210.h>
+#include <utils/trace.h>
 #include <utils/util.h>
 
 #include "di.inl"
@@ -35,6 +36,8 @@
 static bool _nx_aula      = false;
 static u32  _panel_id     = 0;
 static u32  _panel_id_raw = 0;
+static bool _init_deferred = false;
+static u32  _init_time     = 0;
 
 static void _display_panel_and_hw_end(bool no_panel_deinit);
 
@@ -670,6 +673,15 @@ static void _display_pwm_backlight_brightness(u32 duty, u32 step_delay)
 
 void display_backlight_brightness(u32 brightness, u32 step_delay)
 {
+	// Panel is only needed once something gets shown.
+	if (_init_deferred)
+	{
+		if (!brightness)
+			return;
+
+		display_init_finish();
+	}
+
 	if (brightness > 255)
 		brightness = 255;
 
@@ -803,7 +815,52 @@ skip_panel_deinit:
 	max7762x_regulator_enable(REGULATOR_LDO0, false);
 }
 
-void display_end() { _display_panel_and_hw_end(false); };
+void display_end()
+{
+	// Panel was never initialized.
+	if (_init_deferred)
+	{
+		_init_deferred = false;
+		return;
+	}
+
+	_display_panel_and_hw_end(false);
+}
+
+u32 *display_init_deferred()
+{
+	// Sanitize framebuffer area.
+	memset((u32 *)IPL_FB_ADDRESS, 0, IPL_FB_SZ);
+
+	// Panel init and window A config are done on first backlight enable or by display_init_finish().
+	_init_deferred = true;
+
+	return (u32 *)IPL_FB_ADDRESS;
+}
+
+void display_init_finish()
+{
+	if (!_init_deferred)
+		return;
+
+	_init_deferred = false;
+
+	TRACE_BEGIN("display_init");
+	u32 time_start = get_tmr_us();
+	display_init();
+
+	// Keep framebuffer contents. Anything rendered while deferred shows up.
+	reg_write_array((vu32 *)DISPLAY_A_BASE, _di_winA_pitch, ARRAY_SIZE(_di_winA_pitch));
+
+	display_backlight_pwm_init();
+	_init_time = get_tmr_us() - time_start;
+	TRACE_END("display_init");
+}
+
+u32 display_get_init_time()
+{
+	return _init_time;
+}
 
 u32 display_get_verbose_panel_id()
 {
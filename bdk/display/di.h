@@ -869,6 +869,11 @@ void display_init();
 void display_backlight_pwm_init();
 void display_end();
 
+/*! Deferred init. Framebuffer is usable right away and panel comes up on first use. */
+u32 *display_init_deferred();
+void display_init_finish();
+u32  display_get_init_time();
+
 /*! Interrupt management. */
 void display_enable_interrupt(u32 intr);
 void display_disable_interrupt(u32 intr);
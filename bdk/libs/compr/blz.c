@@ -32,6 +32,49 @@ const blz_footer *blz_get_footer(const u8 *comp_data, u32 comp_data_size, blz_fo
 	return src_footer;
 }
 
+#define BLZ_SEG_SIZE_MAX 18
+
+/*
+ * Segment copy. Bytes are written in ascending order and each source byte is read
+ * before it could be written, so word copies keep the byte loop semantics when
+ * seg_ofs >= 4 and both sides share alignment.
+ */
+static inline void _blz_seg_copy(u8 *dst, u32 seg_size, u32 seg_ofs)
+{
+	const u8 *src = dst + seg_ofs;
+
+	if (seg_ofs >= 4 && !(seg_ofs & 3) && seg_size >= 8)
+	{
+		while ((uptr)dst & 3)
+		{
+			*dst++ = *src++;
+			seg_size--;
+		}
+
+		u32 *dst32 = (u32 *)dst;
+		const u32 *src32 = (const u32 *)src;
+		while (seg_size >= 4)
+		{
+			*dst32++ = *src32++;
+			seg_size -= 4;
+		}
+
+		dst = (u8 *)dst32;
+		src = (const u8 *)src32;
+		for (u32 j = 0; j < seg_size; j++)
+			dst[j] = src[j];
+
+		return;
+	}
+
+	// Minimum segment is 3 bytes.
+	dst[0] = src[0];
+	dst[1] = src[1];
+	dst[2] = src[2];
+	for (u32 j = 3; j < seg_size; j++)
+		dst[j] = src[j];
+}
+
 // From https://github.com/SciresM/hactool/blob/master/kip.c which is exactly how kernel does it, thanks SciresM!
 int blz_uncompress_inplace(u8 *data, u32 comp_size, const blz_footer *footer)
 {
@@ -45,6 +88,47 @@ int blz_uncompress_inplace(u8 *data, u32 comp_size, const blz_footer *footer)
 
 	while (out_ofs)
 	{
+		// Fast path. A control byte and its 8 segments can't run out of bounds, so checks are skipped.
+		if (cmp_ofs > 8 * 2 && out_ofs >= 8 * BLZ_SEG_SIZE_MAX)
+		{
+			u8 control = cmp_start[--cmp_ofs];
+
+			// All literals.
+			if (!control)
+			{
+				u8 *out = &cmp_start[out_ofs];
+				const u8 *in = &cmp_start[cmp_ofs];
+				out[-1] = in[-1]; out[-2] = in[-2]; out[-3] = in[-3]; out[-4] = in[-4];
+				out[-5] = in[-5]; out[-6] = in[-6]; out[-7] = in[-7]; out[-8] = in[-8];
+				cmp_ofs -= 8;
+				out_ofs -= 8;
+				continue;
+			}
+
+			for (u32 i = 0; i < 8; i++)
+			{
+				if (control & 0x80)
+				{
+					cmp_ofs -= 2;
+					u16 seg_val = ((u32)(cmp_start[cmp_ofs + 1]) << 8) | cmp_start[cmp_ofs];
+					u32 seg_size = ((seg_val >> 12) & 0xF) + 3;
+					u32 seg_ofs = (seg_val & 0x0FFF) + 3;
+
+					out_ofs -= seg_size;
+					_blz_seg_copy(&cmp_start[out_ofs], seg_size, seg_ofs);
+				}
+				else
+					cmp_start[--out_ofs] = cmp_start[--cmp_ofs];
+
+				control <<= 1;
+			}
+
+			continue;
+		}
+
+		if (cmp_ofs < 1)
+			return 0; // Out of bounds.
+
 		u8 control = cmp_start[--cmp_ofs];
 		for (u32 i = 0; i < 8; i++)
 		{
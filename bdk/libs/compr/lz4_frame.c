@@ -0,0 +1,353 @@
+/*
+ * LZ4 frame streaming decoder.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "lz4.h"
+#include "lz4_frame.h"
+
+#define LZ4F_FLG_VERSION_MASK  0xC0
+#define LZ4F_FLG_VERSION       0x40
+#define LZ4F_FLG_BLOCK_INDEP   BIT(5)
+#define LZ4F_FLG_BLOCK_CSUM    BIT(4)
+#define LZ4F_FLG_CONTENT_SIZE  BIT(3)
+#define LZ4F_FLG_CONTENT_CSUM  BIT(2)
+#define LZ4F_FLG_DICT_ID       BIT(0)
+
+#define LZ4F_BLK_UNCOMPRESSED  BIT(31)
+#define LZ4F_DICT_MAX          SZ_64K
+
+#define XXH_P1 2654435761U
+#define XXH_P2 2246822519U
+#define XXH_P3 3266489917U
+#define XXH_P4 668265263U
+#define XXH_P5 374761393U
+
+#define XXH_ROTL(x, r) (((x) << (r)) | ((x) >> (32 - (r))))
+
+static inline u32 _xxh32_read32(const u8 *p)
+{
+	u32 v;
+	memcpy(&v, p, sizeof(u32));
+
+	return v;
+}
+
+static inline u32 _xxh32_round(u32 acc, u32 input)
+{
+	acc += input * XXH_P2;
+	acc  = XXH_ROTL(acc, 13);
+
+	return acc * XXH_P1;
+}
+
+void lz4f_xxh32_init(lz4f_xxh32_t *state)
+{
+	// Seed is always 0 for LZ4 frames.
+	state->v[0] = XXH_P1 + XXH_P2;
+	state->v[1] = XXH_P2;
+	state->v[2] = 0;
+	state->v[3] = 0 - XXH_P1;
+	state->total    = 0;
+	state->large    = false;
+	state->mem_size = 0;
+}
+
+void lz4f_xxh32_update(lz4f_xxh32_t *state, const void *buf, u32 size)
+{
+	const u8 *p = (const u8 *)buf;
+
+	state->total += size;
+	if (size >= 16 || state->total >= 16)
+		state->large = true;
+
+	// Not enough for a stripe. Keep it for later.
+	if (state->mem_size + size < 16)
+	{
+		memcpy(state->mem + state->mem_size, p, size);
+		state->mem_size += size;
+
+		return;
+	}
+
+	// Complete the pending stripe.
+	if (state->mem_size)
+	{
+		u32 fill = 16 - state->mem_size;
+		memcpy(state->mem + state->mem_size, p, fill);
+		for (u32 i = 0; i < 4; i++)
+			state->v[i] = _xxh32_round(state->v[i], _xxh32_read32(state->mem + i * 4));
+		p += fill;
+		size -= fill;
+		state->mem_size = 0;
+	}
+
+	u32 v0 = state->v[0], v1 = state->v[1], v2 = state->v[2], v3 = state->v[3];
+	while (size >= 16)
+	{
+		v0 = _xxh32_round(v0, _xxh32_read32(p));
+		v1 = _xxh32_round(v1, _xxh32_read32(p + 4));
+		v2 = _xxh32_round(v2, _xxh32_read32(p + 8));
+		v3 = _xxh32_round(v3, _xxh32_read32(p + 12));
+		p += 16;
+		size -= 16;
+	}
+	state->v[0] = v0; state->v[1] = v1; state->v[2] = v2; state->v[3] = v3;
+
+	memcpy(state->mem, p, size);
+	state->mem_size = size;
+}
+
+u32 lz4f_xxh32_digest(lz4f_xxh32_t *state)
+{
+	const u8 *p = state->mem;
+	u32 len = state->mem_size;
+	u32 h;
+
+	if (state->large)
+		h = XXH_ROTL(state->v[0], 1) + XXH_ROTL(state->v[1], 7) + XXH_ROTL(state->v[2], 12) + XXH_ROTL(state->v[3], 18);
+	else
+		h = state->v[2] + XXH_P5;
+
+	h += state->total;
+
+	while (len >= 4)
+	{
+		h += _xxh32_read32(p) * XXH_P3;
+		h  = XXH_ROTL(h, 17) * XXH_P4;
+		p += 4;
+		len -= 4;
+	}
+
+	while (len--)
+	{
+		h += *p++ * XXH_P5;
+		h  = XXH_ROTL(h, 11) * XXH_P1;
+	}
+
+	h ^= h >> 15;
+	h *= XXH_P2;
+	h ^= h >> 13;
+	h *= XXH_P3;
+	h ^= h >> 16;
+
+	return h;
+}
+
+u32 lz4f_xxh32(const void *buf, u32 size)
+{
+	lz4f_xxh32_t state;
+
+	lz4f_xxh32_init(&state);
+	lz4f_xxh32_update(&state, buf, size);
+
+	return lz4f_xxh32_digest(&state);
+}
+
+bool lz4f_is_frame(const void *buf)
+{
+	return *(const u32 *)buf == LZ4F_MAGIC;
+}
+
+static int _lz4f_block_csum_check(lz4f_ctxt_t *ctxt, const void *data, u32 size)
+{
+	u32 csum;
+
+	if (ctxt->read(ctxt->priv, &csum, sizeof(u32)))
+		return 1;
+
+	return csum != lz4f_xxh32(data, size);
+}
+
+static int _lz4f_decode_block(lz4f_ctxt_t *ctxt)
+{
+	u32 blk_hdr;
+	u32 csum;
+
+	// Linked blocks use the previous block as dictionary.
+	u8 *prev = ctxt->out;
+	u32 prev_size = ctxt->out_size;
+
+	ctxt->out_size = 0;
+	ctxt->out_pos  = 0;
+
+	if (ctxt->end)
+		return 0;
+
+	if (ctxt->read(ctxt->priv, &blk_hdr, sizeof(u32)))
+		return 1;
+
+	// End mark.
+	if (!blk_hdr)
+	{
+		ctxt->end = true;
+
+		if (ctxt->content_csum)
+		{
+			if (ctxt->read(ctxt->priv, &csum, sizeof(u32)))
+				return 1;
+
+			if (csum != lz4f_xxh32_digest(&ctxt->xxh))
+				return 1;
+		}
+
+		return 0;
+	}
+
+	u32 size = blk_hdr & ~LZ4F_BLK_UNCOMPRESSED;
+	if (size > ctxt->block_max)
+		return 1;
+
+	ctxt->didx ^= 1;
+	u8 *dst = ctxt->dbuf[ctxt->didx];
+
+	if (blk_hdr & LZ4F_BLK_UNCOMPRESSED)
+	{
+		if (ctxt->read(ctxt->priv, dst, size))
+			return 1;
+
+		// Block checksum covers the data as stored.
+		if (ctxt->block_csum && _lz4f_block_csum_check(ctxt, dst, size))
+			return 1;
+	}
+	else
+	{
+		if (ctxt->read(ctxt->priv, ctxt->cbuf, size))
+			return 1;
+
+		if (ctxt->block_csum && _lz4f_block_csum_check(ctxt, ctxt->cbuf, size))
+			return 1;
+
+		int res;
+		if (ctxt->linked && prev_size)
+		{
+			u32 dict_size = MIN(prev_size, LZ4F_DICT_MAX);
+			res = LZ4_decompress_safe_usingDict((const char *)ctxt->cbuf, (char *)dst, size, ctxt->block_max,
+				(const char *)prev + prev_size - dict_size, dict_size);
+		}
+		else
+			res = LZ4_decompress_safe((const char *)ctxt->cbuf, (char *)dst, size, ctxt->block_max);
+
+		if (res < 0)
+			return 1;
+		size = res;
+	}
+
+	if (ctxt->content_csum)
+		lz4f_xxh32_update(&ctxt->xxh, dst, size);
+
+	ctxt->out = dst;
+	ctxt->out_size = size;
+
+	return 0;
+}
+
+int lz4f_init(lz4f_ctxt_t *ctxt, void *work)
+{
+	u8 hdr[4 + 2 + 8 + 4 + 1];
+	u32 pos = 6;
+
+	ctxt->content_size = 0;
+	ctxt->end      = false;
+	ctxt->out      = NULL;
+	ctxt->out_size = 0;
+	ctxt->out_pos  = 0;
+	ctxt->didx     = 0;
+
+	// Magic, FLG and BD.
+	if (ctxt->read(ctxt->priv, hdr, pos) || !lz4f_is_frame(hdr))
+		return 1;
+
+	u8 flg = hdr[4];
+	u8 bd  = hdr[5];
+
+	if ((flg & LZ4F_FLG_VERSION_MASK) != LZ4F_FLG_VERSION || (flg & LZ4F_FLG_DICT_ID))
+		return 1;
+
+	// Block max size. 64KB to 4MB.
+	u32 bsize_id = (bd >> 4) & 7;
+	if (bsize_id < 4)
+		return 1;
+	ctxt->block_max = SZ_64K << ((bsize_id - 4) * 2);
+
+	ctxt->linked       = !(flg & LZ4F_FLG_BLOCK_INDEP);
+	ctxt->block_csum   = !!(flg & LZ4F_FLG_BLOCK_CSUM);
+	ctxt->content_csum = !!(flg & LZ4F_FLG_CONTENT_CSUM);
+
+	// Optional content size and header checksum.
+	u32 extra = ((flg & LZ4F_FLG_CONTENT_SIZE) ? 8 : 0) + 1;
+	if (ctxt->read(ctxt->priv, &hdr[pos], extra))
+		return 1;
+	if (flg & LZ4F_FLG_CONTENT_SIZE)
+		memcpy(&ctxt->content_size, &hdr[pos], sizeof(u64));
+
+	// Header checksum is the second byte of the descriptor hash.
+	if (hdr[pos + extra - 1] != ((lz4f_xxh32(&hdr[4], pos + extra - 1 - 4) >> 8) & 0xFF))
+		return 1;
+
+	lz4f_xxh32_init(&ctxt->xxh);
+
+	ctxt->cbuf    = (u8 *)work;
+	ctxt->dbuf[0] = ctxt->cbuf + LZ4F_BLOCK_MAX;
+	ctxt->dbuf[1] = ctxt->dbuf[0] + LZ4F_BLOCK_MAX + 0x200;
+
+	// Decode the first block, so the image type can be peeked.
+	return _lz4f_decode_block(ctxt);
+}
+
+const void *lz4f_peek(lz4f_ctxt_t *ctxt, u32 size)
+{
+	if (ctxt->out_size - ctxt->out_pos < size)
+		return NULL;
+
+	return ctxt->out + ctxt->out_pos;
+}
+
+int lz4f_next_block(lz4f_ctxt_t *ctxt, u8 **out, u32 *size)
+{
+	if (ctxt->out_pos == ctxt->out_size && _lz4f_decode_block(ctxt))
+		return 1;
+
+	*out  = ctxt->out + ctxt->out_pos;
+	*size = ctxt->out_size - ctxt->out_pos;
+	ctxt->out_pos = ctxt->out_size;
+
+	return 0;
+}
+
+int lz4f_read(void *priv, void *buf, u32 size)
+{
+	lz4f_ctxt_t *ctxt = (lz4f_ctxt_t *)priv;
+
+	while (size)
+	{
+		if (ctxt->out_pos == ctxt->out_size)
+		{
+			if (_lz4f_decode_block(ctxt) || !ctxt->out_size)
+				return 1;
+		}
+
+		u32 chunk = MIN(size, ctxt->out_size - ctxt->out_pos);
+		memcpy(buf, ctxt->out + ctxt->out_pos, chunk);
+		ctxt->out_pos += chunk;
+		buf += chunk;
+		size -= chunk;
+	}
+
+	return 0;
+}
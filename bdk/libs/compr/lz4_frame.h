@@ -0,0 +1,72 @@
+/*
+ * LZ4 frame streaming decoder.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LZ4_FRAME_H_
+#define _LZ4_FRAME_H_
+
+#include <utils/types.h>
+
+#define LZ4F_MAGIC      0x184D2204
+#define LZ4F_BLOCK_MAX  SZ_4M
+
+// Compressed block buffer and two decoded block buffers, with room for sector padding.
+#define LZ4F_WORK_SIZE  (LZ4F_BLOCK_MAX + (LZ4F_BLOCK_MAX + 0x200) * 2)
+
+typedef struct _lz4f_xxh32_t
+{
+	u32 v[4];
+	u32 total;
+	bool large;
+	u8  mem[16];
+	u32 mem_size;
+} lz4f_xxh32_t;
+
+typedef struct _lz4f_ctxt_t
+{
+	// Returns 0 on success.
+	int (*read)(void *priv, void *buf, u32 size);
+	void *priv;
+
+	u64 content_size; // 0 if not stored in the frame.
+	u32 block_max;
+	bool linked;
+	bool block_csum;
+	bool content_csum;
+	bool end;
+	lz4f_xxh32_t xxh; // Running content checksum.
+
+	u8 *cbuf;
+	u8 *dbuf[2];
+	u32 didx;
+	u8 *out;
+	u32 out_size;
+	u32 out_pos;
+} lz4f_ctxt_t;
+
+void lz4f_xxh32_init(lz4f_xxh32_t *state);
+void lz4f_xxh32_update(lz4f_xxh32_t *state, const void *buf, u32 size);
+u32  lz4f_xxh32_digest(lz4f_xxh32_t *state);
+u32  lz4f_xxh32(const void *buf, u32 size);
+
+bool lz4f_is_frame(const void *buf);
+int  lz4f_init(lz4f_ctxt_t *ctxt, void *work);
+const void *lz4f_peek(lz4f_ctxt_t *ctxt, u32 size);
+int  lz4f_next_block(lz4f_ctxt_t *ctxt, u8 **out, u32 *size);
+int  lz4f_read(void *priv, void *buf, u32 size);
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * LZ4 block image format for eMMC backups.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LZ4_IMG_H_
+#define _LZ4_IMG_H_
+
+#include <utils/types.h>
+#include "lz4_frame.h"
+
+/*
+ * Each file is a standard LZ4 frame with independent blocks, followed by a skippable frame with the block index.
+ * Any LZ4 frame decoder can unpack it, and the parts of a split image can be concatenated before unpacking.
+ * Every block holds block_sectors sectors, except the last one of the image.
+ * Split images are a series of files, each with its own frame and index.
+ *
+ * Layout: frame header, blocks, end mark, skippable frame header, block index, footer.
+ */
+
+#define LZ4_IMG_FRAME_FLG   0x60 // Version 1, independent blocks, no checksums or content size.
+#define LZ4_IMG_FRAME_BD    0x70 // 4MB max block size.
+#define LZ4_IMG_FRAME_HC    0x73 // Header checksum of FLG and BD.
+#define LZ4_IMG_BLK_STORED  BIT(31)
+
+#define LZ4_IMG_SKIP_MAGIC  0x184D2A5E
+#define LZ4_IMG_MAGIC       0x49345A4C // "LZ4I".
+#define LZ4_IMG_VERSION     2
+#define LZ4_IMG_EXT         ".lz4"
+
+typedef struct _lz4_img_frame_hdr_t
+{
+	u32 magic;
+	u8  flg;
+	u8  bd;
+	u8  hc;
+} __attribute__((packed)) lz4_img_frame_hdr_t;
+
+typedef struct _lz4_img_skip_hdr_t
+{
+	u32 magic;
+	u32 size;          // Block index and footer.
+} lz4_img_skip_hdr_t;
+
+// Zero blocks are still stored compressed, so the frame stays valid, but restore can skip them.
+#define LZ4_IMG_BLK_ZERO BIT(0)
+
+typedef struct _lz4_img_blk_t
+{
+	u64 offset;        // Block data, after its block header.
+	u32 csize;         // Block header. Size with LZ4_IMG_BLK_STORED for an uncompressed block.
+	u32 flags;
+} lz4_img_blk_t;
+
+// Last bytes of the file.
+typedef struct _lz4_img_ftr_t
+{
+	u32 block_sectors;
+	u32 block_num;     // Blocks in this file.
+	u32 lba_offset;    // First sector in this file, relative to image start.
+	u32 sectors;       // Sectors in this file.
+	u32 total_sectors; // Sectors in the whole image.
+	u32 rsvd;
+	u32 version;
+	u32 magic;
+} lz4_img_ftr_t;
+
+#endif
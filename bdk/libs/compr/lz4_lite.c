@@ -0,0 +1,119 @@
+/*
+ * Small LZ4 block decoder for trusted payloads.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lz4_lite.h"
+
+/*
+ * ARMv4T has no unaligned word access, so words are only used when source and
+ * destination share alignment. Forward word copies are also safe for overlapping
+ * matches, as long as the match is at least a word behind.
+ */
+static u8 *_lz4_lite_copy(u8 *dst, const u8 *src, u32 len)
+{
+	if (len >= 8 && !(((uptr)dst ^ (uptr)src) & 3))
+	{
+		while ((uptr)dst & 3)
+		{
+			*dst++ = *src++;
+			len--;
+		}
+
+		u32 *dst32 = (u32 *)dst;
+		const u32 *src32 = (const u32 *)src;
+		while (len >= 8)
+		{
+			dst32[0] = src32[0];
+			dst32[1] = src32[1];
+			dst32 += 2;
+			src32 += 2;
+			len -= 8;
+		}
+
+		dst = (u8 *)dst32;
+		src = (const u8 *)src32;
+	}
+
+	while (len)
+	{
+		*dst++ = *src++;
+		len--;
+	}
+
+	return dst;
+}
+
+static u32 _lz4_lite_len(const u8 **in, u32 len)
+{
+	const u8 *ip = *in;
+	u32 b;
+
+	do
+	{
+		b = *ip++;
+		len += b;
+	} while (b == 255);
+
+	*in = ip;
+
+	return len;
+}
+
+u32 lz4_lite_uncompress(const u8 *in, u8 *out, u32 insize)
+{
+	const u8 *ip = in;
+	const u8 *iend = in + insize;
+	u8 *op = out;
+
+	while (ip < iend)
+	{
+		u32 token = *ip++;
+
+		// Literals.
+		u32 len = token >> 4;
+		if (len == 15)
+			len = _lz4_lite_len(&ip, len);
+		op = _lz4_lite_copy(op, ip, len);
+		ip += len;
+
+		// Last sequence has no match.
+		if (ip >= iend)
+			break;
+
+		u32 offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+
+		len = (token & 0xF) + 4;
+		if (len == 19)
+			len = _lz4_lite_len(&ip, len);
+
+		// Matches closer than a word repeat a short pattern.
+		const u8 *match = op - offset;
+		if (offset < 4)
+		{
+			while (len)
+			{
+				*op++ = *match++;
+				len--;
+			}
+		}
+		else
+			op = _lz4_lite_copy(op, match, len);
+	}
+
+	return op - out;
+}
@@ -0,0 +1,27 @@
+/*
+ * Small LZ4 block decoder for trusted payloads.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LZ4_LITE_H_
+#define _LZ4_LITE_H_
+
+#include <utils/types.h>
+
+// No bounds checking. Returns the uncompressed size.
+u32 lz4_lite_uncompress(const u8 *in, u8 *out, u32 insize);
+
+#endif
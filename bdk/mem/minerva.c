@@ -20,11 +20,15 @@
 #include "minerva.h"
 
 #include <ianos/ianos.h>
+#include <libs/fatfs/ff.h>
 #include <mem/emc_t210.h>
+#include <mem/heap.h>
 #include <soc/clock.h>
 #include <soc/fuse.h>
 #include <soc/hw_init.h>
 #include <soc/t210.h>
+#include <storage/sd.h>
+#include <utils/util.h>
 
 #define FREQ_NO_TABLE_MAX FREQ_408
 
@@ -33,10 +37,122 @@
 #define TABLE_LA_REGS_T210B01_OFFSET 0xFA4
 #define LA_SDMMC1_INDEX 6
 
+#define MTC_TRAIN_CACHE_MAGIC   0x3154524D // MRT1.
+#define MTC_TRAIN_CACHE_VERSION 1
+
+typedef struct _mtc_train_cache_hdr_t
+{
+	u32 magic;
+	u32 version;
+	u32 sdram_id;
+	u32 sdram_id_raw;
+	u32 hidrev;
+	u32 fuse_id[6];    // Vendor, fab, lot, wafer, x and y.
+	u32 table_entries;
+	u32 entry_size;
+	u32 table_crc32;   // Untrained table as provided by Minerva.
+	u32 crc32;         // Trained table.
+} mtc_train_cache_hdr_t;
+
 static bool no_table = false;
 static mtc_config_t *mtc_cfg = NULL;
+static mtc_train_cache_hdr_t *train_cache = NULL; // Pending save. Header followed by trained table.
 void (*mtc_call)(mtc_config_t *mtc_cfg, void *);
 
+static void _minerva_train_cache_hdr_init(mtc_train_cache_hdr_t *hdr)
+{
+	memset(hdr, 0, sizeof(mtc_train_cache_hdr_t));
+
+	hdr->magic         = MTC_TRAIN_CACHE_MAGIC;
+	hdr->version       = MTC_TRAIN_CACHE_VERSION;
+	hdr->sdram_id      = mtc_cfg->sdram_id;
+	hdr->sdram_id_raw  = fuse_read_dramid(true);
+	hdr->hidrev        = APB_MISC(APB_MISC_GP_HIDREV);
+	hdr->fuse_id[0]    = FUSE(FUSE_OPT_VENDOR_CODE);
+	hdr->fuse_id[1]    = FUSE(FUSE_OPT_FAB_CODE);
+	hdr->fuse_id[2]    = FUSE(FUSE_OPT_LOT_CODE_0);
+	hdr->fuse_id[3]    = FUSE(FUSE_OPT_WAFER_ID);
+	hdr->fuse_id[4]    = FUSE(FUSE_OPT_X_COORDINATE);
+	hdr->fuse_id[5]    = FUSE(FUSE_OPT_Y_COORDINATE);
+	hdr->table_entries = mtc_cfg->table_entries;
+	hdr->entry_size    = sizeof(emc_table_t);
+	hdr->table_crc32   = crc32_calc(0, (u8 *)mtc_cfg->mtc_table, mtc_cfg->table_entries * sizeof(emc_table_t));
+}
+
+static int _minerva_train_cache_load(mtc_train_cache_hdr_t *hdr)
+{
+	if (!sd_get_card_mounted())
+		return 1;
+
+	u32 size;
+	u32 table_size = mtc_cfg->table_entries * sizeof(emc_table_t);
+	mtc_train_cache_hdr_t *cache = (mtc_train_cache_hdr_t *)sd_file_read(MTC_TRAIN_CACHE_PATH, &size);
+	if (!cache)
+		return 1;
+
+	// Results are only valid for the same DRAM, SoC and untrained table.
+	u8 *table = (u8 *)cache + sizeof(mtc_train_cache_hdr_t);
+	if (size != sizeof(mtc_train_cache_hdr_t) + table_size ||
+		memcmp(cache, hdr, offsetof(mtc_train_cache_hdr_t, crc32)) ||
+		cache->crc32 != crc32_calc(0, table, table_size))
+	{
+		free(cache);
+
+		return 1;
+	}
+
+	memcpy(mtc_cfg->mtc_table, table, table_size);
+	free(cache);
+
+	return 0;
+}
+
+static void _minerva_train_cache_prep(mtc_train_cache_hdr_t *hdr)
+{
+	u32 table_size = mtc_cfg->table_entries * sizeof(emc_table_t);
+
+	// Keep a copy of the results before switching modifies the table.
+	free(train_cache);
+	train_cache = (mtc_train_cache_hdr_t *)malloc(sizeof(mtc_train_cache_hdr_t) + table_size);
+	memcpy(train_cache, hdr, sizeof(mtc_train_cache_hdr_t));
+	memcpy((u8 *)train_cache + sizeof(mtc_train_cache_hdr_t), mtc_cfg->mtc_table, table_size);
+	train_cache->crc32 = crc32_calc(0, (u8 *)mtc_cfg->mtc_table, table_size);
+}
+
+void minerva_train_cache_save()
+{
+	FIL fp;
+
+	if (!train_cache)
+		return;
+
+	if (!sd_get_card_mounted())
+		goto out;
+
+	u32 size = sizeof(mtc_train_cache_hdr_t) + train_cache->table_entries * sizeof(emc_table_t);
+
+	if (f_open(&fp, MTC_TRAIN_CACHE_PATH, FA_CREATE_ALWAYS | FA_WRITE))
+		goto out;
+
+	UINT bw = 0;
+	f_write(&fp, train_cache, size, &bw);
+	f_close(&fp);
+
+	// Do not leave a partial file behind.
+	if (bw != size)
+		f_unlink(MTC_TRAIN_CACHE_PATH);
+
+out:
+	free(train_cache);
+	train_cache = NULL;
+}
+
+void minerva_train_cache_remove()
+{
+	if (sd_get_card_mounted())
+		f_unlink(MTC_TRAIN_CACHE_PATH);
+}
+
 int minerva_init(minerva_str_t *mtc_str)
 {
 	mtc_call = NULL;
@@ -109,15 +225,26 @@ int minerva_init(minerva_str_t *mtc_str)
 		return 0;
 	}
 
-	// Train frequencies.
-	mtc_cfg->train_mode = OP_TRAIN;
+	// Use saved training results if they match this DRAM, SoC and table.
+	mtc_train_cache_hdr_t cache_hdr;
+	_minerva_train_cache_hdr_init(&cache_hdr);
+	bool cached = !_minerva_train_cache_load(&cache_hdr);
+
 	mtc_cfg->rate_from = FREQ_204;
-	mtc_cfg->rate_to = FREQ_204;
-	mtc_call(mtc_cfg, NULL);
-	mtc_cfg->rate_to = FREQ_800;
-	mtc_call(mtc_cfg, NULL);
-	mtc_cfg->rate_to = FREQ_1600;
-	mtc_call(mtc_cfg, NULL);
+	if (!cached)
+	{
+		// Train frequencies.
+		mtc_cfg->train_mode = OP_TRAIN;
+		mtc_cfg->rate_to = FREQ_204;
+		mtc_call(mtc_cfg, NULL);
+		mtc_cfg->rate_to = FREQ_800;
+		mtc_call(mtc_cfg, NULL);
+		mtc_cfg->rate_to = FREQ_1600;
+		mtc_call(mtc_cfg, NULL);
+
+		// Results are written by minerva_train_cache_save(), outside of any watchdog protected section.
+		_minerva_train_cache_prep(&cache_hdr);
+	}
 
 	// FSP WAR.
 	mtc_cfg->train_mode = OP_SWITCH;
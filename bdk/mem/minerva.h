@@ -26,6 +26,8 @@
 
 #define EMC_PERIODIC_TRAIN_MS 250
 
+#define MTC_TRAIN_CACHE_PATH "bootloader/sys/minerva_train.bin"
+
 typedef struct
 {
 	u32 rate_to;
@@ -74,6 +76,8 @@ typedef enum
 extern void (*minerva_cfg)(mtc_config_t *mtc_cfg, void *);
 int  minerva_init(minerva_str_t *mtc_str);
 void minerva_deinit();
+void minerva_train_cache_save();
+void minerva_train_cache_remove();
 void minerva_change_freq(minerva_freq_t freq);
 void minerva_sdmmc_la_program(void *table, bool t210b01);
 void minerva_prep_boot_hos();
@@ -17,6 +17,10 @@
 #ifndef _MEMORY_MAP_H_
 #define _MEMORY_MAP_H_
 
+// Checks if two regions overlap. For use in static asserts.
+#define MEM_REGION_OVERLAP(a, a_sz, b, b_sz) \
+	((unsigned long long)(a) < ((unsigned long long)(b) + (b_sz)) && (unsigned long long)(b) < ((unsigned long long)(a) + (a_sz)))
+
 /* --- BIT/BCT: 0x40000000 - 0x40003000 --- */
 /* ---     IPL: 0x40008000 - 0x40028000 --- */
 #define LDR_LOAD_ADDR     0x40007000
@@ -103,6 +107,16 @@
 #define NYX_FB2_ADDRESS  0xF6600000
 #define  NYX_FB_SZ         0x384000 // 1280 x 720 x 4.
 
+/* --- Gap: 0xF7A00000 - 0xFEEFFFFF --- */
+
+// Boot trace ring buffer. Kept after Nyx LvGL memory, so it survives Nyx launch.
+#define TRACE_BUF_ADDR   0xF7A00000
+#define  TRACE_BUF_SZ        SZ_16K
+
+// CCPLEX worker runtime. Code, page table and job ring.
+#define CCPLEX_WORKER_ADDR 0xF7A10000
+#define  CCPLEX_WORKER_SZ      SZ_64K
+
 // USB buffers.
 #define USBD_ADDR                 0xFEF00000
 #define USB_DESCRIPTOR_ADDR       0xFEF40000
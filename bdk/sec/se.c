@@ -32,9 +32,23 @@ typedef struct _se_ll_t
 	u32 size;
 } se_ll_t;
 
+typedef struct _se_aes_async_t
+{
+	bool pending;
+	bool xts;
+	u32 *dst;
+	u32  size;
+	u8  *res_dst;
+	const u8 *res_src;
+	u32  res_size;
+	u32  tweak[SE_AES_BLOCK_SIZE / sizeof(u32)];
+} se_aes_async_t;
+
 se_ll_t ll_src, ll_dst; // Must be u32 aligned.
 se_ll_t *ll_src_ptr, *ll_dst_ptr;
 
+static se_aes_async_t aes_async = { 0 };
+
 static void _se_ls_1bit(void *buf)
 {
 	u8 *block = (u8 *)buf;
@@ -178,7 +192,26 @@ static int _se_execute_oneshot(u32 op, void *dst, u32 dst_size, const void *src,
 	return _se_execute(op, dst, dst_size, src, src_size, true);
 }
 
-static int _se_execute_aes_oneshot(void *dst, const void *src, u32 size)
+static int _se_execute_aes_residue(void *dst, const void *src, u32 size_residue)
+{
+	// Copy message to a block sized buffer in case it's partial.
+	u32 block[SE_AES_BLOCK_SIZE / sizeof(u32)] = {0};
+	memcpy(block, src, size_residue);
+
+	// Use updated IV for CBC and OFB. Ignored on others.
+	SE(SE_CRYPTO_CONFIG_REG) |= SE_CRYPTO_IV_SEL(IV_UPDATED);
+
+	SE(SE_CRYPTO_LAST_BLOCK_REG) = (SE_AES_BLOCK_SIZE >> 4) - 1;
+
+	int res = _se_execute_oneshot(SE_OP_START, block, SE_AES_BLOCK_SIZE, block, SE_AES_BLOCK_SIZE);
+
+	// Copy result back.
+	memcpy(dst, block, size_residue);
+
+	return res;
+}
+
+static int _se_execute_aes(void *dst, const void *src, u32 size, bool is_oneshot)
 {
 	// Set optional memory interface.
 	if (dst >= (void *)DRAM_START && src >= (void *)DRAM_START)
@@ -193,30 +226,32 @@ static int _se_execute_aes_oneshot(void *dst, const void *src, u32 size)
 	{
 		SE(SE_CRYPTO_LAST_BLOCK_REG) = (size >> 4) - 1;
 
-		res = _se_execute_oneshot(SE_OP_START, dst, size_aligned, src, size_aligned);
+		res = _se_execute(SE_OP_START, dst, size_aligned, src, size_aligned, is_oneshot);
+
+		// Leftover partial message is handled on finalize if async.
+		if (!is_oneshot)
+		{
+			aes_async.pending  = !res;
+			aes_async.res_dst  = (u8 *)dst + size_aligned;
+			aes_async.res_src  = (const u8 *)src + size_aligned;
+			aes_async.res_size = size_residue;
+
+			return res;
+		}
 	}
 
 	// Handle leftover partial message.
 	if (!res && size_residue)
-	{
-		// Copy message to a block sized buffer in case it's partial.
-		u32 block[SE_AES_BLOCK_SIZE / sizeof(u32)] = {0};
-		memcpy(block, src + size_aligned, size_residue);
-
-		// Use updated IV for CBC and OFB. Ignored on others.
-		SE(SE_CRYPTO_CONFIG_REG) |= SE_CRYPTO_IV_SEL(IV_UPDATED);
-
-		SE(SE_CRYPTO_LAST_BLOCK_REG) = (SE_AES_BLOCK_SIZE >> 4) - 1;
-
-		res = _se_execute_oneshot(SE_OP_START, block, SE_AES_BLOCK_SIZE, block, SE_AES_BLOCK_SIZE);
-
-		// Copy result back.
-		memcpy(dst + size_aligned, block, size_residue);
-	}
+		res = _se_execute_aes_residue(dst + size_aligned, src + size_aligned, size_residue);
 
 	return res;
 }
 
+static int _se_execute_aes_oneshot(void *dst, const void *src, u32 size)
+{
+	return _se_execute_aes(dst, src, size, true);
+}
+
 static void _se_aes_counter_set(const void *ctr)
 {
 	u32 data[SE_AES_IV_SIZE / sizeof(u32)];
@@ -319,7 +354,7 @@ int se_aes_unwrap_key(u32 ks_dst, u32 ks_src, const void *seed)
 	return _se_execute_oneshot(SE_OP_START, NULL, 0, seed, SE_KEY_128_SIZE);
 }
 
-int se_aes_crypt_ecb(u32 ks, int enc, void *dst, const void *src, u32 size)
+static void _se_aes_ecb_config(u32 ks, int enc)
 {
 	if (enc)
 	{
@@ -333,11 +368,23 @@ int se_aes_crypt_ecb(u32 ks, int enc, void *dst, const void *src, u32 size)
 		SE(SE_CRYPTO_CONFIG_REG) = SE_CRYPTO_KEY_INDEX(ks)         | SE_CRYPTO_CORE_SEL(CORE_DECRYPT) |
 								   SE_CRYPTO_XOR_POS(XOR_BYPASS);
 	}
+}
+
+int se_aes_crypt_ecb(u32 ks, int enc, void *dst, const void *src, u32 size)
+{
+	_se_aes_ecb_config(ks, enc);
 
 	return _se_execute_aes_oneshot(dst, src, size);
 }
 
-int se_aes_crypt_cbc(u32 ks, int enc, void *dst, const void *src, u32 size)
+int se_aes_crypt_ecb_async(u32 ks, int enc, void *dst, const void *src, u32 size)
+{
+	_se_aes_ecb_config(ks, enc);
+
+	return _se_execute_aes(dst, src, size, false);
+}
+
+static void _se_aes_cbc_config(u32 ks, int enc)
 {
 	if (enc)
 	{
@@ -351,10 +398,22 @@ int se_aes_crypt_cbc(u32 ks, int enc, void *dst, const void *src, u32 size)
 		SE(SE_CRYPTO_CONFIG_REG) = SE_CRYPTO_KEY_INDEX(ks)          | SE_CRYPTO_VCTRAM_SEL(VCTRAM_PREVMEM) |
 								   SE_CRYPTO_CORE_SEL(CORE_DECRYPT) | SE_CRYPTO_XOR_POS(XOR_BOTTOM);
 	}
+}
+
+int se_aes_crypt_cbc(u32 ks, int enc, void *dst, const void *src, u32 size)
+{
+	_se_aes_cbc_config(ks, enc);
 
 	return _se_execute_aes_oneshot(dst, src, size);
 }
 
+int se_aes_crypt_cbc_async(u32 ks, int enc, void *dst, const void *src, u32 size)
+{
+	_se_aes_cbc_config(ks, enc);
+
+	return _se_execute_aes(dst, src, size, false);
+}
+
 int se_aes_crypt_ofb(u32 ks, void *dst, const void *src, u32 size)
 {
 	SE(SE_SPARE_REG)         = SE_INPUT_NONCE_LE;
@@ -365,7 +424,7 @@ int se_aes_crypt_ofb(u32 ks, void *dst, const void *src, u32 size)
 	return _se_execute_aes_oneshot(dst, src, size);
 }
 
-int se_aes_crypt_ctr(u32 ks, void *dst, const void *src, u32 size, void *ctr)
+static void _se_aes_ctr_config(u32 ks, const void *ctr)
 {
 	SE(SE_SPARE_REG)         = SE_INPUT_NONCE_LE;
 	SE(SE_CONFIG_REG)        = SE_CONFIG_ENC_MODE(MODE_KEY128) | SE_CONFIG_ENC_ALG(ALG_AES_ENC)     | SE_CONFIG_DST(DST_MEMORY);
@@ -374,10 +433,22 @@ int se_aes_crypt_ctr(u32 ks, void *dst, const void *src, u32 size, void *ctr)
 							   SE_CRYPTO_CTR_CNTN(1);
 
 	_se_aes_counter_set(ctr);
+}
+
+int se_aes_crypt_ctr(u32 ks, void *dst, const void *src, u32 size, void *ctr)
+{
+	_se_aes_ctr_config(ks, ctr);
 
 	return _se_execute_aes_oneshot(dst, src, size);
 }
 
+int se_aes_crypt_ctr_async(u32 ks, void *dst, const void *src, u32 size, void *ctr)
+{
+	_se_aes_ctr_config(ks, ctr);
+
+	return _se_execute_aes(dst, src, size, false);
+}
+
 int se_aes_crypt_xts_sec(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, void *dst, void *src, u32 secsize)
 {
 	u32 tmp[SE_AES_BLOCK_SIZE / sizeof(u32)];
@@ -414,7 +485,7 @@ int se_aes_crypt_xts_sec(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, void *dst
 	return 0;
 }
 
-int se_aes_crypt_xts_sec_nx(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, u8 *tweak, bool regen_tweak, u32 tweak_exp, void *dst, void *src, u32 sec_size)
+static int _se_aes_xts_nx_tweak_pre(u32 tweak_ks, u64 sec, u8 *tweak, bool regen_tweak, u32 tweak_exp, u8 *orig_tweak, void *dst, void *src, u32 sec_size)
 {
 	u32 *pdst = (u32 *)dst;
 	u32 *psrc = (u32 *)src;
@@ -435,7 +506,6 @@ int se_aes_crypt_xts_sec_nx(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, u8 *tw
 	for (u32 i = 0; i < (tweak_exp << 5); i++)
 		_se_ls_1bit_le(tweak);
 
-	u8 orig_tweak[SE_KEY_128_SIZE] __attribute__((aligned(4)));
 	memcpy(orig_tweak, tweak, SE_KEY_128_SIZE);
 
 	// We are assuming a 16 sector aligned size in this implementation.
@@ -449,11 +519,14 @@ int se_aes_crypt_xts_sec_nx(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, u8 *tw
 		pdst += sizeof(u32);
 	}
 
-	if (se_aes_crypt_ecb(crypt_ks, enc, dst, dst, sec_size))
-		return 1;
+	return 0;
+}
+
+static void _se_aes_xts_nx_tweak_post(u8 *orig_tweak, void *dst, u32 sec_size)
+{
+	u32 *pdst = (u32 *)dst;
+	u32 *ptweak = (u32 *)orig_tweak;
 
-	pdst = (u32 *)dst;
-	ptweak = (u32 *)orig_tweak;
 	for (u32 i = 0; i < (sec_size >> 4); i++)
 	{
 		for (u32 j = 0; j < (SE_AES_BLOCK_SIZE / sizeof(u32)); j++)
@@ -462,10 +535,75 @@ int se_aes_crypt_xts_sec_nx(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, u8 *tw
 		_se_ls_1bit_le(orig_tweak);
 		pdst += sizeof(u32);
 	}
+}
+
+int se_aes_crypt_xts_sec_nx(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, u8 *tweak, bool regen_tweak, u32 tweak_exp, void *dst, void *src, u32 sec_size)
+{
+	u8 orig_tweak[SE_KEY_128_SIZE] __attribute__((aligned(4)));
+
+	if (_se_aes_xts_nx_tweak_pre(tweak_ks, sec, tweak, regen_tweak, tweak_exp, orig_tweak, dst, src, sec_size))
+		return 1;
+
+	if (se_aes_crypt_ecb(crypt_ks, enc, dst, dst, sec_size))
+		return 1;
+
+	_se_aes_xts_nx_tweak_post(orig_tweak, dst, sec_size);
 
 	return 0;
 }
 
+int se_aes_crypt_xts_sec_nx_async(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, u8 *tweak, bool regen_tweak, u32 tweak_exp, void *dst, void *src, u32 sec_size)
+{
+	if (_se_aes_xts_nx_tweak_pre(tweak_ks, sec, tweak, regen_tweak, tweak_exp, (u8 *)aes_async.tweak, dst, src, sec_size))
+		return 1;
+
+	if (se_aes_crypt_ecb_async(crypt_ks, enc, dst, dst, sec_size))
+		return 1;
+
+	// Less than a block was done in place.
+	if (!aes_async.pending)
+	{
+		_se_aes_xts_nx_tweak_post((u8 *)aes_async.tweak, dst, sec_size);
+		return 0;
+	}
+
+	// Output tweak is applied on finalize.
+	aes_async.xts  = true;
+	aes_async.dst  = (u32 *)dst;
+	aes_async.size = sec_size;
+
+	return 0;
+}
+
+bool se_aes_async_done()
+{
+	if (!aes_async.pending)
+		return true;
+
+	return !!(SE(SE_INT_STATUS_REG) & SE_INT_OP_DONE);
+}
+
+int se_aes_finalize()
+{
+	if (!aes_async.pending)
+		return 0;
+
+	aes_async.pending = false;
+
+	int res = _se_execute_finalize();
+
+	// Handle leftover partial message.
+	if (!res && aes_async.res_size)
+		res = _se_execute_aes_residue(aes_async.res_dst, aes_async.res_src, aes_async.res_size);
+
+	if (!res && aes_async.xts)
+		_se_aes_xts_nx_tweak_post((u8 *)aes_async.tweak, aes_async.dst, aes_async.size);
+
+	aes_async.xts = false;
+
+	return res;
+}
+
 int se_aes_crypt_xts(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, void *dst, void *src, u32 secsize, u32 num_secs)
 {
 	u8 *pdst = (u8 *)dst;
@@ -487,16 +625,36 @@ static void _se_sha_hash_256_get_hash(void *hash)
 	memcpy(hash, hash32, SE_SHA_256_SIZE);
 }
 
+static void _se_sha_hash_256_null(void *hash)
+{
+	static const u8 null_hash[SE_SHA_256_SIZE] = {
+		0xE3, 0xB0, 0xC4, 0x42, 0x98, 0xFC, 0x1C, 0x14, 0x9A, 0xFB, 0xF4, 0xC8, 0x99, 0x6F, 0xB9, 0x24,
+		0x27, 0xAE, 0x41, 0xE4, 0x64, 0x9B, 0x93, 0x4C, 0xA4, 0x95, 0x99, 0x1B, 0x78, 0x52, 0xB8, 0x55
+	};
+	memcpy(hash, null_hash, SE_SHA_256_SIZE);
+}
+
+static void _se_sha_hash_256_size_set(u64 total_size, u32 msg_left)
+{
+	// Set total size: BITS(total_size), up to 2 EB.
+	SE(SE_SHA_MSG_LENGTH_0_REG) = (u32)(total_size << 3);
+	SE(SE_SHA_MSG_LENGTH_1_REG) = (u32)(total_size >> 29);
+	SE(SE_SHA_MSG_LENGTH_2_REG) = 0;
+	SE(SE_SHA_MSG_LENGTH_3_REG) = 0;
+
+	// Set leftover size: BITS(src_size).
+	SE(SE_SHA_MSG_LEFT_0_REG) = (u32)(msg_left << 3);
+	SE(SE_SHA_MSG_LEFT_1_REG) = (u32)(msg_left >> 29);
+	SE(SE_SHA_MSG_LEFT_2_REG) = 0;
+	SE(SE_SHA_MSG_LEFT_3_REG) = 0;
+}
+
 static int _se_sha_hash_256(void *hash, u64 total_size, const void *src, u32 src_size, bool is_oneshot)
 {
 	// Src size of 0 is not supported, so return null string sha256.
 	if (!src_size)
 	{
-		const u8 null_hash[SE_SHA_256_SIZE] = {
-			0xE3, 0xB0, 0xC4, 0x42, 0x98, 0xFC, 0x1C, 0x14, 0x9A, 0xFB, 0xF4, 0xC8, 0x99, 0x6F, 0xB9, 0x24,
-			0x27, 0xAE, 0x41, 0xE4, 0x64, 0x9B, 0x93, 0x4C, 0xA4, 0x95, 0x99, 0x1B, 0x78, 0x52, 0xB8, 0x55
-		};
-		memcpy(hash, null_hash, SE_SHA_256_SIZE);
+		_se_sha_hash_256_null(hash);
 		return 0;
 	}
 
@@ -508,17 +666,7 @@ static int _se_sha_hash_256(void *hash, u64 total_size, const void *src, u32 src
 	// Setup config for SHA256.
 	SE(SE_CONFIG_REG) = SE_CONFIG_ENC_MODE(MODE_SHA256) | SE_CONFIG_ENC_ALG(ALG_SHA) | SE_CONFIG_DST(DST_HASHREG);
 
-	// Set total size: BITS(total_size), up to 2 EB.
-	SE(SE_SHA_MSG_LENGTH_0_REG) = (u32)(total_size << 3);
-	SE(SE_SHA_MSG_LENGTH_1_REG) = (u32)(total_size >> 29);
-	SE(SE_SHA_MSG_LENGTH_2_REG) = 0;
-	SE(SE_SHA_MSG_LENGTH_3_REG) = 0;
-
-	// Set leftover size: BITS(src_size).
-	SE(SE_SHA_MSG_LEFT_0_REG) = (u32)(msg_left << 3);
-	SE(SE_SHA_MSG_LEFT_1_REG) = (u32)(msg_left >> 29);
-	SE(SE_SHA_MSG_LEFT_2_REG) = 0;
-	SE(SE_SHA_MSG_LEFT_3_REG) = 0;
+	_se_sha_hash_256_size_set(total_size, msg_left);
 
 	// Set config based on init or partial continuation.
 	if (total_size == src_size || !total_size)
@@ -577,6 +725,72 @@ int se_sha_hash_256_finalize(void *hash)
 	return res;
 }
 
+int se_sha_hash_256_batch(se_sha_job_t *jobs, u32 count)
+{
+	static se_ll_t ll_jobs[SE_SHA_BATCH_MAX]; // Must be u32 aligned.
+	int res = 0;
+
+	while (count)
+	{
+		u32 batch = MIN(count, SE_SHA_BATCH_MAX);
+
+		// Queue linked lists for the whole batch.
+		for (u32 i = 0; i < batch; i++)
+			_se_ll_set(&ll_jobs[i], (u32)jobs[i].src, jobs[i].size);
+
+		// Setup config for SHA256. Each job is a full message.
+		SE(SE_CONFIG_REG) = SE_CONFIG_ENC_MODE(MODE_SHA256) | SE_CONFIG_ENC_ALG(ALG_SHA) | SE_CONFIG_DST(DST_HASHREG);
+		SE(SE_OUT_LL_ADDR_REG) = 0;
+		ll_src_ptr = NULL;
+		ll_dst_ptr = NULL;
+
+		// Flush data and linked lists once for all jobs.
+		bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLEAN_WAY, false);
+
+		for (u32 i = 0; i < batch; i++)
+		{
+			se_sha_job_t *job = &jobs[i];
+
+			// Src size of 0 is not supported, so return null string sha256.
+			if (!job->size)
+			{
+				_se_sha_hash_256_null(job->hash);
+				continue;
+			}
+
+			if (job->size > SE_LL_MAX_SIZE)
+			{
+				memset(job->hash, 0, SE_SHA_256_SIZE);
+				res = 1;
+				continue;
+			}
+
+			_se_sha_hash_256_size_set(job->size, job->size);
+			SE(SE_SHA_CONFIG_REG) = SHA_INIT_HASH;
+			SE(SE_IN_LL_ADDR_REG) = (u32)&ll_jobs[i];
+
+			// Clear status.
+			SE(SE_ERR_STATUS_REG) = SE(SE_ERR_STATUS_REG);
+			SE(SE_INT_STATUS_REG) = SE(SE_INT_STATUS_REG);
+
+			SE(SE_OPERATION_REG) = SE_OP_START;
+
+			if (_se_op_wait())
+			{
+				memset(job->hash, 0, SE_SHA_256_SIZE);
+				res = 1;
+			}
+			else
+				_se_sha_hash_256_get_hash(job->hash);
+		}
+
+		jobs  += batch;
+		count -= batch;
+	}
+
+	return res;
+}
+
 int se_rng_pseudo(void *dst, u32 size)
 {
 	// Setup config for SP 800-90 PRNG.
@@ -21,6 +21,15 @@
 #include "se_t210.h"
 #include <utils/types.h>
 
+#define SE_SHA_BATCH_MAX 16
+
+typedef struct _se_sha_job_t
+{
+	void       *hash;
+	const void *src;
+	u32         size;
+} se_sha_job_t;
+
 void se_rsa_acc_ctrl(u32 rs, u32 flags);
 void se_key_acc_ctrl(u32 ks, u32 flags);
 u32  se_key_acc_ctrl_get(u32 ks);
@@ -41,6 +50,13 @@ int  se_aes_crypt_ctr(u32 ks, void *dst, const void *src, u32 size, void *ctr);
 int  se_aes_crypt_xts_sec(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, void *dst, void *src, u32 secsize);
 int  se_aes_crypt_xts_sec_nx(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, u8 *tweak, bool regen_tweak, u32 tweak_exp, void *dst, void *src, u32 sec_size);
 int  se_aes_crypt_xts(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, void *dst, void *src, u32 secsize, u32 num_secs);
+/*! Async Encryption Functions. No other SE operation is allowed until finalized. */
+int  se_aes_crypt_ecb_async(u32 ks, int enc, void *dst, const void *src, u32 size);
+int  se_aes_crypt_cbc_async(u32 ks, int enc, void *dst, const void *src, u32 size);
+int  se_aes_crypt_ctr_async(u32 ks, void *dst, const void *src, u32 size, void *ctr);
+int  se_aes_crypt_xts_sec_nx_async(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, u8 *tweak, bool regen_tweak, u32 tweak_exp, void *dst, void *src, u32 sec_size);
+bool se_aes_async_done();
+int  se_aes_finalize();
 /*! Hashing Functions */
 int  se_sha_hash_256_async(void *hash, const void *src, u32 size);
 int  se_sha_hash_256_oneshot(void *hash, const void *src, u32 size);
@@ -48,6 +64,7 @@ int  se_sha_hash_256_partial_start(void *hash, const void *src, u32 size, bool i
 int  se_sha_hash_256_partial_update(void *hash, const void *src, u32 size, bool is_oneshot);
 int  se_sha_hash_256_partial_end(void *hash, u64 total_size, const void *src, u32 src_size, bool is_oneshot);
 int  se_sha_hash_256_finalize(void *hash);
+int  se_sha_hash_256_batch(se_sha_job_t *jobs, u32 count);
 int  se_aes_hash_cmac(u32 ks, void *hash, const void *src, u32 size);
 /*! Random Functions */
 int  se_rng_pseudo(void *dst, u32 size);
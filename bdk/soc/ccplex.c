@@ -1,6 +1,6 @@
 /*
  * Copyright (c) 2018 naehrwert
- * Copyright (c) 2018-2024 CTCaer
+ * Copyright (c) 2018-2026 CTCaer
  *
  * This program is free software; you can redistribute it and/or modify it
  * under the terms and conditions of the GNU General Public License,
@@ -15,13 +15,17 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include <memory_map.h>
+#include <soc/bpmp.h>
 #include <soc/ccplex.h>
 #include <soc/hw_init.h>
 #include <soc/i2c.h>
 #include <soc/clock.h>
 #include <soc/pmc.h>
 #include <soc/t210.h>
+#include <soc/timer.h>
 #include <power/max77620.h>
 #include <power/max7762x.h>
 #include <power/max77812.h>
@@ -29,6 +33,137 @@
 
 #define CCPLEX_FLOWCTRL_POWERGATING 0
 
+#define CCPLEX_WORKER_PT_OFF   0x1000
+#define CCPLEX_WORKER_RING_OFF 0x2000
+
+#define CCPLEX_PTE_BLOCK   (1 << 0)
+#define CCPLEX_PTE_ATTR(x) ((x) << 2)
+#define CCPLEX_PTE_SH_OUT  (2 << 8)
+#define CCPLEX_PTE_AF      (1 << 10)
+#define CCPLEX_PTE_XN      (1ULL << 54)
+
+#define CCPLEX_PTE_DEVICE (CCPLEX_PTE_XN | CCPLEX_PTE_AF | CCPLEX_PTE_ATTR(0) | CCPLEX_PTE_BLOCK) // Device-nGnRnE.
+#define CCPLEX_PTE_NORMAL (CCPLEX_PTE_AF | CCPLEX_PTE_SH_OUT | CCPLEX_PTE_ATTR(1) | CCPLEX_PTE_BLOCK) // Normal Non-cacheable.
+
+#define CCPLEX_WORKER_TIMEOUT 10000 // ms.
+
+static_assert(CCPLEX_WORKER_RING_OFF + sizeof(ccplex_ring_t) <= CCPLEX_WORKER_SZ, "CCPLEX worker ring does not fit!");
+static_assert(!MEM_REGION_OVERLAP(CCPLEX_WORKER_ADDR, CCPLEX_WORKER_SZ, NYX_LV_VDB_ADR, NYX_LV_MEM_ADR + NYX_LV_MEM_SZ - NYX_LV_VDB_ADR),
+			  "CCPLEX worker overlaps Nyx LvGL memory!");
+static_assert(!MEM_REGION_OVERLAP(CCPLEX_WORKER_ADDR, CCPLEX_WORKER_SZ, IPL_FB_ADDRESS, NYX_FB2_ADDRESS + NYX_FB_SZ - IPL_FB_ADDRESS),
+			  "CCPLEX worker overlaps framebuffers!");
+static_assert(!MEM_REGION_OVERLAP(CCPLEX_WORKER_ADDR, CCPLEX_WORKER_SZ, TRACE_BUF_ADDR, TRACE_BUF_SZ),
+			  "CCPLEX worker overlaps trace buffer!");
+static_assert(!MEM_REGION_OVERLAP(CCPLEX_WORKER_ADDR, CCPLEX_WORKER_SZ, USBD_ADDR, USB_EP_BULK_OUT_BUF_ADDR + USB_EP_BULK_OUT_MAX_XFER - USBD_ADDR),
+			  "CCPLEX worker overlaps USB buffers!");
+
+/*
+ * AArch64 worker. Runs at EL3 from CCPLEX_WORKER_ADDR. Source is in tools/ccplex_worker.
+ * Identity maps 4GB with the page table at +0x1000 and serves the job ring at +0x2000.
+ * DRAM is Non-cacheable on both sides, so no cache maintenance is needed on CCPLEX.
+ */
+static const u8 ccplex_worker_payload[] = {
+	0x13, 0x00, 0x00, 0x10, // 0x000: ADR    X19, _start
+	0x74, 0x06, 0x40, 0x91, // 0x004: ADD    X20, X19, #0x1000
+	0x73, 0x0A, 0x40, 0x91, // 0x008: ADD    X19, X19, #0x2000
+	0x14, 0x20, 0x1E, 0xD5, // 0x00C: MSR    TTBR0_EL3, X20
+	0x00, 0x80, 0x88, 0xD2, // 0x010: MOV    X0, #0x4400
+	0x00, 0xA2, 0x1E, 0xD5, // 0x014: MSR    MAIR_EL3, X0
+	0x00, 0x04, 0x80, 0xD2, // 0x018: MOV    X0, #0x20
+	0x00, 0x10, 0xB0, 0xF2, // 0x01C: MOVK   X0, #0x8080, LSL #16
+	0x40, 0x20, 0x1E, 0xD5, // 0x020: MSR    TCR_EL3, X0
+	0xDF, 0x3F, 0x03, 0xD5, // 0x024: ISB
+	0x1F, 0x87, 0x0E, 0xD5, // 0x028: TLBI   ALLE3
+	0x9F, 0x3F, 0x03, 0xD5, // 0x02C: DSB    SY
+	0xDF, 0x3F, 0x03, 0xD5, // 0x030: ISB
+	0x00, 0x10, 0x3E, 0xD5, // 0x034: MRS    X0, SCTLR_EL3
+	0x00, 0x00, 0x40, 0xB2, // 0x038: ORR    X0, X0, #1
+	0x00, 0xF8, 0x7E, 0x92, // 0x03C: AND    X0, X0, #~0x2
+	0x00, 0xF8, 0x6C, 0x92, // 0x040: AND    X0, X0, #~0x80000
+	0x00, 0x10, 0x1E, 0xD5, // 0x044: MSR    SCTLR_EL3, X0
+	0xDF, 0x3F, 0x03, 0xD5, // 0x048: ISB
+	0x75, 0x42, 0x40, 0xB9, // 0x04C: LDR    W21, [X19, #0x40]
+	// poll:
+	0x60, 0xFE, 0xDF, 0x88, // 0x050: LDAR   W0, [X19]
+	0x1F, 0x00, 0x15, 0x6B, // 0x054: CMP    W0, W21
+	0xC0, 0xFF, 0xFF, 0x54, // 0x058: B.EQ   poll
+	0xA1, 0x16, 0x00, 0x12, // 0x05C: AND    W1, W21, #63
+	0x62, 0x02, 0x02, 0x91, // 0x060: ADD    X2, X19, #0x80
+	0x42, 0x14, 0x01, 0x8B, // 0x064: ADD    X2, X2, X1, LSL #5
+	0x43, 0x00, 0x40, 0xB9, // 0x068: LDR    W3, [X2]
+	0x45, 0x18, 0x41, 0x29, // 0x06C: LDP    W5, W6, [X2, #8]
+	0x47, 0x20, 0x42, 0x29, // 0x070: LDP    W7, W8, [X2, #16]
+	0x09, 0x00, 0x80, 0x52, // 0x074: MOV    W9, #0
+	0x7F, 0x04, 0x00, 0x71, // 0x078: CMP    W3, #1
+	0x00, 0x01, 0x00, 0x54, // 0x07C: B.EQ   job_memcpy
+	0x7F, 0x08, 0x00, 0x71, // 0x080: CMP    W3, #2
+	0xA0, 0x02, 0x00, 0x54, // 0x084: B.EQ   job_memset
+	0x7F, 0x0C, 0x00, 0x71, // 0x088: CMP    W3, #3
+	0x00, 0x04, 0x00, 0x54, // 0x08C: B.EQ   job_crc32
+	0x83, 0x05, 0x00, 0x34, // 0x090: CBZ    W3, job_done
+	0x09, 0x00, 0x80, 0x12, // 0x094: MOV    W9, #-1
+	0x2A, 0x00, 0x00, 0x14, // 0x098: B      job_done
+	// job_memcpy:
+	0xFF, 0x80, 0x00, 0xF1, // 0x09C: CMP    X7, #32
+	0x23, 0x01, 0x00, 0x54, // 0x0A0: B.LO   memcpy_tail
+	0xCA, 0x2C, 0x40, 0xA9, // 0x0A4: LDP    X10, X11, [X6]
+	0xCC, 0x34, 0x41, 0xA9, // 0x0A8: LDP    X12, X13, [X6, #16]
+	0xAA, 0x2C, 0x00, 0xA9, // 0x0AC: STP    X10, X11, [X5]
+	0xAC, 0x34, 0x01, 0xA9, // 0x0B0: STP    X12, X13, [X5, #16]
+	0xC6, 0x80, 0x00, 0x91, // 0x0B4: ADD    X6, X6, #32
+	0xA5, 0x80, 0x00, 0x91, // 0x0B8: ADD    X5, X5, #32
+	0xE7, 0x80, 0x00, 0xD1, // 0x0BC: SUB    X7, X7, #32
+	0xF7, 0xFF, 0xFF, 0x17, // 0x0C0: B      job_memcpy
+	// memcpy_tail:
+	0xE7, 0x03, 0x00, 0xB4, // 0x0C4: CBZ    X7, job_done
+	0xCA, 0x14, 0x40, 0x38, // 0x0C8: LDRB   W10, [X6], #1
+	0xAA, 0x14, 0x00, 0x38, // 0x0CC: STRB   W10, [X5], #1
+	0xE7, 0x04, 0x00, 0xD1, // 0x0D0: SUB    X7, X7, #1
+	0xFC, 0xFF, 0xFF, 0x17, // 0x0D4: B      memcpy_tail
+	// job_memset:
+	0x08, 0x1D, 0x40, 0x92, // 0x0D8: AND    X8, X8, #0xFF
+	0x08, 0x21, 0x08, 0xAA, // 0x0DC: ORR    X8, X8, X8, LSL #8
+	0x08, 0x41, 0x08, 0xAA, // 0x0E0: ORR    X8, X8, X8, LSL #16
+	0x08, 0x81, 0x08, 0xAA, // 0x0E4: ORR    X8, X8, X8, LSL #32
+	// memset_loop:
+	0xFF, 0x40, 0x00, 0xF1, // 0x0E8: CMP    X7, #16
+	0x83, 0x00, 0x00, 0x54, // 0x0EC: B.LO   memset_tail
+	0xA8, 0x20, 0x81, 0xA8, // 0x0F0: STP    X8, X8, [X5], #16
+	0xE7, 0x40, 0x00, 0xD1, // 0x0F4: SUB    X7, X7, #16
+	0xFC, 0xFF, 0xFF, 0x17, // 0x0F8: B      memset_loop
+	// memset_tail:
+	0x27, 0x02, 0x00, 0xB4, // 0x0FC: CBZ    X7, job_done
+	0xA8, 0x14, 0x00, 0x38, // 0x100: STRB   W8, [X5], #1
+	0xE7, 0x04, 0x00, 0xD1, // 0x104: SUB    X7, X7, #1
+	0xFD, 0xFF, 0xFF, 0x17, // 0x108: B      memset_tail
+	// job_crc32:
+	0xE9, 0x03, 0x28, 0x2A, // 0x10C: MVN    W9, W8
+	// crc32_loop:
+	0xFF, 0x20, 0x00, 0xF1, // 0x110: CMP    X7, #8
+	0xA3, 0x00, 0x00, 0x54, // 0x114: B.LO   crc32_tail
+	0xCA, 0x84, 0x40, 0xF8, // 0x118: LDR    X10, [X6], #8
+	0x29, 0x4D, 0xCA, 0x9A, // 0x11C: CRC32X W9, W9, X10
+	0xE7, 0x20, 0x00, 0xD1, // 0x120: SUB    X7, X7, #8
+	0xFB, 0xFF, 0xFF, 0x17, // 0x124: B      crc32_loop
+	// crc32_tail:
+	0xA7, 0x00, 0x00, 0xB4, // 0x128: CBZ    X7, crc32_end
+	0xCA, 0x14, 0x40, 0x38, // 0x12C: LDRB   W10, [X6], #1
+	0x29, 0x41, 0xCA, 0x1A, // 0x130: CRC32B W9, W9, W10
+	0xE7, 0x04, 0x00, 0xD1, // 0x134: SUB    X7, X7, #1
+	0xFC, 0xFF, 0xFF, 0x17, // 0x138: B      crc32_tail
+	// crc32_end:
+	0xE9, 0x03, 0x29, 0x2A, // 0x13C: MVN    W9, W9
+	// job_done:
+	0x49, 0x04, 0x00, 0xB9, // 0x140: STR    W9, [X2, #4]
+	0xB5, 0x06, 0x00, 0x11, // 0x144: ADD    W21, W21, #1
+	0xBF, 0x3F, 0x03, 0xD5, // 0x148: DMB    SY
+	0x75, 0x42, 0x00, 0xB9, // 0x14C: STR    W21, [X19, #0x40]
+	0xC0, 0xFF, 0xFF, 0x17, // 0x150: B      poll
+};
+
+static bool ccplex_worker_on   = false;
+static u32  ccplex_worker_head = 0;
+
 static void _ccplex_enable_power_t210()
 {
 	// Configure GPIO5 and enable output in order to power CPU pmic.
@@ -65,6 +200,10 @@ static void _ccplex_disable_power()
 
 void ccplex_boot_cpu0(u32 entry, bool lock)
 {
+	// Worker owns CPU0. Stop it first.
+	if (ccplex_worker_on)
+		ccplex_worker_stop();
+
 	// Set ACTIVE_CLUSER to FAST.
 	FLOW_CTLR(FLOW_CTLR_BPMP_CLUSTER_CONTROL) &= ~CLUSTER_CTRL_ACTIVE_SLOW;
 
@@ -161,3 +300,161 @@ void ccplex_powergate_cpu0()
 
 	_ccplex_disable_power();
 }
+
+static ccplex_ring_t *_ccplex_worker_ring()
+{
+	return (ccplex_ring_t *)(CCPLEX_WORKER_ADDR + CCPLEX_WORKER_RING_OFF);
+}
+
+static u32 _ccplex_worker_tail()
+{
+	// Drop stale lines. BPMP cache is write-through, so nothing is lost.
+	bpmp_mmu_maintenance(BPMP_MMU_MAINT_INVALID_WAY, false);
+
+	return _ccplex_worker_ring()->tail;
+}
+
+static u32 _ccplex_worker_job_run(ccplex_job_t *job)
+{
+	switch (job->op)
+	{
+	case CCPLEX_JOB_NOP:
+		return 0;
+	case CCPLEX_JOB_MEMCPY:
+		memcpy((void *)job->dst, (void *)job->src, job->size);
+		return 0;
+	case CCPLEX_JOB_MEMSET:
+		memset((void *)job->dst, job->arg, job->size);
+		return 0;
+	case CCPLEX_JOB_CRC32:
+		return crc32_calc(job->arg, (u8 *)job->src, job->size);
+	default:
+		return 0xFFFFFFFF;
+	}
+}
+
+// Stops an unresponsive worker and runs its pending jobs on BPMP.
+static void _ccplex_worker_recover()
+{
+	ccplex_ring_t *ring = _ccplex_worker_ring();
+
+	ccplex_worker_stop();
+
+	for (u32 job = _ccplex_worker_tail(); job != ccplex_worker_head; job++)
+	{
+		ccplex_job_t *entry = &ring->jobs[job & (CCPLEX_WORKER_RING_SIZE - 1)];
+		entry->res = _ccplex_worker_job_run(entry);
+	}
+
+	ring->tail = ccplex_worker_head;
+}
+
+// Waits until the job is done. Falls back to BPMP on timeout or if the worker was stopped.
+static void _ccplex_worker_sync(u32 job)
+{
+	u32 timeout = get_tmr_ms() + CCPLEX_WORKER_TIMEOUT;
+	while (!ccplex_worker_done(job))
+	{
+		if (!ccplex_worker_on || get_tmr_ms() > timeout)
+		{
+			_ccplex_worker_recover();
+			break;
+		}
+	}
+}
+
+void ccplex_worker_start()
+{
+	if (ccplex_worker_on)
+		return;
+
+	u8 *base = (u8 *)CCPLEX_WORKER_ADDR;
+	u64 *pt = (u64 *)(base + CCPLEX_WORKER_PT_OFF);
+	ccplex_ring_t *ring = _ccplex_worker_ring();
+
+	// Run from DRAM. IRAM is Device memory once the MMU is on.
+	memcpy(base, ccplex_worker_payload, sizeof(ccplex_worker_payload));
+
+	// Identity map with 1GB blocks. MMIO as Device, DRAM as Normal.
+	pt[0] = 0x00000000 | CCPLEX_PTE_DEVICE;
+	pt[1] = 0x40000000 | CCPLEX_PTE_DEVICE;
+	pt[2] = 0x80000000 | CCPLEX_PTE_NORMAL;
+	pt[3] = 0xC0000000 | CCPLEX_PTE_NORMAL;
+
+	memset(ring, 0, sizeof(ccplex_ring_t));
+	ccplex_worker_head = 0;
+
+	// Drain write buffer before CCPLEX starts reading.
+	bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLEAN_WAY, false);
+
+	ccplex_boot_cpu0(CCPLEX_WORKER_ADDR, false);
+	ccplex_worker_on = true;
+}
+
+// Jobs still queued are dropped. Wait for them first.
+void ccplex_worker_stop()
+{
+	if (!ccplex_worker_on)
+		return;
+
+	ccplex_worker_on = false;
+	ccplex_powergate_cpu0();
+}
+
+bool ccplex_worker_running()
+{
+	return ccplex_worker_on;
+}
+
+/*
+ * Posts a job and returns its id. If the worker is not running, the job is executed inline.
+ * Buffers must be in DRAM and must not be touched by BPMP until the job is done.
+ */
+u32 ccplex_worker_post(u32 op, void *dst, const void *src, u32 size, u32 arg)
+{
+	ccplex_ring_t *ring = _ccplex_worker_ring();
+	u32 job = ccplex_worker_head;
+
+	// Wait for a free slot.
+	if (ccplex_worker_on)
+		_ccplex_worker_sync(job - CCPLEX_WORKER_RING_SIZE);
+
+	ccplex_job_t *entry = &ring->jobs[job & (CCPLEX_WORKER_RING_SIZE - 1)];
+	entry->op   = op;
+	entry->res  = 0;
+	entry->dst  = (u32)dst;
+	entry->src  = (u32)src;
+	entry->size = size;
+	entry->arg  = arg;
+
+	ccplex_worker_head = job + 1;
+
+	if (!ccplex_worker_on)
+	{
+		entry->res = _ccplex_worker_job_run(entry);
+		ring->head = job + 1;
+		ring->tail = job + 1;
+
+		return job;
+	}
+
+	// Entry and source data must land before head.
+	bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLEAN_WAY, false);
+	ring->head = job + 1;
+	bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLEAN_WAY, false);
+
+	return job;
+}
+
+bool ccplex_worker_done(u32 job)
+{
+	return (s32)(_ccplex_worker_tail() - job) > 0;
+}
+
+// Returns the job result. Valid until CCPLEX_WORKER_RING_SIZE more jobs are posted.
+u32 ccplex_worker_wait(u32 job)
+{
+	_ccplex_worker_sync(job);
+
+	return _ccplex_worker_ring()->jobs[job & (CCPLEX_WORKER_RING_SIZE - 1)].res;
+}
@@ -19,7 +19,44 @@
 
 #include <utils/types.h>
 
+#define CCPLEX_WORKER_RING_SIZE 64 // Power of 2.
+
+enum
+{
+	CCPLEX_JOB_NOP    = 0,
+	CCPLEX_JOB_MEMCPY = 1,
+	CCPLEX_JOB_MEMSET = 2, // arg: fill byte.
+	CCPLEX_JOB_CRC32  = 3, // arg: seed crc. res: crc. Same as crc32_calc.
+};
+
+typedef struct _ccplex_job_t
+{
+	u32 op;
+	u32 res;
+	u32 dst;
+	u32 src;
+	u32 size;
+	u32 arg;
+	u32 rsvd[2];
+} ccplex_job_t;
+
+typedef struct _ccplex_ring_t
+{
+	vu32 head; // Written by BPMP.
+	u32  rsvd0[15];
+	vu32 tail; // Written by worker.
+	u32  rsvd1[15];
+	ccplex_job_t jobs[CCPLEX_WORKER_RING_SIZE];
+} ccplex_ring_t;
+
 void ccplex_boot_cpu0(u32 entry, bool lock);
 void ccplex_powergate_cpu0();
 
+void ccplex_worker_start();
+void ccplex_worker_stop();
+bool ccplex_worker_running();
+u32  ccplex_worker_post(u32 op, void *dst, const void *src, u32 size, u32 arg);
+bool ccplex_worker_done(u32 job);
+u32  ccplex_worker_wait(u32 job);
+
 #endif
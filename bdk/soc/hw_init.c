@@ -25,6 +25,7 @@
 #include <sec/se.h>
 #include <sec/se_t210.h>
 #include <soc/bpmp.h>
+#include <soc/ccplex.h>
 #include <soc/clock.h>
 #include <soc/fuse.h>
 #include <soc/gpio.h>
@@ -41,6 +42,7 @@
 #include <power/max77620.h>
 #include <power/max7762x.h>
 #include <power/regulator_5v.h>
+#include <storage/emmc.h>
 #include <storage/sd.h>
 #include <storage/sdmmc.h>
 #include <thermal/fan.h>
@@ -470,6 +472,12 @@ void hw_init()
 
 void hw_deinit(bool keep_display)
 {
+	// Stop CCPLEX worker. Next stage owns CPU0.
+	ccplex_worker_stop();
+
+	// Write back eMMC volatile cache. Next stage might reset eMMC.
+	mmc_storage_cache_flush(&emmc_storage);
+
 	// Seamless display or display power off.
 	if (!keep_display)
 	{
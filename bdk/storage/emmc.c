@@ -23,8 +23,18 @@
 #include <storage/mbr_gpt.h>
 #include <utils/list.h>
 
+enum
+{
+	EMMC_ASYNC_NONE    = 0,
+	EMMC_ASYNC_PENDING = 1,
+	EMMC_ASYNC_READY   = 2,
+	EMMC_ASYNC_FAILED  = 3
+};
+
 static u16 emmc_errors[3] = { 0 }; // Init and Read/Write errors.
 static u32 emmc_mode = EMMC_MMC_HS400;
+static u32 emmc_init_async = EMMC_ASYNC_NONE;
+static sdmmc_storage_init_t emmc_init_ctxt;
 
 sdmmc_t emmc_sdmmc;
 sdmmc_storage_t emmc_storage;
@@ -61,43 +71,98 @@ u32 emmc_get_mode()
 	return emmc_mode;
 }
 
-void emmc_end() { sdmmc_storage_end(&emmc_storage); }
-
-int emmc_init_retry(bool power_cycle)
+int emmc_initialize_async_finish()
 {
-	u32 bus_width = SDMMC_BUS_WIDTH_8;
-	u32 type = SDHCI_TIMING_MMC_HS400;
-
-	// Power cycle SD eMMC.
-	if (power_cycle)
+	if (emmc_init_async == EMMC_ASYNC_PENDING)
 	{
-		emmc_mode--;
-		emmc_end();
+		if (!sdmmc_storage_init_finish(&emmc_init_ctxt))
+			emmc_init_async = EMMC_ASYNC_READY;
+		else
+			emmc_init_async = EMMC_ASYNC_FAILED;
 	}
 
+	return emmc_init_async != EMMC_ASYNC_READY;
+}
+
+void emmc_end()
+{
+	// Collect any pending early init.
+	emmc_initialize_async_finish();
+	emmc_init_async = EMMC_ASYNC_NONE;
+
+	sdmmc_storage_end(&emmc_storage);
+}
+
+static int _emmc_init_params(u32 *bus_width, u32 *type)
+{
+	*bus_width = SDMMC_BUS_WIDTH_8;
+	*type = SDHCI_TIMING_MMC_HS400;
+
 	// Get init parameters.
 	switch (emmc_mode)
 	{
 	case EMMC_INIT_FAIL: // Reset to max.
 		return 1;
 	case EMMC_1BIT_HS52:
-		bus_width = SDMMC_BUS_WIDTH_1;
-		type = SDHCI_TIMING_MMC_HS52;
+		*bus_width = SDMMC_BUS_WIDTH_1;
+		*type = SDHCI_TIMING_MMC_HS52;
 		break;
 	case EMMC_8BIT_HS52:
-		type = SDHCI_TIMING_MMC_HS52;
+		*type = SDHCI_TIMING_MMC_HS52;
 		break;
 	case EMMC_MMC_HS200:
-		type = SDHCI_TIMING_MMC_HS200;
+		*type = SDHCI_TIMING_MMC_HS200;
 		break;
 	case EMMC_MMC_HS400:
-		type = SDHCI_TIMING_MMC_HS400;
+		*type = SDHCI_TIMING_MMC_HS400;
 		break;
 	default:
 		emmc_mode = EMMC_MMC_HS400;
 	}
 
-	return sdmmc_storage_init_mmc(&emmc_storage, &emmc_sdmmc, bus_width, type);
+	return 0;
+}
+
+int emmc_init_retry(bool power_cycle)
+{
+	u32 bus_width, type;
+
+	// Power cycle SD eMMC.
+	if (power_cycle)
+	{
+		emmc_mode--;
+		emmc_end();
+	}
+
+	if (_emmc_init_params(&bus_width, &type))
+		return 1;
+
+	// Use the early init context, so init time is also kept for normal inits.
+	sdmmc_storage_init_mmc_start(&emmc_init_ctxt, &emmc_storage, &emmc_sdmmc, bus_width, type);
+
+	return sdmmc_storage_init_finish(&emmc_init_ctxt);
+}
+
+void emmc_initialize_async()
+{
+	u32 bus_width, type;
+
+	// Reset mode in case of previous failure.
+	if (emmc_mode == EMMC_INIT_FAIL)
+		emmc_mode = EMMC_MMC_HS400;
+
+	if (emmc_init_async != EMMC_ASYNC_NONE || emmc_storage.initialized || _emmc_init_params(&bus_width, &type))
+		return;
+
+	// Start init and let it progress while other hardware is brought up.
+	sdmmc_storage_init_mmc_start(&emmc_init_ctxt, &emmc_storage, &emmc_sdmmc, bus_width, type);
+	sdmmc_storage_init_bg_add(&emmc_init_ctxt);
+	emmc_init_async = EMMC_ASYNC_PENDING;
+}
+
+u32 emmc_get_init_time()
+{
+	return emmc_init_ctxt.time_end - emmc_init_ctxt.time_start;
 }
 
 int emmc_initialize(bool power_cycle)
@@ -106,10 +171,18 @@ int emmc_initialize(bool power_cycle)
 	if (emmc_mode == EMMC_INIT_FAIL)
 		emmc_mode = EMMC_MMC_HS400;
 
-	if (power_cycle)
-		emmc_end();
+	// Collect early init if any. A failed one counts as the first try.
+	bool early = emmc_init_async != EMMC_ASYNC_NONE;
+	int res = emmc_initialize_async_finish();
+	emmc_init_async = EMMC_ASYNC_NONE;
 
-	int res = emmc_init_retry(false);
+	if (!early || power_cycle)
+	{
+		if (power_cycle)
+			emmc_end();
+
+		res = emmc_init_retry(false);
+	}
 
 	while (true)
 	{
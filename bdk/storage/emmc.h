@@ -63,6 +63,9 @@ u16 *emmc_get_error_count();
 u32  emmc_get_mode();
 int  emmc_init_retry(bool power_cycle);
 int  emmc_initialize(bool power_cycle);
+void emmc_initialize_async();
+int  emmc_initialize_async_finish();
+u32  emmc_get_init_time();
 int  emmc_set_partition(u32 partition);
 void emmc_end();
 
@@ -425,6 +425,20 @@
 #define MMC_SECURE_ARGS                0x80000000
 #define MMC_TRIM_ARGS                  0x00008001
 
+/*
+ * SET_BLOCK_COUNT (CMD23) argument flags
+ */
+#define MMC_CMD23_ARG_REL_WR           (1U << 31)
+#define MMC_CMD23_ARG_PACKED           (1U << 30)
+
+/*
+ * Packed command header
+ */
+#define MMC_PACKED_CMD_VER             0x01
+#define MMC_PACKED_CMD_RD              0x01
+#define MMC_PACKED_CMD_WR              0x02
+#define MMC_PACKED_HDR_ENTRIES_MAX     63 /* 512B header. 8 bytes per entry after the first. */
+
 /*
  * Vendor definitions and structs
  */
@@ -0,0 +1,45 @@
+/*
+ * eMMC packed write command header.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <storage/mmc_def.h>
+#include <storage/sdmmc.h>
+
+u32 mmc_storage_packed_max_entries(sdmmc_storage_t *storage)
+{
+	if (!storage->initialized)
+		return 0;
+
+	return MIN(storage->ext_csd.max_packed_wr, MMC_PACKED_HDR_ENTRIES_MAX);
+}
+
+void mmc_storage_packed_hdr_build(sdmmc_storage_t *storage, u32 *hdr, const mmc_packed_entry_t *entries, u32 count)
+{
+	memset(hdr, 0, SDMMC_DAT_BLOCKSIZE);
+
+	// Version, direction and number of entries. Little endian.
+	hdr[0] = (count << 16) | (MMC_PACKED_CMD_WR << 8) | MMC_PACKED_CMD_VER;
+
+	// Each entry is a CMD23 and CMD25 argument pair.
+	for (u32 i = 0; i < count; i++)
+	{
+		hdr[(i + 1) * 2]     = entries[i].num_sectors;
+		hdr[(i + 1) * 2 + 1] = storage->has_sector_access ? entries[i].sector : (entries[i].sector << 9);
+	}
+}
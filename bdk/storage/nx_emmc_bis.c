@@ -24,6 +24,7 @@
 #include <mem/heap.h>
 #include <sec/se.h>
 #include <storage/emmc.h>
+#include <storage/mmc_def.h>
 #include <storage/sd.h>
 #include <storage/sdmmc.h>
 #include <utils/types.h>
@@ -32,6 +33,7 @@
 #define BIS_CLUSTER_SIZE      16384
 #define BIS_CACHE_MAX_ENTRIES 16384
 #define BIS_CACHE_LOOKUP_TBL_EMPTY_ENTRY -1
+#define BIS_PACKED_MAX_ENTRIES MMC_PACKED_HDR_ENTRIES_MAX
 
 typedef struct _cluster_cache_t
 {
@@ -126,20 +128,102 @@ static void _nx_emmc_bis_cluster_cache_init(bool enable_cache)
 	bis_cache->enabled = enable_cache;
 }
 
-static void _nx_emmc_bis_flush_cache()
+#ifndef BDK_EMUMMC_ENABLE
+static int _nx_emmc_bis_flush_packed_batch(mmc_packed_entry_t *entries, cluster_cache_t **clusters, u32 count)
 {
-	if (!bis_cache->enabled || !bis_cache->dirty_cnt)
-		return;
+	u8 tweak[SE_KEY_128_SIZE] __attribute__((aligned(4)));
+
+	int res = mmc_storage_write_packed(&emmc_storage, entries, count);
 
-	for (u32 i = 0; i < bis_cache->top_idx && bis_cache->dirty_cnt; i++)
+	for (u32 i = 0; i < count; i++)
 	{
-		if (bis_cache->clusters[i].dirty) {
-			nx_emmc_bis_write_block(bis_cache->clusters[i].cluster_idx * BIS_CLUSTER_SECTORS, BIS_CLUSTER_SECTORS, NULL, true);
+		cluster_cache_t *cluster = clusters[i];
+
+		// Mark cache entry not dirty if write succeeds.
+		if (!res)
+		{
+			cluster->dirty = false;
 			bis_cache->dirty_cnt--;
 		}
+		else // Decrypt back, so it can be flushed again.
+			se_aes_crypt_xts_sec_nx(ks_tweak, ks_crypt, DECRYPT, cluster->cluster_idx, tweak, true, 0, cluster->data, cluster->data, BIS_CLUSTER_SIZE);
 	}
 
+	return res;
+}
+
+static int _nx_emmc_bis_flush_cache_packed()
+{
+	u8 tweak[SE_KEY_128_SIZE] __attribute__((aligned(4)));
+	mmc_packed_entry_t entries[BIS_PACKED_MAX_ENTRIES];
+	cluster_cache_t *clusters[BIS_PACKED_MAX_ENTRIES];
+	u32 count = 0;
+	int res = 0;
+
+	for (u32 i = 0; i < bis_cache->top_idx; i++)
+	{
+		cluster_cache_t *cluster = &bis_cache->clusters[i];
+		if (!cluster->dirty)
+			continue;
+
+		// Encrypt in place. Clusters are decrypted back if the write fails.
+		if (se_aes_crypt_xts_sec_nx(ks_tweak, ks_crypt, ENCRYPT, cluster->cluster_idx, tweak, true, 0, cluster->data, cluster->data, BIS_CLUSTER_SIZE))
+		{
+			res = 1; // Encryption error. Keep it dirty.
+			continue;
+		}
+
+		entries[count].sector      = system_part->lba_start + cluster->cluster_idx * BIS_CLUSTER_SECTORS;
+		entries[count].num_sectors = BIS_CLUSTER_SECTORS;
+		entries[count].buf         = cluster->data;
+		clusters[count]            = cluster;
+		count++;
+
+		if (count == BIS_PACKED_MAX_ENTRIES)
+		{
+			if (_nx_emmc_bis_flush_packed_batch(entries, clusters, count))
+				res = 1;
+			count = 0;
+		}
+	}
+
+	if (count && _nx_emmc_bis_flush_packed_batch(entries, clusters, count))
+		res = 1;
+
+	return res;
+}
+#endif
+
+static int _nx_emmc_bis_flush_cache()
+{
+	int res = 0;
+
+	if (!bis_cache->enabled || !bis_cache->dirty_cnt)
+		return 0;
+
+#ifndef BDK_EMUMMC_ENABLE
+	// Merge dirty clusters into packed writes if writing directly to eMMC.
+	if (!emu_offset && mmc_storage_packed_max_entries(&emmc_storage) >= 2)
+		res = _nx_emmc_bis_flush_cache_packed();
+	else
+#endif
+	{
+		// Clusters are marked clean on successful write.
+		for (u32 i = 0; i < bis_cache->top_idx && bis_cache->dirty_cnt; i++)
+		{
+			if (bis_cache->clusters[i].dirty &&
+				nx_emmc_bis_write_block(bis_cache->clusters[i].cluster_idx * BIS_CLUSTER_SECTORS, BIS_CLUSTER_SECTORS, NULL, true))
+				res = 1;
+		}
+	}
+
+	// Keep the cache on failure, so dirty clusters are not lost.
+	if (res)
+		return 1;
+
 	_nx_emmc_bis_cluster_cache_init(true);
+
+	return 0;
 }
 
 static int nx_emmc_bis_read_block_normal(u32 sector, u32 count, void *buff)
@@ -155,6 +239,7 @@ static int nx_emmc_bis_read_block_normal(u32 sector, u32 count, void *buff)
 	u32  sector_in_cluster = sector % BIS_CLUSTER_SECTORS;
 
 	// If not reading from cache, do a regular read and decrypt.
+	// DMA buffer is free, since the previous cluster was XORed out of it before it got queued.
 	if (!emu_offset)
 		res = emmc_part_read(system_part, sector, count, bis_cache->dma_buff);
 	else
@@ -162,6 +247,10 @@ static int nx_emmc_bis_read_block_normal(u32 sector, u32 count, void *buff)
 	if (res)
 		return 1; // R/W error.
 
+	// Wait for previous cluster decryption.
+	if (se_aes_finalize())
+		return 1; // R/W error.
+
 	if (prev_cluster != cluster) // Sector in different cluster than last read.
 	{
 		prev_cluster = cluster;
@@ -176,8 +265,8 @@ static int nx_emmc_bis_read_block_normal(u32 sector, u32 count, void *buff)
 	else // Sector in same cluster and before or same as last sector.
 		tweak_exp = sector_in_cluster;
 
-	// Maximum one cluster (1 XTS crypto block 16KB).
-	if (se_aes_crypt_xts_sec_nx(ks_tweak, ks_crypt, DECRYPT, prev_cluster, tweak, regen_tweak, tweak_exp, buff, bis_cache->dma_buff, count * EMMC_BLOCKSIZE))
+	// Maximum one cluster (1 XTS crypto block 16KB). Finalized on next read or on exit.
+	if (se_aes_crypt_xts_sec_nx_async(ks_tweak, ks_crypt, DECRYPT, prev_cluster, tweak, regen_tweak, tweak_exp, buff, bis_cache->dma_buff, count * EMMC_BLOCKSIZE))
 		return 1; // R/W error.
 
 	prev_sector = sector + count - 1;
@@ -203,8 +292,8 @@ static int nx_emmc_bis_read_block_cached(u32 sector, u32 count, void *buff)
 	}
 
 	// Flush cache if full.
-	if (bis_cache->top_idx >= BIS_CACHE_MAX_ENTRIES)
-		_nx_emmc_bis_flush_cache();
+	if (bis_cache->top_idx >= BIS_CACHE_MAX_ENTRIES && _nx_emmc_bis_flush_cache())
+		return 1; // R/W error.
 
 	// Set new cached cluster parameters.
 	bis_cache->clusters[bis_cache->top_idx].cluster_idx = cluster;
@@ -248,6 +337,7 @@ int nx_emmc_bis_read(u32 sector, u32 count, void *buff)
 {
 	u8 *buf = (u8 *)buff;
 	u32 curr_sct = sector;
+	int res = 0;
 
 	while (count)
 	{
@@ -257,15 +347,20 @@ int nx_emmc_bis_read(u32 sector, u32 count, void *buff)
 
 		u32 sct_cnt = MIN(count, cnt_max); // Only allow cluster sized access.
 
-		if (nx_emmc_bis_read_block(curr_sct, sct_cnt, buf))
-			return 1;
+		res = nx_emmc_bis_read_block(curr_sct, sct_cnt, buf);
+		if (res)
+			break;
 
 		count    -= sct_cnt;
 		curr_sct += sct_cnt;
 		buf      += sct_cnt * EMMC_BLOCKSIZE;
 	}
 
-	return 0;
+	// Wait for last cluster decryption.
+	if (se_aes_finalize())
+		res = 1;
+
+	return res ? 1 : 0;
 }
 
 int nx_emmc_bis_write(u32 sector, u32 count, void *buff)
@@ -318,8 +413,18 @@ void nx_emmc_bis_init(emmc_part_t *part, bool enable_cache, u32 emummc_offset)
 		system_part = NULL;
 }
 
-void nx_emmc_bis_end()
+int nx_emmc_bis_flush()
+{
+	if (!system_part)
+		return 0;
+
+	return _nx_emmc_bis_flush_cache();
+}
+
+int nx_emmc_bis_end()
 {
-	_nx_emmc_bis_flush_cache();
+	int res = _nx_emmc_bis_flush_cache();
 	system_part = NULL;
+
+	return res;
 }
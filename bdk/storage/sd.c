@@ -15,6 +15,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include <storage/sd.h>
 #include <storage/sdmmc.h>
 #include <storage/sdmmc_driver.h>
@@ -33,6 +35,9 @@ static bool sd_init_done = false;
 static bool insertion_event = false;
 static u16  sd_errors[3] = { 0 }; // Init and Read/Write errors.
 static u32  sd_mode = SD_DEFAULT_SPEED;
+static u32  sd_tune_cache_crc = 0; // CRC of the tuning cache as found on SD.
+static bool sd_init_async = false;
+static sdmmc_storage_init_t sd_init_ctxt;
 
 
 sdmmc_t sd_sdmmc;
@@ -83,22 +88,15 @@ u32 sd_get_mode()
 	return sd_mode;
 }
 
-int sd_init_retry(bool power_cycle)
+static int _sd_init_params(u32 *bus_width, u32 *type)
 {
-	u32 bus_width = SDMMC_BUS_WIDTH_4;
+	*bus_width = SDMMC_BUS_WIDTH_4;
 #ifndef BDK_SDMMC_UHS_DDR200_SUPPORT
-	u32 type = SDHCI_TIMING_UHS_SDR104;
+	*type = SDHCI_TIMING_UHS_SDR104;
 #else
-	u32 type = SDHCI_TIMING_UHS_DDR200;
+	*type = SDHCI_TIMING_UHS_DDR200;
 #endif
 
-	// Power cycle SD card.
-	if (power_cycle)
-	{
-		sd_mode--;
-		sdmmc_storage_end(&sd_storage);
-	}
-
 	// Get init parameters.
 	switch (sd_mode)
 	{
@@ -106,25 +104,25 @@ int sd_init_retry(bool power_cycle)
 		return 1;
 
 	case SD_1BIT_HS25:
-		bus_width = SDMMC_BUS_WIDTH_1;
-		type = SDHCI_TIMING_SD_HS25;
+		*bus_width = SDMMC_BUS_WIDTH_1;
+		*type = SDHCI_TIMING_SD_HS25;
 		break;
 
 	case SD_4BIT_HS25:
-		type = SDHCI_TIMING_SD_HS25;
+		*type = SDHCI_TIMING_SD_HS25;
 		break;
 
 	case SD_UHS_SDR82:
-		type = SDHCI_TIMING_UHS_SDR82;
+		*type = SDHCI_TIMING_UHS_SDR82;
 		break;
 
 	case SD_UHS_SDR104:
-		type = SDHCI_TIMING_UHS_SDR104;
+		*type = SDHCI_TIMING_UHS_SDR104;
 		break;
 
 #ifdef BDK_SDMMC_UHS_DDR200_SUPPORT
 	case SD_UHS_DDR208:
-		type = SDHCI_TIMING_UHS_DDR200;
+		*type = SDHCI_TIMING_UHS_DDR200;
 		break;
 #endif
 
@@ -133,7 +131,11 @@ int sd_init_retry(bool power_cycle)
 		break;
 	}
 
-	int res = sdmmc_storage_init_sd(&sd_storage, &sd_sdmmc, bus_width, type);
+	return 0;
+}
+
+static void _sd_init_result(int res)
+{
 	if (!res)
 	{
 		sd_init_done    = true;
@@ -141,16 +143,71 @@ int sd_init_retry(bool power_cycle)
 	}
 	else
 		sd_init_done = false;
+}
+
+int sd_init_retry(bool power_cycle)
+{
+	u32 bus_width, type;
+
+	// Power cycle SD card.
+	if (power_cycle)
+	{
+		sd_mode--;
+		sdmmc_storage_end(&sd_storage);
+	}
+
+	if (_sd_init_params(&bus_width, &type))
+		return 1;
+
+	int res = sdmmc_storage_init_sd(&sd_storage, &sd_sdmmc, bus_width, type);
+	_sd_init_result(res);
+
+	return res;
+}
+
+void sd_initialize_async()
+{
+	u32 bus_width, type;
+
+	if (sd_init_done || sd_init_async || _sd_init_params(&bus_width, &type))
+		return;
+
+	// Start init and let it progress while other hardware is brought up.
+	sdmmc_storage_init_sd_start(&sd_init_ctxt, &sd_storage, &sd_sdmmc, bus_width, type);
+	sdmmc_storage_init_bg_add(&sd_init_ctxt);
+	sd_init_async = true;
+}
+
+u32 sd_get_init_time()
+{
+	return sd_init_ctxt.time_end - sd_init_ctxt.time_start;
+}
+
+static int _sd_init_async_finish()
+{
+	if (!sd_init_async)
+		return 1;
+
+	sd_init_async = false;
+	int res = sdmmc_storage_init_finish(&sd_init_ctxt);
+	_sd_init_result(res);
 
 	return res;
 }
 
 int sd_initialize(bool power_cycle)
 {
-	if (power_cycle)
-		sdmmc_storage_end(&sd_storage);
+	// Collect early init if any. A failed one counts as the first try.
+	bool early = sd_init_async;
+	int res = _sd_init_async_finish();
 
-	int res = sd_init_retry(false);
+	if (!early || power_cycle)
+	{
+		if (power_cycle)
+			sdmmc_storage_end(&sd_storage);
+
+		res = sd_init_retry(false);
+	}
 
 	while (true)
 	{
@@ -177,6 +234,64 @@ int sd_initialize(bool power_cycle)
 	return 1;
 }
 
+/*
+ * The file can only be read after SD is up, so on a cold boot the SD slot
+ * is already tuned by then and only the eMMC slot benefits from it.
+ * SD tuning is skipped only on re-inits and Nyx reloads, where the cache
+ * is carried over in Nyx storage.
+ */
+static void _sd_tune_cache_load()
+{
+	FIL fp;
+	sdmmc_tune_cache_t file_cache;
+	sdmmc_tune_cache_t *cache = sdmmc_storage_tune_cache_get();
+
+	if (!cache)
+		return;
+
+	if (f_open(&fp, SD_TUNE_CACHE_PATH, FA_READ) != FR_OK)
+		return;
+
+	int res = f_read(&fp, &file_cache, sizeof(sdmmc_tune_cache_t), NULL);
+	f_close(&fp);
+
+	if (res != FR_OK || !sdmmc_storage_tune_cache_is_valid(&file_cache))
+		return;
+
+	// Merge saved entries for cards that were not initialized yet.
+	bool merged = false;
+	for (u32 i = 0; i < SDMMC_TUNE_SLOT_MAX; i++)
+	{
+		if (!cache->entries[i].valid && file_cache.entries[i].valid)
+		{
+			memcpy(&cache->entries[i], &file_cache.entries[i], sizeof(sdmmc_tune_entry_t));
+			merged = true;
+		}
+	}
+
+	if (merged)
+		sdmmc_storage_tune_cache_update_crc(cache);
+
+	sd_tune_cache_crc = file_cache.crc32;
+}
+
+static void _sd_tune_cache_save()
+{
+	FIL fp;
+	sdmmc_tune_cache_t *cache = sdmmc_storage_tune_cache_get();
+
+	// Save only if something changed.
+	if (!cache || cache->crc32 == sd_tune_cache_crc)
+		return;
+
+	if (f_open(&fp, SD_TUNE_CACHE_PATH, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+		return;
+
+	if (f_write(&fp, cache, sizeof(sdmmc_tune_cache_t), NULL) == FR_OK)
+		sd_tune_cache_crc = cache->crc32;
+	f_close(&fp);
+}
+
 int sd_mount()
 {
 	if (sd_init_done && sd_mounted)
@@ -203,6 +318,10 @@ int sd_mount()
 		if (res == FR_OK)
 		{
 			sd_mounted = true;
+
+			// Only helps later inits and eMMC. The SD is already tuned at this point on a cold boot.
+			_sd_tune_cache_load();
+
 			return 0;
 		}
 		else
@@ -217,6 +336,9 @@ int sd_mount()
 
 static void _sd_deinit(bool deinit)
 {
+	// Collect any pending early init.
+	_sd_init_async_finish();
+
 	if (deinit)
 	{
 		insertion_event = false;
@@ -227,7 +349,10 @@ static void _sd_deinit(bool deinit)
 	if (sd_init_done)
 	{
 		if (sd_mounted)
+		{
+			_sd_tune_cache_save();
 			f_unmount("0:"); // Volume 0 is SD.
+		}
 
 		if (deinit)
 		{
@@ -24,6 +24,8 @@
 
 #define SD_BLOCKSIZE SDMMC_DAT_BLOCKSIZE
 
+#define SD_TUNE_CACHE_PATH "bootloader/sys/sdmmc_tune.bin"
+
 enum
 {
 	SD_INIT_FAIL  = 0,
@@ -56,6 +58,8 @@ bool sd_get_card_mounted();
 u32  sd_get_mode();
 int  sd_init_retry(bool power_cycle);
 int  sd_initialize(bool power_cycle);
+void sd_initialize_async();
+u32  sd_get_init_time();
 int  sd_mount();
 void sd_unmount();
 void sd_end();
@@ -25,6 +25,8 @@
 #include <storage/mmc_def.h>
 #include <storage/sd.h>
 #include <storage/sd_def.h>
+#include <storage/sdmmc_stats.h>
+#include <utils/util.h>
 #include <memory_map.h>
 #include <gfx_utils.h>
 
@@ -44,6 +46,11 @@
 
 u32 sd_power_cycle_time_start;
 
+#define SDMMC_TUNE_TYPE_ANY 0xFF
+
+static sdmmc_tune_cache_t *tune_cache = NULL;
+static bool mmc_cache_policy = false;
+
 static inline u32 unstuff_bits(const u32 *resp, u32 start, u32 size)
 {
 	start %= 128;
@@ -277,10 +284,142 @@ static int _sdmmc_storage_readwrite_ex(sdmmc_storage_t *storage, u32 *blkcnt_out
 	return _sdmmc_storage_check_cached_card_status(storage->sdmmc);
 }
 
+/*
+ * Tuning cache functions.
+ */
+
+void sdmmc_storage_tune_cache_update_crc(sdmmc_tune_cache_t *cache)
+{
+	cache->crc32 = crc32_calc(0, (const u8 *)cache->entries, sizeof(cache->entries));
+}
+
+bool sdmmc_storage_tune_cache_is_valid(sdmmc_tune_cache_t *cache)
+{
+	return cache->magic == SDMMC_TUNE_CACHE_MAGIC &&
+		   cache->crc32 == crc32_calc(0, (const u8 *)cache->entries, sizeof(cache->entries));
+}
+
+static_assert(sizeof(sdmmc_tune_cache_t) <= sizeof(((nyx_storage_t *)0)->tune_cache), "Tune cache does not fit Nyx storage!");
+
+void sdmmc_storage_tune_cache_set(sdmmc_tune_cache_t *cache)
+{
+	tune_cache = cache;
+	if (!cache)
+		return;
+
+	// Reset cache if corrupted or not initialized.
+	if (!sdmmc_storage_tune_cache_is_valid(cache))
+	{
+		memset(cache, 0, sizeof(sdmmc_tune_cache_t));
+		cache->magic = SDMMC_TUNE_CACHE_MAGIC;
+		sdmmc_storage_tune_cache_update_crc(cache);
+	}
+}
+
+sdmmc_tune_cache_t *sdmmc_storage_tune_cache_get()
+{
+	return tune_cache;
+}
+
+static sdmmc_tune_entry_t *_sdmmc_storage_tune_cache_entry(sdmmc_storage_t *storage, u32 type)
+{
+	if (!tune_cache)
+		return NULL;
+
+	// Only timings that actually do tuning are cached.
+	switch (type)
+	{
+	case SDHCI_TIMING_MMC_HS200:
+	case SDHCI_TIMING_UHS_SDR50:
+	case SDHCI_TIMING_UHS_SDR104:
+	case SDHCI_TIMING_UHS_SDR82:
+	case SDHCI_TIMING_UHS_DDR200:
+	case SDMMC_TUNE_TYPE_ANY:
+		break;
+	default:
+		return NULL;
+	}
+
+	switch (storage->sdmmc->id)
+	{
+	case SDMMC_1:
+		return &tune_cache->entries[SDMMC_TUNE_SLOT_SD];
+	case SDMMC_4:
+		return &tune_cache->entries[SDMMC_TUNE_SLOT_EMMC];
+	default:
+		return NULL;
+	}
+}
+
+static void _sdmmc_storage_tune_cache_invalidate(sdmmc_storage_t *storage)
+{
+	sdmmc_tune_entry_t *entry = _sdmmc_storage_tune_cache_entry(storage, SDMMC_TUNE_TYPE_ANY);
+	if (!entry || !entry->valid)
+		return;
+
+	memset(entry, 0, sizeof(sdmmc_tune_entry_t));
+	sdmmc_storage_tune_cache_update_crc(tune_cache);
+}
+
+static int _sdmmc_storage_tuning_verify(sdmmc_storage_t *storage)
+{
+	// eMMC: Re-read EXT_CSD. That also keeps the raw buffer valid.
+	if (storage->sdmmc->id == SDMMC_4)
+		return mmc_storage_get_ext_csd(storage);
+
+	// SD: Read first sector into the scratch buffer.
+	u32 blkcnt = 0;
+	return _sdmmc_storage_readwrite_ex(storage, &blkcnt, 0, 1, storage->raw_ext_csd, 0);
+}
+
+static int _sdmmc_storage_tuning_execute(sdmmc_storage_t *storage, u32 type, u32 cmd)
+{
+	sdmmc_tune_entry_t *entry = _sdmmc_storage_tune_cache_entry(storage, type);
+	bool t210b01 = storage->sdmmc->t210b01;
+
+	// Try the saved tap first and verify it with a single read.
+	if (entry && entry->valid && entry->type == type && entry->t210b01 == t210b01 &&
+		!memcmp(entry->raw_cid, storage->raw_cid, sizeof(entry->raw_cid)))
+	{
+		sdmmc_set_tap_value(storage->sdmmc, entry->tap);
+		if (!_sdmmc_storage_tuning_verify(storage))
+		{
+			DPRINTF("[SDMMC%d] used cached tap %d\n", storage->sdmmc->id + 1, entry->tap);
+			return 0;
+		}
+
+		// Stale entry. Do a full tuning.
+		_sdmmc_storage_tune_cache_invalidate(storage);
+	}
+
+	if (sdmmc_tuning_execute(storage->sdmmc, type, cmd))
+		return 1;
+
+#ifdef BDK_SDMMC_STATS
+	sdmmc_stats_tuning(storage->sdmmc->id, sdmmc_get_tap_value(storage->sdmmc));
+#endif
+
+	// Save tuning result.
+	if (entry)
+	{
+		memcpy(entry->raw_cid, storage->raw_cid, sizeof(entry->raw_cid));
+		entry->type    = type;
+		entry->tap     = sdmmc_get_tap_value(storage->sdmmc);
+		entry->t210b01 = t210b01;
+		entry->valid   = 1;
+		sdmmc_storage_tune_cache_update_crc(tune_cache);
+	}
+
+	return 0;
+}
+
 int sdmmc_storage_end(sdmmc_storage_t *storage)
 {
 	DPRINTF("[SDMMC%d] end\n", storage->sdmmc->id);
 
+	// Write back eMMC volatile cache. It might be lost on reset.
+	mmc_storage_cache_flush(storage);
+
 	if (_sdmmc_storage_go_idle_state(storage))
 		return 1;
 
@@ -297,6 +436,9 @@ static int _sdmmc_storage_handle_io_error(sdmmc_storage_t *storage, bool first_r
 
 	if (storage->sdmmc->id == SDMMC_1 || storage->sdmmc->id == SDMMC_4)
 	{
+		// Cached tap might be marginal. Force a full tuning on reinit.
+		_sdmmc_storage_tune_cache_invalidate(storage);
+
 		if (storage->sdmmc->id == SDMMC_1)
 		{
 			sd_error_count_increment(SD_ERROR_RW_FAIL);
@@ -351,17 +493,26 @@ static int _sdmmc_storage_readwrite(sdmmc_storage_t *storage, u32 sector, u32 nu
 	while (sct_total)
 	{
 		u32 blkcnt = 0;
+#ifdef BDK_SDMMC_STATS
+		u32 io_start = 0;
+#endif
 		// Retry 5 times if failed.
 		u32 retries = 5;
 		do
 		{
 reinit_try:
+#ifdef BDK_SDMMC_STATS
+			io_start = get_tmr_us();
+#endif
 			if (!_sdmmc_storage_readwrite_ex(storage, &blkcnt, sct_off, MIN(sct_total, SDMMC_AMAX_BLOCKNUM), bbuf, is_write))
 				goto out;
 			else
 				retries--;
 
 			sd_error_count_increment(SD_ERROR_RW_RETRY);
+#ifdef BDK_SDMMC_STATS
+			sdmmc_stats_retry(storage->sdmmc->id);
+#endif
 
 			msleep(50);
 		} while (retries);
@@ -385,6 +536,9 @@ reinit_try:
 		return 1;
 
 out:
+#ifdef BDK_SDMMC_STATS
+		sdmmc_stats_io(storage->sdmmc->id, is_write, blkcnt, get_tmr_us() - io_start);
+#endif
 		sct_off += blkcnt;
 		sct_total -= blkcnt;
 		bbuf += SDMMC_DAT_BLOCKSIZE * blkcnt;
@@ -456,32 +610,22 @@ static int _mmc_storage_get_op_cond_inner(sdmmc_storage_t *storage, u32 *rocr, u
 	return sdmmc_get_cached_rsp(storage->sdmmc, rocr, SDMMC_RSP_TYPE_3);
 }
 
-static int _mmc_storage_get_op_cond(sdmmc_storage_t *storage, u32 power)
+static int _mmc_storage_get_op_cond(sdmmc_storage_t *storage, u32 power, bool *busy)
 {
-	u32 timeout = get_tmr_ms() + 1500;
-
-	while (true)
-	{
-		u32 rocr = 0;
-		if (_mmc_storage_get_op_cond_inner(storage, &rocr, power))
-			break;
-
-		// Check if power up is done.
-		if (rocr & MMC_OCR_BUSY)
-		{
-			// Check if card is high capacity.
-			if (rocr & MMC_OCR_CCS)
-				storage->has_sector_access = 1;
+	u32 rocr = 0;
+	if (_mmc_storage_get_op_cond_inner(storage, &rocr, power))
+		return 1;
 
-			return 0;
-		}
-		if (get_tmr_ms() > timeout)
-			break;
+	// Check if power up is done.
+	*busy = !(rocr & MMC_OCR_BUSY);
+	if (*busy)
+		return 0;
 
-		usleep(1000);
-	}
+	// Check if card is high capacity.
+	if (rocr & MMC_OCR_CCS)
+		storage->has_sector_access = 1;
 
-	return 1;
+	return 0;
 }
 
 static int _mmc_storage_set_relative_addr(sdmmc_storage_t *storage)
@@ -566,12 +710,17 @@ static void _mmc_storage_parse_ext_csd(sdmmc_storage_t *storage)
 									(ext_csd[EXT_CSD_CACHE_SIZE + 1] << 8)  |
 									(ext_csd[EXT_CSD_CACHE_SIZE + 2] << 16) |
 									(ext_csd[EXT_CSD_CACHE_SIZE + 3] << 24);
+	storage->ext_csd.cache_ctrl   = ext_csd[EXT_CSD_CACHE_CTRL] & 1;
 
 	storage->ext_csd.max_enh_mult = (ext_csd[EXT_CSD_MAX_ENH_SIZE_MULT]             |
 									(ext_csd[EXT_CSD_MAX_ENH_SIZE_MULT + 1] << 8)   |
 									(ext_csd[EXT_CSD_MAX_ENH_SIZE_MULT + 2] << 16)) *
 									 ext_csd[EXT_CSD_HC_WP_GRP_SIZE] * ext_csd[EXT_CSD_HC_ERASE_GRP_SIZE];
 
+	// Packed writes are only used when failure reporting is enabled.
+	storage->ext_csd.max_packed_wr = (ext_csd[EXT_CSD_EXP_EVENTS_CTRL] & EXT_CSD_PACKED_EVENT_EN) ?
+									  ext_csd[EXT_CSD_MAX_PACKED_WRITES] : 0;
+
 	storage->sec_cnt = *(u32 *)&ext_csd[EXT_CSD_SEC_CNT];
 }
 
@@ -657,7 +806,7 @@ static int _mmc_storage_enable_HS200(sdmmc_storage_t *storage)
 	if (sdmmc_setup_clock(storage->sdmmc, SDHCI_TIMING_MMC_HS200))
 		return 1;
 
-	if (sdmmc_tuning_execute(storage->sdmmc, SDHCI_TIMING_MMC_HS200, MMC_SEND_TUNING_BLOCK_HS200))
+	if (_sdmmc_storage_tuning_execute(storage, SDHCI_TIMING_MMC_HS200, MMC_SEND_TUNING_BLOCK_HS200))
 		return 1;
 
 	DPRINTF("[MMC] switched to HS200\n");
@@ -725,29 +874,37 @@ static int _mmc_storage_enable_auto_bkops(sdmmc_storage_t *storage)
 }
 */
 
-int sdmmc_storage_init_mmc(sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type)
+static int _mmc_storage_cache_ctrl(sdmmc_storage_t *storage, bool enable)
 {
-	memset(storage, 0, sizeof(sdmmc_storage_t));
-	storage->sdmmc = sdmmc;
-	storage->rca = 2; // Set default device address. This could be a config item.
-
-	DPRINTF("[MMC]-[init: bus: %d, type: %d]\n", bus_width, type);
+	if (_mmc_storage_switch(storage, SDMMC_SWITCH(MMC_SWITCH_MODE_WRITE_BYTE, EXT_CSD_CACHE_CTRL, enable ? 1 : 0)))
+		return 1;
 
-	if (sdmmc_init(sdmmc, SDMMC_4, SDMMC_POWER_1_8, SDMMC_BUS_WIDTH_1, SDHCI_TIMING_MMC_ID))
+	if (_sdmmc_storage_check_status(storage))
 		return 1;
-	DPRINTF("[MMC] after init\n");
 
-	// Wait 1ms + 74 cycles.
-	usleep(1000 + (74 * 1000 + sdmmc->card_clock - 1) / sdmmc->card_clock);
+	storage->ext_csd.cache_ctrl = enable;
 
-	if (_sdmmc_storage_go_idle_state(storage))
-		return 1;
-	DPRINTF("[MMC] went to idle state\n");
+	return 0;
+}
 
-	if (_mmc_storage_get_op_cond(storage, SDMMC_POWER_1_8))
-		return 1;
-	DPRINTF("[MMC] got op cond\n");
+static void _mmc_storage_enable_packed_event(sdmmc_storage_t *storage)
+{
+	// Packed commands are supported from eMMC 4.5 and up.
+	if (storage->ext_csd.rev < 6 || storage->raw_ext_csd[EXT_CSD_MAX_PACKED_WRITES] < 2 || storage->ext_csd.max_packed_wr)
+		return;
+
+	// Not fatal. Packed writes stay disabled.
+	if (_mmc_storage_switch(storage, SDMMC_SWITCH(MMC_SWITCH_MODE_SET_BITS, EXT_CSD_EXP_EVENTS_CTRL, EXT_CSD_PACKED_EVENT_EN)))
+		return;
+
+	if (_sdmmc_storage_check_status(storage))
+		return;
 
+	storage->ext_csd.max_packed_wr = storage->raw_ext_csd[EXT_CSD_MAX_PACKED_WRITES];
+}
+
+static int _mmc_storage_init_setup(sdmmc_storage_t *storage, u32 bus_width, u32 type)
+{
 	if (_sdmmc_storage_get_cid(storage))
 		return 1;
 	DPRINTF("[MMC] got cid\n");
@@ -787,6 +944,16 @@ int sdmmc_storage_init_mmc(sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_wid
 
 	_mmc_storage_parse_cid(storage); // This needs to be after csd and ext_csd.
 
+	_mmc_storage_enable_packed_event(storage);
+	DPRINTF("[MMC] max packed writes %d\n", storage->ext_csd.max_packed_wr);
+
+	// Enable volatile cache if requested. Not fatal.
+	if (mmc_cache_policy && storage->ext_csd.cache_size && !storage->ext_csd.cache_ctrl)
+	{
+		_mmc_storage_cache_ctrl(storage, true);
+		DPRINTF("[MMC] cache enabled\n");
+	}
+
 /*
 	if (storage->cid.manfid == 0x11 && storage->ext_csd.bkops && !(storage->ext_csd.bkops_en & EXT_CSD_BKOPS_AUTO))
 	{
@@ -807,6 +974,96 @@ done:
 	return 0;
 }
 
+static int _mmc_storage_init_step(sdmmc_storage_init_t *init)
+{
+	sdmmc_storage_t *storage = init->storage;
+	sdmmc_t *sdmmc = init->sdmmc;
+	bool busy;
+	u32 wait_us;
+
+	switch (init->state)
+	{
+	case SDMMC_INIT_ST_POWER:
+		if (sdmmc_init_start(sdmmc, SDMMC_4, &wait_us))
+			return 1;
+		init->wait_end = get_tmr_us() + wait_us;
+		init->state = SDMMC_INIT_ST_CONTROLLER;
+		break;
+
+	case SDMMC_INIT_ST_CONTROLLER:
+		if (sdmmc_init_finish(sdmmc, SDMMC_POWER_1_8, SDMMC_BUS_WIDTH_1, SDHCI_TIMING_MMC_ID))
+			return 1;
+		DPRINTF("[MMC] after init\n");
+
+		// Wait 1ms + 74 cycles.
+		init->wait_end = get_tmr_us() + 1000 + (74 * 1000 + sdmmc->card_clock - 1) / sdmmc->card_clock;
+		init->state = SDMMC_INIT_ST_IDLE;
+		break;
+
+	case SDMMC_INIT_ST_IDLE:
+		if (_sdmmc_storage_go_idle_state(storage))
+			return 1;
+		DPRINTF("[MMC] went to idle state\n");
+
+		init->timeout = get_tmr_ms() + 1500;
+		init->state = SDMMC_INIT_ST_OP_COND;
+		break;
+
+	case SDMMC_INIT_ST_OP_COND:
+		if (_mmc_storage_get_op_cond(storage, SDMMC_POWER_1_8, &busy))
+			return 1;
+
+		// Retry while card is still powering up.
+		if (busy)
+		{
+			if (get_tmr_ms() > init->timeout)
+				return 1;
+			init->wait_end = get_tmr_us() + 1000;
+			break;
+		}
+		DPRINTF("[MMC] got op cond\n");
+
+		init->state = SDMMC_INIT_ST_SETUP;
+		break;
+
+	case SDMMC_INIT_ST_SETUP:
+		if (_mmc_storage_init_setup(storage, init->bus_width, init->type))
+			return 1;
+		init->state = SDMMC_INIT_ST_DONE;
+		break;
+	}
+
+	return 0;
+}
+
+void sdmmc_storage_init_mmc_start(sdmmc_storage_init_t *init, sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type)
+{
+	memset(init, 0, sizeof(sdmmc_storage_init_t));
+	init->storage    = storage;
+	init->sdmmc      = sdmmc;
+	init->id         = SDMMC_4;
+	init->bus_width  = bus_width;
+	init->type       = type;
+	init->state      = SDMMC_INIT_ST_POWER;
+	init->time_start = get_tmr_us();
+	init->wait_end   = init->time_start;
+
+	memset(storage, 0, sizeof(sdmmc_storage_t));
+	storage->sdmmc = sdmmc;
+	storage->rca = 2; // Set default device address. This could be a config item.
+
+	DPRINTF("[MMC]-[init: bus: %d, type: %d]\n", bus_width, type);
+}
+
+int sdmmc_storage_init_mmc(sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type)
+{
+	sdmmc_storage_init_t init;
+
+	sdmmc_storage_init_mmc_start(&init, storage, sdmmc, bus_width, type);
+
+	return sdmmc_storage_init_finish(&init);
+}
+
 int sdmmc_storage_set_mmc_partition(sdmmc_storage_t *storage, u32 partition)
 {
 	if (_mmc_storage_switch(storage, SDMMC_SWITCH(MMC_SWITCH_MODE_WRITE_BYTE, EXT_CSD_PART_CONFIG, partition)))
@@ -820,6 +1077,231 @@ int sdmmc_storage_set_mmc_partition(sdmmc_storage_t *storage, u32 partition)
 	return 0;
 }
 
+static int _mmc_storage_wait_programming(sdmmc_storage_t *storage, u32 *resp, u32 timeout)
+{
+	timeout += get_tmr_ms();
+	while (true)
+	{
+		*resp = 0; // Not updated if command fails.
+		if (!_sdmmc_storage_get_status(storage, resp, 0))
+			return 0;
+
+		if (R1_CURRENT_STATE(*resp) != R1_STATE_PRG || get_tmr_ms() > timeout)
+			return 1;
+	}
+}
+
+void mmc_storage_cache_policy_set(bool enable)
+{
+	mmc_cache_policy = enable;
+}
+
+int mmc_storage_cache_enable(sdmmc_storage_t *storage, bool enable)
+{
+	if (!storage->initialized || !storage->ext_csd.cache_size)
+		return enable;
+
+	if (storage->ext_csd.cache_ctrl == enable)
+		return 0;
+
+	// Write back cached data before disabling.
+	if (!enable && mmc_storage_cache_flush(storage))
+		return 1;
+
+	return _mmc_storage_cache_ctrl(storage, enable);
+}
+
+int mmc_storage_cache_flush(sdmmc_storage_t *storage)
+{
+	if (!storage->initialized || !storage->ext_csd.cache_ctrl)
+		return 0;
+
+	u32 tmp;
+	u32 arg = SDMMC_SWITCH(MMC_SWITCH_MODE_WRITE_BYTE, EXT_CSD_FLUSH_CACHE, 1);
+
+	// Flushing a big cache can outlast the busy timeout. Wait for it and flush again.
+	if (_mmc_storage_switch(storage, arg))
+	{
+		if (_mmc_storage_wait_programming(storage, &tmp, 10000))
+			return 1;
+
+		if (_mmc_storage_switch(storage, arg))
+			return 1;
+	}
+
+	return _sdmmc_storage_check_status(storage);
+}
+
+static void _mmc_storage_packed_get_failure(sdmmc_storage_t *storage, u32 count, u32 *done)
+{
+	*done = 0;
+
+	if (mmc_storage_get_ext_csd(storage))
+		return;
+
+	// Entries before the failed one were programmed. Otherwise assume none was.
+	u8 *ext_csd = storage->raw_ext_csd;
+	if (ext_csd[EXT_CSD_PACKED_CMD_STATUS] & EXT_CSD_PACKED_INDEXED_ERROR)
+	{
+		u32 failed_idx = ext_csd[EXT_CSD_PACKED_FAILURE_INDEX]; // 1-based.
+		if (failed_idx && failed_idx <= count)
+			*done = failed_idx - 1;
+	}
+
+	DPRINTF("[MMC] packed write failed: status %X, done %d/%d\n", ext_csd[EXT_CSD_PACKED_CMD_STATUS], *done, count);
+}
+
+static int _mmc_storage_write_packed_ex(sdmmc_storage_t *storage, u8 *buf, const mmc_packed_entry_t *entries, u32 count, u32 blocks, u32 *done)
+{
+	u32 tmp = 0;
+	sdmmc_cmd_t cmdbuf;
+	sdmmc_req_t reqbuf;
+
+	*done = 0;
+
+	// Check if out of bounds.
+	for (u32 i = 0; i < count; i++)
+		if (((u64)entries[i].sector + entries[i].num_sectors) > storage->sec_cnt)
+			return 1;
+
+	// Header block. Data of all entries follows it.
+	mmc_storage_packed_hdr_build(storage, (u32 *)buf, entries, count);
+
+#ifdef BDK_SDMMC_STATS
+	u32 io_start = get_tmr_us();
+#endif
+
+	// Set packed block count. It includes the header.
+	if (_sdmmc_storage_execute_cmd_ex_state(storage, MMC_SET_BLOCK_COUNT, blocks | MMC_CMD23_ARG_PACKED, 0, R1_STATE_TRAN))
+		return 1;
+
+	u32 sector = entries[0].sector;
+	if (!storage->has_sector_access)
+		sector <<= 9;
+
+	sdmmc_init_cmd(&cmdbuf, MMC_WRITE_MULTIPLE_BLOCK, sector, SDMMC_RSP_TYPE_1, 0);
+
+	reqbuf.buf              = buf;
+	reqbuf.num_sectors      = blocks;
+	reqbuf.blksize          = SDMMC_DAT_BLOCKSIZE;
+	reqbuf.is_write         = 1;
+	reqbuf.is_multi_block   = 1;
+	reqbuf.is_auto_stop_trn = 0; // Predefined block count.
+
+	if (sdmmc_execute_cmd(storage->sdmmc, &cmdbuf, &reqbuf, NULL))
+	{
+		sdmmc_stop_transmission(storage->sdmmc, &tmp);
+		_mmc_storage_packed_get_failure(storage, count, done);
+
+		return 1;
+	}
+
+	// Wait for programming to finish.
+	if (_mmc_storage_wait_programming(storage, &tmp, 2000))
+	{
+		_mmc_storage_packed_get_failure(storage, count, done);
+
+		return 1;
+	}
+
+	if (tmp & R1_EXCEPTION_EVENT)
+	{
+		_mmc_storage_packed_get_failure(storage, count, done);
+
+		return 1;
+	}
+
+#ifdef BDK_SDMMC_STATS
+	sdmmc_stats_io(storage->sdmmc->id, 1, blocks, get_tmr_us() - io_start);
+#endif
+
+	*done = count;
+
+	return 0;
+}
+
+static int _mmc_storage_write_entries(sdmmc_storage_t *storage, const mmc_packed_entry_t *entries, u32 count)
+{
+	for (u32 i = 0; i < count; i++)
+		if (sdmmc_storage_write(storage, entries[i].sector, entries[i].num_sectors, entries[i].buf))
+			return 1;
+
+	return 0;
+}
+
+static int _mmc_storage_write_packed_batch(sdmmc_storage_t *storage, u8 *buf, const mmc_packed_entry_t *entries, u32 count, u32 blocks)
+{
+	// On failure, rewrite the entries that were not programmed. Retries and reinit are handled there.
+	u32 done;
+	if (_mmc_storage_write_packed_ex(storage, buf, entries, count, blocks, &done))
+	{
+#ifdef BDK_SDMMC_STATS
+		sdmmc_stats_retry(storage->sdmmc->id);
+#endif
+		return _mmc_storage_write_entries(storage, &entries[done], count - done);
+	}
+
+	return 0;
+}
+
+int mmc_storage_write_packed(sdmmc_storage_t *storage, const mmc_packed_entry_t *entries, u32 count)
+{
+	u32 max_entries = mmc_storage_packed_max_entries(storage);
+	u8 *buf = (u8 *)SDMMC_ALT_DMA_BUFFER;
+	u32 idx = 0;
+
+	while (idx < count)
+	{
+		// Gather as many entries as fit in one transfer.
+		u32 batch  = 0;
+		u32 blocks = 1; // Header.
+		while ((idx + batch) < count && batch < max_entries &&
+			   (blocks + entries[idx + batch].num_sectors) <= SDMMC_AMAX_BLOCKNUM)
+		{
+			blocks += entries[idx + batch].num_sectors;
+			batch++;
+		}
+
+		// Not supported or nothing to pack. Do a normal write.
+		if (batch < 2)
+		{
+			if (_mmc_storage_write_entries(storage, &entries[idx], 1))
+				return 1;
+
+			idx++;
+			continue;
+		}
+
+		// Copy data after the header block.
+		u8 *data = buf + SDMMC_DAT_BLOCKSIZE;
+		for (u32 i = idx; i < idx + batch; i++)
+		{
+			memcpy(data, entries[i].buf, entries[i].num_sectors * SDMMC_DAT_BLOCKSIZE);
+			data += entries[i].num_sectors * SDMMC_DAT_BLOCKSIZE;
+		}
+
+		if (_mmc_storage_write_packed_batch(storage, buf, &entries[idx], batch, blocks))
+			return 1;
+
+		idx += batch;
+	}
+
+	return 0;
+}
+
+int mmc_storage_write_packed_buf(sdmmc_storage_t *storage, u8 *buf, const mmc_packed_entry_t *entries, u32 count)
+{
+	u32 blocks = 1; // Header.
+	for (u32 i = 0; i < count; i++)
+		blocks += entries[i].num_sectors;
+
+	// Must fit in one transfer. Otherwise do normal writes from the same buffer.
+	if (count < 2 || count > mmc_storage_packed_max_entries(storage) || blocks > SDMMC_AMAX_BLOCKNUM)
+		return _mmc_storage_write_entries(storage, entries, count);
+
+	return _mmc_storage_write_packed_batch(storage, buf, entries, count, blocks);
+}
+
 /*
  * SD specific functions.
  */
@@ -1087,10 +1569,8 @@ static int _sd_storage_send_op_cond(sdmmc_storage_t *storage, u32 *rocr, u32 ocr
 	return sdmmc_get_cached_rsp(storage->sdmmc, rocr, SDMMC_RSP_TYPE_3);
 }
 
-static int _sd_storage_get_op_cond(sdmmc_storage_t *storage, bool is_sd_v1, int lv_support)
+static int _sd_storage_get_op_cond(sdmmc_storage_t *storage, bool is_sd_v1, int lv_support, bool *busy)
 {
-	u32 timeout = get_tmr_ms() + 1500;
-
 	// Host in 3.3V power supply (VDD1).
 	u32 ocr = SD_OCR_VDD_32_33;
 
@@ -1104,55 +1584,48 @@ static int _sd_storage_get_op_cond(sdmmc_storage_t *storage, bool is_sd_v1, int
 		ocr |= lv_support ? SD_OCR_S18R : 0;
 	}
 
-	while (true)
-	{
-		u32 rocr = 0;
-		if (_sd_storage_send_op_cond(storage, &rocr, ocr, is_sd_v1))
-			break;
+	u32 rocr = 0;
+	if (_sd_storage_send_op_cond(storage, &rocr, ocr, is_sd_v1))
+		return 1;
+
+	// Check if power up is done.
+	*busy = !(rocr & SD_OCR_BUSY);
+	if (*busy)
+		return 0;
 
-		// Check if power up is done.
-		if (rocr & SD_OCR_BUSY)
-		{
 #ifdef SDMMC_DEBUG_PRINT_SD_REGS
-			gfx_printf("ROCR:                  %08X (%d)\n", rocr, lv_support);
+	gfx_printf("ROCR:                  %08X (%d)\n", rocr, lv_support);
 #else
-			DPRINTF("[SD] rocr: %08X, lv: %d\n", rocr, lv_support);
+	DPRINTF("[SD] rocr: %08X, lv: %d\n", rocr, lv_support);
 #endif
 
-			// Check if card is higher capacity.
-			if (rocr & SD_OCR_CCS)
-				storage->has_sector_access = 1; // Non-SDUC.
+	// Check if card is higher capacity.
+	if (rocr & SD_OCR_CCS)
+		storage->has_sector_access = 1; // Non-SDUC.
 
-			// Check if card accepted 1.8V signaling.
-			if (rocr & SD_OCR_S18A && lv_support)
-			{
-				// Switch to 1.8V signaling.
-				if (!_sdmmc_storage_execute_cmd_ex_state(storage, SD_VOLTAGE_SWITCH, 0, 0, R1_STATE_READY))
-				{
-					if (sdmmc_setup_clock(storage->sdmmc, SDHCI_TIMING_UHS_SDR12))
-						return 1;
-
-					if (sdmmc_enable_low_voltage(storage->sdmmc))
-						return 1;
+	// Check if card accepted 1.8V signaling.
+	if (rocr & SD_OCR_S18A && lv_support)
+	{
+		// Switch to 1.8V signaling.
+		if (!_sdmmc_storage_execute_cmd_ex_state(storage, SD_VOLTAGE_SWITCH, 0, 0, R1_STATE_READY))
+		{
+			if (sdmmc_setup_clock(storage->sdmmc, SDHCI_TIMING_UHS_SDR12))
+				return 1;
 
-					storage->is_low_voltage = 1;
+			if (sdmmc_enable_low_voltage(storage->sdmmc))
+				return 1;
 
-					DPRINTF("-> switched to low voltage\n");
-				}
-			}
-			else
-			{
-				DPRINTF("[SD] no low voltage support\n");
-			}
+			storage->is_low_voltage = 1;
 
-			return 0;
+			DPRINTF("-> switched to low voltage\n");
 		}
-		if (get_tmr_ms() > timeout)
-			break;
-		msleep(10); // Needs to be at least 10ms for some SD Cards
+	}
+	else
+	{
+		DPRINTF("[SD] no low voltage support\n");
 	}
 
-	return 1;
+	return 0;
 }
 
 static int _sd_storage_get_rca(sdmmc_storage_t *storage)
@@ -1452,7 +1925,7 @@ static int _sd_storage_enable_DDR200(sdmmc_storage_t *storage, u8 *buf)
 			return 1;
 		DPRINTF("[SD] after setup clock DDR200\n");
 
-		if (sdmmc_tuning_execute(storage->sdmmc, SDHCI_TIMING_UHS_DDR200, MMC_SEND_TUNING_BLOCK))
+		if (_sdmmc_storage_tuning_execute(storage, SDHCI_TIMING_UHS_DDR200, MMC_SEND_TUNING_BLOCK))
 			return 1;
 		DPRINTF("[SD] after tuning DDR200\n");
 
@@ -1621,7 +2094,7 @@ static int _sd_storage_set_uhs_bus_speed(sdmmc_storage_t *storage, u32 type)
 		return 1;
 	DPRINTF("[SD] after setup clock\n");
 
-	if (sdmmc_tuning_execute(storage->sdmmc, type, SD_SEND_TUNING_BLOCK))
+	if (_sdmmc_storage_tuning_execute(storage, type, SD_SEND_TUNING_BLOCK))
 		return 1;
 	DPRINTF("[SD] after tuning\n");
 
@@ -1991,38 +2464,8 @@ void sdmmc_storage_init_wait_sd()
 		msleep(239 - sd_poweroff_time);
 }
 
-int sdmmc_storage_init_sd(sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type)
+static int _sd_storage_init_setup(sdmmc_storage_t *storage, u32 bus_width, u32 type)
 {
-	bool is_sd_v1   = false;
-	bool lv_support = _sd_storage_get_bus_uhs_support(bus_width, type);
-
-	DPRINTF("[SD]-[init: bus: %d, type: %d]\n", bus_width, type);
-
-	// Some cards (SanDisk U1), do not like a fast power cycle. Wait min 100ms.
-	sdmmc_storage_init_wait_sd();
-
-	memset(storage, 0, sizeof(sdmmc_storage_t));
-	storage->sdmmc = sdmmc;
-
-	if (sdmmc_init(sdmmc, SDMMC_1, SDMMC_POWER_3_3, SDMMC_BUS_WIDTH_1, SDHCI_TIMING_SD_ID))
-		return 1;
-	DPRINTF("[SD] after init\n");
-
-	// Wait 1ms + 74 cycles.
-	usleep(1000 + (74 * 1000 + sdmmc->card_clock - 1) / sdmmc->card_clock);
-
-	if (_sdmmc_storage_go_idle_state(storage))
-		return 1;
-	DPRINTF("[SD] went to idle state\n");
-
-	if (_sd_storage_send_if_cond(storage, &is_sd_v1))
-		return 1;
-	DPRINTF("[SD] sent if cond\n");
-
-	if (_sd_storage_get_op_cond(storage, is_sd_v1, lv_support))
-		return 1;
-	DPRINTF("[SD] got op cond\n");
-
 	if (_sdmmc_storage_get_cid(storage))
 		return 1;
 	DPRINTF("[SD] got cid\n");
@@ -2106,13 +2549,203 @@ int sdmmc_storage_init_sd(sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_widt
 		DPRINTF("[SD] got sd status\n");
 	}
 
-	sdmmc_card_clock_powersave(sdmmc, SDMMC_POWER_SAVE_ENABLE);
+	sdmmc_card_clock_powersave(storage->sdmmc, SDMMC_POWER_SAVE_ENABLE);
 
 	storage->initialized = 1;
 
 	return 0;
 }
 
+static int _sd_storage_init_step(sdmmc_storage_init_t *init)
+{
+	sdmmc_storage_t *storage = init->storage;
+	sdmmc_t *sdmmc = init->sdmmc;
+	bool busy;
+	u32 wait_us;
+	u32 poweroff_ms;
+
+	switch (init->state)
+	{
+	case SDMMC_INIT_ST_DISCHARGE:
+		// Some cards (SanDisk U1), do not like a fast power cycle. Wait min 100ms.
+		// T210/T210B01 WAR: Wait exactly 239ms for IO and Controller power to discharge.
+		poweroff_ms = (u32)get_tmr_ms() - sd_power_cycle_time_start;
+		if (poweroff_ms < 239)
+			init->wait_end = get_tmr_us() + (239 - poweroff_ms) * 1000;
+		init->state = SDMMC_INIT_ST_POWER;
+		break;
+
+	case SDMMC_INIT_ST_POWER:
+		if (sdmmc_init_start(sdmmc, SDMMC_1, &wait_us))
+			return 1;
+		init->wait_end = get_tmr_us() + wait_us;
+		init->state = SDMMC_INIT_ST_CONTROLLER;
+		break;
+
+	case SDMMC_INIT_ST_CONTROLLER:
+		if (sdmmc_init_finish(sdmmc, SDMMC_POWER_3_3, SDMMC_BUS_WIDTH_1, SDHCI_TIMING_SD_ID))
+			return 1;
+		DPRINTF("[SD] after init\n");
+
+		// Wait 1ms + 74 cycles.
+		init->wait_end = get_tmr_us() + 1000 + (74 * 1000 + sdmmc->card_clock - 1) / sdmmc->card_clock;
+		init->state = SDMMC_INIT_ST_IDLE;
+		break;
+
+	case SDMMC_INIT_ST_IDLE:
+		if (_sdmmc_storage_go_idle_state(storage))
+			return 1;
+		DPRINTF("[SD] went to idle state\n");
+
+		if (_sd_storage_send_if_cond(storage, &init->is_sd_v1))
+			return 1;
+		DPRINTF("[SD] sent if cond\n");
+
+		init->timeout = get_tmr_ms() + 1500;
+		init->state = SDMMC_INIT_ST_OP_COND;
+		break;
+
+	case SDMMC_INIT_ST_OP_COND:
+		if (_sd_storage_get_op_cond(storage, init->is_sd_v1, init->lv_support, &busy))
+			return 1;
+
+		// Retry while card is still powering up.
+		if (busy)
+		{
+			if (get_tmr_ms() > init->timeout)
+				return 1;
+			init->wait_end = get_tmr_us() + 10000; // Needs to be at least 10ms for some SD Cards
+			break;
+		}
+		DPRINTF("[SD] got op cond\n");
+
+		init->state = SDMMC_INIT_ST_SETUP;
+		break;
+
+	case SDMMC_INIT_ST_SETUP:
+		if (_sd_storage_init_setup(storage, init->bus_width, init->type))
+			return 1;
+		init->state = SDMMC_INIT_ST_DONE;
+		break;
+	}
+
+	return 0;
+}
+
+void sdmmc_storage_init_sd_start(sdmmc_storage_init_t *init, sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type)
+{
+	memset(init, 0, sizeof(sdmmc_storage_init_t));
+	init->storage    = storage;
+	init->sdmmc      = sdmmc;
+	init->id         = SDMMC_1;
+	init->bus_width  = bus_width;
+	init->type       = type;
+	init->lv_support = _sd_storage_get_bus_uhs_support(bus_width, type);
+	init->state      = SDMMC_INIT_ST_DISCHARGE;
+	init->time_start = get_tmr_us();
+	init->wait_end   = init->time_start;
+
+	memset(storage, 0, sizeof(sdmmc_storage_t));
+	storage->sdmmc = sdmmc;
+
+	DPRINTF("[SD]-[init: bus: %d, type: %d]\n", bus_width, type);
+}
+
+int sdmmc_storage_init_sd(sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type)
+{
+	sdmmc_storage_init_t init;
+
+	sdmmc_storage_init_sd_start(&init, storage, sdmmc, bus_width, type);
+
+	return sdmmc_storage_init_finish(&init);
+}
+
+/*
+ * Resumable init functions.
+ */
+
+static sdmmc_storage_init_t *init_bg[SDMMC_INIT_BG_MAX] = { NULL };
+
+bool sdmmc_storage_init_poll(sdmmc_storage_init_t *init)
+{
+	while (init->state != SDMMC_INIT_ST_DONE)
+	{
+		// Check if current wait phase is over.
+		if ((int)(init->wait_end - get_tmr_us()) > 0)
+			return false;
+
+		int res = (init->id == SDMMC_1) ? _sd_storage_init_step(init) : _mmc_storage_init_step(init);
+		if (res)
+		{
+			init->res   = 1;
+			init->state = SDMMC_INIT_ST_DONE;
+		}
+	}
+
+	if (!init->time_end)
+		init->time_end = get_tmr_us();
+
+	return true;
+}
+
+void sdmmc_storage_init_bg_add(sdmmc_storage_init_t *init)
+{
+	for (u32 i = 0; i < SDMMC_INIT_BG_MAX; i++)
+	{
+		if (!init_bg[i])
+		{
+			init_bg[i] = init;
+			return;
+		}
+	}
+}
+
+static void _sdmmc_storage_init_bg_remove(sdmmc_storage_init_t *init)
+{
+	for (u32 i = 0; i < SDMMC_INIT_BG_MAX; i++)
+		if (init_bg[i] == init)
+			init_bg[i] = NULL;
+}
+
+static bool _sdmmc_storage_init_bg_poll()
+{
+	bool pending = false;
+
+	for (u32 i = 0; i < SDMMC_INIT_BG_MAX; i++)
+		if (init_bg[i] && !sdmmc_storage_init_poll(init_bg[i]))
+			pending = true;
+
+	return pending;
+}
+
+int sdmmc_storage_init_finish(sdmmc_storage_init_t *init)
+{
+	while (!sdmmc_storage_init_poll(init))
+	{
+		// Progress any other init while waiting.
+		_sdmmc_storage_init_bg_poll();
+
+		// Sleep until the nearest wait phase is over.
+		int wait_us = init->wait_end - get_tmr_us();
+		for (u32 i = 0; i < SDMMC_INIT_BG_MAX; i++)
+		{
+			if (init_bg[i] && init_bg[i]->state != SDMMC_INIT_ST_DONE)
+			{
+				int bg_wait_us = init_bg[i]->wait_end - get_tmr_us();
+				if (bg_wait_us < wait_us)
+					wait_us = bg_wait_us;
+			}
+		}
+
+		if (wait_us > 0)
+			usleep(wait_us);
+	}
+
+	_sdmmc_storage_init_bg_remove(init);
+
+	return init->res;
+}
+
 /*
  * Gamecard specific functions.
  */
@@ -157,6 +157,8 @@ typedef struct _mmc_ext_csd
 	u16 dev_version;
 	u32 cache_size;
 	u32 max_enh_mult;
+	u8  max_packed_wr; /* 0 if packed failure reporting is not enabled */
+	u8  cache_ctrl;
 } mmc_ext_csd_t;
 
 typedef struct _sd_scr
@@ -230,6 +232,48 @@ typedef struct _sd_vendor_info_t
 	u8  ssr_rsvd496_501; //  6-bit.
 } sd_vendor_info_t;
 
+#define SDMMC_TUNE_CACHE_MAGIC 0x4E555453 // "STUN".
+
+enum
+{
+	SDMMC_TUNE_SLOT_SD   = 0,
+	SDMMC_TUNE_SLOT_EMMC = 1,
+	SDMMC_TUNE_SLOT_MAX
+};
+
+typedef struct _sdmmc_tune_entry_t
+{
+	u8 raw_cid[0x10];
+	u8 type;
+	u8 tap;
+	u8 t210b01;
+	u8 valid;
+} sdmmc_tune_entry_t;
+
+/*!
+ * Tuning results of the last known cards. Keyed by CID and bus timing.
+ * Kept in Nyx storage across re-inits and reloads. The SD copy only seeds
+ * cards that are initialized after SD, since it is read after SD init.
+ */
+typedef struct _sdmmc_tune_cache_t
+{
+	u32 magic;
+	u32 crc32;
+	sdmmc_tune_entry_t entries[SDMMC_TUNE_SLOT_MAX];
+} sdmmc_tune_cache_t;
+
+/*!
+ * One write of a packed write command. Buffers do not need to be DMA aligned.
+ * For mmc_storage_write_packed_buf, a DMA aligned buffer holds a free 512B header
+ * block and then the data of all entries in order.
+ */
+typedef struct _mmc_packed_entry_t
+{
+	u32   sector;
+	u32   num_sectors;
+	void *buf;
+} mmc_packed_entry_t;
+
 /*! SDMMC storage context. */
 typedef struct _sdmmc_storage_t
 {
@@ -256,6 +300,37 @@ typedef struct _sdmmc_storage_t
 	sd_ext_reg_t  ser;
 } sdmmc_storage_t;
 
+#define SDMMC_INIT_BG_MAX 2
+
+enum
+{
+	SDMMC_INIT_ST_DISCHARGE  = 0, // SD power discharge wait.
+	SDMMC_INIT_ST_POWER      = 1, // Pads and card power.
+	SDMMC_INIT_ST_CONTROLLER = 2, // Controller config after power ramp.
+	SDMMC_INIT_ST_IDLE       = 3, // Card reset after 1ms + 74 cycles.
+	SDMMC_INIT_ST_OP_COND    = 4, // Card power up polling.
+	SDMMC_INIT_ST_SETUP      = 5, // Identification and bus setup.
+	SDMMC_INIT_ST_DONE       = 6
+};
+
+/*! Resumable SD/eMMC init context. Waits are deadlines so inits can be interleaved. */
+typedef struct _sdmmc_storage_init_t
+{
+	sdmmc_storage_t *storage;
+	sdmmc_t *sdmmc;
+	u32  id;
+	u32  bus_width;
+	u32  type;
+	u32  state;
+	u32  wait_end;   // Timer in us when next state can run.
+	u32  timeout;    // Timer in ms for op cond polling.
+	u32  time_start; // Timer in us.
+	u32  time_end;   // Timer in us.
+	bool is_sd_v1;
+	bool lv_support;
+	int  res;
+} sdmmc_storage_init_t;
+
 int  sdmmc_storage_end(sdmmc_storage_t *storage);
 int  sdmmc_storage_read(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf);
 int  sdmmc_storage_write(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf);
@@ -265,11 +340,29 @@ void sdmmc_storage_init_wait_sd();
 int  sdmmc_storage_init_sd(sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type);
 int  sdmmc_storage_init_gc(sdmmc_storage_t *storage, sdmmc_t *sdmmc);
 
+void sdmmc_storage_init_mmc_start(sdmmc_storage_init_t *init, sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type);
+void sdmmc_storage_init_sd_start(sdmmc_storage_init_t *init, sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type);
+bool sdmmc_storage_init_poll(sdmmc_storage_init_t *init);
+int  sdmmc_storage_init_finish(sdmmc_storage_init_t *init);
+void sdmmc_storage_init_bg_add(sdmmc_storage_init_t *init);
+
 int  sdmmc_storage_gen_cmd(sdmmc_storage_t *storage, u32 arg, void *buf);
 int  sdmmc_storage_vendor_cmd(sdmmc_storage_t *storage, u32 arg);
 int  sdmmc_storage_vendor_sandisk_report(sdmmc_storage_t *storage, void *buf);
 
 int  mmc_storage_get_ext_csd(sdmmc_storage_t *storage);
+void mmc_storage_cache_policy_set(bool enable);
+int  mmc_storage_cache_enable(sdmmc_storage_t *storage, bool enable);
+int  mmc_storage_cache_flush(sdmmc_storage_t *storage);
+u32  mmc_storage_packed_max_entries(sdmmc_storage_t *storage);
+void mmc_storage_packed_hdr_build(sdmmc_storage_t *storage, u32 *hdr, const mmc_packed_entry_t *entries, u32 count);
+int  mmc_storage_write_packed(sdmmc_storage_t *storage, const mmc_packed_entry_t *entries, u32 count);
+int  mmc_storage_write_packed_buf(sdmmc_storage_t *storage, u8 *buf, const mmc_packed_entry_t *entries, u32 count);
+
+void sdmmc_storage_tune_cache_set(sdmmc_tune_cache_t *cache);
+sdmmc_tune_cache_t *sdmmc_storage_tune_cache_get();
+bool sdmmc_storage_tune_cache_is_valid(sdmmc_tune_cache_t *cache);
+void sdmmc_storage_tune_cache_update_crc(sdmmc_tune_cache_t *cache);
 
 int  sd_storage_get_ext_reg(sdmmc_storage_t *storage, u8 fno, u8 page, u16 offset, u32 len, void *buf);
 int  sd_storage_get_fmodes(sdmmc_storage_t *storage, u8 *buf, sd_func_modes_t *functions);
@@ -19,6 +19,7 @@
 
 #include <storage/mmc_def.h>
 #include <storage/sdmmc.h>
+#include <storage/sdmmc_stats.h>
 #include <gfx_utils.h>
 #include <power/max7762x.h>
 #include <soc/bpmp.h>
@@ -103,10 +104,27 @@ void sdmmc_set_bus_width(sdmmc_t *sdmmc, u32 bus_width)
 
 void sdmmc_save_tap_value(sdmmc_t *sdmmc)
 {
-	sdmmc->venclkctl_tap = (sdmmc->regs->venclkctl & 0xFF0000) >> 16;
+	sdmmc->venclkctl_tap = sdmmc_get_tap_value(sdmmc);
 	sdmmc->venclkctl_set = 1;
 }
 
+u32 sdmmc_get_tap_value(sdmmc_t *sdmmc)
+{
+	return (sdmmc->regs->venclkctl & 0xFF0000) >> 16;
+}
+
+void sdmmc_set_tap_value(sdmmc_t *sdmmc, u32 tap)
+{
+	sdmmc->regs->clkcon     &= ~SDHCI_CLOCK_CARD_EN;
+	sdmmc->regs->ventunctl0 &= ~SDHCI_TEGRA_TUNING_TAP_HW_UPDATED;
+
+	// Set tap.
+	sdmmc->regs->venclkctl   = (sdmmc->regs->venclkctl & 0xFF00FFFF) | (tap << 16);
+
+	sdmmc->regs->ventunctl0 |=  SDHCI_TEGRA_TUNING_TAP_HW_UPDATED;
+	sdmmc->regs->clkcon     |= SDHCI_CLOCK_CARD_EN;
+}
+
 static int _sdmmc_config_tap_val(sdmmc_t *sdmmc, u32 type)
 {
 	static const u32 dqs_trim_val = 40; // 24 if HS533/HS667.
@@ -706,14 +724,7 @@ static int _sdmmc_manual_tuning_set_tap(sdmmc_t *sdmmc, sdmmc_manual_tuning_t *t
 	if (!best_tap || best_size < SDMMC_SAMPLE_WIN_SIZE_MIN)
 		return 1;
 
-	sdmmc->regs->clkcon     &= ~SDHCI_CLOCK_CARD_EN;
-	sdmmc->regs->ventunctl0 &= ~SDHCI_TEGRA_TUNING_TAP_HW_UPDATED;
-
-	// Set tap.
-	sdmmc->regs->venclkctl   = (sdmmc->regs->venclkctl & 0xFF00FFFF) | (best_tap << 16);
-
-	sdmmc->regs->ventunctl0 |=  SDHCI_TEGRA_TUNING_TAP_HW_UPDATED;
-	sdmmc->regs->clkcon     |= SDHCI_CLOCK_CARD_EN;
+	sdmmc_set_tap_value(sdmmc, best_tap);
 
 	return 0;
 }
@@ -1150,7 +1161,13 @@ static int _sdmmc_execute_cmd_inner(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_
 		}
 		if (request && !res)
 		{
+#ifdef BDK_SDMMC_STATS
+			u32 dma_start = get_tmr_us();
 			res = _sdmmc_update_sdma(sdmmc);
+			sdmmc_stats_dma_wait(sdmmc->id, get_tmr_us() - dma_start);
+#else
+			res = _sdmmc_update_sdma(sdmmc);
+#endif
 #ifdef ERROR_EXTRA_PRINTING
 			if (res)
 				EPRINTFARGS("SDMMC%d: DMA Update failed!", sdmmc->id + 1);
@@ -1281,8 +1298,12 @@ static int _sdmmc_config_sdmmc1(bool t210b01)
 	// Enable SD card power. Powers LDO2 also.
 	PINMUX_AUX(PINMUX_AUX_DMIC3_CLK) = PINMUX_PULL_DOWN | 2;
 	gpio_direction_output(GPIO_PORT_E, GPIO_PIN_4, GPIO_HIGH);
-	usleep(10000); // Minimum 3 to 10 ms.
 
+	return 0;
+}
+
+static void _sdmmc_config_sdmmc1_io_power(bool t210b01)
+{
 	// Inform IO pads that voltage is gonna be 3.3V.
 	PMC(APBDEV_PMC_PWR_DET_VAL) |= PMC_PWR_DET_33V_SDMMC1;
 	(void)PMC(APBDEV_PMC_PWR_DET_VAL); // Commit write.
@@ -1299,8 +1320,6 @@ static int _sdmmc_config_sdmmc1(bool t210b01)
 		(void)APB_MISC(APB_MISC_GP_SDMMC1_PAD_CFGPADCTRL); // Commit write.
 		usleep(1000);
 	}
-
-	return 0;
 }
 
 static void _sdmmc_config_emmc(u32 id, bool t210b01)
@@ -1331,16 +1350,8 @@ static void _sdmmc_config_emmc(u32 id, bool t210b01)
 	}
 }
 
-int sdmmc_init(sdmmc_t *sdmmc, u32 id, u32 power, u32 bus_width, u32 type)
+int sdmmc_init_start(sdmmc_t *sdmmc, u32 id, u32 *wait_us)
 {
-	u32 clock;
-	u16 divisor;
-	u8 vref_sel = 7;
-
-	static const u8 trim_values_t210[4]    = {  2,  8,  3,  8 };
-	static const u8 trim_values_t210b01[4] = { 14, 13, 15, 13 };
-	const u8 *trim_values;
-
 	if (id > SDMMC_4 || id == SDMMC_3)
 		return 1;
 
@@ -1351,7 +1362,7 @@ int sdmmc_init(sdmmc_t *sdmmc, u32 id, u32 power, u32 bus_width, u32 type)
 	sdmmc->clock_stopped = 1;
 	sdmmc->t210b01 = hw_get_chip_id() == GP_HIDREV_MAJOR_T210B01;
 
-	trim_values = sdmmc->t210b01 ? trim_values_t210b01 : trim_values_t210;
+	*wait_us = 0;
 
 	// Do specific SDMMC HW configuration.
 	switch (id)
@@ -1359,10 +1370,9 @@ int sdmmc_init(sdmmc_t *sdmmc, u32 id, u32 power, u32 bus_width, u32 type)
 	case SDMMC_1:
 		if (_sdmmc_config_sdmmc1(sdmmc->t210b01))
 			return 1;
-		if (sdmmc->t210b01)
-			vref_sel = 0;
-		else
+		if (!sdmmc->t210b01)
 			sdmmc->periodic_calibration = 1;
+		*wait_us = 10000; // Card power ramp. Minimum 3 to 10 ms.
 		break;
 
 	case SDMMC_2:
@@ -1371,8 +1381,29 @@ int sdmmc_init(sdmmc_t *sdmmc, u32 id, u32 power, u32 bus_width, u32 type)
 		break;
 	}
 
+	return 0;
+}
+
+int sdmmc_init_finish(sdmmc_t *sdmmc, u32 power, u32 bus_width, u32 type)
+{
+	u32 clock;
+	u16 divisor;
+	u8 vref_sel = 7;
+
+	static const u8 trim_values_t210[4]    = {  2,  8,  3,  8 };
+	static const u8 trim_values_t210b01[4] = { 14, 13, 15, 13 };
+	const u8 *trim_values = sdmmc->t210b01 ? trim_values_t210b01 : trim_values_t210;
+
+	// Finish SD card power up.
+	if (sdmmc->id == SDMMC_1)
+	{
+		_sdmmc_config_sdmmc1_io_power(sdmmc->t210b01);
+		if (sdmmc->t210b01)
+			vref_sel = 0;
+	}
+
 	// Disable clock if enabled.
-	if (clock_sdmmc_is_active(id))
+	if (clock_sdmmc_is_active(sdmmc->id))
 	{
 		_sdmmc_card_clock_disable(sdmmc);
 		_sdmmc_commit_changes(sdmmc);
@@ -1380,7 +1411,7 @@ int sdmmc_init(sdmmc_t *sdmmc, u32 id, u32 power, u32 bus_width, u32 type)
 
 	// Configure and enable selected clock.
 	clock_sdmmc_get_card_clock_div(&clock, &divisor, type);
-	clock_sdmmc_enable(id, clock);
+	clock_sdmmc_enable(sdmmc->id, clock);
 	sdmmc->clock_stopped = 0;
 
 	// Make sure all sdmmc registers are reset.
@@ -1421,6 +1452,19 @@ int sdmmc_init(sdmmc_t *sdmmc, u32 id, u32 power, u32 bus_width, u32 type)
 	return 1;
 }
 
+int sdmmc_init(sdmmc_t *sdmmc, u32 id, u32 power, u32 bus_width, u32 type)
+{
+	u32 wait_us;
+
+	if (sdmmc_init_start(sdmmc, id, &wait_us))
+		return 1;
+
+	if (wait_us)
+		usleep(wait_us);
+
+	return sdmmc_init_finish(sdmmc, power, bus_width, type);
+}
+
 void sdmmc1_disable_power()
 {
 	// T210B01 WAR: Clear pull down from CLK pad.
@@ -0,0 +1,147 @@
+/*
+ * SDMMC I/O statistics.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <storage/sdmmc_stats.h>
+#include <storage/sdmmc_driver.h>
+#include <utils/sprintf.h>
+
+static sdmmc_stats_t sdmmc_stats[SDMMC_STATS_DEV_MAX] = { 0 };
+
+static const char *sdmmc_stats_dev_names[SDMMC_STATS_DEV_MAX] = { "SD", "GC", "eMMC" };
+
+static u32 _log2(u32 val)
+{
+	u32 res = 0;
+	while (val >>= 1)
+		res++;
+
+	return res;
+}
+
+u32 sdmmc_stats_dev(u32 sdmmc_id)
+{
+	switch (sdmmc_id)
+	{
+	case SDMMC_1:
+		return SDMMC_STATS_DEV_SD;
+	case SDMMC_2:
+		return SDMMC_STATS_DEV_GC;
+	default:
+		return SDMMC_STATS_DEV_EMMC;
+	}
+}
+
+void sdmmc_stats_io(u32 sdmmc_id, u32 is_write, u32 num_sectors, u32 time_us)
+{
+	sdmmc_stats_op_t *op = &sdmmc_stats[sdmmc_stats_dev(sdmmc_id)].op[is_write ? SDMMC_STATS_OP_WRITE : SDMMC_STATS_OP_READ];
+
+	// Size classes go up by 8x.
+	u32 size_class = num_sectors > 1 ? (_log2(num_sectors - 1) / 3 + 1) : 0;
+	u32 lat_bucket = _log2(time_us);
+
+	op->count++;
+	op->sectors += num_sectors;
+	op->time_us += time_us;
+	if (time_us > op->max_us)
+		op->max_us = time_us;
+	op->hist[MIN(size_class, SDMMC_STATS_SIZE_CLASSES - 1)][MIN(lat_bucket, SDMMC_STATS_LAT_BUCKETS - 1)]++;
+}
+
+void sdmmc_stats_dma_wait(u32 sdmmc_id, u32 time_us)
+{
+	sdmmc_stats[sdmmc_stats_dev(sdmmc_id)].dma_wait_us += time_us;
+}
+
+void sdmmc_stats_retry(u32 sdmmc_id)
+{
+	sdmmc_stats[sdmmc_stats_dev(sdmmc_id)].retries++;
+}
+
+void sdmmc_stats_tuning(u32 sdmmc_id, u32 tap)
+{
+	sdmmc_stats_t *stats = &sdmmc_stats[sdmmc_stats_dev(sdmmc_id)];
+
+	// Track tap drift across tunings.
+	if (!stats->tunings)
+	{
+		stats->tap_min = tap;
+		stats->tap_max = tap;
+	}
+	else
+	{
+		stats->tap_min = MIN(stats->tap_min, tap);
+		stats->tap_max = MAX(stats->tap_max, tap);
+	}
+
+	stats->tap_last = tap;
+	stats->tunings++;
+}
+
+sdmmc_stats_t *sdmmc_stats_get(u32 dev)
+{
+	return &sdmmc_stats[dev];
+}
+
+void sdmmc_stats_reset(u32 dev)
+{
+	memset(&sdmmc_stats[dev], 0, sizeof(sdmmc_stats_t));
+}
+
+u32 sdmmc_stats_to_csv(u32 dev, char *buf)
+{
+	static const char *op_names[SDMMC_STATS_OP_MAX] = { "read", "write" };
+
+	sdmmc_stats_t *stats = &sdmmc_stats[dev];
+	const char *name = sdmmc_stats_dev_names[dev];
+
+	// Summary.
+	s_printf(buf, "device,dma_wait_ms,retries,tunings,tap_last,tap_min,tap_max\n%s,%d,%d,%d,%d,%d,%d\n\n",
+		name, (u32)(stats->dma_wait_us / 1000), stats->retries, stats->tunings,
+		stats->tap_last, stats->tap_min, stats->tap_max);
+
+	strcat(buf, "device,op,count,kib,time_ms,max_us\n");
+	for (u32 i = 0; i < SDMMC_STATS_OP_MAX; i++)
+	{
+		sdmmc_stats_op_t *op = &stats->op[i];
+		s_printf(buf + strlen(buf), "%s,%s,%d,%d,%d,%d\n",
+			name, op_names[i], op->count, op->sectors / 2, (u32)(op->time_us / 1000), op->max_us);
+	}
+
+	// Histograms. Only non empty buckets. Size class max and latency bucket min are inclusive.
+	strcat(buf, "\ndevice,op,max_sectors,min_us,count\n");
+	for (u32 i = 0; i < SDMMC_STATS_OP_MAX; i++)
+	{
+		for (u32 size_class = 0; size_class < SDMMC_STATS_SIZE_CLASSES; size_class++)
+		{
+			u32 max_sectors = size_class < (SDMMC_STATS_SIZE_CLASSES - 1) ? (1U << (size_class * 3)) : 0xFFFFFFFF;
+			for (u32 lat_bucket = 0; lat_bucket < SDMMC_STATS_LAT_BUCKETS; lat_bucket++)
+			{
+				u32 count = stats->op[i].hist[size_class][lat_bucket];
+				if (!count)
+					continue;
+
+				s_printf(buf + strlen(buf), "%s,%s,%d,%d,%d\n",
+					name, op_names[i], max_sectors == 0xFFFFFFFF ? -1 : (int)max_sectors, 1 << lat_bucket, count);
+			}
+		}
+	}
+
+	return strlen(buf);
+}
@@ -0,0 +1,72 @@
+/*
+ * SDMMC I/O statistics.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SDMMC_STATS_H
+#define SDMMC_STATS_H
+
+#include <utils/types.h>
+
+#define SDMMC_STATS_SIZE_CLASSES 6  // 1, <=8, <=64, <=512, <=4096 and more sectors.
+#define SDMMC_STATS_LAT_BUCKETS  24 // log2 us. Last one is >= 8s.
+
+enum
+{
+	SDMMC_STATS_DEV_SD   = 0,
+	SDMMC_STATS_DEV_GC   = 1,
+	SDMMC_STATS_DEV_EMMC = 2,
+	SDMMC_STATS_DEV_MAX
+};
+
+enum
+{
+	SDMMC_STATS_OP_READ  = 0,
+	SDMMC_STATS_OP_WRITE = 1,
+	SDMMC_STATS_OP_MAX
+};
+
+typedef struct _sdmmc_stats_op_t
+{
+	u32 count;
+	u32 sectors;
+	u64 time_us;
+	u32 max_us;
+	u32 hist[SDMMC_STATS_SIZE_CLASSES][SDMMC_STATS_LAT_BUCKETS];
+} sdmmc_stats_op_t;
+
+typedef struct _sdmmc_stats_t
+{
+	sdmmc_stats_op_t op[SDMMC_STATS_OP_MAX];
+	u64 dma_wait_us;
+	u32 retries;
+	u32 tunings;
+	u8  tap_last;
+	u8  tap_min;
+	u8  tap_max;
+	u8  rsvd;
+} sdmmc_stats_t;
+
+u32  sdmmc_stats_dev(u32 sdmmc_id);
+void sdmmc_stats_io(u32 sdmmc_id, u32 is_write, u32 num_sectors, u32 time_us);
+void sdmmc_stats_dma_wait(u32 sdmmc_id, u32 time_us);
+void sdmmc_stats_retry(u32 sdmmc_id);
+void sdmmc_stats_tuning(u32 sdmmc_id, u32 tap);
+sdmmc_stats_t *sdmmc_stats_get(u32 dev);
+void sdmmc_stats_reset(u32 dev);
+u32  sdmmc_stats_to_csv(u32 dev, char *buf);
+
+#endif
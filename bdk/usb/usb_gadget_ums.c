@@ -58,6 +58,12 @@
 
 #define UMS_SCSI_TRANSFER_512K (0x80000 >> UMS_DISK_LBA_SHIFT)
 
+// Small eMMC writes are queued and merged into packed writes.
+#define UMS_WCACHE_MAX_ENTRIES 32
+#define UMS_WCACHE_MAX_IO      SZ_64K // Max write command size that gets queued.
+#define UMS_WCACHE_SZ          SZ_4M
+#define UMS_WCACHE_IDLE_MS     100
+
 #define UMS_EP_OUT_MAX_XFER (USB_EP_BULK_OUT_MAX_XFER)
 
 // Length of a SCSI Command Data Block.
@@ -200,6 +206,16 @@ typedef struct _bulk_ctxt_t {
 	enum buffer_state bulk_out_buf_state;
 } bulk_ctxt_t;
 
+typedef struct _ums_wcache_t {
+	bool enabled;
+	u32  count;
+	u32  size;
+	u32  time_last;  // Timer in ms of the last queued write.
+	u32  max_entries;
+	u8  *buf;        // Packed header block followed by the queued data.
+	mmc_packed_entry_t entries[UMS_WCACHE_MAX_ENTRIES];
+} ums_wcache_t;
+
 typedef struct _usbd_gadget_ums_t {
 	bulk_ctxt_t bulk_ctxt;
 
@@ -208,6 +224,7 @@ typedef struct _usbd_gadget_ums_t {
 
 	u32  lun_idx; // lun index
 	logical_unit_t lun;
+	ums_wcache_t wcache;
 
 	enum ums_state state; // For exception handling.
 
@@ -535,11 +552,68 @@ static int _scsi_read(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	return UMS_RES_IO_ERROR; // No default reply.
 }
 
+static int _wcache_flush(usbd_gadget_ums_t *ums)
+{
+	ums_wcache_t *wcache = &ums->wcache;
+
+	if (!wcache->count)
+		return 0;
+
+	// Queued data is already laid out after the packed header block.
+	int res = mmc_storage_write_packed_buf(ums->lun.storage, wcache->buf, wcache->entries, wcache->count);
+
+	wcache->count = 0;
+	wcache->size  = 0;
+
+	if (res)
+		ums->set_text(ums->label, "#FFDD00 错误：#SDMMC写入失败！");
+
+	return res;
+}
+
+static int _wcache_add(usbd_gadget_ums_t *ums, u32 sector, u32 num_sectors, const u8 *buf)
+{
+	ums_wcache_t *wcache = &ums->wcache;
+	u32 size = num_sectors << UMS_DISK_LBA_SHIFT;
+
+	// Flush if full or if it overlaps a queued write, so write order is kept.
+	bool flush = wcache->count == wcache->max_entries || (wcache->size + size) > UMS_WCACHE_SZ;
+	for (u32 i = 0; i < wcache->count && !flush; i++)
+	{
+		mmc_packed_entry_t *entry = &wcache->entries[i];
+		if (sector < (entry->sector + entry->num_sectors) && entry->sector < (sector + num_sectors))
+			flush = true;
+	}
+
+	if (flush && _wcache_flush(ums))
+		return 1;
+
+	u8 *data = wcache->buf + SDMMC_DAT_BLOCKSIZE + wcache->size;
+	memcpy(data, buf, size);
+
+	// Extend last entry if sequential. Its data is at the end of the buffer.
+	mmc_packed_entry_t *last = wcache->count ? &wcache->entries[wcache->count - 1] : NULL;
+	if (last && (last->sector + last->num_sectors) == sector)
+		last->num_sectors += num_sectors;
+	else
+	{
+		wcache->entries[wcache->count].sector      = sector;
+		wcache->entries[wcache->count].num_sectors = num_sectors;
+		wcache->entries[wcache->count].buf         = data;
+		wcache->count++;
+	}
+
+	wcache->size += size;
+	wcache->time_last = get_tmr_ms();
+
+	return 0;
+}
+
 /*
  * Writes are another story.
  * Tests showed that big writes are faster than concurrent 32K usb reads + writes.
- * The only thing that can help here is caching the writes. But for the simplicity
- * of this implementation it will not be implemented yet.
+ * The only thing that can help here is caching the writes. Small eMMC writes are
+ * queued and merged into packed writes. Anything else is written synchronously.
  */
 
 static int _scsi_write(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
@@ -548,6 +622,8 @@ static int _scsi_write(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	u32 amount_left_to_req, amount_left_to_write;
 	u32 usb_lba_offset, lba_offset;
 	u32 amount;
+	bool fua = false;
+	int res;
 
 	if (ums->lun.ro)
 	{
@@ -570,6 +646,8 @@ static int _scsi_write(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 
 			return UMS_RES_INVALID_ARG;
 		}
+
+		fua = ums->cmnd[1] & 0x08;
 	}
 
 	// Check that starting LBA is not past the end sector offset.
@@ -581,6 +659,15 @@ static int _scsi_write(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 		return UMS_RES_INVALID_ARG;
 	}
 
+	// Queue small writes. Otherwise flush queued writes first to keep write order.
+	bool cached = ums->wcache.enabled && !fua && ums->data_size_from_cmnd <= UMS_WCACHE_MAX_IO;
+	if (!cached && _wcache_flush(ums))
+	{
+		ums->lun.sense_data = SS_WRITE_ERROR;
+
+		return UMS_RES_INVALID_ARG;
+	}
+
 	// Carry out the file writes.
 	usb_lba_offset       = lba_offset;
 	amount_left_to_req   = ums->data_size_from_cmnd;
@@ -650,8 +737,13 @@ static int _scsi_write(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 				goto empty_write;
 
 			// Perform the write.
-			if (sdmmc_storage_write(ums->lun.storage, ums->lun.offset + lba_offset,
-				amount >> UMS_DISK_LBA_SHIFT, (u8 *)bulk_ctxt->bulk_out_buf))
+			if (cached)
+				res = _wcache_add(ums, ums->lun.offset + lba_offset,
+					amount >> UMS_DISK_LBA_SHIFT, (u8 *)bulk_ctxt->bulk_out_buf);
+			else
+				res = sdmmc_storage_write(ums->lun.storage, ums->lun.offset + lba_offset,
+					amount >> UMS_DISK_LBA_SHIFT, (u8 *)bulk_ctxt->bulk_out_buf);
+			if (res)
 				amount = 0;
 
 DPRINTF("file write %X @ %X\n", amount, lba_offset);
@@ -1093,7 +1185,7 @@ static int _scsi_prevent_allow_removal(usbd_gadget_ums_t *ums)
 	}
 
 	// Notify for possible unmounting?
-	// Normally we sync here but we do synced writes to SDMMC.
+	// Normally we sync here but queued writes are already flushed on any non write command.
 	if (ums->lun.prevent_medium_removal && !prevent) { /* Do nothing */ }
 
 	ums->lun.prevent_medium_removal = prevent;
@@ -1215,6 +1307,10 @@ static int _parse_scsi_cmd(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	ums->phase_error = 0;
 	ums->short_packet_received = 0;
 
+	// Flush queued writes before anything else can observe the medium. Writes were already acknowledged.
+	if (ums->cmnd[0] != SC_WRITE_6 && ums->cmnd[0] != SC_WRITE_10 && ums->cmnd[0] != SC_WRITE_12 && _wcache_flush(ums))
+		ums->lun.unit_attention_data = SS_WRITE_ERROR;
+
 	switch (ums->cmnd[0])
 	{
 	case SC_INQUIRY:
@@ -1329,8 +1425,11 @@ static int _parse_scsi_cmd(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	case SC_SYNCHRONIZE_CACHE:
 		ums->data_size_from_cmnd = 0;
 		reply = _check_scsi_cmd(ums, 10, DATA_DIR_NONE, (0xf<<2) | (3<<7), 1);
-		if (reply == 0)
-			reply = 0; // Don't bother
+		if (reply == 0 && mmc_storage_cache_flush(ums->lun.storage)) // Queued writes were flushed above.
+		{
+			ums->lun.sense_data = SS_WRITE_ERROR;
+			reply = UMS_RES_INVALID_ARG;
+		}
 		break;
 
 	case SC_TEST_UNIT_READY:
@@ -1884,6 +1983,11 @@ int usb_device_gadget_ums(usb_ctxt_t *usbs)
 
 		ums.lun.sdmmc   = &emmc_sdmmc;
 		ums.lun.storage = &emmc_storage;
+
+		// Use write queue if packed writes are supported.
+		ums.wcache.max_entries = MIN(mmc_storage_packed_max_entries(&emmc_storage), UMS_WCACHE_MAX_ENTRIES);
+		ums.wcache.enabled     = !ums.lun.ro && ums.wcache.max_entries >= 2;
+		ums.wcache.buf         = (u8 *)EMMC_BUF_ALIGNED;
 	}
 
 	ums.set_text(ums.label, "#C7EA46 状态：#正在等待连接");
@@ -1913,6 +2017,10 @@ int usb_device_gadget_ums(usb_ctxt_t *usbs)
 		// Do DRAM training and update system tasks.
 		_system_maintainance(&ums);
 
+		// Flush queued writes if host is idle.
+		if (ums.wcache.count && (get_tmr_ms() - ums.wcache.time_last) > UMS_WCACHE_IDLE_MS && _wcache_flush(&ums))
+			ums.lun.unit_attention_data = SS_WRITE_ERROR;
+
 		// Check for force unmount button combo.
 		if (btn_read_vol() == (BTN_VOL_UP | BTN_VOL_DOWN))
 		{
@@ -1960,6 +2068,8 @@ usb_enum_error:
 	res = 1;
 
 exit:
+	_wcache_flush(&ums);
+
 	if (ums.lun.type == MMC_EMMC)
 		emmc_end();
 
@@ -0,0 +1,277 @@
+/*
+ * Android sparse image decoder.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "simg.h"
+#include <soc/ccplex.h>
+
+bool simg_is_sparse(const void *buf)
+{
+	return ((const simg_hdr_t *)buf)->magic == SIMG_MAGIC;
+}
+
+static int _simg_hdr_check(const simg_hdr_t *hdr)
+{
+	if (hdr->magic != SIMG_MAGIC || hdr->major_version != SIMG_MAJOR_VER)
+		return 1;
+
+	if (hdr->file_hdr_sz < sizeof(simg_hdr_t) || hdr->chunk_hdr_sz < sizeof(simg_chunk_hdr_t))
+		return 1;
+
+	// Blocks must be whole sectors.
+	if (!hdr->blk_sz || (hdr->blk_sz & 0x1FF))
+		return 1;
+
+	// Output must fit in 32-bit sectors.
+	if (((u64)hdr->total_blks * hdr->blk_sz) >> 9 > 0xFFFFFFFF)
+		return 1;
+
+	return 0;
+}
+
+u32 simg_image_sectors(const simg_hdr_t *hdr)
+{
+	if (_simg_hdr_check(hdr))
+		return 0;
+
+	return hdr->total_blks * (hdr->blk_sz >> 9);
+}
+
+static u32 _simg_gf2_times(const u32 *mat, u32 vec)
+{
+	u32 sum = 0;
+
+	while (vec)
+	{
+		if (vec & 1)
+			sum ^= *mat;
+		vec >>= 1;
+		mat++;
+	}
+
+	return sum;
+}
+
+static void _simg_gf2_square(u32 *square, const u32 *mat)
+{
+	for (u32 i = 0; i < 32; i++)
+		square[i] = _simg_gf2_times(mat, mat[i]);
+}
+
+/*
+ * Extends a CRC32 with len zero bytes in O(log len), same as zlib's crc32_combine().
+ * DONT_CARE and zero FILL chunks can span gigabytes, so they are not hashed byte by byte.
+ */
+static u32 _simg_crc32_zeros(u32 crc, u64 len)
+{
+	u32 even[32];
+	u32 odd[32];
+	u32 row = 1;
+
+	if (!len)
+		return crc;
+
+	// Operator for one zero bit.
+	odd[0] = 0xEDB88320;
+	for (u32 i = 1; i < 32; i++)
+	{
+		odd[i] = row;
+		row <<= 1;
+	}
+
+	// Operators for two and four zero bits.
+	_simg_gf2_square(even, odd);
+	_simg_gf2_square(odd, even);
+
+	crc = ~crc;
+	while (true)
+	{
+		// Apply zero bytes in powers of two.
+		_simg_gf2_square(even, odd);
+		if (len & 1)
+			crc = _simg_gf2_times(even, crc);
+		len >>= 1;
+		if (!len)
+			break;
+
+		_simg_gf2_square(odd, even);
+		if (len & 1)
+			crc = _simg_gf2_times(odd, crc);
+		len >>= 1;
+		if (!len)
+			break;
+	}
+
+	return ~crc;
+}
+
+static int _simg_skip(simg_ctxt_t *ctxt, u32 size)
+{
+	while (size)
+	{
+		u32 chunk = MIN(size, ctxt->buf_size);
+		if (ctxt->read(ctxt->rpriv, ctxt->buf, chunk))
+			return 1;
+		size -= chunk;
+	}
+
+	return 0;
+}
+
+// Writes the buffer while the CCPLEX worker checksums it. Runs inline on BPMP if the worker is not running.
+static int _simg_write_crc32(simg_ctxt_t *ctxt, u32 sct_off, u32 num)
+{
+	u32 job = ccplex_worker_post(CCPLEX_JOB_CRC32, NULL, ctxt->buf, num << 9, ctxt->crc32);
+
+	int res = ctxt->write(ctxt->wpriv, sct_off, num, ctxt->buf);
+
+	// Buffer is reused next, so always wait.
+	ctxt->crc32 = ccplex_worker_wait(job);
+
+	return res;
+}
+
+static int _simg_raw(simg_ctxt_t *ctxt, u32 sct_off, u32 sct_num)
+{
+	u32 buf_sct = ctxt->buf_size >> 9;
+
+	while (sct_num)
+	{
+		u32 num = MIN(sct_num, buf_sct);
+		if (ctxt->read(ctxt->rpriv, ctxt->buf, num << 9))
+			return 1;
+		if (_simg_write_crc32(ctxt, sct_off, num))
+			return 1;
+
+		sct_off += num;
+		sct_num -= num;
+	}
+
+	return 0;
+}
+
+static int _simg_fill(simg_ctxt_t *ctxt, u32 sct_off, u32 sct_num, u32 pattern)
+{
+	u32 buf_sct = MIN(sct_num, ctxt->buf_size >> 9);
+	u32 *buf32 = (u32 *)ctxt->buf;
+
+	// Prepare the pattern buffer once and write it repeatedly.
+	for (u32 i = 0; i < (buf_sct << 9) / sizeof(u32); i++)
+		buf32[i] = pattern;
+
+	if (!pattern)
+		ctxt->crc32 = _simg_crc32_zeros(ctxt->crc32, (u64)sct_num << 9);
+
+	while (sct_num)
+	{
+		u32 num = MIN(sct_num, buf_sct);
+		if (pattern)
+		{
+			if (_simg_write_crc32(ctxt, sct_off, num))
+				return 1;
+		}
+		else if (ctxt->write(ctxt->wpriv, sct_off, num, ctxt->buf))
+			return 1;
+
+		sct_off += num;
+		sct_num -= num;
+	}
+
+	return 0;
+}
+
+int simg_flash(simg_ctxt_t *ctxt)
+{
+	simg_hdr_t hdr;
+	simg_chunk_hdr_t chunk;
+	u32 val;
+
+	ctxt->skipped_sct = 0;
+	ctxt->crc32       = 0;
+
+	if (ctxt->read(ctxt->rpriv, &hdr, sizeof(simg_hdr_t)) || _simg_hdr_check(&hdr))
+		return 1;
+
+	if (_simg_skip(ctxt, hdr.file_hdr_sz - sizeof(simg_hdr_t)))
+		return 1;
+
+	u32 blk_sct   = hdr.blk_sz >> 9;
+	u32 total_sct = simg_image_sectors(&hdr);
+	u32 sct_off   = 0;
+
+	for (u32 i = 0; i < hdr.total_chunks; i++)
+	{
+		if (ctxt->read(ctxt->rpriv, &chunk, sizeof(simg_chunk_hdr_t)))
+			return 1;
+
+		if (_simg_skip(ctxt, hdr.chunk_hdr_sz - sizeof(simg_chunk_hdr_t)))
+			return 1;
+
+		if (chunk.total_sz < hdr.chunk_hdr_sz)
+			return 1;
+
+		u64 chunk_sct = (u64)chunk.chunk_sz * blk_sct;
+		u32 data_sz   = chunk.total_sz - hdr.chunk_hdr_sz;
+
+		if (sct_off + chunk_sct > total_sct)
+			return 1;
+
+		switch (chunk.chunk_type)
+		{
+		case SIMG_CHUNK_RAW:
+			if ((chunk_sct << 9) != data_sz)
+				return 1;
+			if (_simg_raw(ctxt, sct_off, chunk_sct))
+				return 1;
+			break;
+
+		case SIMG_CHUNK_FILL:
+			if (data_sz != sizeof(u32) || ctxt->read(ctxt->rpriv, &val, sizeof(u32)))
+				return 1;
+			if (_simg_fill(ctxt, sct_off, chunk_sct, val))
+				return 1;
+			break;
+
+		case SIMG_CHUNK_DONT_CARE:
+			// Leave the target untouched.
+			if (data_sz)
+				return 1;
+			ctxt->skipped_sct += chunk_sct;
+
+			// Checksum covers them as zeros.
+			ctxt->crc32 = _simg_crc32_zeros(ctxt->crc32, chunk_sct << 9);
+			break;
+
+		case SIMG_CHUNK_CRC32:
+			// Checksum of the image so far.
+			if (data_sz != sizeof(u32) || ctxt->read(ctxt->rpriv, &val, sizeof(u32)))
+				return 1;
+			if (val != ctxt->crc32)
+				return 1;
+			break;
+
+		default:
+			return 1;
+		}
+
+		sct_off += chunk_sct;
+	}
+
+	return sct_off != total_sct;
+}
@@ -0,0 +1,71 @@
+/*
+ * Android sparse image decoder.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SIMG_H_
+#define _SIMG_H_
+
+#include <utils/types.h>
+
+#define SIMG_MAGIC       0xED26FF3A
+#define SIMG_MAJOR_VER   1
+
+#define SIMG_CHUNK_RAW       0xCAC1
+#define SIMG_CHUNK_FILL      0xCAC2
+#define SIMG_CHUNK_DONT_CARE 0xCAC3
+#define SIMG_CHUNK_CRC32     0xCAC4
+
+typedef struct _simg_hdr_t
+{
+	u32 magic;
+	u16 major_version;
+	u16 minor_version;
+	u16 file_hdr_sz;
+	u16 chunk_hdr_sz;
+	u32 blk_sz;
+	u32 total_blks;
+	u32 total_chunks;
+	u32 image_checksum;
+} simg_hdr_t;
+
+typedef struct _simg_chunk_hdr_t
+{
+	u16 chunk_type;
+	u16 rsvd;
+	u32 chunk_sz; // Output size in blocks.
+	u32 total_sz; // Input size in bytes, header included.
+} simg_chunk_hdr_t;
+
+typedef struct _simg_ctxt_t
+{
+	// Both return 0 on success.
+	int (*read)(void *priv, void *buf, u32 size);
+	int (*write)(void *priv, u32 sct_off, u32 num, const void *buf);
+	void *rpriv;
+	void *wpriv;
+
+	u8  *buf;
+	u32  buf_size;    // Work buffer size. Must be a multiple of 512.
+	u32  skipped_sct; // Sectors left untouched by DONT_CARE chunks.
+	u32  crc32;       // Running checksum of the output, for CRC32 chunks.
+} simg_ctxt_t;
+
+bool simg_is_sparse(const void *buf);
+u32  simg_image_sectors(const simg_hdr_t *hdr);
+int  simg_flash(simg_ctxt_t *ctxt);
+
+#endif
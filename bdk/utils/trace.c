@@ -0,0 +1,121 @@
+/*
+ * Boot time tracing.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef BDK_TRACE
+
+#include <string.h>
+
+#include <memory_map.h>
+#include <mem/heap.h>
+#include <soc/timer.h>
+#include <storage/sd.h>
+#include <utils/sprintf.h>
+#include <utils/trace.h>
+#include <libs/fatfs/ff.h>
+
+#define TRACE_JSON_EVENT_SZ_MAX 96
+
+static_assert(sizeof(trace_buf_t) <= TRACE_BUF_SZ, "Trace buffer size is wrong!");
+static_assert(!MEM_REGION_OVERLAP(TRACE_BUF_ADDR, TRACE_BUF_SZ, SDMMC_ALT_DMA_BUFFER, EMMC_BUF_ALIGNED + SDMMC_DMA_BUF_SZ - SDMMC_ALT_DMA_BUFFER),
+			  "Trace buffer overlaps SDMMC or Nyx buffers!");
+static_assert(!MEM_REGION_OVERLAP(TRACE_BUF_ADDR, TRACE_BUF_SZ, NYX_LV_VDB_ADR, NYX_LV_MEM_ADR + NYX_LV_MEM_SZ - NYX_LV_VDB_ADR),
+			  "Trace buffer overlaps Nyx LvGL memory!");
+static_assert(!MEM_REGION_OVERLAP(TRACE_BUF_ADDR, TRACE_BUF_SZ, IPL_FB_ADDRESS, NYX_FB2_ADDRESS + NYX_FB_SZ - IPL_FB_ADDRESS),
+			  "Trace buffer overlaps framebuffers!");
+static_assert(!MEM_REGION_OVERLAP(TRACE_BUF_ADDR, TRACE_BUF_SZ, USBD_ADDR, USB_EP_BULK_OUT_BUF_ADDR + USB_EP_BULK_OUT_MAX_XFER - USBD_ADDR),
+			  "Trace buffer overlaps USB buffers!");
+
+static trace_buf_t *trace = (trace_buf_t *)TRACE_BUF_ADDR;
+
+void trace_init()
+{
+	memset(trace, 0, sizeof(trace_buf_t));
+	trace->magic = TRACE_MAGIC;
+
+	// Timer runs since reset, so this covers bootrom and initial hw config.
+	trace->events[0].name  = "bootrom+hw_init";
+	trace->events[0].ts    = 0;
+	trace->events[0].phase = TRACE_PH_BEGIN;
+	trace->events[1].name  = "bootrom+hw_init";
+	trace->events[1].ts    = get_tmr_us();
+	trace->events[1].phase = TRACE_PH_END;
+	trace->idx   = 2;
+	trace->count = 2;
+}
+
+void trace_event(const char *name, u32 phase)
+{
+	if (trace->magic != TRACE_MAGIC)
+		return;
+
+	trace_event_t *event = &trace->events[trace->idx];
+	event->name  = name;
+	event->ts    = get_tmr_us();
+	event->phase = phase;
+
+	trace->idx = (trace->idx + 1) % TRACE_EVENTS_MAX;
+	if (trace->count < TRACE_EVENTS_MAX)
+		trace->count++;
+}
+
+int trace_dump(const char *path)
+{
+	FIL fp;
+
+	if (trace->magic != TRACE_MAGIC || !sd_get_card_mounted())
+		return 1;
+
+	// Mark the dump itself, so handoff point is visible.
+	trace_event("trace_dump", TRACE_PH_INSTANT);
+
+	char *buf = (char *)malloc(TRACE_EVENTS_MAX * TRACE_JSON_EVENT_SZ_MAX + 64);
+	char *pos = buf;
+
+	strcpy(pos, "{\"traceEvents\":[\n");
+	pos += strlen(pos);
+
+	// Oldest first.
+	u32 idx = (trace->idx + TRACE_EVENTS_MAX - trace->count) % TRACE_EVENTS_MAX;
+	for (u32 i = 0; i < trace->count; i++)
+	{
+		trace_event_t *event = &trace->events[idx];
+		s_printf(pos, "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%d,\"pid\":1,\"tid\":1%s}%s\n",
+			event->name, event->phase, event->ts,
+			event->phase == TRACE_PH_INSTANT ? ",\"s\":\"g\"" : "",
+			i + 1 < trace->count ? "," : "");
+		pos += strlen(pos);
+
+		idx = (idx + 1) % TRACE_EVENTS_MAX;
+	}
+
+	strcpy(pos, "],\"displayTimeUnit\":\"ms\"}\n");
+	pos += strlen(pos);
+
+	int res = f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE);
+	if (!res)
+	{
+		res = f_write(&fp, buf, pos - buf, NULL);
+		f_close(&fp);
+	}
+
+	free(buf);
+
+	return res ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * Boot time tracing.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <utils/types.h>
+
+#define TRACE_MAGIC       0x43525442 // BTRC.
+#define TRACE_EVENTS_MAX  512
+#define TRACE_JSON_PATH   "bootloader/sys/boot_trace.json"
+
+enum
+{
+	TRACE_PH_BEGIN   = 'B',
+	TRACE_PH_END     = 'E',
+	TRACE_PH_INSTANT = 'i'
+};
+
+typedef struct _trace_event_t
+{
+	const char *name; // Must be a static string.
+	u32 ts;
+	u32 phase;
+} trace_event_t;
+
+typedef struct _trace_buf_t
+{
+	u32 magic;
+	u32 idx;   // Next event slot.
+	u32 count; // Valid events. Oldest ones get overwritten when full.
+	u32 rsvd;
+	trace_event_t events[TRACE_EVENTS_MAX];
+} trace_buf_t;
+
+/*
+ * Trace points compile to nothing if BDK_TRACE is not defined.
+ * Events are kept in a ring buffer in TRACE_BUF_ADDR and exported as a Chrome/Perfetto JSON trace.
+ */
+#ifdef BDK_TRACE
+#define TRACE_BEGIN(name)   trace_event(name, TRACE_PH_BEGIN)
+#define TRACE_END(name)     trace_event(name, TRACE_PH_END)
+#define TRACE_INSTANT(name) trace_event(name, TRACE_PH_INSTANT)
+#define TRACE_INIT()        trace_init()
+#define TRACE_DUMP()        trace_dump(TRACE_JSON_PATH)
+
+void trace_init();
+void trace_event(const char *name, u32 phase);
+int  trace_dump(const char *path);
+#else
+#define TRACE_BEGIN(name)
+#define TRACE_END(name)
+#define TRACE_INSTANT(name)
+#define TRACE_INIT()
+#define TRACE_DUMP()
+#endif
+
+#endif
@@ -87,10 +87,19 @@ typedef struct _nyx_info_t
 	u32 errors;
 } nyx_info_t;
 
+typedef struct _nyx_boot_time_t
+{
+	u32 display; // us.
+	u32 sd;      // us.
+	u32 emmc;    // us.
+	u32 total;   // us. Sum of the above if serial, wall time if overlapped.
+} nyx_boot_time_t;
+
 typedef struct _nyx_info_ex_t
 {
 	u32 magic;
 	u32 rsvd_flags;
+	nyx_boot_time_t boot_time;
 } nyx_info_ex_t;
 
 typedef struct _nyx_storage_t
@@ -103,6 +112,7 @@ typedef struct _nyx_storage_t
 	u8  rsvd1[SZ_8M - sizeof(nyx_info_ex_t) - sizeof(nyx_info_t)];
 	nyx_info_t info;
 	minerva_str_t minerva;
+	u8 tune_cache[0x30]; // sdmmc_tune_cache_t.
 } nyx_storage_t;
 
 #endif
@@ -361,6 +361,7 @@ bool render_ticker_logo(u32 boot_wait, u32 backlight)
 	free(grey);
 
 	// Enable backlight to show first frame.
+	display_init_finish();
 	display_backlight_brightness(backlight, 1000);
 
 	// Animated line as ticker.
@@ -398,6 +399,7 @@ bool render_ticker(u32 boot_wait, u32 backlight, bool no_ticker)
 	}
 
 	// Enable backlight to show first frame.
+	display_init_finish();
 	display_backlight_brightness(backlight, 1000);
 
 	// Animated line as ticker.
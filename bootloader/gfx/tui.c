@@ -86,6 +86,8 @@ void *tui_do_menu(menu_t *menu)
 {
 	int idx = 0, prev_idx = 0, cnt = 0x7FFFFFFF;
 
+	display_init_finish();
+
 	gfx_clear_partial_grey(0x1B, 0, 1256);
 	tui_sbar(true);
 
@@ -24,6 +24,7 @@
 
 #include "hos.h"
 #include "hos_config.h"
+#include "pkg2_cache.h"
 #include "secmon_exo.h"
 #include "../frontend/fe_tools.h"
 #include "../config.h"
@@ -708,6 +709,8 @@ void hos_launch(ini_sec_t *cfg)
 	launch_ctxt_t ctxt = {0};
 	tsec_ctxt_t tsec_ctxt = {0};
 
+	TRACE_BEGIN("hos_launch");
+
 	minerva_change_freq(FREQ_1600);
 	list_init(&ctxt.kip1_list);
 
@@ -720,7 +723,9 @@ void hos_launch(ini_sec_t *cfg)
 	gfx_puts("Initializing...\n\n");
 
 	// Initialize eMMC/emuMMC.
+	TRACE_BEGIN("hos_emmc_init");
 	int res = emummc_storage_init_mmc();
+	TRACE_END("hos_emmc_init");
 	if (res)
 	{
 		_hos_crit_error(res == 2 ? "Failed to init eMMC." : "Failed to init emuMMC.");
@@ -736,14 +741,20 @@ void hos_launch(ini_sec_t *cfg)
 	}
 
 	// Try to parse config if present.
-	if (hos_parse_boot_config(&ctxt))
+	TRACE_BEGIN("hos_config");
+	res = hos_parse_boot_config(&ctxt);
+	TRACE_END("hos_config");
+	if (res)
 	{
 		_hos_crit_error("Wrong ini cfg or missing/corrupt files!");
 		goto error;
 	}
 
 	// Read package1 and the correct eks.
-	if (_read_emmc_pkg1(&ctxt))
+	TRACE_BEGIN("pkg1_read");
+	res = _read_emmc_pkg1(&ctxt);
+	TRACE_END("pkg1_read");
+	if (res)
 	{
 		// Check if stock is enabled and device can boot in OFW.
 		if (ctxt.stock && (h_cfg.t210b01 || !tools_autorcm_enabled()))
@@ -823,11 +834,15 @@ void hos_launch(ini_sec_t *cfg)
 	tsec_ctxt.pkg11_off = ctxt.pkg1_id->pkg11_off;
 
 	// Generate keys.
-	if (_hos_keygen(ctxt.eks, mkey, &tsec_ctxt, ctxt.stock, is_exo))
+	TRACE_BEGIN("keygen");
+	res = _hos_keygen(ctxt.eks, mkey, &tsec_ctxt, ctxt.stock, is_exo);
+	TRACE_END("keygen");
+	if (res)
 		goto error;
 	gfx_puts("Generated keys\n");
 
 	// Decrypt and unpack package1 if we require parts of it.
+	TRACE_BEGIN("pkg1_unpack");
 	if (!ctxt.warmboot || !ctxt.secmon)
 	{
 		// Decrypt PK1 or PK11.
@@ -879,6 +894,7 @@ void hos_launch(ini_sec_t *cfg)
 		_hos_crit_error("\nFailed to match warmboot with fuses!\nIf you continue, sleep wont work!");
 
 		gfx_puts("\nPress POWER to continue.\nPress VOL to go to the menu.\n");
+		display_init_finish();
 		display_backlight_brightness(h_cfg.backlight, 1000);
 
 		if (!(btn_wait() & BTN_POWER))
@@ -907,9 +923,12 @@ void hos_launch(ini_sec_t *cfg)
 		pkg1_secmon_patch((void *)&ctxt, secmon_base, h_cfg.t210b01);
 
 	gfx_puts("Loaded warmboot and secmon\n");
+	TRACE_END("pkg1_unpack");
 
 	// Read package2.
+	TRACE_BEGIN("pkg2_read");
 	u8 *pkg2_nx_bc = _read_emmc_pkg2(&ctxt);
+	TRACE_END("pkg2_read");
 	if (!pkg2_nx_bc)
 	{
 		_hos_crit_error("Pkg2 read failed!");
@@ -918,7 +937,13 @@ void hos_launch(ini_sec_t *cfg)
 
 	gfx_puts("Read pkg2\n");
 
+	// Hash all package2 build inputs before they get modified.
+	u8 pkg2_digest[SE_SHA_256_SIZE];
+	if (ctxt.pkg2_cache)
+		pkg2_cache_digest(&ctxt, pkg2_digest);
+
 	// Decrypt package2 and parse KIP1 blobs in INI1 section.
+	TRACE_BEGIN("pkg2_patch");
 	pkg2_hdr_t *pkg2_hdr = pkg2_decrypt(ctxt.pkg2, mkey, is_exo);
 	if (!pkg2_hdr)
 	{
@@ -930,6 +955,14 @@ void hos_launch(ini_sec_t *cfg)
 	}
 
 	LIST_INIT(kip1_info);
+
+	// Use the cached rebuilt kernel and INI1 if inputs didn't change. Skips decompression and patching.
+	if (ctxt.pkg2_cache && !pkg2_cache_load(&ctxt, pkg2_digest, &kip1_info))
+	{
+		gfx_puts("Loaded cached pkg2\n");
+		goto pkg2_build;
+	}
+
 	if (pkg2_parse_kips(&kip1_info, pkg2_hdr, &ctxt.new_pkg2))
 	{
 		_hos_crit_error("INI1 parsing failed!");
@@ -1014,21 +1047,32 @@ void hos_launch(ini_sec_t *cfg)
 		if (!emu_patch_failed)
 		{
 			gfx_puts("\nPress POWER to continue.\nPress VOL to go to the menu.\n");
+			display_init_finish();
 			display_backlight_brightness(h_cfg.backlight, 1000);
 		}
 
 		if (emu_patch_failed || !(btn_wait() & BTN_POWER))
 			goto error; // MUST stop here, because if user requests 'nogc' but it's not applied, their GC controller gets updated!
 	}
+	else if (ctxt.pkg2_cache)
+		pkg2_cache_save(&ctxt, pkg2_digest, &kip1_info);
+
+pkg2_build:
+	TRACE_END("pkg2_patch");
 
 	// Rebuild and encrypt package2.
+	TRACE_BEGIN("pkg2_build");
 	pkg2_build_encrypt((void *)PKG2_LOAD_ADDR, &ctxt, &kip1_info, is_exo);
+	TRACE_END("pkg2_build");
 
 	// Configure Exosphere if secmon is replaced.
 	if (is_exo)
 		config_exosphere(&ctxt, warmboot_base);
 
+	TRACE_END("hos_launch");
+
 	// Unmount SD card and eMMC.
+	TRACE_DUMP();
 	sd_end();
 	emmc_end();
 
@@ -103,6 +103,7 @@ typedef struct _launch_ctxt_t
 	void *pkg2;
 	u32   pkg2_size;
 	bool  new_pkg2;
+	bool  pkg2_cache;
 
 	void *kernel;
 	u32   kernel_size;
@@ -201,6 +201,17 @@ static int _config_kernel_proc_id(launch_ctxt_t *ctxt, const char *value)
 	return 0;
 }
 
+static int _config_pkg2_cache(launch_ctxt_t *ctxt, const char *value)
+{
+	if (*value == '1')
+	{
+		DPRINTF("Enabled pkg2 cache\n");
+		ctxt->pkg2_cache = true;
+	}
+
+	return 0;
+}
+
 static int _config_dis_exo_user_exceptions(launch_ctxt_t *ctxt, const char *value)
 {
 	if (*value == '1')
@@ -317,6 +328,7 @@ static const cfg_handler_t _config_handlers[] = {
 	{ "fullsvcperm",      _config_svcperm },
 	{ "debugmode",        _config_debugmode },
 	{ "kernelprocid",     _config_kernel_proc_id },
+	{ "pkg2cache",        _config_pkg2_cache },
 
 	// To override elements from PKG3, it should be set before others.
 	{ "pkg3",             _config_pkg3 },
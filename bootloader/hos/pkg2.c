@@ -22,6 +22,7 @@
 #include "hos.h"
 #include "pkg2.h"
 #include "pkg2_ini_kippatch.h"
+#include "pkg2_patch_db.h"
 
 #include "../config.h"
 #include <libs/compr/blz.h>
@@ -47,6 +48,27 @@ u32 pkg2_newkern_ini1_rela;
 
 #include "pkg2_patches.inl"
 
+#define KIP_HASH_CACHE_MAGIC   0x3148494B // KIH1.
+#define KIP_HASH_CACHE_PATH    "bootloader/sys/kip_hash.bin"
+#define KIP_HASH_CACHE_ENTRIES 32
+
+typedef struct _kip_hash_cache_entry_t
+{
+	char name[12];
+	u32  size;
+	u32  hdr_crc32;
+	u8   hash[SE_SHA_256_SIZE];
+} kip_hash_cache_entry_t;
+
+typedef struct _kip_hash_cache_t
+{
+	u32 magic;
+	u32 entries_num;
+	u32 next_idx;
+	u32 crc32;
+	kip_hash_cache_entry_t entries[KIP_HASH_CACHE_ENTRIES];
+} kip_hash_cache_t;
+
 static kip1_id_t *_kip_id_sets = (kip1_id_t *)_kip_ids;
 static u32 _kip_id_sets_cnt = ARRAY_SIZE(_kip_ids);
 
@@ -56,6 +78,144 @@ void pkg2_get_ids(kip1_id_t **ids, u32 *entries)
 	*entries = _kip_id_sets_cnt;
 }
 
+static_assert(sizeof(kip1_id_t)       == sizeof(kip_patch_db_kip_t),      "Patch db kip size is wrong!");
+static_assert(sizeof(kip1_patchset_t) == sizeof(kip_patch_db_patchset_t), "Patch db patchset size is wrong!");
+static_assert(sizeof(kip1_patch_t)    == sizeof(kip_patch_db_patch_t),    "Patch db patch size is wrong!");
+
+static bool _kip_patch_db_reloc(u8 *db, u32 size, u32 *ofs, u32 len)
+{
+	if (!*ofs)
+		return true;
+
+	if (*ofs < sizeof(kip_patch_db_hdr_t) || *ofs > size || len > size - *ofs)
+		return false;
+
+	*ofs += (uptr)db;
+
+	return true;
+}
+
+static bool _kip_patch_db_reloc_str(u8 *db, u32 size, u32 *ofs)
+{
+	if (!*ofs || *ofs >= size || !memchr(db + *ofs, 0, size - *ofs))
+		return false;
+
+	return _kip_patch_db_reloc(db, size, ofs, 1);
+}
+
+static kip1_id_t *_kip_patch_db_load(u32 *kips_num)
+{
+	FILINFO fno;
+	u32 size;
+	u8 *db = sd_file_read(KIP_PATCH_DB_PATH, &size);
+	if (!db)
+		return NULL;
+
+	u8 *end = db + size;
+	kip_patch_db_hdr_t *hdr = (kip_patch_db_hdr_t *)db;
+	if (size < sizeof(kip_patch_db_hdr_t) || hdr->magic != KIP_PATCH_DB_MAGIC ||
+		hdr->version != KIP_PATCH_DB_VERSION || hdr->size != size)
+		goto failed;
+
+	// Check that it was compiled from the current patches.ini. Size and modification time are enough to catch user edits.
+	if (!f_stat(KIP_PATCH_INI_PATH, &fno) &&
+		(fno.fsize != hdr->ini_size || fno.fdate != hdr->ini_date || fno.ftime != hdr->ini_time))
+		goto failed;
+
+	if (hdr->crc32 != crc32_calc(0, db + sizeof(kip_patch_db_hdr_t), size - sizeof(kip_patch_db_hdr_t)))
+		goto failed;
+
+	// Relocate everything in place.
+	if (!hdr->kips_ofs || hdr->kips_num > size / sizeof(kip_patch_db_kip_t) ||
+		!_kip_patch_db_reloc(db, size, &hdr->kips_ofs, hdr->kips_num * sizeof(kip_patch_db_kip_t)))
+		goto failed;
+
+	kip_patch_db_kip_t *kips = (kip_patch_db_kip_t *)hdr->kips_ofs;
+	for (u32 i = 0; i < hdr->kips_num; i++)
+	{
+		if (!_kip_patch_db_reloc_str(db, size, &kips[i].name_ofs) || !kips[i].patchsets_ofs ||
+			!_kip_patch_db_reloc(db, size, &kips[i].patchsets_ofs, sizeof(kip_patch_db_patchset_t)))
+			goto failed;
+
+		for (kip_patch_db_patchset_t *ps = (kip_patch_db_patchset_t *)kips[i].patchsets_ofs; ps->name_ofs; ps++)
+		{
+			if ((u8 *)(ps + 2) > end ||
+				!_kip_patch_db_reloc_str(db, size, &ps->name_ofs) ||
+				!_kip_patch_db_reloc(db, size, &ps->patches_ofs, sizeof(kip_patch_db_patch_t)))
+				goto failed;
+
+			if (!ps->patches_ofs)
+				continue;
+
+			for (kip_patch_db_patch_t *pt = (kip_patch_db_patch_t *)ps->patches_ofs; pt->src_ofs; pt++)
+			{
+				if ((u8 *)(pt + 2) > end ||
+					!_kip_patch_db_reloc(db, size, &pt->src_ofs, pt->length) ||
+					!_kip_patch_db_reloc(db, size, &pt->dst_ofs, pt->length))
+					goto failed;
+			}
+		}
+	}
+
+	*kips_num = hdr->kips_num;
+
+	return (kip1_id_t *)kips;
+
+failed:
+	free(db);
+
+	return NULL;
+}
+
+static int _kip_patch_db_merge()
+{
+	u32 db_kips_num;
+	kip1_id_t *db_kips = _kip_patch_db_load(&db_kips_num);
+	if (!db_kips)
+		return 1;
+
+	// Copy ids into a new patchset.
+	_kip_id_sets = zalloc(sizeof(kip1_id_t) * (ARRAY_SIZE(_kip_ids) + db_kips_num));
+	memcpy(_kip_id_sets, _kip_ids, sizeof(_kip_ids));
+
+	for (u32 i = 0; i < db_kips_num; i++)
+	{
+		kip1_id_t *db_kip = &db_kips[i];
+		kip1_id_t *kip = NULL;
+
+		// Check if name and hash match a built-in id. The db has its own ids already merged.
+		for (u32 kip_idx = 0; kip_idx < ARRAY_SIZE(_kip_ids); kip_idx++)
+		{
+			if (!strcmp(_kip_id_sets[kip_idx].name, db_kip->name) && !memcmp(_kip_id_sets[kip_idx].hash, db_kip->hash, 8))
+			{
+				kip = &_kip_id_sets[kip_idx];
+				break;
+			}
+		}
+
+		// New id. Its patchsets are used in place.
+		if (!kip)
+		{
+			memcpy(&_kip_id_sets[_kip_id_sets_cnt++], db_kip, sizeof(kip1_id_t));
+			continue;
+		}
+
+		// Append db patchsets to the built-in ones.
+		u32 builtin_num = 0, db_num = 0;
+		while (kip->patchset[builtin_num].name)
+			builtin_num++;
+		while (db_kip->patchset[db_num].name)
+			db_num++;
+
+		kip1_patchset_t *patchsets = (kip1_patchset_t *)zalloc(sizeof(kip1_patchset_t) * (builtin_num + db_num + 1));
+		memcpy(patchsets, kip->patchset, sizeof(kip1_patchset_t) * builtin_num);
+		memcpy(&patchsets[builtin_num], db_kip->patchset, sizeof(kip1_patchset_t) * db_num);
+		kip->patchset = patchsets;
+	}
+
+	return 0;
+}
+
 static void parse_external_kip_patches()
 {
 	static bool ext_patches_parsed = false;
@@ -65,8 +225,12 @@ static void parse_external_kip_patches()
 
 	ext_patches_parsed = true;
 
+	// Use compiled patches if they are up to date.
+	if (!_kip_patch_db_merge())
+		return;
+
 	LIST_INIT(ini_kip_sections);
-	if (ini_patch_parse(&ini_kip_sections, "bootloader/patches.ini"))
+	if (ini_patch_parse(&ini_kip_sections, KIP_PATCH_INI_PATH))
 		return;
 
 	// Copy ids into a new patchset.
@@ -170,7 +334,7 @@ const pkg2_kernel_id_t *pkg2_identify(const u8 *hash)
 	return NULL;
 }
 
-static u32 _pkg2_calc_kip1_size(pkg2_kip1_t *kip1)
+u32 pkg2_calc_kip1_size(pkg2_kip1_t *kip1)
 {
 	u32 size = sizeof(pkg2_kip1_t);
 	for (u32 j = 0; j < KIP1_NUM_SECTIONS; j++)
@@ -243,21 +407,25 @@ int pkg2_parse_kips(link_t *info, pkg2_hdr_t *pkg2, bool *new_pkg2)
 	else
 		ptr = pkg2->data + pkg2->sec_size[PKG2_SEC_KERNEL];
 
-	pkg2_ini1_t *ini1 = (pkg2_ini1_t *)ptr;
-	ptr += sizeof(pkg2_ini1_t);
+	pkg2_parse_ini1(info, (pkg2_ini1_t *)ptr);
+
+	return 0;
+}
+
+void pkg2_parse_ini1(link_t *info, pkg2_ini1_t *ini1)
+{
+	u8 *ptr = (u8 *)ini1 + sizeof(pkg2_ini1_t);
 
 	for (u32 i = 0; i < ini1->num_procs; i++)
 	{
 		pkg2_kip1_t *kip1 = (pkg2_kip1_t *)ptr;
 		pkg2_kip1_info_t *ki = (pkg2_kip1_info_t *)malloc(sizeof(pkg2_kip1_info_t));
 		ki->kip1 = kip1;
-		ki->size = _pkg2_calc_kip1_size(kip1);
+		ki->size = pkg2_calc_kip1_size(kip1);
 		list_append(info, &ki->link);
 		ptr += ki->size;
 DPRINTF(" kip1 %d:%s @ %08X (%08X)\n", i, kip1->name, (u32)kip1, ki->size);
 	}
-
-	return 0;
 }
 
 bool pkg2_has_kip(link_t *info, u64 tid)
@@ -275,7 +443,7 @@ void pkg2_replace_kip(link_t *info, u64 tid, pkg2_kip1_t *kip1)
 		if (ki->kip1->tid == tid)
 		{
 			ki->kip1 = kip1;
-			ki->size = _pkg2_calc_kip1_size(kip1);
+			ki->size = pkg2_calc_kip1_size(kip1);
 DPRINTF("replaced kip %s (new size %08X)\n", kip1->name, ki->size);
 			return;
 		}
@@ -286,7 +454,7 @@ void pkg2_add_kip(link_t *info, pkg2_kip1_t *kip1)
 {
 	pkg2_kip1_info_t *ki = (pkg2_kip1_info_t *)malloc(sizeof(pkg2_kip1_info_t));
 	ki->kip1 = kip1;
-	ki->size = _pkg2_calc_kip1_size(kip1);
+	ki->size = pkg2_calc_kip1_size(kip1);
 DPRINTF("added kip %s (size %08X)\n", kip1->name, ki->size);
 	list_append(info, &ki->link);
 }
@@ -430,9 +598,246 @@ static int _kipm_inject(const char *kipm_path, char *target_name, pkg2_kip1_info
 	return 0;
 }
 
+static bool _pkg2_kip_patches_enabled(const kip1_patchset_t *patchset, char **patches, u32 patches_num)
+{
+	while (patchset != NULL && patchset->name != NULL)
+	{
+		for (u32 i = 0; i < patches_num; i++)
+		{
+			// Continue if patch name does not match.
+			if (strcmp(patchset->name, patches[i]) != 0)
+				continue;
+
+			return true;
+		}
+		patchset++;
+	}
+
+	return false;
+}
+
+static kip_hash_cache_t *_kip_hash_cache_load()
+{
+	u32 size = 0;
+	kip_hash_cache_t *cache = (kip_hash_cache_t *)sd_file_read(KIP_HASH_CACHE_PATH, &size);
+
+	// Start with an empty one if missing or invalid.
+	if (!cache || size != sizeof(kip_hash_cache_t) || cache->magic != KIP_HASH_CACHE_MAGIC ||
+		cache->entries_num > KIP_HASH_CACHE_ENTRIES || cache->next_idx >= KIP_HASH_CACHE_ENTRIES ||
+		cache->crc32 != crc32_calc(0, (u8 *)cache->entries, sizeof(cache->entries)))
+	{
+		free(cache);
+		cache = (kip_hash_cache_t *)zalloc(sizeof(kip_hash_cache_t));
+		cache->magic = KIP_HASH_CACHE_MAGIC;
+	}
+
+	return cache;
+}
+
+static kip_hash_cache_entry_t *_kip_hash_cache_find(kip_hash_cache_t *cache, pkg2_kip1_info_t *ki, u32 hdr_crc32)
+{
+	for (u32 i = 0; i < cache->entries_num; i++)
+	{
+		kip_hash_cache_entry_t *entry = &cache->entries[i];
+		if (entry->size == ki->size && entry->hdr_crc32 == hdr_crc32 &&
+			!memcmp(entry->name, ki->kip1->name, sizeof(entry->name)))
+			return entry;
+	}
+
+	return NULL;
+}
+
+static void _kip_hash_cache_add(kip_hash_cache_t *cache, pkg2_kip1_info_t *ki, u32 hdr_crc32)
+{
+	// Replace oldest entry when full.
+	u32 idx = cache->entries_num;
+	if (idx < KIP_HASH_CACHE_ENTRIES)
+		cache->entries_num++;
+	else
+	{
+		idx = cache->next_idx;
+		cache->next_idx = (cache->next_idx + 1) % KIP_HASH_CACHE_ENTRIES;
+	}
+
+	kip_hash_cache_entry_t *entry = &cache->entries[idx];
+	memcpy(entry->name, ki->kip1->name, sizeof(entry->name));
+	entry->size      = ki->size;
+	entry->hdr_crc32 = hdr_crc32;
+	memcpy(entry->hash, ki->hash, sizeof(entry->hash));
+}
+
+static void _pkg2_kips_hash(link_t *info, char **patches, u32 patches_num, bool emummc_patch_selected)
+{
+	u32 jobs_num = 0;
+	LIST_FOREACH_ENTRY(pkg2_kip1_info_t, ki, info, link)
+		jobs_num++;
+
+	se_sha_job_t *jobs = (se_sha_job_t *)malloc(sizeof(se_sha_job_t) * jobs_num);
+	u32 *hdr_crcs = (u32 *)malloc(sizeof(u32) * jobs_num);
+	pkg2_kip1_info_t **job_kips = (pkg2_kip1_info_t **)malloc(sizeof(pkg2_kip1_info_t *) * jobs_num);
+
+	kip_hash_cache_t *cache = _kip_hash_cache_load();
+
+	// Queue only KIPs that have patches enabled and are not in the hash cache.
+	jobs_num = 0;
+	LIST_FOREACH_ENTRY(pkg2_kip1_info_t, ki, info, link)
+	{
+		memset(ki->hash, 0, sizeof(ki->hash));
+
+		bool emummc_patch_apply = emummc_patch_selected && !strcmp((char *)ki->kip1->name, "FS");
+
+		for (u32 kip_id_idx = 0; kip_id_idx < _kip_id_sets_cnt; kip_id_idx++)
+		{
+			if (strcmp((char *)ki->kip1->name, _kip_id_sets[kip_id_idx].name) != 0)
+				continue;
+
+			if (emummc_patch_apply || _pkg2_kip_patches_enabled(_kip_id_sets[kip_id_idx].patchset, patches, patches_num))
+			{
+				// Header has all section sizes and attributes, so it identifies a KIP along with its size.
+				u32 hdr_crc32 = crc32_calc(0, (u8 *)ki->kip1, sizeof(pkg2_kip1_t));
+				kip_hash_cache_entry_t *entry = _kip_hash_cache_find(cache, ki, hdr_crc32);
+				if (entry)
+				{
+					memcpy(ki->hash, entry->hash, sizeof(ki->hash));
+					break;
+				}
+
+				hdr_crcs[jobs_num] = hdr_crc32;
+				job_kips[jobs_num] = ki;
+				jobs[jobs_num].hash = ki->hash;
+				jobs[jobs_num].src  = ki->kip1;
+				jobs[jobs_num].size = ki->size;
+				jobs_num++;
+				break;
+			}
+		}
+	}
+
+	if (jobs_num)
+	{
+		// Failed hashes are zeroed and mark the whole batch as not cacheable.
+		if (!se_sha_hash_256_batch(jobs, jobs_num))
+		{
+			for (u32 i = 0; i < jobs_num; i++)
+				_kip_hash_cache_add(cache, job_kips[i], hdr_crcs[i]);
+
+			cache->crc32 = crc32_calc(0, (u8 *)cache->entries, sizeof(cache->entries));
+			sd_save_to_file(cache, sizeof(kip_hash_cache_t), KIP_HASH_CACHE_PATH);
+		}
+	}
+
+	free(cache);
+	free(job_kips);
+	free(hdr_crcs);
+	free(jobs);
+}
+
+static const char *_pkg2_kips_sig_patch(link_t *info, char **patches, u32 patches_num, u32 *patches_applied, pkg2_kip1_info_t *emummc_ki)
+{
+	static bool sig_patches_parsed = false;
+	LIST_INIT_STATIC(sig_patches);
+
+	u32 patches_pending = 0;
+	for (u32 i = 0; i < patches_num; i++)
+	{
+		if (!(*patches_applied & BIT(i)))
+			patches_pending |= BIT(i);
+	}
+
+	if (!patches_pending)
+		return NULL;
+
+	if (!sig_patches_parsed)
+	{
+		sig_patches_parsed = true;
+		ini_sig_patch_parse(&sig_patches, "bootloader/patches_sig.ini");
+	}
+
+	u32 sigs_max = 0;
+	LIST_FOREACH_ENTRY(ini_sig_patch_t, sp, &sig_patches, link)
+		sigs_max++;
+
+	if (!sigs_max)
+		return NULL;
+
+	kip_sig_t **sigs = (kip_sig_t **)malloc(sizeof(kip_sig_t *) * sigs_max);
+	u32 *sigs_patch_idx = (u32 *)malloc(sizeof(u32) * sigs_max);
+	const char *failed_patch = NULL;
+
+	LIST_FOREACH_ENTRY(pkg2_kip1_info_t, ki, info, link)
+	{
+		// emuMMC code is already injected in TEXT.
+		if (ki == emummc_ki)
+			continue;
+
+		// Gather all requested signatures for this KIP, so they cost one scan.
+		u32 sigs_num = 0;
+		LIST_FOREACH_ENTRY(ini_sig_patch_t, sp, &sig_patches, link)
+		{
+			if (strcmp((char *)ki->kip1->name, sp->sig.kip))
+				continue;
+
+			for (u32 i = 0; i < patches_num; i++)
+			{
+				if ((patches_pending & BIT(i)) && !strcmp(sp->sig.name, patches[i]))
+				{
+					sigs_patch_idx[sigs_num] = i;
+					sigs[sigs_num++] = &sp->sig;
+					break;
+				}
+			}
+		}
+
+		if (!sigs_num)
+			continue;
+
+		if (_decompress_kip(ki, BIT(KIP_TEXT)))
+		{
+			failed_patch = (char *)ki->kip1->name; // Failed to decompress.
+			break;
+		}
+
+		kip_sig_ac_t *ac = kip_sig_compile(sigs, sigs_num);
+		if (!ac)
+		{
+			failed_patch = sigs[0]->name;
+			break;
+		}
+
+		u8 *kip_text = ki->kip1->data;
+		u32 text_size = ki->kip1->sections[KIP_TEXT].size_comp;
+		kip_sig_scan(ac, kip_text, text_size);
+		kip_sig_free(ac);
+
+		for (u32 i = 0; i < sigs_num; i++)
+		{
+			gfx_printf("Applying '%s' on %s by signature\n", sigs[i]->name, (char *)ki->kip1->name);
+			if (kip_sig_apply(sigs[i], kip_text, text_size))
+			{
+				gfx_con.mute = false;
+				gfx_printf("%kSignature %s (%d matches)!%k\n", TXT_CLR_ERROR,
+					sigs[i]->matches ? "ambiguous" : "not found", sigs[i]->matches, TXT_CLR_DEFAULT);
+				failed_patch = sigs[i]->name; // MUST stop here as KIP is likely not the expected one.
+				break;
+			}
+
+			*patches_applied |= BIT(sigs_patch_idx[i]);
+		}
+
+		if (failed_patch)
+			break;
+	}
+
+	free(sigs_patch_idx);
+	free(sigs);
+
+	return failed_patch;
+}
+
 const char *pkg2_patch_kips(link_t *info, char *patch_names)
 {
 	bool emummc_patch_selected = false;
+	pkg2_kip1_info_t *emummc_ki = NULL;
 
 	if (patch_names == NULL || patch_names[0] == 0)
 		return NULL;
@@ -504,12 +909,11 @@ const char *pkg2_patch_kips(link_t *info, char *patch_names)
 			parse_external_kip_patches();
 	}
 
-	u32 kip_hash[SE_SHA_256_SIZE / sizeof(u32)];
+	// Hash all KIPs that need patching in one go.
+	_pkg2_kips_hash(info, patches, patches_num, emummc_patch_selected);
+
 	LIST_FOREACH_ENTRY(pkg2_kip1_info_t, ki, info, link)
 	{
-		// Reset hash so it can be calculated for the new kip.
-		kip_hash[0] = 0;
-
 		bool emummc_patch_apply = emummc_patch_selected && !strcmp((char *)ki->kip1->name, "FS");
 
 		// Check all SHA256 ID sets. (IDs are grouped per KIP. IDs are still unique.)
@@ -520,38 +924,19 @@ const char *pkg2_patch_kips(link_t *info, char *patch_names)
 				continue;
 
 			// Check if there are patches to apply.
-			bool patches_found = false;
-			const kip1_patchset_t *patchset = _kip_id_sets[kip_id_idx].patchset;
-			while (patchset != NULL && patchset->name != NULL && !patches_found)
-			{
-				for (u32 i = 0; i < patches_num; i++)
-				{
-					// Continue if patch name does not match.
-					if (strcmp(patchset->name, patches[i]) != 0)
-						continue;
-
-					patches_found = true;
-					break;
-				}
-				patchset++;
-			}
+			bool patches_found = _pkg2_kip_patches_enabled(_kip_id_sets[kip_id_idx].patchset, patches, patches_num);
 
-			// Don't bother hashing this KIP if no patches are enabled for it.
+			// This KIP was not hashed if no patches are enabled for it.
 			if (!patches_found && !emummc_patch_apply)
 				continue;
 
-			// Check if current KIP not hashed and hash it.
-			if (kip_hash[0] == 0)
-				if (se_sha_hash_256_oneshot(kip_hash, ki->kip1, ki->size))
-					memset(kip_hash, 0, sizeof(kip_hash));
-
 			// Check if kip is the expected version.
-			if (memcmp(kip_hash, _kip_id_sets[kip_id_idx].hash, sizeof(_kip_id_sets[0].hash)) != 0)
+			if (memcmp(ki->hash, _kip_id_sets[kip_id_idx].hash, sizeof(_kip_id_sets[0].hash)) != 0)
 				continue;
 
 			// Find out which sections are affected by the enabled patches, in order to decompress them.
 			u32 sections_affected = 0;
-			patchset = _kip_id_sets[kip_id_idx].patchset;
+			const kip1_patchset_t *patchset = _kip_id_sets[kip_id_idx].patchset;
 			while (patchset != NULL && patchset->name != NULL)
 			{
 				if (patchset->patches != NULL)
@@ -658,6 +1043,7 @@ const char *pkg2_patch_kips(link_t *info, char *patch_names)
 				gfx_printf("Injecting emuMMC. FS ID: %d\n", emu_cfg.fs_ver);
 				if (_kipm_inject("bootloader/sys/emummc.kipm", "FS", ki))
 					return "emummc";
+				emummc_ki = ki;
 
 				// Skip checking again.
 				emummc_patch_selected = false;
@@ -666,6 +1052,11 @@ const char *pkg2_patch_kips(link_t *info, char *patch_names)
 		}
 	}
 
+	// Patches that no KIP ID provided can still be applied by signature.
+	const char *failed_patch = _pkg2_kips_sig_patch(info, patches, patches_num, &patches_applied, emummc_ki);
+	if (failed_patch)
+		return failed_patch;
+
 	// Check if all patches were applied.
 	for (u32 i = 0; i < patches_num; i++)
 	{
@@ -774,6 +1165,9 @@ DPRINTF("adding kip1 '%s' @ %08X (%08X)\n", (char *)ki->kip1->name, (u32)ki->kip
 	{
 		hdr->sec_size[PKG2_SEC_INI1] = ini1_size;
 		hdr->sec_off[PKG2_SEC_INI1] = 0x14080000;
+
+		// Wait for kernel encryption that was running while INI1 was merged.
+		se_aes_finalize();
 		se_aes_crypt_ctr(8, ini1, ini1, ini1_size, hdr->sec_ctr[PKG2_SEC_INI1]);
 	}
 	else
@@ -852,25 +1246,31 @@ DPRINTF("%s @ %08X (%08X)\n", is_meso ? "Mesosphere": "kernel",(u32)ctxt->kernel
 		kernel_size += ini1_size;
 	}
 	hdr->sec_size[PKG2_SEC_KERNEL] = kernel_size;
-	se_aes_crypt_ctr(pkg2_keyslot, pdst, pdst, kernel_size, hdr->sec_ctr[PKG2_SEC_KERNEL]);
+
+	// Encrypt kernel in the background. Old Package2 INI1 gets merged meanwhile.
+	se_aes_crypt_ctr_async(pkg2_keyslot, pdst, pdst, kernel_size, hdr->sec_ctr[PKG2_SEC_KERNEL]);
 	pdst += kernel_size;
-DPRINTF("kernel encrypted\n");
 
 	// Build INI1 for old Package2.
 	u32 ini1_size = 0;
 	if (!ctxt->new_pkg2)
 		ini1_size = _pkg2_ini1_build(pdst, NULL, hdr, kips_info, false);
-DPRINTF("INI1 encrypted\n");
+	se_aes_finalize();
+DPRINTF("kernel and INI1 encrypted\n");
 
 	if (!is_exo) // Not needed on Exosphere 1.0.0 and up.
 	{
 		// Calculate SHA256 over encrypted sections. Only 3 have valid hashes.
+		se_sha_job_t jobs[PKG2_SEC_UNUSED + 1];
 		u8 *pk2_hash_data = (u8 *)dst + 0x100 + sizeof(pkg2_hdr_t);
 		for (u32 i = PKG2_SEC_KERNEL; i <= PKG2_SEC_UNUSED; i++)
 		{
-			se_sha_hash_256_oneshot(hdr->sec_sha256[i], (void *)pk2_hash_data, hdr->sec_size[i]);
+			jobs[i].hash = hdr->sec_sha256[i];
+			jobs[i].src  = pk2_hash_data;
+			jobs[i].size = hdr->sec_size[i];
 			pk2_hash_data += hdr->sec_size[i];
 		}
+		se_sha_hash_256_batch(jobs, PKG2_SEC_UNUSED + 1);
 	}
 
 	// Encrypt header.
@@ -40,6 +40,7 @@
 extern u32 pkg2_newkern_ini1_info;
 extern u32 pkg2_newkern_ini1_start;
 extern u32 pkg2_newkern_ini1_end;
+extern u32 pkg2_newkern_ini1_rela;
 
 typedef struct _kernel_patch_t
 {
@@ -131,6 +132,7 @@ typedef struct _pkg2_kip1_info_t
 {
 	pkg2_kip1_t *kip1;
 	u32 size;
+	u32 hash[SE_SHA_256_SIZE / sizeof(u32)];
 	link_t link;
 } pkg2_kip1_info_t;
 
@@ -208,7 +210,9 @@ typedef struct _nx_bc_t {
 	u8  padding2[0xC0];
 } nx_bc_t;
 
+u32  pkg2_calc_kip1_size(pkg2_kip1_t *kip1);
 int  pkg2_parse_kips(link_t *info, pkg2_hdr_t *pkg2, bool *new_pkg2);
+void pkg2_parse_ini1(link_t *info, pkg2_ini1_t *ini1);
 bool pkg2_has_kip(link_t *info, u64 tid);
 void pkg2_replace_kip(link_t *info, u64 tid, pkg2_kip1_t *kip1);
 void pkg2_add_kip(link_t *info, pkg2_kip1_t *kip1);
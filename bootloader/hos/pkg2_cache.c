@@ -0,0 +1,293 @@
+/*
+ * Package2 rebuild cache
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <bdk.h>
+
+#include "hos.h"
+#include "pkg2.h"
+#include "pkg2_cache.h"
+#include "../config.h"
+#include "../storage/emummc.h"
+#include <libs/fatfs/ff.h>
+
+//#define DPRINTF(...) gfx_printf(__VA_ARGS__)
+#define DPRINTF(...)
+
+#define PKG2_CACHE_FLAG_STOCK       BIT(0)
+#define PKG2_CACHE_FLAG_SVCPERM     BIT(1)
+#define PKG2_CACHE_FLAG_DEBUGMODE   BIT(2)
+#define PKG2_CACHE_FLAG_KRN_PROC_ID BIT(3)
+#define PKG2_CACHE_FLAG_SECMON      BIT(4)
+#define PKG2_CACHE_FLAG_T210B01     BIT(5)
+
+typedef struct _pkg2_cache_file_id_t
+{
+	u32 size;
+	u16 date;
+	u16 time;
+} pkg2_cache_file_id_t;
+
+// Everything besides the hashed buffers that affects the rebuilt kernel and INI1.
+typedef struct _pkg2_cache_key_t
+{
+	u32 cache_version;
+	u32 bl_version;
+	u32 pkg2_size;
+	u32 pkg3_hosver;
+	u32 fs_type;
+	u32 flags;
+	u32 kips_num;
+	pkg2_cache_file_id_t patches_ini;
+	pkg2_cache_file_id_t patches_sig_ini;
+	pkg2_cache_file_id_t patches_bin;
+	pkg2_cache_file_id_t emummc_kipm;
+} pkg2_cache_key_t;
+
+enum
+{
+	PKG2_CACHE_JOB_PKG2    = 0,
+	PKG2_CACHE_JOB_KERNEL  = 1,
+	PKG2_CACHE_JOB_PATCHES = 2,
+	PKG2_CACHE_JOB_KIPS    = 3
+};
+
+static void _pkg2_cache_file_id(const char *path, pkg2_cache_file_id_t *id)
+{
+	FILINFO fno;
+
+	// Size and modification time are enough to catch user edits.
+	if (f_stat(path, &fno))
+		memset(id, 0, sizeof(pkg2_cache_file_id_t));
+	else
+	{
+		id->size = fno.fsize;
+		id->date = fno.fdate;
+		id->time = fno.ftime;
+	}
+}
+
+/*
+ * Must be called before package2 gets decrypted and before kip patch names get parsed,
+ * since both are modified in place.
+ */
+void pkg2_cache_digest(launch_ctxt_t *ctxt, u8 *digest)
+{
+	u32 kips_num = 0;
+	LIST_FOREACH_ENTRY(merge_kip_t, mki, &ctxt->kip1_list, link)
+		kips_num++;
+
+	u32 jobs_num = PKG2_CACHE_JOB_KIPS + kips_num;
+	u32 key_size = sizeof(pkg2_cache_key_t) + jobs_num * SE_SHA_256_SIZE;
+	pkg2_cache_key_t *key = (pkg2_cache_key_t *)zalloc(key_size);
+	u8 *hashes = (u8 *)key + sizeof(pkg2_cache_key_t);
+	se_sha_job_t *jobs = (se_sha_job_t *)zalloc(sizeof(se_sha_job_t) * jobs_num);
+
+	key->cache_version = PKG2_CACHE_VERSION;
+	key->bl_version    = (BL_VER_MJ << 24) | (BL_VER_MN << 16) | (BL_VER_HF << 8) | BL_VER_RL;
+	key->pkg2_size     = ctxt->pkg2_size;
+	key->pkg3_hosver   = ctxt->pkg3_hosver;
+	key->fs_type       = sd_fs.fs_type;
+	key->kips_num      = kips_num;
+
+	if (ctxt->stock)
+		key->flags |= PKG2_CACHE_FLAG_STOCK;
+	if (ctxt->svcperm)
+		key->flags |= PKG2_CACHE_FLAG_SVCPERM;
+	if (ctxt->debugmode)
+		key->flags |= PKG2_CACHE_FLAG_DEBUGMODE;
+	if (ctxt->patch_krn_proc_id)
+		key->flags |= PKG2_CACHE_FLAG_KRN_PROC_ID;
+	if (ctxt->secmon)
+		key->flags |= PKG2_CACHE_FLAG_SECMON;
+	if (h_cfg.t210b01)
+		key->flags |= PKG2_CACHE_FLAG_T210B01;
+
+	_pkg2_cache_file_id("bootloader/patches.ini", &key->patches_ini);
+	_pkg2_cache_file_id("bootloader/patches_sig.ini", &key->patches_sig_ini);
+	_pkg2_cache_file_id("bootloader/patches.bin", &key->patches_bin);
+	_pkg2_cache_file_id("bootloader/sys/emummc.kipm", &key->emummc_kipm);
+
+	// Hash all input buffers in one go. Missing ones get the null string hash.
+	for (u32 i = 0; i < jobs_num; i++)
+		jobs[i].hash = hashes + i * SE_SHA_256_SIZE;
+
+	jobs[PKG2_CACHE_JOB_PKG2].src  = ctxt->pkg2;
+	jobs[PKG2_CACHE_JOB_PKG2].size = ctxt->pkg2_size;
+
+	if (ctxt->kernel)
+	{
+		jobs[PKG2_CACHE_JOB_KERNEL].src  = ctxt->kernel;
+		jobs[PKG2_CACHE_JOB_KERNEL].size = ctxt->kernel_size;
+	}
+
+	if (ctxt->kip1_patches)
+	{
+		jobs[PKG2_CACHE_JOB_PATCHES].src  = ctxt->kip1_patches;
+		jobs[PKG2_CACHE_JOB_PATCHES].size = strlen(ctxt->kip1_patches);
+	}
+
+	u32 kip_idx = PKG2_CACHE_JOB_KIPS;
+	LIST_FOREACH_ENTRY(merge_kip_t, mki, &ctxt->kip1_list, link)
+	{
+		jobs[kip_idx].src  = mki->kip1;
+		jobs[kip_idx].size = pkg2_calc_kip1_size((pkg2_kip1_t *)mki->kip1);
+		kip_idx++;
+	}
+
+	// A failed hash is zeroed and can only cause a cache miss.
+	se_sha_hash_256_batch(jobs, jobs_num);
+	se_sha_hash_256_oneshot(digest, key, key_size);
+
+	free(jobs);
+	free(key);
+}
+
+int pkg2_cache_load(launch_ctxt_t *ctxt, const u8 *digest, link_t *kips_info)
+{
+	FIL fp;
+	pkg2_cache_hdr_t hdr;
+
+	if (f_open(&fp, PKG2_CACHE_PATH, FA_READ) != FR_OK)
+		return 1;
+
+	// Check that cache is valid and built from the same inputs.
+	if (f_read(&fp, &hdr, sizeof(pkg2_cache_hdr_t), NULL) != FR_OK ||
+		hdr.magic != PKG2_CACHE_MAGIC || hdr.version != PKG2_CACHE_VERSION ||
+		memcmp(hdr.digest, digest, SE_SHA_256_SIZE) ||
+		f_size(&fp) != sizeof(pkg2_cache_hdr_t) + hdr.kernel_size + hdr.ini1_size)
+	{
+		f_close(&fp);
+		DPRINTF("pkg2 cache miss\n");
+
+		return 1;
+	}
+
+	// Read kernel and INI1 in one go.
+	u8 *data = malloc(hdr.kernel_size + hdr.ini1_size);
+	if (f_read(&fp, data, hdr.kernel_size + hdr.ini1_size, NULL) != FR_OK)
+	{
+		f_close(&fp);
+		free(data);
+
+		return 1;
+	}
+	f_close(&fp);
+
+	// Verify contents.
+	u8 kernel_hash[SE_SHA_256_SIZE];
+	u8 ini1_hash[SE_SHA_256_SIZE];
+	se_sha_job_t jobs[2] = {
+		{ kernel_hash, data, hdr.kernel_size },
+		{ ini1_hash, data + hdr.kernel_size, hdr.ini1_size }
+	};
+	pkg2_ini1_t *ini1 = (pkg2_ini1_t *)(data + hdr.kernel_size);
+	if (se_sha_hash_256_batch(jobs, 2) ||
+		memcmp(kernel_hash, hdr.kernel_hash, SE_SHA_256_SIZE) ||
+		memcmp(ini1_hash, hdr.ini1_hash, SE_SHA_256_SIZE) ||
+		ini1->magic != INI1_MAGIC)
+	{
+		free(data);
+		DPRINTF("pkg2 cache corrupt\n");
+
+		return 1;
+	}
+
+	// Restore state that was set while patching.
+	ctxt->kernel      = data;
+	ctxt->kernel_size = hdr.kernel_size;
+	ctxt->new_pkg2    = hdr.new_pkg2;
+	ctxt->exo_ctx.hos_revision = hdr.hos_revision;
+	emu_cfg.fs_ver = hdr.emummc_fs_ver;
+
+	pkg2_newkern_ini1_info  = hdr.newkern_ini1_info;
+	pkg2_newkern_ini1_start = hdr.newkern_ini1_start;
+	pkg2_newkern_ini1_end   = hdr.newkern_ini1_end;
+	pkg2_newkern_ini1_rela  = hdr.newkern_ini1_rela;
+
+	pkg2_parse_ini1(kips_info, ini1);
+
+	return 0;
+}
+
+void pkg2_cache_save(launch_ctxt_t *ctxt, const u8 *digest, link_t *kips_info)
+{
+	FIL fp;
+	pkg2_cache_hdr_t hdr = {0};
+
+	// Merge KIPs into an INI1.
+	u32 kips_num = 0;
+	u32 ini1_size = sizeof(pkg2_ini1_t);
+	LIST_FOREACH_ENTRY(pkg2_kip1_info_t, ki, kips_info, link)
+	{
+		ini1_size += ki->size;
+		kips_num++;
+	}
+
+	pkg2_ini1_t *ini1 = (pkg2_ini1_t *)zalloc(ini1_size);
+	ini1->magic     = INI1_MAGIC;
+	ini1->size      = ini1_size;
+	ini1->num_procs = kips_num;
+
+	u8 *pdst = (u8 *)ini1 + sizeof(pkg2_ini1_t);
+	LIST_FOREACH_ENTRY(pkg2_kip1_info_t, ki, kips_info, link)
+	{
+		memcpy(pdst, ki->kip1, ki->size);
+		pdst += ki->size;
+	}
+
+	hdr.magic       = PKG2_CACHE_MAGIC;
+	hdr.version     = PKG2_CACHE_VERSION;
+	hdr.kernel_size = ctxt->kernel_size;
+	hdr.ini1_size   = ini1_size;
+	hdr.new_pkg2    = ctxt->new_pkg2;
+	hdr.hos_revision  = ctxt->exo_ctx.hos_revision;
+	hdr.emummc_fs_ver = emu_cfg.fs_ver;
+	memcpy(hdr.digest, digest, SE_SHA_256_SIZE);
+
+	hdr.newkern_ini1_info  = pkg2_newkern_ini1_info;
+	hdr.newkern_ini1_start = pkg2_newkern_ini1_start;
+	hdr.newkern_ini1_end   = pkg2_newkern_ini1_end;
+	hdr.newkern_ini1_rela  = pkg2_newkern_ini1_rela;
+
+	se_sha_job_t jobs[2] = {
+		{ hdr.kernel_hash, ctxt->kernel, ctxt->kernel_size },
+		{ hdr.ini1_hash, ini1, ini1_size }
+	};
+	if (se_sha_hash_256_batch(jobs, 2))
+		goto out;
+
+	if (f_open(&fp, PKG2_CACHE_PATH, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+		goto out;
+
+	// Remove partial cache on failure, so it doesn't get parsed again.
+	if (f_write(&fp, &hdr, sizeof(pkg2_cache_hdr_t), NULL) != FR_OK ||
+		f_write(&fp, ctxt->kernel, ctxt->kernel_size, NULL) != FR_OK ||
+		f_write(&fp, ini1, ini1_size, NULL) != FR_OK)
+	{
+		f_close(&fp);
+		f_unlink(PKG2_CACHE_PATH);
+		goto out;
+	}
+	f_close(&fp);
+DPRINTF("pkg2 cache saved (%08X)\n", sizeof(pkg2_cache_hdr_t) + ctxt->kernel_size + ini1_size);
+
+out:
+	free(ini1);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PKG2_CACHE_H_
+#define _PKG2_CACHE_H_
+
+#include <bdk.h>
+
+#include "hos.h"
+
+#define PKG2_CACHE_MAGIC   0x43324B50 // PK2C.
+#define PKG2_CACHE_VERSION 1
+#define PKG2_CACHE_PATH    "bootloader/sys/pkg2_cache.bin"
+
+typedef struct _pkg2_cache_hdr_t
+{
+	u32 magic;
+	u32 version;
+	u8  digest[SE_SHA_256_SIZE];      // Digest of all package2 build inputs.
+	u8  kernel_hash[SE_SHA_256_SIZE];
+	u8  ini1_hash[SE_SHA_256_SIZE];
+	u32 kernel_size;
+	u32 ini1_size;
+	u32 new_pkg2;
+	u32 newkern_ini1_info;
+	u32 newkern_ini1_start;
+	u32 newkern_ini1_end;
+	u32 newkern_ini1_rela;
+	u32 emummc_fs_ver;
+	u32 hos_revision;
+	u32 rsvd[29];
+} pkg2_cache_hdr_t;
+
+static_assert(sizeof(pkg2_cache_hdr_t) == 0x100, "Pkg2 cache header size is wrong!");
+
+void pkg2_cache_digest(launch_ctxt_t *ctxt, u8 *digest);
+int  pkg2_cache_load(launch_ctxt_t *ctxt, const u8 *digest, link_t *kips_info);
+void pkg2_cache_save(launch_ctxt_t *ctxt, const u8 *digest, link_t *kips_info);
+
+#endif
@@ -178,3 +178,84 @@ int ini_patch_parse(link_t *dst, const char *ini_path)
 
 	return 0;
 }
+
+int ini_sig_patch_parse(link_t *dst, const char *ini_path)
+{
+	FIL fp;
+	u32 lblen;
+	char *lbuf;
+	char *kip_name = NULL;
+
+	// Open ini.
+	if (f_open(&fp, ini_path, FA_READ) != FR_OK)
+		return 1;
+
+	lbuf = malloc(512);
+
+	do
+	{
+		// Fetch one line.
+		lbuf[0] = 0;
+		f_gets(lbuf, 512, &fp);
+		lblen = strlen(lbuf);
+
+		// Remove trailing newline. Depends on 'FF_USE_STRFUNC 2' that removes \r.
+		if (lblen && lbuf[lblen - 1] == '\n')
+			lbuf[lblen - 1] = 0;
+
+		if (lblen > 2 && lbuf[0] == '[') // Set kip name.
+		{
+			_find_patch_section_name(lbuf, lblen, ']');
+			kip_name = strcpy_ns(malloc(strlen(&lbuf[1]) + 1), &lbuf[1]);
+		}
+		else if (kip_name && lbuf[0] == '.') // Extract pattern:offset:patch.
+		{
+			u32 pos = _find_patch_section_name(lbuf, lblen, '=') + 1;
+			if (pos >= lblen)
+				continue;
+
+			// Allocate signature, name and data in one go.
+			char *buf = zalloc(sizeof(ini_sig_patch_t) + KIP_SIG_MAX_SIZE * 3 + strlen(&lbuf[1]) + 1);
+			ini_sig_patch_t *sp = (ini_sig_patch_t *)buf;
+			kip_sig_t *sig = &sp->sig;
+
+			sig->kip     = kip_name;
+			sig->pattern = (u8 *)buf + sizeof(ini_sig_patch_t);
+			sig->mask    = sig->pattern + KIP_SIG_MAX_SIZE;
+			sig->patch   = sig->mask    + KIP_SIG_MAX_SIZE;
+			sig->name    = strcpy_ns((char *)sig->patch + KIP_SIG_MAX_SIZE, &lbuf[1]);
+
+			// Set pattern.
+			u32 str_start = _find_patch_section_name(&lbuf[pos], lblen - pos, ':');
+			sig->size = kip_sig_parse_hex(&lbuf[pos], sig->pattern, sig->mask, KIP_SIG_MAX_SIZE);
+			pos += str_start + 1;
+
+			// Set patch offset.
+			if (pos < lblen)
+			{
+				str_start = _find_patch_section_name(&lbuf[pos], lblen - pos, ':');
+				sig->offset = strtol(&lbuf[pos], NULL, 16);
+				pos += str_start + 1;
+			}
+
+			// Set patch data.
+			if (pos < lblen)
+				sig->patch_size = kip_sig_parse_hex(&lbuf[pos], sig->patch, NULL, KIP_SIG_MAX_SIZE);
+
+			// Skip broken lines. The patch will be reported as not applied.
+			if (!sig->size || !sig->patch_size)
+			{
+				free(buf);
+				continue;
+			}
+
+			list_append(dst, &sp->link);
+		}
+	} while (!f_eof(&fp));
+
+	f_close(&fp);
+
+	free(lbuf);
+
+	return 0;
+}
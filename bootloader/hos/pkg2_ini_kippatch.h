@@ -19,6 +19,8 @@
 
 #include <bdk.h>
 
+#include "pkg2_kip_sig.h"
+
 typedef struct _ini_patchset_t
 {
 	char *name;
@@ -37,6 +39,13 @@ typedef struct _ini_kip_sec_t
 	link_t link;
 } ini_kip_sec_t;
 
+typedef struct _ini_sig_patch_t
+{
+	kip_sig_t sig;
+	link_t link;
+} ini_sig_patch_t;
+
 int ini_patch_parse(link_t *dst, const char *ini_path);
+int ini_sig_patch_parse(link_t *dst, const char *ini_path);
 
 #endif
@@ -0,0 +1,265 @@
+/*
+ * KIP1 signature patching.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pkg2_kip_sig.h"
+
+static int _hex_nibble(char ch)
+{
+	if (ch >= '0' && ch <= '9')
+		return ch - '0';
+	else if (ch >= 'A' && ch <= 'F')
+		return ch - 'A' + 10;
+	else if (ch >= 'a' && ch <= 'f')
+		return ch - 'a' + 10;
+	else if (ch == '?')
+		return 0x10;
+
+	return -1;
+}
+
+/*
+ * Parses a hex array. If mask is provided, '?' is a wildcard nibble.
+ * Returns size in bytes or 0 if invalid.
+ */
+u32 kip_sig_parse_hex(const char *str, u8 *data, u8 *mask, u32 max_size)
+{
+	u32 size = 0;
+	bool high = true;
+
+	for (; *str; str++)
+	{
+		if (*str == ' ' || *str == '\t')
+			continue;
+
+		int nibble = _hex_nibble(*str);
+		if (nibble < 0 || (nibble == 0x10 && !mask) || size >= max_size)
+			return 0;
+
+		u8 val  = nibble & 0xF;
+		u8 nmsk = nibble == 0x10 ? 0 : 0xF;
+		if (high)
+		{
+			data[size] = val << 4;
+			if (mask)
+				mask[size] = nmsk << 4;
+		}
+		else
+		{
+			data[size] |= val;
+			if (mask)
+				mask[size] |= nmsk;
+			size++;
+		}
+
+		high = !high;
+	}
+
+	// Half bytes are not allowed.
+	if (!high)
+		return 0;
+
+	return size;
+}
+
+static void _kip_sig_set_anchor(kip_sig_t *sig)
+{
+	u32 run_start = 0;
+
+	sig->anchor_start = 0;
+	sig->anchor_size  = 0;
+
+	for (u32 i = 0; i <= sig->size; i++)
+	{
+		if (i < sig->size && sig->mask[i] == 0xFF)
+			continue;
+
+		if (i - run_start > sig->anchor_size)
+		{
+			sig->anchor_start = run_start;
+			sig->anchor_size  = i - run_start;
+		}
+		run_start = i + 1;
+	}
+}
+
+kip_sig_ac_t *kip_sig_compile(kip_sig_t **sigs, u32 sigs_num)
+{
+	// Every anchor byte can create one state, plus root.
+	u32 states_max = 1;
+	for (u32 i = 0; i < sigs_num; i++)
+	{
+		kip_sig_t *sig = sigs[i];
+
+		for (u32 j = 0; j < sig->size; j++)
+			sig->pattern[j] &= sig->mask[j];
+
+		_kip_sig_set_anchor(sig);
+		if (!sig->anchor_size)
+			return NULL;
+
+		states_max += sig->anchor_size;
+	}
+
+	if (states_max > KIP_SIG_MAX_STATES)
+		return NULL;
+
+	kip_sig_ac_t *ac = (kip_sig_ac_t *)calloc(1, sizeof(kip_sig_ac_t));
+	ac->next     = (u16 *)calloc(states_max * 256, sizeof(u16));
+	ac->dict     = (u16 *)calloc(states_max, sizeof(u16));
+	ac->out      = (u16 *)calloc(states_max, sizeof(u16));
+	ac->out_next = (u16 *)calloc(sigs_num, sizeof(u16));
+	ac->sigs     = sigs;
+	ac->sigs_num = sigs_num;
+	ac->states_num = 1;
+
+	u16 *fail  = (u16 *)calloc(states_max, sizeof(u16));
+	u16 *queue = (u16 *)malloc(states_max * sizeof(u16));
+
+	// Build the trie. State 0 is root, so 0 also means no child here.
+	for (u32 i = 0; i < sigs_num; i++)
+	{
+		const u8 *anchor = sigs[i]->pattern + sigs[i]->anchor_start;
+		u32 state = 0;
+
+		for (u32 j = 0; j < sigs[i]->anchor_size; j++)
+		{
+			u16 *next = &ac->next[state * 256 + anchor[j]];
+			if (!*next)
+				*next = ac->states_num++;
+			state = *next;
+		}
+
+		ac->out_next[i] = ac->out[state];
+		ac->out[state]  = i + 1;
+	}
+
+	// Resolve failure links breadth first and turn the trie into a full transition table.
+	u32 q_head = 0, q_tail = 0;
+	for (u32 b = 0; b < 256; b++)
+	{
+		if (ac->next[b])
+			queue[q_tail++] = ac->next[b];
+	}
+
+	while (q_head < q_tail)
+	{
+		u32 state = queue[q_head++];
+		u16 *next = &ac->next[state * 256];
+		const u16 *fail_next = &ac->next[fail[state] * 256];
+
+		for (u32 b = 0; b < 256; b++)
+		{
+			// Rows are completed when dequeued, so any set entry is still a trie child.
+			if (next[b])
+			{
+				u32 child = next[b];
+				fail[child] = fail_next[b];
+				ac->dict[child] = ac->out[fail[child]] ? fail[child] : ac->dict[fail[child]];
+				queue[q_tail++] = child;
+			}
+			else
+				next[b] = fail_next[b];
+		}
+	}
+
+	free(queue);
+	free(fail);
+
+	return ac;
+}
+
+void kip_sig_scan(kip_sig_ac_t *ac, const u8 *data, u32 size)
+{
+	for (u32 i = 0; i < ac->sigs_num; i++)
+	{
+		ac->sigs[i]->matches      = 0;
+		ac->sigs[i]->match_offset = 0;
+	}
+
+	const u16 *next = ac->next;
+	u32 state = 0;
+	for (u32 pos = 0; pos < size; pos++)
+	{
+		state = next[state * 256 + data[pos]];
+
+		// Visit this state and every suffix state with outputs.
+		u32 out_state = ac->out[state] ? state : ac->dict[state];
+		while (out_state)
+		{
+			for (u32 idx = ac->out[out_state]; idx; idx = ac->out_next[idx - 1])
+			{
+				kip_sig_t *sig = ac->sigs[idx - 1];
+
+				// Anchor ends at pos. Check the whole pattern.
+				u32 anchor_end = sig->anchor_start + sig->anchor_size - 1;
+				if (pos < anchor_end)
+					continue;
+
+				u32 start = pos - anchor_end;
+				if (start + sig->size > size)
+					continue;
+
+				u32 j;
+				for (j = 0; j < sig->size; j++)
+				{
+					if ((data[start + j] & sig->mask[j]) != sig->pattern[j])
+						break;
+				}
+
+				if (j != sig->size)
+					continue;
+
+				if (!sig->matches)
+					sig->match_offset = start;
+				sig->matches++;
+			}
+
+			out_state = ac->dict[out_state];
+		}
+	}
+}
+
+int kip_sig_apply(const kip_sig_t *sig, u8 *data, u32 size)
+{
+	// Missing or ambiguous signatures are not safe to patch.
+	if (sig->matches != 1)
+		return 1;
+
+	s64 patch_offset = (s64)sig->match_offset + sig->offset;
+	if (patch_offset < 0 || patch_offset + sig->patch_size > size)
+		return 1;
+
+	memcpy(data + patch_offset, sig->patch, sig->patch_size);
+
+	return 0;
+}
+
+void kip_sig_free(kip_sig_ac_t *ac)
+{
+	if (!ac)
+		return;
+
+	free(ac->next);
+	free(ac->dict);
+	free(ac->out);
+	free(ac->out_next);
+	free(ac);
+}
@@ -0,0 +1,65 @@
+/*
+ * KIP1 signature patching.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PKG2_KIP_SIG_H_
+#define _PKG2_KIP_SIG_H_
+
+#include <utils/types.h>
+
+#define KIP_SIG_MAX_SIZE   64
+#define KIP_SIG_MAX_STATES 0xFFFF
+
+/*
+ * A signature is a byte pattern with per byte masks. Its patch is written at a
+ * signed offset relative to the pattern start and it must match exactly once.
+ */
+typedef struct _kip_sig_t
+{
+	char *kip;          // KIP1 name.
+	char *name;         // Patchset name.
+	u8   *pattern;      // Already masked.
+	u8   *mask;         // 0xFF: must match. 0x00: any byte.
+	u8   *patch;
+	u32   size;
+	u32   patch_size;
+	int   offset;       // Patch offset from pattern start.
+	u32   anchor_start; // Longest fully masked run. Set on compile.
+	u32   anchor_size;
+	u32   matches;      // Set on scan.
+	u32   match_offset;
+} kip_sig_t;
+
+// Aho-Corasick automaton over the signature anchors, with all transitions resolved.
+typedef struct _kip_sig_ac_t
+{
+	u32   states_num;
+	u16  *next;     // 256 entries per state.
+	u16  *dict;     // Closest suffix state with outputs.
+	u16  *out;      // First signature per state, +1.
+	u16  *out_next; // Next signature with the same anchor, +1.
+	kip_sig_t **sigs;
+	u32   sigs_num;
+} kip_sig_ac_t;
+
+u32  kip_sig_parse_hex(const char *str, u8 *data, u8 *mask, u32 max_size);
+kip_sig_ac_t *kip_sig_compile(kip_sig_t **sigs, u32 sigs_num);
+void kip_sig_scan(kip_sig_ac_t *ac, const u8 *data, u32 size);
+int  kip_sig_apply(const kip_sig_t *sig, u8 *data, u32 size);
+void kip_sig_free(kip_sig_ac_t *ac);
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * Compiled KIP1 patches database.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PKG2_PATCH_DB_H_
+#define _PKG2_PATCH_DB_H_
+
+#include <utils/types.h>
+
+#define KIP_PATCH_DB_MAGIC   0x4244504B // "KPDB".
+#define KIP_PATCH_DB_VERSION 2
+#define KIP_PATCH_DB_PATH    "bootloader/patches.bin"
+#define KIP_PATCH_INI_PATH   "bootloader/patches.ini"
+
+/*
+ * Compiled from patches.ini by tools/kip_patch_db.
+ * All offsets are from file start and 0 means NULL. They get relocated in place to pointers,
+ * so on the 32-bit bootloader the arrays are used as kip1_id_t, kip1_patchset_t and kip1_patch_t.
+ * KIP sections with the same name and hash are merged in file order.
+ * A patches.ini with a different size or modification time makes the database stale.
+ */
+typedef struct _kip_patch_db_hdr_t
+{
+	u32 magic;
+	u32 version;
+	u32 size;      // Whole file.
+	u32 crc32;     // Everything after the header.
+	u32 ini_size;  // Source patches.ini size and FAT modification date/time.
+	u16 ini_date;
+	u16 ini_time;
+	u32 kips_num;
+	u32 kips_ofs;
+} kip_patch_db_hdr_t;
+
+typedef struct _kip_patch_db_kip_t
+{
+	u32 name_ofs;
+	u8  hash[8];
+	u32 patchsets_ofs; // Ends with a zeroed patchset.
+} kip_patch_db_kip_t;
+
+typedef struct _kip_patch_db_patchset_t
+{
+	u32 name_ofs;
+	u32 patches_ofs;   // Ends with a zeroed patch.
+} kip_patch_db_patchset_t;
+
+typedef struct _kip_patch_db_patch_t
+{
+	u32 offset;        // section + offset of patch to apply.
+	u32 length;        // 0 with src set is an empty patch.
+	u32 src_ofs;
+	u32 dst_ofs;
+} kip_patch_db_patch_t;
+
+#endif
@@ -36,6 +36,8 @@ extern bool is_ipl_updated(void *buf, u32 size, const char *path, bool force);
 // PKG3 Magic and Meta header offset.
 #define PKG3_MAGIC 0x30535346 // FSS0.
 #define PKG3_META_OFFSET 0x4
+#define PKG3_HDR_SIZE    0x400
+#define PKG3_CNT_ALIGN   0x10
 #define PKG3_VERSION_0_17_0 0x110000
 
 // PKG3 Content Types.
@@ -82,6 +84,13 @@ typedef struct _pkg3_content_t
 	char name[0x10];
 } pkg3_content_t;
 
+// PKG3 content to load.
+typedef struct _pkg3_load_t
+{
+	pkg3_content_t *cnt;
+	u32 dst_offset;
+} pkg3_load_t;
+
 static void _pkg3_update_r2p()
 {
 	u32 size = 0;
@@ -163,119 +172,183 @@ int parse_pkg3(launch_ctxt_t *ctxt, const char *path)
 	if (f_open(&fp, path, FA_READ) != FR_OK)
 		return 1;
 
-	void *pkg3 = malloc(f_size(&fp));
-
-	// Read first 1024 bytes of the PKG3 file.
-	f_read(&fp, pkg3, 1024, NULL);
+	// Read PKG3 header.
+	u8 *hdr = (u8 *)malloc(PKG3_HDR_SIZE);
+	pkg3_content_t *cnts = NULL;
+	pkg3_load_t *loads = NULL;
+	if (f_read(&fp, hdr, PKG3_HDR_SIZE, NULL) != FR_OK)
+		goto out;
 
 	// Get PKG3 Meta header offset.
-	u32 pkg3_meta_addr = *(u32 *)(pkg3 + PKG3_META_OFFSET);
-	pkg3_meta_t *pkg3_meta = (pkg3_meta_t *)(pkg3 + pkg3_meta_addr);
+	u32 pkg3_meta_addr = *(u32 *)(hdr + PKG3_META_OFFSET);
+	if (pkg3_meta_addr > PKG3_HDR_SIZE - sizeof(pkg3_meta_t))
+		goto out;
+	pkg3_meta_t *pkg3_meta = (pkg3_meta_t *)(hdr + pkg3_meta_addr);
 
 	// Check if valid PKG3 and parse it.
-	if (pkg3_meta->magic == PKG3_MAGIC)
+	if (pkg3_meta->magic != PKG3_MAGIC)
+		goto out;
+
+	gfx_printf("Atmosphere %d.%d.%d-%08x via PKG3\n"
+		"Max HOS: %d.%d.%d\n"
+		"Unpacking..  ",
+		pkg3_meta->version >> 24, (pkg3_meta->version >> 16) & 0xFF, (pkg3_meta->version >> 8) & 0xFF, pkg3_meta->git_rev,
+		pkg3_meta->hos_ver >> 24, (pkg3_meta->hos_ver >> 16) & 0xFF, (pkg3_meta->hos_ver >> 8) & 0xFF);
+
+	ctxt->patch_krn_proc_id = true;
+	ctxt->pkg3_hosver = pkg3_meta->hos_ver;
+
+	// Read PKG3 contents table.
+	u32 cnt_count = pkg3_meta->cnt_count;
+	cnts = (pkg3_content_t *)malloc(cnt_count * sizeof(pkg3_content_t));
+	f_lseek(&fp, pkg3_meta->cnt_off);
+	if (f_read(&fp, cnts, cnt_count * sizeof(pkg3_content_t), NULL) != FR_OK)
+		goto out;
+
+	// Select only the needed contents and lay them out packed.
+	u32 loads_num = 0;
+	u32 pkg3_size = 0;
+	loads = (pkg3_load_t *)malloc(cnt_count * sizeof(pkg3_load_t));
+	for (u32 i = 0; i < cnt_count; i++)
 	{
-		gfx_printf("Atmosphere %d.%d.%d-%08x via PKG3\n"
-			"Max HOS: %d.%d.%d\n"
-			"Unpacking..  ",
-			pkg3_meta->version >> 24, (pkg3_meta->version >> 16) & 0xFF, (pkg3_meta->version >> 8) & 0xFF, pkg3_meta->git_rev,
-			pkg3_meta->hos_ver >> 24, (pkg3_meta->hos_ver >> 16) & 0xFF, (pkg3_meta->hos_ver >> 8) & 0xFF);
-
-		ctxt->patch_krn_proc_id = true;
-		ctxt->pkg3_hosver = pkg3_meta->hos_ver;
-
-		// Parse PKG3 contents.
-		pkg3_content_t *curr_pkg3_cnt = (pkg3_content_t *)(pkg3 + pkg3_meta->cnt_off);
-		void *content;
-		for (u32 i = 0; i < pkg3_meta->cnt_count; i++)
-		{
-			content = (void *)(pkg3 + curr_pkg3_cnt[i].offset);
+		// Check if offset is inside limits.
+		if ((cnts[i].offset + cnts[i].size) > pkg3_meta->size)
+			continue;
 
-			// Check if offset is inside limits.
-			if ((curr_pkg3_cnt[i].offset + curr_pkg3_cnt[i].size) > pkg3_meta->size)
-				continue;
+		// If content is experimental and experimental config is not enabled, skip it.
+		if ((cnts[i].flags0 & CNT_FLAG0_EXPERIMENTAL) && !experimental)
+			continue;
 
-			// If content is experimental and experimental config is not enabled, skip it.
-			if ((curr_pkg3_cnt[i].flags0 & CNT_FLAG0_EXPERIMENTAL) && !experimental)
+		switch (cnts[i].type)
+		{
+		case CNT_TYPE_KIP:
+			if (stock)
 				continue;
 
-			// Prepare content.
-			switch (curr_pkg3_cnt[i].type)
+			bool should_skip = false;
+			for (u32 k = 0; k < pkg3_kip1_skip_num; k++)
 			{
-			case CNT_TYPE_KIP:
-				if (stock)
-					continue;
-
-				bool should_skip = false;
-				for (u32 k = 0; k < pkg3_kip1_skip_num; k++)
+				if (!strcmp(cnts[i].name, pkg3_kip1_skip[k]))
 				{
-					if (!strcmp(curr_pkg3_cnt[i].name, pkg3_kip1_skip[k]))
-					{
-						gfx_printf("Skipped %s.kip1 from PKG3\n", curr_pkg3_cnt[i].name);
-						should_skip = true;
-						break;
-					}
+					gfx_printf("Skipped %s.kip1 from PKG3\n", cnts[i].name);
+					should_skip = true;
+					break;
 				}
-				if (should_skip)
-					continue;
-
-				merge_kip_t *mkip1 = (merge_kip_t *)malloc(sizeof(merge_kip_t));
-				mkip1->kip1 = content;
-				list_append(&ctxt->kip1_list, &mkip1->link);
-				DPRINTF("Loaded %s.kip1 from PKG3 (size %08X)\n", curr_pkg3_cnt[i].name, curr_pkg3_cnt[i].size);
-				break;
-
-			case CNT_TYPE_KRN:
-				if (stock)
-					continue;
-				ctxt->kernel_size = curr_pkg3_cnt[i].size;
-				ctxt->kernel = content;
-				break;
-
-			case CNT_TYPE_EXO:
-				ctxt->secmon_size = curr_pkg3_cnt[i].size;
-				ctxt->secmon = content;
-				break;
-
-			case CNT_TYPE_EXF:
-				ctxt->exofatal_size = curr_pkg3_cnt[i].size;
-				ctxt->exofatal = content;
-				break;
-
-			case CNT_TYPE_WBT:
-				if (h_cfg.t210b01)
-					continue;
-				ctxt->warmboot_size = curr_pkg3_cnt[i].size;
-				ctxt->warmboot = content;
-				break;
-
-			default:
-				continue;
 			}
+			if (should_skip)
+				continue;
+			break;
 
-			// Load content to launch context.
-			f_lseek(&fp, curr_pkg3_cnt[i].offset);
-			f_read(&fp, content, curr_pkg3_cnt[i].size, NULL);
+		case CNT_TYPE_KRN:
+			if (stock)
+				continue;
+			break;
+
+		case CNT_TYPE_WBT:
+			if (h_cfg.t210b01)
+				continue;
+			break;
+
+		case CNT_TYPE_EXO:
+		case CNT_TYPE_EXF:
+			break;
+
+		default:
+			continue;
 		}
 
-		gfx_printf("Done!\n");
-		f_close(&fp);
+		loads[loads_num].cnt = &cnts[i];
+		loads[loads_num].dst_offset = pkg3_size;
+		loads_num++;
 
-		ctxt->pkg3 = pkg3;
+		pkg3_size += ALIGN(cnts[i].size, PKG3_CNT_ALIGN);
+	}
+
+	u8 *pkg3 = (u8 *)malloc(pkg3_size);
 
-		// Update r2p if needed.
-		_pkg3_update_r2p();
+	// Load contents straight into their final place. Contents that are adjacent in both file and memory are read together.
+	for (u32 i = 0; i < loads_num;)
+	{
+		u32 file_offset = loads[i].cnt->offset;
+		u32 dst_offset  = loads[i].dst_offset;
 
-		free(pkg3_kip1_skip);
+		u32 j = i + 1;
+		while (j < loads_num && loads[j].cnt->offset - file_offset == loads[j].dst_offset - dst_offset)
+			j++;
 
-		return 0;
+		u32 size = loads[j - 1].dst_offset + loads[j - 1].cnt->size - dst_offset;
+DPRINTF("Reading %08X @ %08X (%d contents)\n", size, file_offset, j - i);
+		f_lseek(&fp, file_offset);
+		if (f_read(&fp, pkg3 + dst_offset, size, NULL) != FR_OK)
+		{
+			free(pkg3);
+			goto out;
+		}
+
+		i = j;
+	}
+
+	// Set contents to launch context.
+	for (u32 i = 0; i < loads_num; i++)
+	{
+		pkg3_content_t *cnt = loads[i].cnt;
+		void *content = pkg3 + loads[i].dst_offset;
+		merge_kip_t *mkip1;
+
+		switch (cnt->type)
+		{
+		case CNT_TYPE_KIP:
+			mkip1 = (merge_kip_t *)malloc(sizeof(merge_kip_t));
+			mkip1->kip1 = content;
+			list_append(&ctxt->kip1_list, &mkip1->link);
+			DPRINTF("Loaded %s.kip1 from PKG3 (size %08X)\n", cnt->name, cnt->size);
+			break;
+
+		case CNT_TYPE_KRN:
+			ctxt->kernel_size = cnt->size;
+			ctxt->kernel = content;
+			break;
+
+		case CNT_TYPE_EXO:
+			ctxt->secmon_size = cnt->size;
+			ctxt->secmon = content;
+			break;
+
+		case CNT_TYPE_EXF:
+			ctxt->exofatal_size = cnt->size;
+			ctxt->exofatal = content;
+			break;
+
+		case CNT_TYPE_WBT:
+			ctxt->warmboot_size = cnt->size;
+			ctxt->warmboot = content;
+			break;
+		}
 	}
 
+	gfx_printf("Done!\n");
+	f_close(&fp);
+
+	ctxt->pkg3 = pkg3;
+
+	// Update r2p if needed.
+	_pkg3_update_r2p();
+
+	free(loads);
+	free(cnts);
+	free(hdr);
+	free(pkg3_kip1_skip);
+
+	return 0;
+
+out:
 	// Failed. Close and free all.
 	f_close(&fp);
 
+	free(loads);
+	free(cnts);
+	free(hdr);
 	free(pkg3_kip1_skip);
-	free(pkg3);
 
 	return 1;
 }
@@ -428,6 +428,7 @@ void secmon_exo_check_panic()
 	gfx_printf("\n\nPress POWER to continue.\n");
 	gfx_con_setpos(0, 0);
 
+	display_init_finish();
 	display_backlight_brightness(150, 1000);
 	msleep(1000);
 
@@ -257,6 +257,7 @@ typedef struct _l4t_fw_t
 {
 	u32   addr;
 	char *name;
+	char *err;
 } l4t_fw_t;
 
 typedef struct _l4t_ctxt_t
@@ -299,13 +300,13 @@ static const u8 mtc_table_idx_t210b01[] = {
 #undef NA
 
 static const l4t_fw_t l4t_fw[] = {
-	{ TZDRAM_BASE,               "bl31.bin"        },
-	{ BL33_LOAD_BASE,            "bl33.bin"        },
-	{ SC7ENTRY_BASE,             "sc7entry.bin"    },
-	{ SC7EXIT_BASE,              "sc7exit.bin"     },
-	{ BPMPFW_BASE,               "bpmpfw.bin"      },
-	{ BPMPFW_B01_BASE,           "bpmpfw_b01.bin"  },
-	{ BPMPFW_B01_MTC_TABLE_BASE, "mtc_tbl_b01.bin" },
+	{ TZDRAM_BASE,               "bl31.bin",        "BL31 missing"         },
+	{ BL33_LOAD_BASE,            "bl33.bin",        "BL33 missing"         },
+	{ SC7ENTRY_BASE,             "sc7entry.bin",    "loading SC7-Entry"    },
+	{ SC7EXIT_BASE,              "sc7exit.bin",     "loading SC7-Exit"     },
+	{ BPMPFW_BASE,               "bpmpfw.bin",      "loading BPMP-FW"      },
+	{ BPMPFW_B01_BASE,           "bpmpfw_b01.bin",  "loading BPMP-FW"      },
+	{ BPMPFW_B01_MTC_TABLE_BASE, "mtc_tbl_b01.bin", "loading BPMP-FW MTC"  },
 };
 
 enum {
@@ -326,28 +327,71 @@ static void _l4t_crit_error(const char *text, bool needs_update)
 }
 
 char *sd_path;
-u32 sd_path_len;
-static int _l4t_sd_load(u32 idx)
+static int _l4t_sd_load_fw(const u8 *fw_list, u32 fw_num, u32 *sizes)
 {
-	FIL fp;
-	void *load_address = (void *)l4t_fw[idx].addr;
+	int res = 1;
+	u32 opened = 0;
+	u32 cur = 0;
 
-	strcpy(sd_path + sd_path_len, l4t_fw[idx].name);
+	FIL *fps = (FIL *)malloc(sizeof(FIL) * fw_num);
+	char *path = (char *)malloc(512);
 
-	if (f_open(&fp, sd_path, FA_READ) != FR_OK)
-		return 0;
+	// Open all files first, so a missing one fails before any read. I/O is still serial per file.
+	TRACE_BEGIN("l4t_fw_open");
+	for (; opened < fw_num; opened++)
+	{
+		u32 idx = fw_list[opened];
 
-	u32 size = f_size(&fp);
-	if (f_read(&fp, load_address, size, NULL) != FR_OK)
-		size = 0;
+		// BL31/BL33 are in the boot path. The rest are in the bootloader folder.
+		strcpy(path, idx < SC7ENTRY_FW ? sd_path : "bootloader/sys/l4t/");
+		strcat(path, l4t_fw[idx].name);
 
-	f_close(&fp);
+		if (f_open(&fps[opened], path, FA_READ) != FR_OK)
+		{
+			cur = opened;
+			break;
+		}
+	}
+	TRACE_END("l4t_fw_open");
 
-	u32 rev = *(u32 *)(load_address + size - sizeof(u32));
-	if (idx >= SC7ENTRY_FW && rev != L4T_FIRMWARE_REV)
-		return 0;
+	if (opened != fw_num)
+		goto out;
 
-	return size;
+	// Read each file in one go straight to its load address.
+	for (cur = 0; cur < fw_num; cur++)
+	{
+		u32 idx = fw_list[cur];
+		void *load_address = (void *)l4t_fw[idx].addr;
+		u32 size = f_size(&fps[cur]);
+
+		TRACE_BEGIN(l4t_fw[idx].name);
+		int read_res = f_read(&fps[cur], load_address, size, NULL);
+		TRACE_END(l4t_fw[idx].name);
+
+		if (read_res != FR_OK || size < sizeof(u32))
+			goto out;
+
+		// Check firmware revision.
+		u32 rev = *(u32 *)(load_address + size - sizeof(u32));
+		if (idx >= SC7ENTRY_FW && rev != L4T_FIRMWARE_REV)
+			goto out;
+
+		sizes[idx] = size;
+	}
+
+	res = 0;
+
+out:
+	for (u32 i = 0; i < opened; i++)
+		f_close(&fps[i]);
+
+	if (res)
+		_l4t_crit_error(l4t_fw[fw_list[cur]].err, fw_list[cur] >= SC7ENTRY_FW);
+
+	free(path);
+	free(fps);
+
+	return res;
 }
 
 static void _l4t_sdram_lp0_save_params(bool t210b01)
@@ -933,7 +977,6 @@ static void _l4t_set_config(l4t_ctxt_t *ctxt, const ini_sec_t *ini_sec, int entr
 
 	// Set boot path.
 	sd_path = (char *)malloc(512);
-	sd_path_len = strlen(ctxt->path);
 	strcpy(sd_path, ctxt->path);
 }
 
@@ -961,70 +1004,32 @@ void launch_l4t(const ini_sec_t *ini_sec, int entry_idx, int is_list, bool t210b
 		return;
 	}
 
-	// Load BL31 (ATF/TrustZone fw).
-	if (!_l4t_sd_load(BL31_FW))
-	{
-		_l4t_crit_error("BL31 missing", false);
-		return;
-	}
-
-	// Load BL33 (U-BOOT/CBOOT).
-	if (!_l4t_sd_load(BL33_FW))
-	{
-		_l4t_crit_error("BL33 missing", false);
-		return;
-	}
-
-	// Set firmware path.
-	strcpy(sd_path, "bootloader/sys/l4t/");
-	sd_path_len = strlen(sd_path);
+	// Load BL31 (ATF/TrustZone fw), BL33 (U-BOOT/CBOOT) and firmware.
+	// T210:    SC7-Entry, BPMP-FW (power management) and SC7-Exit.
+	// T210B01: BPMP-FW (manages SC7-Entry also) and its MTC table.
+	static const u8 fw_t210[]    = { BL31_FW, BL33_FW, SC7ENTRY_FW, BPMPFW_FW, SC7EXIT_FW };
+	static const u8 fw_t210b01[] = { BL31_FW, BL33_FW, BPMPFW_B01_FW, BPMPFW_B01_MTC_TBL };
+	u32 fw_sizes[ARRAY_SIZE(l4t_fw)] = { 0 };
 
 	if (!t210b01)
 	{
-		// Load SC7-Entry firmware.
-		ctxt->sc7entry_size = _l4t_sd_load(SC7ENTRY_FW);
-		if (!ctxt->sc7entry_size)
-		{
-			_l4t_crit_error("loading SC7-Entry", true);
-			return;
-		}
-
-		// Load BPMP-FW. Does power management.
-		if (!_l4t_sd_load(BPMPFW_FW))
-		{
-			_l4t_crit_error("loading BPMP-FW", true);
-			return;
-		}
-
-		// Load SC7-Exit firmware.
-		if (!_l4t_sd_load(SC7EXIT_FW))
-		{
-			_l4t_crit_error("loading SC7-Exit", true);
+		if (_l4t_sd_load_fw(fw_t210, ARRAY_SIZE(fw_t210), fw_sizes))
 			return;
-		}
 	}
 	else
 	{
-		// Load BPMP-FW. Manages SC7-Entry also.
-		if (!_l4t_sd_load(BPMPFW_B01_FW))
-		{
-			_l4t_crit_error("loading BPMP-FW", true);
-			return;
-		}
-
-		// Load BPMP-FW MTC table.
-		if (!_l4t_sd_load(BPMPFW_B01_MTC_TBL))
-		{
-			_l4t_crit_error("loading BPMP-FW MTC", true);
+		if (_l4t_sd_load_fw(fw_t210b01, ARRAY_SIZE(fw_t210b01), fw_sizes))
 			return;
-		}
 	}
 
+	ctxt->sc7entry_size = fw_sizes[SC7ENTRY_FW];
+
 	// Set SC7-Exit firmware address to PMC for bootrom and do further setup.
 	if (_l4t_sc7_exit_config(t210b01))
 		return;
 
 	// Done loading bootloaders/firmware.
+	TRACE_DUMP();
 	sd_end();
 
 	// We don't need AHB aperture open.
@@ -1142,7 +1147,8 @@ void launch_l4t(const ini_sec_t *ini_sec, int entry_idx, int is_list, bool t210b
 	PMC(APBDEV_PMC_SECURE_SCRATCH109) = (u32)&ctxt->bl31_plat_params;
 	PMC(APBDEV_PMC_SECURE_SCRATCH110) = BL31_IRAM_PARAMS;
 
-	// Set panel model.
+	// Set panel model. Make sure the panel is up, in case of deferred display init.
+	display_init_finish();
 	PMC(APBDEV_PMC_SECURE_SCRATCH113) = display_get_decoded_panel_id();
 
 	// Set charging limit parameters.
@@ -47,6 +47,8 @@ const volatile ipl_ver_meta_t __attribute__((section ("._ipl_version"))) ipl_ver
 
 volatile nyx_storage_t *nyx_str = (nyx_storage_t *)NYX_STORAGE_ADDR;
 
+static nyx_boot_time_t boot_time = { 0 };
+
 static void _check_power_off_from_hos()
 {
 	// Power off on alarm wakeup from HOS shutdown. For modchips/dongles.
@@ -65,6 +67,9 @@ static void _check_power_off_from_hos()
 		{
 			render_static_bootlogo();
 
+			// Panel id is needed below.
+			display_init_finish();
+
 			if (display_get_decoded_panel_id() != PANEL_SAM_AMS699VC01)
 			{
 				// Slow fading for LCD panels.
@@ -180,6 +185,7 @@ static void _launch_payload(char *path, bool update, bool clear_screen)
 		goto out;
 	}
 
+	TRACE_DUMP();
 	sd_end();
 
 	// Copy the payload to our chosen address.
@@ -579,12 +585,18 @@ out:
 
 static void _nyx_load_run()
 {
+	TRACE_BEGIN("nyx_load");
 	u8 *nyx = sd_file_read("bootloader/sys/nyx.bin", NULL);
+	TRACE_END("nyx_load");
 	if (!nyx)
 		return;
 
+	TRACE_DUMP();
 	sd_end();
 
+	// Nyx expects an initialized panel.
+	display_init_finish();
+
 	render_static_bootlogo();
 	display_backlight_brightness(h_cfg.backlight, 1000);
 
@@ -627,6 +639,12 @@ static void _nyx_load_run()
 	// Set [new] reserved flags.
 	nyx_str->info_ex.rsvd_flags = ipl_ver.rcfg.rsvd_flags;
 
+	// Set [new] boot storage/display init times. eMMC is only set if it was used. They run serially here.
+	boot_time.display = display_get_init_time();
+	boot_time.emmc    = emmc_get_init_time();
+	boot_time.total   = boot_time.display + boot_time.sd + boot_time.emmc;
+	memcpy((void *)&nyx_str->info_ex.boot_time, &boot_time, sizeof(nyx_boot_time_t));
+
 	// Set [new] SD card initialization and error info.
 	nyx_str->info.sd_init = sd_get_mode();
 	u16 *sd_errors = sd_get_error_count();
@@ -752,7 +770,10 @@ static void _auto_launch()
 	emummc_load_cfg();
 
 	// Parse hekate main configuration.
-	if (ini_parse(&ini_sections, "bootloader/hekate_ipl.ini", false))
+	TRACE_BEGIN("config_parse");
+	int res = ini_parse(&ini_sections, "bootloader/hekate_ipl.ini", false);
+	TRACE_END("config_parse");
+	if (res)
 		goto out; // Can't load hekate_ipl.ini.
 
 	// Load configuration.
@@ -940,6 +961,8 @@ skip_list:
 		if (boot_wait > 20)
 			boot_wait = 3;
 
+		TRACE_INSTANT("bootwait");
+
 		// Render boot logo.
 		if (bootlogoFound)
 		{
@@ -960,10 +983,15 @@ skip_list:
 	}
 
 	if (b_cfg.boot_cfg & BOOT_CFG_FROM_LAUNCH)
+	{
+		display_init_finish();
 		display_backlight_brightness(h_cfg.backlight, 0);
+	}
 	else if (btn_read_vol() == BTN_VOL_DOWN) // 0s bootwait VOL- check.
 		goto out;
 
+	TRACE_INSTANT("boot_entry");
+
 	if (special_path)
 	{
 		// Try to launch Payload or L4T.
@@ -996,6 +1024,7 @@ wrong_emupath:
 error:
 		gfx_con.mute = false;
 		gfx_printf("\nPress any key...\n");
+		display_init_finish();
 		display_backlight_brightness(h_cfg.backlight, 1000);
 		msleep(500);
 		btn_wait();
@@ -1069,6 +1098,7 @@ static void _show_errors()
 	{
 		gfx_clear_grey(0x1B);
 		gfx_con_setpos(0, 0);
+		display_init_finish();
 		display_backlight_brightness(150, 1000);
 
 		if (h_cfg.errors & ERR_SD_BOOT_EN)
@@ -1445,6 +1475,9 @@ void ipl_main()
 	// Place heap at a place outside of L4T/HOS configuration and binaries.
 	heap_init((void *)IPL_HEAP_START);
 
+	// Start boot tracing if enabled.
+	TRACE_INIT();
+
 #ifdef DEBUG_UART_PORT
 	uart_send(DEBUG_UART_PORT, (u8 *)"hekate: Hello!\n", 15);
 	uart_wait_xfer(DEBUG_UART_PORT, UART_TX_IDLE);
@@ -1459,45 +1492,56 @@ void ipl_main()
 	// Prep RTC regs for read. Needed for T210B01 R2C.
 	max77620_rtc_prep_read();
 
-	// Initialize display.
-	display_init();
+	// Use SDMMC tuning results from previous inits if any.
+	sdmmc_storage_tune_cache_set((sdmmc_tune_cache_t *)&nyx_str->tune_cache);
 
 	// Overclock BPMP.
 	bpmp_clk_rate_set(h_cfg.t210b01 ? ipl_ver.rcfg.bclk_t210b01 : ipl_ver.rcfg.bclk_t210);
 
-	// Mount SD Card.
+	// Mount SD Card. eMMC is initialized on first use, since most boot paths do not need it.
+	TRACE_BEGIN("sd_mount");
+	sd_initialize_async();
 	if (sd_mount())
 		h_cfg.errors |= ERR_SD_BOOT_EN;
+	TRACE_END("sd_mount");
+	boot_time.sd = sd_get_init_time();
 
-	// Check if watchdog was fired previously.
+	// Check if watchdog was fired previously. Saved DRAM training could be the cause, so retrain next time.
 	if (watchdog_fired())
+	{
+		minerva_train_cache_remove();
 		goto skip_lp0_minerva_config;
+	}
 
 	// Enable watchdog protection to avoid SD corruption based hanging in LP0/Minerva config.
 	watchdog_start(5000000 / 2, TIMER_FIQENABL_EN); // 5 seconds.
 
 	// Save sdram lp0 config.
+	TRACE_BEGIN("lp0_config");
 	void *sdram_params = h_cfg.t210b01 ? sdram_get_params_t210b01() : sdram_get_params_patched();
 	if (!ianos_static_module("bootloader/sys/libsys_lp0.bso", sdram_params))
 		h_cfg.errors |= ERR_LIBSYS_LP0;
+	TRACE_END("lp0_config");
 
 	// Train DRAM and switch to max frequency.
+	TRACE_BEGIN("minerva_init");
 	if (minerva_init((minerva_str_t *)&nyx_str->minerva))
 		h_cfg.errors |= ERR_LIBSYS_MTC;
+	TRACE_END("minerva_init");
 
 	// Disable watchdog protection.
 	watchdog_end();
 
+	// Save new DRAM training results if any.
+	minerva_train_cache_save();
+
 skip_lp0_minerva_config:
-	// Initialize display window, backlight and gfx console.
-	u32 *fb = display_init_window_a_pitch();
+	// Initialize gfx console. Panel, window and backlight PWM get initialized on first backlight enable.
+	// That way autoboot with no bootwait goes straight to the payload without ever waking the panel.
+	u32 *fb = display_init_deferred();
 	gfx_init_ctxt(fb, 720, 1280, 720);
 	gfx_con_init();
 
-	// Initialize backlight PWM.
-	display_backlight_pwm_init();
-	//display_backlight_brightness(h_cfg.backlight, 1000);
-
 	// Show exceptions, HOS errors, library errors and L4T kernel panics.
 	_show_errors();
 
@@ -21,7 +21,11 @@
 #include "payload_01.h"
 
 #include <memory_map.h>
+#ifdef LDR_LZ4
+#include <libs/compr/lz4_lite.h>
+#else
 #include <libs/compr/lz.h>
+#endif
 #include <soc/bpmp.h>
 #include <soc/clock.h>
 #include <soc/t210.h>
@@ -31,6 +35,12 @@
 #define IPL_PATCHED_RELOC_SZ 0x94
 #define IPL_VERSION_RCFG_OFF 0x120
 
+#ifdef LDR_LZ4
+#define payload_uncompress lz4_lite_uncompress
+#else
+#define payload_uncompress LZ_Uncompress
+#endif
+
 boot_cfg_t __attribute__((section ("._boot_cfg"))) b_cfg;
 const volatile ipl_ver_meta_t __attribute__((section ("._ipl_version"))) ipl_ver = {
 	.magic             = BL_MAGIC,
@@ -97,12 +107,12 @@ void loader_main()
 	// Set source address of the first part.
 	u8 *src_addr = (void *)(IPL_RELOC_TOP - payload_size);
 	// Uncompress first part.
-	u32 dst_pos = LZ_Uncompress((const u8 *)src_addr, (u8 *)IPL_LOAD_ADDR, sizeof(payload_00));
+	u32 dst_pos = payload_uncompress((const u8 *)src_addr, (u8 *)IPL_LOAD_ADDR, sizeof(payload_00));
 
 	// Set source address of the second part. Includes compiler alignment.
 	src_addr += (u32)payload_01 - (u32)payload_00;
 	// Uncompress second part.
-	LZ_Uncompress((const u8 *)src_addr, (u8 *)IPL_LOAD_ADDR + dst_pos, sizeof(payload_01));
+	payload_uncompress((const u8 *)src_addr, (u8 *)IPL_LOAD_ADDR + dst_pos, sizeof(payload_01));
 
 	// Copy over boot configuration storage.
 	memcpy((u8 *)(IPL_LOAD_ADDR + IPL_PATCHED_RELOC_SZ), &b_cfg, sizeof(boot_cfg_t));
@@ -59,6 +59,9 @@ void set_nyx_default_configuration()
 	n_cfg.jc_disable     = 0;
 	n_cfg.jc_force_right = 0;
 	n_cfg.bpmp_clock     = 0;
+	n_cfg.emmc_cache     = 0;
+	n_cfg.backup_compress = 0;
+	n_cfg.restore_compare = 0;
 }
 
 int create_config_entry()
@@ -245,6 +248,18 @@ int create_nyx_config_entry(bool force_unmount)
 	itoa(n_cfg.bpmp_clock, lbuf, 10);
 	f_puts(lbuf, &fp);
 
+	f_puts("\nemmccache=", &fp);
+	itoa(n_cfg.emmc_cache, lbuf, 10);
+	f_puts(lbuf, &fp);
+
+	f_puts("\nbackupcompress=", &fp);
+	itoa(n_cfg.backup_compress, lbuf, 10);
+	f_puts(lbuf, &fp);
+
+	f_puts("\nrestorecompare=", &fp);
+	itoa(n_cfg.restore_compare, lbuf, 10);
+	f_puts(lbuf, &fp);
+
 	f_puts("\n", &fp);
 
 	f_close(&fp);
@@ -56,6 +56,9 @@ typedef struct _nyx_config
 	u32 jc_disable;
 	u32 jc_force_right;
 	u32 bpmp_clock;
+	u32 emmc_cache;
+	u32 backup_compress;
+	u32 restore_compare;
 } nyx_config;
 
 extern hekate_config h_cfg;
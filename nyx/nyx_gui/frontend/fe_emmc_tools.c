@@ -28,6 +28,8 @@
 #include "fe_emummc_tools.h"
 #include "../config.h"
 #include <libs/fatfs/ff.h>
+#include <libs/compr/lz4.h>
+#include <libs/compr/lz4_img.h>
 
 #define VERIF_STATUS_OK    0
 #define VERIF_STATUS_ERROR 1
@@ -37,6 +39,9 @@
 #define OUT_FILENAME_SZ 128
 #define HASH_FILENAME_SZ (OUT_FILENAME_SZ + 11) // 11 == strlen(".sha256sums")
 
+#define LZ4_IMG_CBUF  (SDXC_BUF_ALIGNED + SZ_8M) // Compressed block buffer.
+#define LZ4_IMG_ACCEL 4 // Favor speed. BPMP is slower than SD writes on incompressible data.
+
 extern nyx_config n_cfg;
 
 extern char *emmcsn_path_impl(char *path, char *sub_dir, char *filename, sdmmc_storage_t *storage);
@@ -141,6 +146,161 @@ static void _update_filename(char *outFilename, u32 sdPathLen, u32 currPartIdx)
 		itoa(currPartIdx, &outFilename[sdPathLen], 10);
 }
 
+static bool _lz4_img_is_zero(const u8 *buf, u32 size)
+{
+	const u32 *buf32 = (const u32 *)buf;
+	for (u32 i = 0; i < size / sizeof(u32); i++)
+		if (buf32[i])
+			return false;
+
+	return true;
+}
+
+static int _lz4_img_write(FIL *fp, const void *buf, u32 size)
+{
+	UINT bw;
+	int res = f_write(fp, buf, size, &bw);
+
+	// Short write means the SD card is full.
+	if (!res && bw != size)
+		res = FR_DENIED;
+
+	return res;
+}
+
+static int _lz4_img_read(FIL *fp, void *buf, u32 size)
+{
+	UINT br;
+	int res = f_read(fp, buf, size, &br);
+
+	if (!res && br != size)
+		res = FR_INT_ERR;
+
+	return res;
+}
+
+static int _lz4_img_index_read(FIL *fp, lz4_img_ftr_t *ftr, lz4_img_blk_t **index)
+{
+	lz4_img_frame_hdr_t frame;
+	lz4_img_skip_hdr_t skip;
+
+	*index = NULL;
+
+	u64 size = f_size(fp);
+	if (size < sizeof(lz4_img_frame_hdr_t) + sizeof(u32) + sizeof(lz4_img_skip_hdr_t) + sizeof(lz4_img_ftr_t))
+		return 1;
+
+	if (_lz4_img_read(fp, &frame, sizeof(lz4_img_frame_hdr_t)) ||
+		frame.magic != LZ4F_MAGIC || frame.flg != LZ4_IMG_FRAME_FLG || frame.bd != LZ4_IMG_FRAME_BD)
+		return 1;
+
+	// Footer is at the end of the file and the index right before it.
+	if (f_lseek(fp, size - sizeof(lz4_img_ftr_t)) || _lz4_img_read(fp, ftr, sizeof(lz4_img_ftr_t)))
+		return 1;
+
+	if (ftr->magic != LZ4_IMG_MAGIC || ftr->version != LZ4_IMG_VERSION ||
+		!ftr->block_sectors || ftr->block_sectors > NUM_SECTORS_PER_ITER ||
+		!ftr->block_num || ftr->block_num != (ftr->sectors + ftr->block_sectors - 1) / ftr->block_sectors)
+		return 1;
+
+	u32 index_size = ftr->block_num * sizeof(lz4_img_blk_t);
+	if (size < sizeof(lz4_img_frame_hdr_t) + sizeof(u32) + sizeof(lz4_img_skip_hdr_t) + index_size + sizeof(lz4_img_ftr_t))
+		return 1;
+
+	if (f_lseek(fp, size - sizeof(lz4_img_ftr_t) - index_size - sizeof(lz4_img_skip_hdr_t)) ||
+		_lz4_img_read(fp, &skip, sizeof(lz4_img_skip_hdr_t)) ||
+		skip.magic != LZ4_IMG_SKIP_MAGIC || skip.size != index_size + sizeof(lz4_img_ftr_t))
+		return 1;
+
+	*index = (lz4_img_blk_t *)malloc(index_size);
+	if (_lz4_img_read(fp, *index, index_size))
+	{
+		free(*index);
+		*index = NULL;
+
+		return 1;
+	}
+
+	return 0;
+}
+
+static int _lz4_img_block_read(FIL *fp, const lz4_img_blk_t *blk, u8 *buf, u8 *cbuf, u32 size)
+{
+	if (blk->flags & LZ4_IMG_BLK_ZERO)
+	{
+		memset(buf, 0, size);
+		return 0;
+	}
+
+	u32 csize = blk->csize & ~LZ4_IMG_BLK_STORED;
+	if (f_lseek(fp, blk->offset))
+		return 1;
+
+	// Stored block.
+	if (blk->csize & LZ4_IMG_BLK_STORED)
+		return csize != size || _lz4_img_read(fp, buf, size);
+
+	if (!csize || csize >= size || _lz4_img_read(fp, cbuf, csize))
+		return 1;
+
+	return LZ4_decompress_safe((const char *)cbuf, (char *)buf, csize, size) != (int)size;
+}
+
+static int _lz4_img_part_create(FIL *fp, lz4_img_ftr_t *ftr, const char *filename, u32 lba_offset, u32 total_sectors)
+{
+	static const lz4_img_frame_hdr_t frame = { LZ4F_MAGIC, LZ4_IMG_FRAME_FLG, LZ4_IMG_FRAME_BD, LZ4_IMG_FRAME_HC };
+
+	memset(ftr, 0, sizeof(lz4_img_ftr_t));
+	ftr->block_sectors = NUM_SECTORS_PER_ITER;
+	ftr->lba_offset    = lba_offset;
+	ftr->total_sectors = total_sectors;
+	ftr->version       = LZ4_IMG_VERSION;
+	ftr->magic         = LZ4_IMG_MAGIC;
+
+	int res = f_open(fp, filename, FA_CREATE_ALWAYS | FA_WRITE);
+	if (res)
+		return res;
+
+	res = _lz4_img_write(fp, &frame, sizeof(lz4_img_frame_hdr_t));
+	if (res)
+		f_close(fp);
+
+	return res;
+}
+
+static int _lz4_img_block_write(FIL *fp, lz4_img_blk_t *blk, const void *data, u32 csize, u32 flags)
+{
+	blk->offset = f_tell(fp) + sizeof(u32);
+	blk->csize  = csize;
+	blk->flags  = flags;
+
+	int res = _lz4_img_write(fp, &csize, sizeof(u32));
+	if (!res)
+		res = _lz4_img_write(fp, data, csize & ~LZ4_IMG_BLK_STORED);
+
+	return res;
+}
+
+static int _lz4_img_part_finish(FIL *fp, lz4_img_ftr_t *ftr, const lz4_img_blk_t *index)
+{
+	u32 index_size = ftr->block_num * sizeof(lz4_img_blk_t);
+	u32 end_mark = 0;
+	lz4_img_skip_hdr_t skip = { LZ4_IMG_SKIP_MAGIC, index_size + sizeof(lz4_img_ftr_t) };
+
+	// End the frame and append block index and footer as a skippable frame.
+	int res = _lz4_img_write(fp, &end_mark, sizeof(u32));
+	if (!res)
+		res = _lz4_img_write(fp, &skip, sizeof(lz4_img_skip_hdr_t));
+	if (!res)
+		res = _lz4_img_write(fp, index, index_size);
+	if (!res)
+		res = _lz4_img_write(fp, ftr, sizeof(lz4_img_ftr_t));
+
+	int res_close = f_close(fp);
+
+	return res ? res : res_close;
+}
+
 static int _emmc_sd_copy_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage, u32 lba_curr, const char *outFilename, const emmc_part_t *part)
 {
 	FIL fp;
@@ -152,11 +312,18 @@ static int _emmc_sd_copy_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage,
 	static const char hexa[] = "0123456789abcdef";
 	DWORD *clmt = NULL;
 
+	lz4_img_ftr_t lz4Ftr;
+	lz4_img_blk_t *lz4Index = NULL;
+
 	u8 hashEm[SE_SHA_256_SIZE];
 	u8 hashSd[SE_SHA_256_SIZE];
 
 	if (f_open(&fp, outFilename, FA_READ) == FR_OK)
 	{
+		// Check for a compressed backup.
+		bool lz4Img = !_lz4_img_index_read(&fp, &lz4Ftr, &lz4Index);
+		u32 iterSectors = lz4Img ? lz4Ftr.block_sectors : NUM_SECTORS_PER_ITER;
+
 		if (n_cfg.verification == 3)
 		{
 			char hashFilename[HASH_FILENAME_SZ];
@@ -166,6 +333,7 @@ static int _emmc_sd_copy_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage,
 			res = f_open(&hashFp, hashFilename, FA_CREATE_ALWAYS | FA_WRITE);
 			if (res)
 			{
+				free(lz4Index);
 				f_close(&fp);
 
 				s_printf(gui->txt_buf,
@@ -178,7 +346,7 @@ static int _emmc_sd_copy_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage,
 			}
 
 			char chunkSizeAscii[10];
-			itoa(NUM_SECTORS_PER_ITER * EMMC_BLOCKSIZE, chunkSizeAscii, 10);
+			itoa(iterSectors * EMMC_BLOCKSIZE, chunkSizeAscii, 10);
 			chunkSizeAscii[9] = '\0';
 
 			f_puts("# chunksize: ", &hashFp);
@@ -186,7 +354,7 @@ static int _emmc_sd_copy_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage,
 			f_puts("\n", &hashFp);
 		}
 
-		u32 totalSectorsVer = (u32)((u64)f_size(&fp) >> (u64)9);
+		u32 totalSectorsVer = lz4Img ? lz4Ftr.sectors : (u32)((u64)f_size(&fp) >> (u64)9);
 
 		u8 *bufEm = (u8 *)EMMC_BUF_ALIGNED;
 		u8 *bufSd = (u8 *)SDXC_BUF_ALIGNED;
@@ -204,7 +372,7 @@ static int _emmc_sd_copy_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage,
 		u32 num = 0;
 		while (totalSectorsVer > 0)
 		{
-			num = MIN(totalSectorsVer, NUM_SECTORS_PER_ITER);
+			num = MIN(totalSectorsVer, iterSectors);
 
 			// Check every time or every 4.
 			// Every 4 protects from fake sd, sector corruption and frequent I/O corruption.
@@ -221,6 +389,7 @@ static int _emmc_sd_copy_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage,
 					manual_system_maintenance(true);
 
 					free(clmt);
+					free(lz4Index);
 					f_close(&fp);
 					if (n_cfg.verification == 3)
 						f_close(&hashFp);
@@ -229,10 +398,19 @@ static int _emmc_sd_copy_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage,
 				}
 				manual_system_maintenance(false);
 
+				// Hash eMMC data while SD is read. A batch would hash both only after the SD read.
 				se_sha_hash_256_async(hashEm, bufEm, num << 9);
 
-				f_lseek(&fp, (u64)sdFileSector << (u64)9);
-				if (f_read_fast(&fp, bufSd, num << 9))
+				int res_sd;
+				if (!lz4Img)
+				{
+					f_lseek(&fp, (u64)sdFileSector << (u64)9);
+					res_sd = f_read_fast(&fp, bufSd, num << 9);
+				}
+				else
+					res_sd = _lz4_img_block_read(&fp, &lz4Index[sdFileSector / iterSectors], bufSd, (u8 *)LZ4_IMG_CBUF, num << 9);
+
+				if (res_sd)
 				{
 					s_printf(gui->txt_buf,
 						"\n#FF0000 从SD卡读取%d块（@LBA %08X）失败！#\n"
@@ -242,6 +420,7 @@ static int _emmc_sd_copy_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage,
 					manual_system_maintenance(true);
 
 					free(clmt);
+					free(lz4Index);
 					f_close(&fp);
 					if (n_cfg.verification == 3)
 						f_close(&hashFp);
@@ -263,6 +442,7 @@ static int _emmc_sd_copy_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage,
 					manual_system_maintenance(true);
 
 					free(clmt);
+					free(lz4Index);
 					f_close(&fp);
 					if (n_cfg.verification == 3)
 						f_close(&hashFp);
@@ -314,6 +494,7 @@ static int _emmc_sd_copy_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage,
 				msleep(1000);
 
 				free(clmt);
+				free(lz4Index);
 				f_close(&fp);
 				f_close(&hashFp);
 
@@ -321,6 +502,7 @@ static int _emmc_sd_copy_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage,
 			}
 		}
 		free(clmt);
+		free(lz4Index);
 		f_close(&fp);
 		f_close(&hashFp);
 
@@ -341,6 +523,283 @@ static int _emmc_sd_copy_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage,
 	}
 }
 
+static int _dump_emmc_part_lz4(emmc_tool_gui_t *gui, char *outFilename, u32 sdPathLen, sdmmc_storage_t *storage, emmc_part_t *part, u32 multipartSplitSize, u32 verification)
+{
+	static const u32 FAT32_FILESIZE_LIMIT = 0xFFFFFFFF;
+
+	u32 totalSectors = part->lba_end - part->lba_start + 1;
+	u32 numBlocks = (totalSectors + NUM_SECTORS_PER_ITER - 1) / NUM_SECTORS_PER_ITER;
+	u32 lba_curr = part->lba_start;
+	u32 lbaStartPart = part->lba_start;
+	u32 currPartIdx = 0;
+	u32 prevPct = 200;
+	u32 pct = 0;
+	u32 num = 0;
+	u64 bytesOut = 0;
+	int res = 0;
+
+	// Split only if the raw image would not fit in a single FAT32 file.
+	bool split = (sd_fs.fs_type != FS_EXFAT) && totalSectors > (FAT32_FILESIZE_LIMIT / EMMC_BLOCKSIZE);
+
+	strcpy(&outFilename[sdPathLen], LZ4_IMG_EXT);
+	sdPathLen += strlen(LZ4_IMG_EXT);
+	if (split)
+	{
+		outFilename[sdPathLen++] = '.';
+		_update_filename(outFilename, sdPathLen, 0);
+	}
+
+	FIL fp;
+	if (!f_open(&fp, outFilename, FA_READ))
+	{
+		f_close(&fp);
+
+		lv_obj_t *warn_mbox_bg = create_mbox_text(
+			"#FFDD00 检测到备份已存在！#\n\n"
+			"按#FF8000 电源键#继续。\n按#FF8000 音量键#中止。", false);
+		manual_system_maintenance(true);
+
+		if (!(btn_wait() & BTN_POWER))
+		{
+			lv_obj_del(warn_mbox_bg);
+			return 1;
+		}
+		lv_obj_del(warn_mbox_bg);
+	}
+
+	s_printf(gui->txt_buf, "#96FF00 文件路径：#\n%s\n#96FF00 文件名：# #FF8000 %s#",
+		gui->base_path, outFilename + strlen(gui->base_path));
+	lv_label_ins_text(gui->label_info, LV_LABEL_POS_LAST, gui->txt_buf);
+	manual_system_maintenance(true);
+
+	lz4_img_ftr_t ftr;
+	res = _lz4_img_part_create(&fp, &ftr, outFilename, 0, totalSectors);
+	if (res)
+	{
+		s_printf(gui->txt_buf, "\n#FF0000 创建文件 # #FFDD00 %s # #FF0000 时出错（%d）#\n", outFilename, res);
+		lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+		manual_system_maintenance(true);
+
+		return 1;
+	}
+
+	u8 *buf = (u8 *)MIXD_BUF_ALIGNED;
+	u8 *cbuf = (u8 *)LZ4_IMG_CBUF;
+	lz4_img_blk_t *index = (lz4_img_blk_t *)malloc(numBlocks * sizeof(lz4_img_blk_t));
+	lz4_img_blk_t *partIndex = index;
+	u8 *zeroData = NULL;
+	u32 zeroSize = 0;
+	u32 zeroCsize = 0;
+
+	lv_obj_set_opa_scale(gui->bar, LV_OPA_COVER);
+	lv_obj_set_opa_scale(gui->label_pct, LV_OPA_COVER);
+	while (totalSectors > 0)
+	{
+		int retryCount = 0;
+		num = MIN(totalSectors, NUM_SECTORS_PER_ITER);
+
+		while (sdmmc_storage_read(storage, lba_curr, num, buf))
+		{
+			s_printf(gui->txt_buf,
+				"\n#FFDD00 从eMMC读取位于逻辑块地址@LBA %08X处的%d个数据块出错！#\n"
+				"#FFDD00 （尝试次数：%d）。#",
+				lba_curr, num, ++retryCount);
+			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+			manual_system_maintenance(true);
+
+			msleep(150);
+			if (retryCount >= 3)
+			{
+				strcpy(gui->txt_buf, "#FF0000 正在中止...#\n请重试...\n");
+				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+				manual_system_maintenance(true);
+
+				goto abort;
+			}
+			else
+			{
+				strcpy(gui->txt_buf, "#FFDD00 正在重试...#\n");
+				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+				manual_system_maintenance(true);
+			}
+		}
+		manual_system_maintenance(false);
+
+		// Compress block. Zero blocks reuse the first compressed one and incompressible ones are stored.
+		u32 size = num << 9;
+		u32 csize;
+		u8 *data = cbuf;
+		bool zero = _lz4_img_is_zero(buf, size);
+		if (zero && size == zeroSize)
+		{
+			csize = zeroCsize;
+			data = zeroData;
+		}
+		else
+		{
+			csize = LZ4_compress_fast((const char *)buf, (char *)cbuf, size, LZ4_compressBound(size), LZ4_IMG_ACCEL);
+			if (!csize || csize >= size)
+			{
+				csize = size | LZ4_IMG_BLK_STORED;
+				data = buf;
+			}
+			else if (zero && !zeroData)
+			{
+				zeroData = (u8 *)malloc(csize);
+				memcpy(zeroData, cbuf, csize);
+				zeroSize = size;
+				zeroCsize = csize;
+			}
+		}
+		u32 csizeData = csize & ~LZ4_IMG_BLK_STORED;
+
+		// Start next part if this block, the end mark, the index and the footer do not fit.
+		u64 partSize = f_tell(&fp) + sizeof(u32) + csizeData + sizeof(u32) + sizeof(lz4_img_skip_hdr_t) +
+			(ftr.block_num + 1) * sizeof(lz4_img_blk_t) + sizeof(lz4_img_ftr_t);
+		if (split && ftr.block_num && partSize > multipartSplitSize)
+		{
+			res = _lz4_img_part_finish(&fp, &ftr, partIndex);
+			if (res)
+				goto write_error;
+			partIndex += ftr.block_num;
+			currPartIdx++;
+
+			if (verification)
+			{
+				// Verify part.
+				res = _emmc_sd_copy_verify(gui, storage, lbaStartPart, outFilename, part);
+				switch (res)
+				{
+				case VERIF_STATUS_OK:
+					break;
+				case VERIF_STATUS_ERROR:
+					strcpy(gui->txt_buf, "\n#FFDD00 请重试...#\n");
+					lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+					manual_system_maintenance(true);
+
+					free(zeroData);
+					free(index);
+					return 1;
+				case VERIF_STATUS_ABORT:
+					verification = 0;
+					break;
+				}
+
+				lv_bar_set_style(gui->bar, LV_BAR_STYLE_BG, gui->bar_white_bg);
+				lv_bar_set_style(gui->bar, LV_BAR_STYLE_INDIC, gui->bar_white_ind);
+			}
+
+			_update_filename(outFilename, sdPathLen, currPartIdx);
+
+			// Create next part.
+			s_printf(gui->txt_buf, "%s#", outFilename + strlen(gui->base_path));
+			lv_label_cut_text(gui->label_info,
+				strlen(lv_label_get_text(gui->label_info)) - strlen(outFilename + strlen(gui->base_path)) - 1,
+				strlen(outFilename + strlen(gui->base_path)) + 1);
+			lv_label_ins_text(gui->label_info, LV_LABEL_POS_LAST, gui->txt_buf);
+			manual_system_maintenance(true);
+			lbaStartPart = lba_curr;
+
+			res = _lz4_img_part_create(&fp, &ftr, outFilename, lba_curr - part->lba_start, part->lba_end - part->lba_start + 1);
+			if (res)
+			{
+				s_printf(gui->txt_buf, "\n#FF0000 创建文件 # #FFDD00 %s # #FF0000 时出错（%d）#\n", outFilename, res);
+				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+				manual_system_maintenance(true);
+
+				free(zeroData);
+				free(index);
+				return 1;
+			}
+		}
+
+		res = _lz4_img_block_write(&fp, &partIndex[ftr.block_num], data, csize, zero ? LZ4_IMG_BLK_ZERO : 0);
+		if (res)
+			goto write_error;
+		ftr.block_num++;
+		ftr.sectors += num;
+		bytesOut += csizeData;
+
+		manual_system_maintenance(false);
+
+		pct = (u64)((u64)(lba_curr - part->lba_start) * 100u) / (u64)(part->lba_end - part->lba_start);
+		if (pct != prevPct)
+		{
+			lv_bar_set_value(gui->bar, pct);
+			s_printf(gui->txt_buf, " "SYMBOL_DOT" %d%%", pct);
+			lv_label_set_text(gui->label_pct, gui->txt_buf);
+			manual_system_maintenance(true);
+			prevPct = pct;
+		}
+
+		lba_curr += num;
+		totalSectors -= num;
+
+		// Check for cancellation combo.
+		if (btn_read_vol() == (BTN_VOL_UP | BTN_VOL_DOWN))
+		{
+			strcpy(gui->txt_buf, "\n#FFDD00 备份已取消！#\n");
+			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+			manual_system_maintenance(true);
+
+			msleep(1500);
+
+			goto abort;
+		}
+	}
+
+	res = _lz4_img_part_finish(&fp, &ftr, partIndex);
+	free(zeroData);
+	free(index);
+	if (res)
+	{
+		s_printf(gui->txt_buf, "\n#FF0000 写入SD卡时发生严重错误（%d）#\n请重试...\n", res);
+		lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+		manual_system_maintenance(true);
+
+		f_unlink(outFilename);
+
+		return 1;
+	}
+
+	lv_bar_set_value(gui->bar, 100);
+	lv_label_set_text(gui->label_pct, " "SYMBOL_DOT" 100%");
+	s_printf(gui->txt_buf, "\n#96FF00 LZ4压缩后大小：#%dMiB\n", (u32)(bytesOut >> 20));
+	lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+	manual_system_maintenance(true);
+
+	if (verification)
+	{
+		// Verify last part or single file backup.
+		if (_emmc_sd_copy_verify(gui, storage, lbaStartPart, outFilename, part) == VERIF_STATUS_ERROR)
+		{
+			strcpy(gui->txt_buf, "\n#FFDD00 请重试...#\n");
+			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+			manual_system_maintenance(true);
+
+			return 1;
+		}
+		lv_bar_set_value(gui->bar, 100);
+		lv_label_set_text(gui->label_pct, " "SYMBOL_DOT" 100%");
+		manual_system_maintenance(true);
+	}
+
+	return 0;
+
+write_error:
+	s_printf(gui->txt_buf, "\n#FF0000 写入SD卡时发生严重错误（%d）#\n请重试...\n", res);
+	lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+	manual_system_maintenance(true);
+
+abort:
+	f_close(&fp);
+	free(zeroData);
+	free(index);
+	f_unlink(outFilename);
+
+	return 1;
+}
+
 bool partial_sd_full_unmount = false;
 
 static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part, sdmmc_storage_t *storage, emmc_part_t *part)
@@ -371,6 +830,9 @@ static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part,
 	char partialIdxFilename[12];
 	strcpy(partialIdxFilename, "partial.idx");
 
+	// Compressed size is unknown, so free space is only checked while writing.
+	bool compress = n_cfg.backup_compress && !gui->raw_emummc;
+
 	if (gui->raw_emummc)
 	{
 		_get_valid_partition(&sector_start, &sector_size, &part_idx, true);
@@ -410,7 +872,7 @@ static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part,
 	maxSplitParts = (sd_fs.free_clst * sd_fs.csize) / (multipartSplitSize / EMMC_BLOCKSIZE);
 
 	// Check if the USER partition or the RAW eMMC fits the sd card free space.
-	if (totalSectors > (sd_fs.free_clst * sd_fs.csize))
+	if (!compress && totalSectors > (sd_fs.free_clst * sd_fs.csize))
 	{
 		isSmallSdCard = true;
 
@@ -437,6 +899,7 @@ static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part,
 		partialDumpInProgress = true;
 		// Force partial dumping, even if the card is larger.
 		isSmallSdCard = true;
+		compress = false;
 
 		f_read(&partialIdxFp, &currPartIdx, 4, NULL);
 		f_close(&partialIdxFp);
@@ -460,6 +923,9 @@ static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part,
 		manual_system_maintenance(true);
 	}
 
+	if (compress)
+		return _dump_emmc_part_lz4(gui, outFilename, sdPathLen, storage, part, multipartSplitSize, verification);
+
 	// Check if filesystem is FAT32 or the free space is smaller and backup in parts.
 	if (((sd_fs.fs_type != FS_EXFAT) && totalSectors > (FAT32_FILESIZE_LIMIT / EMMC_BLOCKSIZE)) || isSmallSdCard)
 	{
@@ -967,6 +1433,287 @@ out:
 	}
 }
 
+static bool _storage_chunk_matches(sdmmc_storage_t *storage, u32 lba, u32 num, const u8 *buf)
+{
+	u8 hashNew[SE_SHA_256_SIZE];
+	u8 hashCurr[SE_SHA_256_SIZE];
+	u8 *bufCurr = (u8 *)SDXC_BUF_ALIGNED;
+
+	// Hash new data while the current one is read.
+	se_sha_hash_256_async(hashNew, buf, num << 9);
+	int res = sdmmc_storage_read(storage, lba, num, bufCurr);
+	se_sha_hash_256_finalize(hashNew);
+	if (res)
+		return false;
+
+	se_sha_hash_256_oneshot(hashCurr, bufCurr, num << 9);
+
+	return !memcmp(hashNew, hashCurr, SE_SHA_256_SIZE);
+}
+
+static void _restore_skip_summary(emmc_tool_gui_t *gui, u32 sectors, u32 sectorsSkipped)
+{
+	if (!n_cfg.restore_compare)
+		return;
+
+	s_printf(gui->txt_buf, "\n#96FF00 相同数据已跳过：#%dMiB，#96FF00 已写入：#%dMiB\n",
+		sectorsSkipped >> 11, (sectors - sectorsSkipped) >> 11);
+	lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+	manual_system_maintenance(true);
+}
+
+static int _restore_emmc_part_lz4(emmc_tool_gui_t *gui, char *outFilename, u32 sdPathLen, sdmmc_storage_t *storage, emmc_part_t *part, u32 verification)
+{
+	u32 partSectors = part->lba_end - part->lba_start + 1;
+	u32 lba_end = part->lba_end;
+	u32 lba_curr = part->lba_start;
+	u32 lbaStartPart = part->lba_start;
+	u32 currPartIdx = 0;
+	u32 prevPct = 200;
+	u32 pct = 0;
+	u32 num = 0;
+	u32 sectorsSkipped = 0;
+	int res = 0;
+	bool split = false;
+
+	FIL fp;
+	FILINFO fno;
+	lz4_img_ftr_t ftr;
+	lz4_img_blk_t *index = NULL;
+
+	// Check for a single or split compressed backup.
+	strcpy(&outFilename[sdPathLen], LZ4_IMG_EXT);
+	u32 lz4PathLen = sdPathLen + strlen(LZ4_IMG_EXT);
+	if (f_stat(outFilename, &fno))
+	{
+		outFilename[lz4PathLen++] = '.';
+		_update_filename(outFilename, lz4PathLen, 0);
+		if (f_stat(outFilename, &fno))
+		{
+			outFilename[sdPathLen] = 0;
+			return 2;
+		}
+		split = true;
+	}
+
+	s_printf(gui->txt_buf, "#96FF00 文件路径：#\n%s\n#96FF00 文件名：# #FF8000 %s#",
+		gui->base_path, outFilename + strlen(gui->base_path));
+	lv_label_ins_text(gui->label_info, LV_LABEL_POS_LAST, gui->txt_buf);
+	manual_system_maintenance(true);
+
+	u8 *buf = (u8 *)MIXD_BUF_ALIGNED;
+	u8 *cbuf = (u8 *)LZ4_IMG_CBUF;
+
+	lv_obj_set_opa_scale(gui->bar, LV_OPA_COVER);
+	lv_obj_set_opa_scale(gui->label_pct, LV_OPA_COVER);
+	while (true)
+	{
+		res = f_open(&fp, outFilename, FA_READ);
+		if (res)
+		{
+			s_printf(gui->txt_buf, "\n#FF0000 打开文件 # #FFDD00 %s # #FFDD00 时出错（%d）！#\n", outFilename, res);
+			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+			manual_system_maintenance(true);
+
+			return 1;
+		}
+
+		// Parts must be contiguous and within the selected partition.
+		if (_lz4_img_index_read(&fp, &ftr, &index) ||
+			ftr.lba_offset != (lba_curr - part->lba_start) ||
+			(ftr.lba_offset + ftr.sectors) > ftr.total_sectors)
+		{
+			strcpy(gui->txt_buf, "\n#FF0000 LZ4备份文件无效或已损坏！#\n#FFDD00 正在中止...#");
+			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+			manual_system_maintenance(true);
+
+			f_close(&fp);
+			free(index);
+			return 1;
+		}
+
+		if (lba_curr == part->lba_start)
+		{
+			if (ftr.total_sectors > partSectors)
+			{
+				strcpy(gui->txt_buf, "\n#FF8000 SD卡备份的大小超过了#\n#FF8000 所选eMMC分区大小！#\n#FFDD00 正在中止...#");
+				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+				manual_system_maintenance(true);
+
+				f_close(&fp);
+				free(index);
+				return 1;
+			}
+			else if (ftr.total_sectors < partSectors)
+			{
+				lv_obj_t *warn_mbox_bg = create_mbox_text(
+					"#FF8000 SD卡备份文件大小与#\n#FF8000 eMMC所选分区的大小不匹配！#\n\n"
+					"#FFDD00 备份可能被污染！#\n#FFDD00 建议中止本次操作！#\n\n"
+					"按 #FF8000 电源键#继续。\n按 #FF8000 音量键#中止。", false);
+				manual_system_maintenance(true);
+
+				if (!(btn_wait() & BTN_POWER))
+				{
+					lv_obj_del(warn_mbox_bg);
+					strcpy(gui->txt_buf, "\n#FF0000 SD卡备份文件大小与#\n#FF0000 eMMC所选分区的大小不匹配。#\n");
+					lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+					manual_system_maintenance(true);
+
+					f_close(&fp);
+					free(index);
+					return 1;
+				}
+				lv_obj_del(warn_mbox_bg);
+
+				// Set new lba end sector for percentage calculations.
+				lba_end = ftr.total_sectors + part->lba_start - 1;
+			}
+
+			s_printf(gui->txt_buf, "\n总恢复大小：%dMiB（LZ4压缩）。\n", ftr.total_sectors >> 11);
+			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+			manual_system_maintenance(true);
+		}
+
+		for (u32 blk = 0; blk < ftr.block_num; blk++)
+		{
+			int retryCount = 0;
+			num = MIN(ftr.block_sectors, ftr.sectors - blk * ftr.block_sectors);
+
+			res = _lz4_img_block_read(&fp, &index[blk], buf, cbuf, num << 9);
+			manual_system_maintenance(false);
+
+			if (res)
+			{
+				s_printf(gui->txt_buf,
+					"\n#FF0000 读取SD卡发生严重错误（%d）！#\n"
+					"#FF0000 此设备可能处于非工作状态！#\n"
+					"#FFDD00 请立刻重试！#\n", res);
+				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+				manual_system_maintenance(true);
+
+				f_close(&fp);
+				free(index);
+				return 1;
+			}
+
+			// Skip chunks that already match.
+			if (n_cfg.restore_compare && _storage_chunk_matches(storage, lba_curr, num, buf))
+			{
+				res = 0;
+				sectorsSkipped += num;
+			}
+			else
+				res = sdmmc_storage_write(storage, lba_curr, num, buf);
+			manual_system_maintenance(false);
+
+			while (res)
+			{
+				s_printf(gui->txt_buf,
+					"\n#FFDD00 从eMMC写入位于逻辑块地址@LBA %08X处的%d个数据块时出错。#\n"
+					"#FFDD00 （尝试次数：%d）。#",
+					lba_curr, num, ++retryCount);
+				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+				manual_system_maintenance(true);
+
+				msleep(150);
+				if (retryCount >= 3)
+				{
+					strcpy(gui->txt_buf, "#FF0000 正在中止...#\n"
+						"#FF0000 此设备可能处于非工作状态！#\n"
+						"#FFDD00 请立刻重试！#\n");
+					lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+					manual_system_maintenance(true);
+
+					f_close(&fp);
+					free(index);
+					return 1;
+				}
+				else
+				{
+					strcpy(gui->txt_buf, "#FFDD00 正在重试...#\n");
+					lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+					manual_system_maintenance(true);
+				}
+				res = sdmmc_storage_write(storage, lba_curr, num, buf);
+				manual_system_maintenance(false);
+			}
+
+			pct = (u64)((u64)(lba_curr - part->lba_start) * 100u) / (u64)(lba_end - part->lba_start);
+			if (pct != prevPct)
+			{
+				lv_bar_set_value(gui->bar, pct);
+				s_printf(gui->txt_buf, " "SYMBOL_DOT" %d%%", pct);
+				lv_label_set_text(gui->label_pct, gui->txt_buf);
+				manual_system_maintenance(true);
+				prevPct = pct;
+			}
+
+			lba_curr += num;
+		}
+
+		f_close(&fp);
+		free(index);
+		index = NULL;
+
+		// Show summary before verification.
+		if ((lba_curr - part->lba_start) >= ftr.total_sectors)
+			_restore_skip_summary(gui, lba_curr - part->lba_start, sectorsSkipped);
+
+		if (verification)
+		{
+			// Verify part.
+			res = _emmc_sd_copy_verify(gui, storage, lbaStartPart, outFilename, part);
+			switch (res)
+			{
+			case VERIF_STATUS_OK:
+				break;
+			case VERIF_STATUS_ERROR:
+				strcpy(gui->txt_buf, "\n#FFDD00 请重试...#\n");
+				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+				manual_system_maintenance(true);
+				return 1;
+			case VERIF_STATUS_ABORT:
+				verification = 0;
+				break;
+			}
+			lv_bar_set_style(gui->bar, LV_BAR_STYLE_BG, gui->bar_orange_bg);
+			lv_bar_set_style(gui->bar, LV_BAR_STYLE_INDIC, gui->bar_orange_ind);
+		}
+
+		lbaStartPart = lba_curr;
+
+		if ((lba_curr - part->lba_start) >= ftr.total_sectors)
+			break;
+
+		// Single file must hold the whole image.
+		if (!split)
+		{
+			strcpy(gui->txt_buf, "\n#FF0000 LZ4备份文件无效或已损坏！#\n#FFDD00 正在中止...#");
+			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+			manual_system_maintenance(true);
+
+			return 1;
+		}
+
+		// Read from next part.
+		currPartIdx++;
+		_update_filename(outFilename, lz4PathLen, currPartIdx);
+
+		s_printf(gui->txt_buf, "%s#", outFilename + strlen(gui->base_path));
+		lv_label_cut_text(gui->label_info,
+			strlen(lv_label_get_text(gui->label_info)) - strlen(outFilename + strlen(gui->base_path)) - 1,
+			strlen(outFilename + strlen(gui->base_path)) + 1);
+		lv_label_ins_text(gui->label_info, LV_LABEL_POS_LAST, gui->txt_buf);
+		manual_system_maintenance(true);
+	}
+
+	lv_bar_set_value(gui->bar, 100);
+	lv_label_set_text(gui->label_pct, " "SYMBOL_DOT" 100%");
+	manual_system_maintenance(true);
+
+	return 0;
+}
+
 static int _restore_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part, sdmmc_storage_t *storage, emmc_part_t *part, bool allow_multi_part)
 {
 	static const u32 SECTORS_TO_MIB_COEFF = 11;
@@ -995,6 +1742,14 @@ static int _restore_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_pa
 	bool use_multipart = false;
 	bool check_4MB_aligned = true;
 
+	// Use compressed backup if found.
+	if (!gui->raw_emummc)
+	{
+		res = _restore_emmc_part_lz4(gui, outFilename, sdPathLen, storage, part, verification);
+		if (res != 2)
+			return res;
+	}
+
 	if (!allow_multi_part)
 		goto multipart_not_allowed;
 
@@ -1200,6 +1955,7 @@ multipart_not_allowed:
 
 	u32 lba_curr = part->lba_start;
 	u32 bytesWritten = 0;
+	u32 sectorsSkipped = 0;
 	u32 prevPct = 200;
 	int retryCount = 0;
 
@@ -1306,7 +2062,17 @@ multipart_not_allowed:
 			free(clmt);
 			return 1;
 		}
-		if (!gui->raw_emummc)
+		// Skip chunks that already match.
+		bool skip = n_cfg.restore_compare && (!gui->raw_emummc ?
+			_storage_chunk_matches(storage, lba_curr, num, buf) :
+			_storage_chunk_matches(&sd_storage, lba_curr + sd_sector_off, num, buf));
+
+		if (skip)
+		{
+			res = 0;
+			sectorsSkipped += num;
+		}
+		else if (!gui->raw_emummc)
 			res = sdmmc_storage_write(storage, lba_curr, num, buf);
 		else
 			res = sdmmc_storage_write(&sd_storage, lba_curr + sd_sector_off, num, buf);
@@ -1369,6 +2135,8 @@ multipart_not_allowed:
 	f_close(&fp);
 	free(clmt);
 
+	_restore_skip_summary(gui, lba_curr - part->lba_start, sectorsSkipped);
+
 	if (verification && !gui->raw_emummc)
 	{
 		// Verify restored data.
@@ -1602,15 +2370,17 @@ void restore_emmc_selected(emmcPartType_t restoreType, emmc_tool_gui_t *gui)
 		}
 	}
 
-	timer = get_tmr_s() - timer;
+	// Include eMMC cache write back in the time taken.
+	bool cache_en = emmc_storage.ext_csd.cache_ctrl;
 	emmc_end();
+	timer = get_tmr_s() - timer;
 
 	if (!res && n_cfg.verification && !gui->raw_emummc)
-		s_printf(txt_buf, "耗时：%d分%d秒。\n#96FF00 完成并通过校验！#", timer / 60, timer % 60);
+		s_printf(txt_buf, "耗时：%d分%d秒%s。\n#96FF00 完成并通过校验！#", timer / 60, timer % 60, cache_en ? " (eMMC缓存)" : "");
 	else if (!res)
-		s_printf(txt_buf, "耗时：%d分%d秒。\n完成！", timer / 60, timer % 60);
+		s_printf(txt_buf, "耗时：%d分%d秒%s。\n完成！", timer / 60, timer % 60, cache_en ? " (eMMC缓存)" : "");
 	else
-		s_printf(txt_buf, "耗时：%d分%d秒。", timer / 60, timer % 60);
+		s_printf(txt_buf, "耗时：%d分%d秒%s。", timer / 60, timer % 60, cache_en ? " (eMMC缓存)" : "");
 
 	lv_label_set_text(gui->label_finish, txt_buf);
 
@@ -31,6 +31,7 @@
 static const char base36[37] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
 
 extern volatile nyx_storage_t *nyx_str;
+extern nyx_boot_time_t nyx_boot_time;
 
 extern lv_res_t launch_payload(lv_obj_t *list);
 extern char *emmcsn_path_impl(char *path, char *sub_dir, char *filename, sdmmc_storage_t *storage);
@@ -1226,6 +1227,24 @@ static lv_res_t _create_window_hw_info_status(lv_obj_t *btn)
 	s_printf(txt_buf + strlen(txt_buf), "\n#FF8000 ID：# #96FF00 %02X# %02X #96FF00 %02X#",
 		nyx_str->info.panel_id & 0xFF, (nyx_str->info.panel_id >> 8) & 0xFF, (nyx_str->info.panel_id >> 16) & 0xFF);
 
+	// Print boot display/storage init times. eMMC is 0 if hekate did not use it.
+	nyx_boot_time_t *boot_time = (nyx_boot_time_t *)&nyx_str->info_ex.boot_time;
+	if (boot_time->total)
+	{
+		s_printf(txt_buf + strlen(txt_buf),
+			"\n#FF8000 启动初始化：# %d ms (显示 %d, SD %d, eMMC %d)",
+			boot_time->total / 1000, boot_time->display / 1000, boot_time->sd / 1000, boot_time->emmc / 1000);
+	}
+
+	// Print Nyx storage init wall time and the sum of its overlapped parts.
+	if (nyx_boot_time.total)
+	{
+		s_printf(txt_buf + strlen(txt_buf),
+			"\n#FF8000 Nyx存储初始化：# %d ms (SD %d + eMMC %d = %d, 并行)",
+			nyx_boot_time.total / 1000, nyx_boot_time.sd / 1000, nyx_boot_time.emmc / 1000,
+			(nyx_boot_time.sd + nyx_boot_time.emmc) / 1000);
+	}
+
 	// Prepare touch panel/ic info.
 	touch_fw_info_t touch_fw;
 	if (!touch_get_fw_info(&touch_fw))
@@ -2151,10 +2170,128 @@ static lv_res_t _create_mbox_sd_bench(lv_obj_t * btn)
 	return LV_RES_OK;
 }
 
+static u32 _io_stats_dev;
+
+static lv_res_t _io_stats_action(lv_obj_t *btns, const char * txt)
+{
+	int btn_idx = lv_btnm_get_pressed(btns);
+
+	nyx_mbox_action(btns, txt);
+
+	if (btn_idx == 1)
+		sdmmc_stats_reset(_io_stats_dev);
+
+	return LV_RES_INV;
+}
+
+static lv_res_t _create_mbox_io_stats(u32 dev)
+{
+	static const char *lat_units[] = { "us", "ms", "s" };
+
+	lv_obj_t *dark_bg = lv_obj_create(lv_scr_act(), NULL);
+	lv_obj_set_style(dark_bg, &mbox_darken);
+	lv_obj_set_size(dark_bg, LV_HOR_RES, LV_VER_RES);
+
+	static const char * mbox_btn_map[] = { "\251", "\222清零", "\222确定", "\251", "" };
+	lv_obj_t * mbox = lv_mbox_create(dark_bg, NULL);
+	lv_mbox_set_recolor_text(mbox, true);
+	lv_obj_set_width(mbox, LV_HOR_RES / 9 * 5);
+
+	_io_stats_dev = dev;
+
+	char *txt_buf = (char *)malloc(SZ_16K);
+	char *csv_buf = (char *)malloc(SZ_16K);
+	char path[128];
+
+	s_printf(txt_buf, "#FF8000 %s I/O统计#", dev == SDMMC_STATS_DEV_SD ? "SD卡" : "eMMC");
+	lv_mbox_set_text(mbox, txt_buf);
+
+	lv_obj_t *lb_desc = lv_label_create(mbox, NULL);
+	lv_label_set_long_mode(lb_desc, LV_LABEL_LONG_BREAK);
+	lv_label_set_recolor(lb_desc, true);
+	lv_label_set_style(lb_desc, &monospace_text);
+	lv_obj_set_width(lb_desc, LV_HOR_RES / 9 * 4);
+
+	// Build CSV first, so that its own export does not show up.
+	sdmmc_stats_to_csv(dev, csv_buf);
+
+	sdmmc_stats_t *stats = sdmmc_stats_get(dev);
+	txt_buf[0] = 0;
+	for (u32 i = 0; i < SDMMC_STATS_OP_MAX; i++)
+	{
+		sdmmc_stats_op_t *op = &stats->op[i];
+		s_printf(txt_buf + strlen(txt_buf), "#00DDFF %s：# %d次, %d MiB, 平均 %d us, 最大 %d us\n",
+			i == SDMMC_STATS_OP_READ ? "读取" : "写入", op->count, op->sectors >> SECTORS_TO_MIB_COEFF,
+			op->count ? (u32)(op->time_us / op->count) : 0, op->max_us);
+	}
+	s_printf(txt_buf + strlen(txt_buf), "#00DDFF DMA等待：# %d ms  #00DDFF 重试：# %d\n",
+		(u32)(stats->dma_wait_us / 1000), stats->retries);
+	s_printf(txt_buf + strlen(txt_buf), "#00DDFF 调谐：# %d次, Tap %d (%d - %d)\n\n",
+		stats->tunings, stats->tap_last, stats->tap_min, stats->tap_max);
+
+	// Latency histogram, all op sizes combined.
+	strcat(txt_buf, "#FF8000 延迟       读取       写入#");
+	for (u32 lat_bucket = 0; lat_bucket < SDMMC_STATS_LAT_BUCKETS; lat_bucket++)
+	{
+		u32 count[SDMMC_STATS_OP_MAX] = { 0 };
+		for (u32 i = 0; i < SDMMC_STATS_OP_MAX; i++)
+			for (u32 size_class = 0; size_class < SDMMC_STATS_SIZE_CLASSES; size_class++)
+				count[i] += stats->op[i].hist[size_class][lat_bucket];
+
+		if (!count[SDMMC_STATS_OP_READ] && !count[SDMMC_STATS_OP_WRITE])
+			continue;
+
+		u32 lat = 1 << lat_bucket;
+		u32 unit = 0;
+		while (lat >= 1024 && unit < 2)
+		{
+			lat >>= 10;
+			unit++;
+		}
+		s_printf(txt_buf + strlen(txt_buf), "\n>=%4d %s %10d %10d", lat, lat_units[unit],
+			count[SDMMC_STATS_OP_READ], count[SDMMC_STATS_OP_WRITE]);
+	}
+
+	// Export to SD.
+	if (!sd_mount())
+	{
+		emmcsn_path_impl(path, "/dumps", dev == SDMMC_STATS_DEV_SD ? "sd_io_stats.csv" : "emmc_io_stats.csv", NULL);
+		if (!sd_save_to_file(csv_buf, strlen(csv_buf), path))
+			s_printf(txt_buf + strlen(txt_buf), "\n\n已导出：#C7EA46 %s#", path);
+		sd_unmount();
+	}
+
+	lv_label_set_text(lb_desc, txt_buf);
+
+	free(txt_buf);
+	free(csv_buf);
+
+	lv_mbox_add_btns(mbox, mbox_btn_map, _io_stats_action); // Important. After set_text.
+	lv_obj_align(mbox, NULL, LV_ALIGN_CENTER, 0, 0);
+	lv_obj_set_top(mbox, true);
+
+	return LV_RES_OK;
+}
+
+static lv_res_t _create_mbox_emmc_io_stats(lv_obj_t * btn)
+{
+	_create_mbox_io_stats(SDMMC_STATS_DEV_EMMC);
+
+	return LV_RES_OK;
+}
+
+static lv_res_t _create_mbox_sd_io_stats(lv_obj_t * btn)
+{
+	_create_mbox_io_stats(SDMMC_STATS_DEV_SD);
+
+	return LV_RES_OK;
+}
+
 static lv_res_t _create_window_emmc_info_status(lv_obj_t *btn)
 {
 	lv_obj_t *win = nyx_create_standard_window(SYMBOL_CHIP" 内部eMMC信息", NULL);
 	lv_win_add_btn(win, NULL, SYMBOL_CHIP" 基准测试", _create_mbox_emmc_bench);
+	lv_win_add_btn(win, NULL, SYMBOL_LIST" I/O统计", _create_mbox_emmc_io_stats);
 
 	lv_obj_t *desc = lv_cont_create(win, NULL);
 	lv_obj_set_size(desc, LV_HOR_RES / 2 / 6 * 2, LV_VER_RES - (LV_DPI * 11 / 7) - 5);
@@ -2300,12 +2437,13 @@ static lv_res_t _create_window_emmc_info_status(lv_obj_t *btn)
 	}
 
 	s_printf(txt_buf + strlen(txt_buf),
-		"#00DDFF V1.%d (修订版本 1.%d)#\n%02X\n%s\n%dMB/s (%dMHz)\n%dMiB\n%d %s\n\n%s\nA：%s, B：%s\n%s",
+		"#00DDFF V1.%d (修订版本 1.%d)#\n%02X\n%s\n%dMB/s (%dMHz)\n%dMiB\n%d %s%s\n\n%s\nA：%s, B：%s\n%s",
 		emmc_storage.ext_csd.ext_struct, emmc_storage.ext_csd.rev,
 		emmc_storage.csd.cmdclass, max_bus_support,
 		emmc_storage.csd.busspeed, bus_clock,
 		emmc_storage.ext_csd.max_enh_mult * EMMC_BLOCKSIZE / 1024,
 		!(cache % 1024) ? (cache / 1024) : cache, !(cache % 1024) ? "MiB" : "KiB",
+		emmc_storage.ext_csd.cache_ctrl ? " (已启用)" : "",
 		bkops,
 		life_a_txt, life_b_txt, rsvd_blocks);
 
@@ -2441,6 +2579,7 @@ static lv_res_t _create_window_sdcard_info_status(lv_obj_t *btn)
 {
 	lv_obj_t *win = nyx_create_standard_window(SYMBOL_SD" microSD卡信息", NULL);
 	lv_win_add_btn(win, NULL, SYMBOL_SD" 基准测试", _create_mbox_sd_bench);
+	lv_win_add_btn(win, NULL, SYMBOL_LIST" I/O统计", _create_mbox_sd_io_stats);
 	lv_win_add_btn(win, NULL, SYMBOL_FILE_ALT" 厂商寄存器", _create_mbox_sd_vendor_info);
 
 	lv_obj_t *desc = lv_cont_create(win, NULL);
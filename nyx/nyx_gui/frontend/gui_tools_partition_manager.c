@@ -25,6 +25,8 @@
 #include "../hos/hos.h"
 #include <libs/fatfs/diskio.h>
 #include <libs/lvgl/lvgl.h>
+#include <libs/compr/lz4_frame.h>
+#include <utils/simg.h>
 
 #define SECTORS_PER_GB   0x200000
 
@@ -101,8 +103,41 @@ typedef struct _l4t_flasher_ctxt_t
 {
 	u32 offset_sct;
 	u32 image_size_sct;
+	u32 part_size_sct;
+	u64 file_size;
+	bool sparse;
+	bool compressed;
 } l4t_flasher_ctxt_t;
 
+typedef struct _l4t_stream_ctxt_t
+{
+	FIL fp;
+	char *path;
+	u32 path_len;
+	u32 part_idx;
+	bool error;
+
+	u64 bytes_read;
+	u32 prev_pct;
+	lv_obj_t *bar;
+	lv_obj_t *label_pct;
+	char *txt_buf;
+} l4t_stream_ctxt_t;
+
+typedef struct _mem_stream_ctxt_t
+{
+	const u8 *buf;
+	u32 size;
+	u32 pos;
+} mem_stream_ctxt_t;
+
+typedef struct _part_stream_ctxt_t
+{
+	u32 offset_sct;
+	u32 size_sct;
+	int error;
+} part_stream_ctxt_t;
+
 partition_ctxt_t part_info;
 l4t_flasher_ctxt_t l4t_flash_ctxt;
 
@@ -752,6 +787,304 @@ static lv_res_t _action_delete_linux_installer_files(lv_obj_t * btns, const char
 	return LV_RES_INV;
 }
 
+static void _l4t_part_path(char *path, u32 path_len, u32 idx)
+{
+	if (idx < 10)
+	{
+		path[path_len] = '0';
+		itoa(idx, &path[path_len + 1], 10);
+	}
+	else
+		itoa(idx, &path[path_len], 10);
+}
+
+#define PART_STREAM_ERR_WRITE 1
+#define PART_STREAM_ERR_SIZE  2
+
+static int _part_stream_write(void *priv, u32 sct_off, u32 num, const void *buf)
+{
+	part_stream_ctxt_t *part = (part_stream_ctxt_t *)priv;
+	int retryCount = 0;
+
+	if ((u64)sct_off + num > part->size_sct)
+	{
+		part->error = PART_STREAM_ERR_SIZE;
+		return 1;
+	}
+
+	// Write data block to partition. If failed, retry 3 more times.
+	while (sdmmc_storage_write(part_info.storage, part->offset_sct + sct_off, num, (void *)buf))
+	{
+		msleep(150);
+		manual_system_maintenance(true);
+
+		if (retryCount >= 3)
+		{
+			part->error = PART_STREAM_ERR_WRITE;
+			return 1;
+		}
+		retryCount++;
+	}
+
+	manual_system_maintenance(false);
+
+	return 0;
+}
+
+static int _part_stream_flash(part_stream_ctxt_t *part, int (*read)(void *, void *, u32), void *rpriv, lz4f_ctxt_t *lz4f, bool sparse)
+{
+	// Compressed images are read through the decoder.
+	if (lz4f)
+	{
+		read  = lz4f_read;
+		rpriv = lz4f;
+	}
+
+	if (sparse)
+	{
+		simg_ctxt_t simg;
+
+		simg.read     = read;
+		simg.write    = _part_stream_write;
+		simg.rpriv    = rpriv;
+		simg.wpriv    = part;
+		simg.buf      = (u8 *)MIXD_BUF_ALIGNED;
+		simg.buf_size = SZ_4M;
+
+		// Checksum on CCPLEX while BPMP writes.
+		ccplex_worker_start();
+		int res = simg_flash(&simg);
+		ccplex_worker_stop();
+
+		if (res)
+			return 1;
+
+		// Decode up to the end mark, so the content checksum gets verified.
+		while (lz4f)
+		{
+			u8 *blk;
+			u32 size;
+
+			if (lz4f_next_block(lz4f, &blk, &size))
+				return 1;
+
+			if (!size)
+				break;
+		}
+
+		return 0;
+	}
+
+	// Decoded blocks are written in place. Only the last one can end mid-sector.
+	u32 sct_off = 0;
+	bool last = false;
+	while (true)
+	{
+		u8 *blk;
+		u32 size;
+
+		if (lz4f_next_block(lz4f, &blk, &size))
+			return 1;
+
+		if (!size)
+			break;
+
+		if (last)
+			return 1;
+
+		if (size & 0x1FF)
+		{
+			u32 size_aligned = ALIGN(size, 0x200);
+			memset(blk + size, 0, size_aligned - size);
+			size = size_aligned;
+			last = true;
+		}
+
+		if (_part_stream_write(part, sct_off, size >> 9, blk))
+			return 1;
+
+		sct_off += size >> 9;
+	}
+
+	return 0;
+}
+
+static int _l4t_stream_read(void *priv, void *buf, u32 size)
+{
+	l4t_stream_ctxt_t *ctxt = (l4t_stream_ctxt_t *)priv;
+	UINT br;
+
+	ctxt->bytes_read += size;
+
+	while (size)
+	{
+		if (f_read(&ctxt->fp, buf, size, &br))
+		{
+			ctxt->error = true;
+			return 1;
+		}
+
+		buf += br;
+		size -= br;
+
+		// Continue from the next split part.
+		if (size)
+		{
+			f_close(&ctxt->fp);
+			ctxt->part_idx++;
+			_l4t_part_path(ctxt->path, ctxt->path_len, ctxt->part_idx);
+
+			if (f_open(&ctxt->fp, ctxt->path, FA_READ))
+			{
+				ctxt->error = true;
+				return 1;
+			}
+		}
+	}
+
+	if (!ctxt->bar)
+		return 0;
+
+	// Update completion percentage.
+	u32 pct = (ctxt->bytes_read * 100u) / l4t_flash_ctxt.file_size;
+	if (pct != ctxt->prev_pct)
+	{
+		lv_bar_set_value(ctxt->bar, pct);
+		s_printf(ctxt->txt_buf, " #DDDDDD "SYMBOL_DOT"# %d%%", pct);
+		lv_label_set_text(ctxt->label_pct, ctxt->txt_buf);
+		manual_system_maintenance(true);
+		ctxt->prev_pct = pct;
+	}
+	else
+		manual_system_maintenance(false);
+
+	return 0;
+}
+
+static int _l4t_stream_probe(char *path, u32 path_len)
+{
+	l4t_stream_ctxt_t l4t_stream = { 0 };
+	lz4f_ctxt_t lz4f;
+	simg_hdr_t hdr;
+	u32 magic = 0;
+	UINT br = 0;
+	int res = 0;
+
+	l4t_stream.path     = path;
+	l4t_stream.path_len = path_len;
+
+	if (f_open(&l4t_stream.fp, path, FA_READ))
+		return 1;
+
+	f_read(&l4t_stream.fp, &magic, sizeof(u32), &br);
+	f_lseek(&l4t_stream.fp, 0);
+
+	if (br == sizeof(u32) && lz4f_is_frame(&magic))
+	{
+		l4t_flash_ctxt.compressed = true;
+
+		// Decode the first block to check for a compressed sparse image.
+		lz4f.read = _l4t_stream_read;
+		lz4f.priv = &l4t_stream;
+		if (lz4f_init(&lz4f, (void *)SDXC_BUF_ALIGNED))
+		{
+			res = 1;
+			goto out;
+		}
+
+		const simg_hdr_t *simg_hdr = lz4f_peek(&lz4f, sizeof(simg_hdr_t));
+		if (simg_hdr && simg_is_sparse(simg_hdr))
+		{
+			memcpy(&hdr, simg_hdr, sizeof(simg_hdr_t));
+			l4t_flash_ctxt.sparse = true;
+		}
+		else if (((lz4f.content_size + 0x1FF) >> 9) > 0xFFFFFFFF)
+			res = 1;
+		else
+			l4t_flash_ctxt.image_size_sct = (lz4f.content_size + 0x1FF) >> 9; // 0 if not stored.
+	}
+	else if (br == sizeof(u32) && simg_is_sparse(&magic))
+	{
+		if (_l4t_stream_read(&l4t_stream, &hdr, sizeof(simg_hdr_t)))
+		{
+			res = 1;
+			goto out;
+		}
+		l4t_flash_ctxt.sparse = true;
+	}
+
+	// Sparse images carry their output size in the header.
+	if (l4t_flash_ctxt.sparse)
+	{
+		l4t_flash_ctxt.image_size_sct = simg_image_sectors(&hdr);
+		if (!l4t_flash_ctxt.image_size_sct)
+			res = 1;
+	}
+
+out:
+	f_close(&l4t_stream.fp);
+	_l4t_part_path(path, path_len, 0);
+
+	return res;
+}
+
+static int _flash_linux_stream(lv_obj_t *lbl_status, lv_obj_t *bar, lv_obj_t *label_pct, char *path, u32 path_len, char *txt_buf)
+{
+	l4t_stream_ctxt_t l4t_stream = { 0 };
+	part_stream_ctxt_t part = { l4t_flash_ctxt.offset_sct, l4t_flash_ctxt.part_size_sct, 0 };
+	lz4f_ctxt_t lz4f;
+	int res = 0;
+
+	l4t_stream.path      = path;
+	l4t_stream.path_len  = path_len;
+	l4t_stream.prev_pct  = 200;
+	l4t_stream.bar       = bar;
+	l4t_stream.label_pct = label_pct;
+	l4t_stream.txt_buf   = txt_buf;
+
+	if (f_open(&l4t_stream.fp, path, FA_READ))
+	{
+		lv_label_set_text(lbl_status, "#FFDD00 错误：#打开第1个分区失败！");
+
+		return 1;
+	}
+
+	// Compressed images are decoded straight into the partition writes.
+	if (l4t_flash_ctxt.compressed)
+	{
+		lz4f.read = _l4t_stream_read;
+		lz4f.priv = &l4t_stream;
+		res = lz4f_init(&lz4f, (void *)SDXC_BUF_ALIGNED);
+	}
+
+	if (!res)
+		res = _part_stream_flash(&part, _l4t_stream_read, &l4t_stream, l4t_flash_ctxt.compressed ? &lz4f : NULL, l4t_flash_ctxt.sparse);
+
+	f_close(&l4t_stream.fp);
+
+	if (res)
+	{
+		if (l4t_stream.error)
+			s_printf(txt_buf, "#FFDD00 错误：#从SD卡读取（第%d分区）！", l4t_stream.part_idx);
+		else if (part.error == PART_STREAM_ERR_WRITE)
+			strcpy(txt_buf, "#FFDD00 错误：#往SD卡写入！");
+		else if (part.error == PART_STREAM_ERR_SIZE)
+			strcpy(txt_buf, "#FFDD00 错误！#镜像大小大于分区！");
+		else
+			strcpy(txt_buf, "#FFDD00 错误：#镜像已损坏！");
+		lv_label_set_text(lbl_status, txt_buf);
+		manual_system_maintenance(true);
+
+		return 1;
+	}
+
+	lv_bar_set_value(bar, 100);
+	lv_label_set_text(label_pct, " "SYMBOL_DOT" 100%");
+	manual_system_maintenance(true);
+
+	return 0;
+}
+
 static lv_res_t _action_flash_linux_data(lv_obj_t * btns, const char * txt)
 {
 	int btn_idx = lv_btnm_get_pressed(btns);
@@ -810,6 +1143,14 @@ static lv_res_t _action_flash_linux_data(lv_obj_t * btns, const char * txt)
 	strcpy(path, "switchroot/install/l4t.00");
 	u32 path_len = strlen(path) - 2;
 
+	// Sparse and compressed images are decoded while streaming and can span any number of parts.
+	if (l4t_flash_ctxt.sparse || l4t_flash_ctxt.compressed)
+	{
+		succeeded = !_flash_linux_stream(lbl_status, bar, label_pct, path, path_len, txt_buf);
+
+		goto exit;
+	}
+
 	FIL fp;
 
 	res = f_open(&fp, path, FA_READ);
@@ -845,14 +1186,7 @@ static lv_res_t _action_flash_linux_data(lv_obj_t * btns, const char * txt)
 			free(clmt);
 			memset(&fp, 0, sizeof(fp));
 			currPartIdx++;
-
-			if (currPartIdx < 10)
-			{
-				path[path_len] = '0';
-				itoa(currPartIdx, &path[path_len + 1], 10);
-			}
-			else
-				itoa(currPartIdx, &path[path_len], 10);
+			_l4t_part_path(path, path_len, currPartIdx);
 
 			// Try to open the next file part
 			res = f_open(&fp, path, FA_READ);
@@ -1078,6 +1412,16 @@ static lv_res_t _action_check_flash_linux(lv_obj_t *btn)
 		goto error;
 	}
 
+	l4t_flash_ctxt.part_size_sct = size_sct;
+
+	// Sparse and compressed images carry their output size in their headers.
+	if (_l4t_stream_probe(path, 23))
+	{
+		lv_label_set_text(lbl_status, "#FFDD00 错误：#镜像已损坏！");
+		goto error;
+	}
+	bool stream = l4t_flash_ctxt.sparse || l4t_flash_ctxt.compressed;
+
 	u32 idx = 0;
 	path[23] = 0;
 
@@ -1096,6 +1440,15 @@ static lv_res_t _action_check_flash_linux(lv_obj_t *btn)
 		if (f_stat(path, &fno))
 			break;
 
+		l4t_flash_ctxt.file_size += fno.fsize;
+
+		// Streamed images have no part alignment requirements.
+		if (stream)
+		{
+			idx++;
+			continue;
+		}
+
 		// Check if current part is unaligned.
 		if ((u64)fno.fsize % SZ_4M)
 		{
@@ -1132,11 +1485,18 @@ static lv_res_t _action_check_flash_linux(lv_obj_t *btn)
 		goto error;
 	}
 
+	// Compressed raw images may not store their size.
+	char size_txt[16];
+	if (l4t_flash_ctxt.image_size_sct)
+		s_printf(size_txt, "%dMiB", l4t_flash_ctxt.image_size_sct >> 11);
+	else
+		strcpy(size_txt, "未知");
+
 	char *txt_buf = malloc(SZ_4K);
 	s_printf(txt_buf,
 		"#C7EA46 状态：#发现安装文件和分区。\n"
-		"#00DDFF 偏移：#%08x，#00DDFF 大小：#%X，#00DDFF 镜像大小：#%dMiB\n"
-		"\n您要继续吗？", l4t_flash_ctxt.offset_sct, size_sct, l4t_flash_ctxt.image_size_sct >> 11);
+		"#00DDFF 偏移：#%08x，#00DDFF 大小：#%X，#00DDFF 镜像大小：#%s%s\n"
+		"\n您要继续吗？", l4t_flash_ctxt.offset_sct, size_sct, size_txt, l4t_flash_ctxt.compressed ? "（已压缩）" : "");
 	lv_label_set_text(lbl_status, txt_buf);
 	free(txt_buf);
 	lv_mbox_add_btns(mbox, mbox_btn_map2, _action_flash_linux_data);
@@ -1186,6 +1546,87 @@ static lv_res_t _action_reboot_recovery(lv_obj_t * btns, const char * txt)
 	return LV_RES_INV;
 }
 
+static int _mem_stream_read(void *priv, void *buf, u32 size)
+{
+	mem_stream_ctxt_t *ctxt = (mem_stream_ctxt_t *)priv;
+
+	if (size > ctxt->size - ctxt->pos)
+		return 1;
+
+	memcpy(buf, ctxt->buf + ctxt->pos, size);
+	ctxt->pos += size;
+
+	return 0;
+}
+
+static int _android_flash_image(const char *path, u32 offset_sct, u32 size_sct)
+{
+	int res = 0;
+	u32 file_size = 0;
+	u8 *buf = sd_file_read(path, &file_size);
+
+	if (!buf)
+		return 2;
+
+	mem_stream_ctxt_t mem = { buf, file_size, 0 };
+	lz4f_ctxt_t lz4f;
+	const simg_hdr_t *hdr = NULL;
+
+	bool compressed = file_size >= sizeof(u32) && lz4f_is_frame(buf);
+	if (compressed)
+	{
+		lz4f.read = _mem_stream_read;
+		lz4f.priv = &mem;
+		if (lz4f_init(&lz4f, (void *)SDXC_BUF_ALIGNED))
+		{
+			free(buf);
+			return 2;
+		}
+
+		hdr = lz4f_peek(&lz4f, sizeof(simg_hdr_t));
+	}
+	else if (file_size >= sizeof(simg_hdr_t))
+		hdr = (const simg_hdr_t *)buf;
+
+	bool sparse = hdr && simg_is_sparse(hdr);
+
+	if (compressed || sparse)
+	{
+		part_stream_ctxt_t part = { offset_sct, size_sct, 0 };
+		u64 image_sct = sparse ? simg_image_sectors(hdr) : (lz4f.content_size + 0x1FF) >> 9;
+
+		if (sparse && !image_sct)
+			res = 2;
+		else if (image_sct > size_sct)
+			res = 1;
+		else if (_part_stream_flash(&part, _mem_stream_read, &mem, compressed ? &lz4f : NULL, sparse))
+			res = part.error == PART_STREAM_ERR_SIZE ? 1 : 2;
+
+		free(buf);
+
+		return res;
+	}
+
+	if (file_size % 0x200)
+	{
+		u32 file_size_aligned = ALIGN(file_size, 0x200);
+		u8 *buf_tmp = zalloc(file_size_aligned);
+		memcpy(buf_tmp, buf, file_size);
+		free(buf);
+		buf = buf_tmp;
+		file_size = file_size_aligned;
+	}
+
+	if ((file_size >> 9) > size_sct)
+		res = 1;
+	else if (sdmmc_storage_write(part_info.storage, offset_sct, file_size >> 9, buf))
+		res = 2;
+
+	free(buf);
+
+	return res;
+}
+
 static lv_res_t _action_flash_android_data(lv_obj_t * btns, const char * txt)
 {
 	int btn_idx = lv_btnm_get_pressed(btns);
@@ -1263,29 +1704,17 @@ static lv_res_t _action_flash_android_data(lv_obj_t * btns, const char * txt)
 	// Flash Kernel.
 	if (offset_sct && size_sct)
 	{
-		u32 file_size = 0;
-		u8 *buf = sd_file_read(path, &file_size);
+		int res = _android_flash_image(path, offset_sct, size_sct);
 
-		if (file_size % 0x200)
-		{
-			file_size = ALIGN(file_size, 0x200);
-			u8 *buf_tmp = zalloc(file_size);
-			memcpy(buf_tmp, buf, file_size);
-			free(buf);
-			buf = buf_tmp;
-		}
-
-		if ((file_size >> 9) > size_sct)
+		if (res == 1)
 			s_printf(txt_buf, "#FF8000 警告：#内核镜像太大！\n");
+		else if (res)
+			s_printf(txt_buf, "#FFDD00 错误：#内核镜像刷入失败！\n");
 		else
 		{
-			sdmmc_storage_write(part_info.storage, offset_sct, file_size >> 9, buf);
-
 			s_printf(txt_buf, "#C7EA46 成功：#内核镜像已刷入！\n");
 			f_unlink(path);
 		}
-
-		free(buf);
 	}
 	else
 		s_printf(txt_buf, "#FF8000 警告：#未找到内核分区！\n");
@@ -1325,28 +1754,17 @@ boot_img_not_found:
 	// Flash Recovery.
 	if (offset_sct && size_sct)
 	{
-		u32 file_size = 0;
-		u8 *buf = sd_file_read(path, &file_size);
+		int res = _android_flash_image(path, offset_sct, size_sct);
 
-		if (file_size % 0x200)
-		{
-			file_size = ALIGN(file_size, 0x200);
-			u8 *buf_tmp = zalloc(file_size);
-			memcpy(buf_tmp, buf, file_size);
-			free(buf);
-			buf = buf_tmp;
-		}
-
-		if ((file_size >> 9) > size_sct)
+		if (res == 1)
 			strcat(txt_buf, "#FF8000 警告：#恢复镜像太大！\n");
+		else if (res)
+			strcat(txt_buf, "#FFDD00 错误：#恢复镜像刷入失败！\n");
 		else
 		{
-			sdmmc_storage_write(part_info.storage, offset_sct, file_size >> 9, buf);
 			strcat(txt_buf, "#C7EA46 成功：#恢复镜像已刷入！\n");
 			f_unlink(path);
 		}
-
-		free(buf);
 	}
 	else
 		strcat(txt_buf, "#FF8000 警告：#恢复分区未找到！\n");
@@ -1385,28 +1803,17 @@ recovery_not_found:
 	// Flash Device Tree.
 	if (offset_sct && size_sct)
 	{
-		u32 file_size = 0;
-		u8 *buf = sd_file_read(path, &file_size);
+		int res = _android_flash_image(path, offset_sct, size_sct);
 
-		if (file_size % 0x200)
-		{
-			file_size = ALIGN(file_size, 0x200);
-			u8 *buf_tmp = zalloc(file_size);
-			memcpy(buf_tmp, buf, file_size);
-			free(buf);
-			buf = buf_tmp;
-		}
-
-		if ((file_size >> 9) > size_sct)
+		if (res == 1)
 			strcat(txt_buf, "#FF8000 警告：#DTB镜像太大！");
+		else if (res)
+			strcat(txt_buf, "#FFDD00 错误：#DTB镜像刷入失败！");
 		else
 		{
-			sdmmc_storage_write(part_info.storage, offset_sct, file_size >> 9, buf);
 			strcat(txt_buf, "#C7EA46 成功：#DTB镜像已刷入！");
 			f_unlink(path);
 		}
-
-		free(buf);
 	}
 	else
 		strcat(txt_buf, "#FF8000 警告：#DTB分区未找到！");
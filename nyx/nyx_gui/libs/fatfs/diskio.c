@@ -133,9 +133,29 @@ DRESULT disk_ioctl (
 		}
 		break;
 
+	case DRIVE_EMMC:
+		switch (cmd)
+		{
+		case CTRL_SYNC:
+			// Write back eMMC volatile cache.
+			if (mmc_storage_cache_flush(&emmc_storage))
+				return RES_ERROR;
+			break;
+		case GET_SECTOR_COUNT:
+		case GET_BLOCK_SIZE:
+			*buf = 0; // Zero value to force default or abort.
+			break;
+		}
+		break;
+
 	case DRIVE_BIS:
 		switch (cmd)
 		{
+		case CTRL_SYNC:
+			// Write back BIS cluster cache first and then eMMC volatile cache.
+			if (nx_emmc_bis_flush() || mmc_storage_cache_flush(&emmc_storage))
+				return RES_ERROR;
+			break;
 		case GET_SECTOR_COUNT:
 			*buf = bis_sectors;
 			break;
@@ -41,6 +41,9 @@ const volatile ipl_ver_meta_t __attribute__((section ("._ipl_version"))) ipl_ver
 volatile nyx_storage_t *nyx_str = (nyx_storage_t *)NYX_STORAGE_ADDR;
 volatile boot_cfg_t *b_cfg;
 
+// Nyx SD/eMMC init times. Total is wall time, since both run overlapped.
+nyx_boot_time_t nyx_boot_time = { 0 };
+
 char *emmcsn_path_impl(char *path, char *sub_dir, char *filename, sdmmc_storage_t *storage)
 {
 	static char emmc_sn[9] = {0};
@@ -255,6 +258,12 @@ skip_main_cfg_parse:
 					n_cfg.jc_force_right = atoi(kv->val) == 1;
 				else if (!strcmp("bpmpclock",    kv->key))
 					n_cfg.bpmp_clock     = atoi(kv->val);
+				else if (!strcmp("emmccache",    kv->key))
+					n_cfg.emmc_cache     = atoi(kv->val) == 1;
+				else if (!strcmp("backupcompress", kv->key))
+					n_cfg.backup_compress = atoi(kv->val) == 1;
+				else if (!strcmp("restorecompare", kv->key))
+					n_cfg.restore_compare = atoi(kv->val) == 1;
 			}
 
 			// Check if user canceled time setting before.
@@ -404,7 +413,10 @@ void nyx_init_load_res()
 
 	// Reset new extended info if magic not correct.
 	if (nyx_str->info_ex.magic != NYX_NEW_INFO)
+	{
 		nyx_str->info_ex.rsvd_flags = 0;
+		memset((void *)&nyx_str->info_ex.boot_time, 0, sizeof(nyx_boot_time_t));
+	}
 
 	// Clear info magic.
 	nyx_str->info.magic    = 0;
@@ -424,6 +436,14 @@ void nyx_init_load_res()
 	// Show exception errors if any.
 	_show_errors(SD_NO_ERROR);
 
+	// Use SDMMC tuning results from previous inits if any.
+	sdmmc_storage_tune_cache_set((sdmmc_tune_cache_t *)&nyx_str->tune_cache);
+
+	// Start SD and eMMC init together so their waits are interleaved.
+	u32 storage_start = get_tmr_us();
+	sd_initialize_async();
+	emmc_initialize_async();
+
 	// Try 2 times to mount SD card.
 	if (sd_mount())
 	{
@@ -435,13 +455,29 @@ void nyx_init_load_res()
 			_show_errors(SD_MOUNT_ERROR); // Fatal.
 	}
 
+	// Finish eMMC init. Result is used by the first eMMC access.
+	emmc_initialize_async_finish();
+
+	// Wall time includes SD mount. Parts are the raw inits, so their sum shows what was overlapped.
+	nyx_boot_time.total = get_tmr_us() - storage_start;
+	nyx_boot_time.sd    = sd_get_init_time();
+	nyx_boot_time.emmc  = emmc_get_init_time();
+
 	// Train DRAM and switch to max frequency.
 	minerva_init((minerva_str_t *)&nyx_str->minerva);
 	minerva_change_freq(FREQ_1600);
+	minerva_train_cache_save();
 
 	// Load hekate/Nyx configuration.
 	_load_saved_configuration();
 
+	// Enable eMMC volatile cache if opted in. It's flushed on end, sync and deinit.
+	if (n_cfg.emmc_cache)
+	{
+		mmc_storage_cache_policy_set(true);
+		mmc_storage_cache_enable(&emmc_storage, true);
+	}
+
 	// Load Nyx resources.
 	if (nyx_load_resources())
 	{
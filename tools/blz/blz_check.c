@@ -0,0 +1,401 @@
+/*
+ * Round-trip and differential checks for the BLZ decoder, plus a benchmark
+ * against the reference byte decoder on KIP1 sections.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libs/compr/blz.h>
+
+#define FUZZ_ROUNDS      1000
+#define BENCH_ITERATIONS 100
+#define SLACK            SZ_8K // Garbage offsets can read up to 4KB past the output.
+
+#define KIP1_MAGIC        0x3150494B // "KIP1".
+#define KIP1_NUM_SECTIONS 6
+#define KIP1_HDR_SIZE     0x100
+
+// Reference decoder. Same as hactool/kernel, with the control byte bounds check added.
+static int _blz_ref_uncompress_inplace(u8 *data, u32 comp_size, const blz_footer *footer)
+{
+	u32 addl_size = footer->addl_size;
+	u32 header_size = footer->header_size;
+	u32 cmp_and_hdr_size = footer->cmp_and_hdr_size;
+
+	u8 *cmp_start = &data[comp_size] - cmp_and_hdr_size;
+	u32 cmp_ofs = cmp_and_hdr_size - header_size;
+	u32 out_ofs = cmp_and_hdr_size + addl_size;
+
+	while (out_ofs)
+	{
+		if (cmp_ofs < 1)
+			return 0;
+
+		u8 control = cmp_start[--cmp_ofs];
+		for (u32 i = 0; i < 8; i++)
+		{
+			if (control & 0x80)
+			{
+				if (cmp_ofs < 2)
+					return 0;
+
+				cmp_ofs -= 2;
+				u16 seg_val = ((u32)(cmp_start[cmp_ofs + 1]) << 8) | cmp_start[cmp_ofs];
+				u32 seg_size = ((seg_val >> 12) & 0xF) + 3;
+				u32 seg_ofs = (seg_val & 0x0FFF) + 3;
+
+				if (out_ofs < seg_size)
+					seg_size = out_ofs;
+
+				out_ofs -= seg_size;
+
+				for (u32 j = 0; j < seg_size; j++)
+					cmp_start[out_ofs + j] = cmp_start[out_ofs + j + seg_ofs];
+			}
+			else
+			{
+				if (cmp_ofs < 1)
+					return 0;
+
+				cmp_start[--out_ofs] = cmp_start[--cmp_ofs];
+			}
+
+			control <<= 1;
+
+			if (!out_ofs)
+				return 1;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Greedy backwards encoder. Bytes [0, raw) are stored as is, the rest is coded
+ * from the end, like Nintendo's tool. Returns the compressed size with footer.
+ */
+static u32 _blz_compress(const u8 *in, u32 size, u32 raw, u8 *out)
+{
+	u8 *seq = malloc(size * 2 + 16); // Decode order.
+	u32 seq_len = 0;
+	u32 pos = size;
+
+	while (pos > raw)
+	{
+		u32 ctrl_pos = seq_len++;
+		u8 control = 0;
+
+		for (u32 i = 0; i < 8 && pos > raw; i++)
+		{
+			u32 best_len = 0, best_ofs = 0;
+			u32 max_len = pos - raw < 18 ? pos - raw : 18;
+
+			// Source must be fully decoded before the copy starts, so offset >= length.
+			for (u32 ofs = 3; ofs <= 4098 && pos - max_len + ofs <= size; ofs++)
+			{
+				u32 len = 0;
+				while (len < max_len && len < ofs && pos - len - 1 + ofs < size && in[pos - len - 1] == in[pos - len - 1 + ofs])
+					len++;
+
+				if (len > best_len)
+				{
+					best_len = len;
+					best_ofs = ofs;
+					if (len == max_len)
+						break;
+				}
+			}
+
+			control <<= 1;
+			if (best_len >= 3)
+			{
+				u16 seg_val = ((best_len - 3) << 12) | (best_ofs - 3);
+				control |= 1;
+				seq[seq_len++] = seg_val >> 8;
+				seq[seq_len++] = seg_val & 0xFF;
+				pos -= best_len;
+			}
+			else
+				seq[seq_len++] = in[--pos];
+
+			// Pad the last group.
+			if (pos == raw)
+				control <<= 7 - i;
+		}
+
+		seq[ctrl_pos] = control;
+	}
+
+	memcpy(out, in, raw);
+	for (u32 i = 0; i < seq_len; i++)
+		out[raw + seq_len - 1 - i] = seq[i];
+
+	blz_footer footer;
+	footer.header_size = sizeof(blz_footer);
+	footer.cmp_and_hdr_size = seq_len + sizeof(blz_footer);
+	footer.addl_size = size - raw - seq_len - sizeof(blz_footer); // Caller checks that it shrunk.
+	memcpy(&out[raw + seq_len], &footer, sizeof(blz_footer));
+
+	free(seq);
+
+	return raw + seq_len + sizeof(blz_footer);
+}
+
+static void _fill(u8 *buf, u32 size)
+{
+	u32 kind = rand() % 3;
+
+	for (u32 i = 0; i < size; i++)
+	{
+		if (kind == 0)
+			buf[i] = rand();
+		else if (kind == 1)
+			buf[i] = (i > 16 && rand() % 4) ? buf[i - 3 - rand() % 12] : rand();
+		else
+			buf[i] = (i / 64) & 1 ? 0 : rand() % 4;
+	}
+}
+
+static int _round_trip()
+{
+	for (u32 round = 0; round < FUZZ_ROUNDS / 10; round++)
+	{
+		u32 size = 1 + rand() % SZ_16K;
+		u8 *in = malloc(size);
+		u8 *comp = malloc(size * 2 + SZ_1K);
+		u8 *out = malloc(size + SLACK);
+		_fill(in, size);
+
+		// Grow the stored prefix until in-place decoding no longer overwrites unread input.
+		int ok = 0;
+		for (u32 raw = 0; raw <= size && !ok; raw += raw < 64 ? 16 : raw / 2)
+		{
+			u32 comp_size = _blz_compress(in, size, raw, comp);
+			if (comp_size >= size)
+			{
+				ok = 1; // Incompressible, gets stored as is.
+				break;
+			}
+
+			ok = blz_uncompress_srcdest(comp, comp_size, out, size) && !memcmp(in, out, size);
+		}
+
+		free(in);
+		free(comp);
+		free(out);
+
+		if (!ok)
+		{
+			printf("round-trip   FAIL (round %u, size %u)\n", round, size);
+			return 1;
+		}
+	}
+
+	printf("round-trip   ok\n");
+
+	return 0;
+}
+
+static int _differential()
+{
+	for (u32 round = 0; round < FUZZ_ROUNDS; round++)
+	{
+		u32 size = 32 + rand() % SZ_8K;
+		u8 *in = malloc(size);
+		u8 *comp = malloc(size * 2 + SZ_1K);
+		_fill(in, size);
+
+		u32 comp_size = _blz_compress(in, size, rand() % 2 ? 0 : rand() % size, comp);
+		blz_footer footer;
+		memcpy(&footer, &comp[comp_size - sizeof(blz_footer)], sizeof(blz_footer));
+		if (comp_size >= size)
+			footer.addl_size = 0;
+
+		// Corrupt the stream and footer. Both decoders must still agree byte for byte.
+		for (u32 i = rand() % 8; i; i--)
+			comp[rand() % (comp_size - sizeof(blz_footer))] = rand();
+		if (!(rand() % 4))
+			footer.addl_size = rand() % SZ_4K;
+		if (!(rand() % 4))
+			footer.cmp_and_hdr_size = sizeof(blz_footer) + rand() % (comp_size - sizeof(blz_footer));
+		if (!(rand() % 4))
+			footer.header_size = rand() % (footer.cmp_and_hdr_size + 1);
+
+		u32 buf_size = comp_size + footer.addl_size + SLACK;
+		u8 *ref = calloc(1, buf_size);
+		u8 *opt = calloc(1, buf_size);
+		memcpy(ref, comp, comp_size);
+		memcpy(opt, comp, comp_size);
+
+		int ref_res = _blz_ref_uncompress_inplace(ref, comp_size, &footer);
+		int opt_res = blz_uncompress_inplace(opt, comp_size, &footer);
+		int fail = ref_res != opt_res || memcmp(ref, opt, buf_size);
+
+		free(in);
+		free(comp);
+		free(ref);
+		free(opt);
+
+		if (fail)
+		{
+			printf("differential FAIL (round %u)\n", round);
+			return 1;
+		}
+	}
+
+	printf("differential ok\n");
+
+	return 0;
+}
+
+static double _time_decode(int (*decode)(u8 *, u32, const blz_footer *), const u8 *comp, u32 comp_size, u32 size, u8 *buf)
+{
+	struct timespec start, end;
+	blz_footer footer;
+	double total = 0;
+
+	blz_get_footer(comp, comp_size, &footer);
+
+	for (u32 i = 0; i < BENCH_ITERATIONS; i++)
+	{
+		memcpy(buf, comp, comp_size);
+		memset(&buf[comp_size], 0, size + SLACK - comp_size);
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		decode(buf, comp_size, &footer);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+
+		total += (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+	}
+
+	return total / BENCH_ITERATIONS;
+}
+
+static void _bench_section(const char *name, const u8 *comp, u32 comp_size, u32 size)
+{
+	u8 *buf = malloc((comp_size > size ? comp_size : size) + SLACK);
+
+	double ref_us = _time_decode(_blz_ref_uncompress_inplace, comp, comp_size, size, buf);
+	double opt_us = _time_decode(blz_uncompress_inplace, comp, comp_size, size, buf);
+
+	printf("%-16s %7u -> %7u bytes, ref %8.1f us, opt %8.1f us (%.2fx)\n", name, comp_size, size, ref_us, opt_us, ref_us / opt_us);
+
+	free(buf);
+}
+
+static int _bench_kip(const char *path)
+{
+	FILE *fp = fopen(path, "rb");
+	if (!fp)
+	{
+		printf("Can't open %s\n", path);
+		return 1;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	u32 size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	u8 *kip = malloc(size);
+	if (fread(kip, 1, size, fp) != size)
+		size = 0;
+	fclose(fp);
+
+	u32 magic;
+	memcpy(&magic, kip, sizeof(u32));
+	if (size < KIP1_HDR_SIZE || magic != KIP1_MAGIC)
+	{
+		printf("%s is not a KIP1\n", path);
+		free(kip);
+		return 1;
+	}
+
+	// Sections follow the header back to back.
+	u32 offset = KIP1_HDR_SIZE;
+	u8 flags = kip[0x1F];
+	for (u32 i = 0; i < KIP1_NUM_SECTIONS; i++)
+	{
+		u32 sec[4];
+		memcpy(sec, &kip[0x20 + i * sizeof(sec)], sizeof(sec));
+		u32 size_decomp = sec[1];
+		u32 size_comp = sec[2];
+
+		if (offset + size_comp > size)
+			break;
+
+		if (i < 3 && (flags & BIT(i)) && size_comp)
+		{
+			char name[32];
+			snprintf(name, sizeof(name), "%.12s sect %u", (char *)&kip[4], i);
+			_bench_section(name, &kip[offset], size_comp, size_decomp);
+		}
+
+		offset += size_comp;
+	}
+
+	free(kip);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	srand(1);
+
+	if (_round_trip() || _differential())
+		return 1;
+
+	// Benchmark real KIP1 sections when given, otherwise a synthetic one.
+	if (argc > 1)
+	{
+		for (int i = 1; i < argc; i++)
+			if (_bench_kip(argv[i]))
+				return 1;
+
+		return 0;
+	}
+
+	u32 size = SZ_256K;
+	u8 *in = malloc(size);
+	u8 *comp = malloc(size * 2 + SZ_1K);
+
+	// Code like data. Instruction words repeating at word aligned distances.
+	for (u32 i = 0; i < size; i += 4)
+	{
+		u32 word = (i >= SZ_1K && rand() % 4) ? *(u32 *)&in[i - 4 * (1 + rand() % 256)] : (u32)rand();
+		memcpy(&in[i], &word, sizeof(u32));
+	}
+
+	u32 comp_size = 0;
+	u8 *out = malloc(size + SLACK);
+	for (u32 raw = 0; raw <= size; raw += raw < 64 ? 16 : raw / 2)
+	{
+		comp_size = _blz_compress(in, size, raw, comp);
+		if (blz_uncompress_srcdest(comp, comp_size, out, size) && !memcmp(in, out, size))
+			break;
+	}
+	free(out);
+
+	_bench_section("synthetic", comp, comp_size, size);
+
+	free(in);
+	free(comp);
+
+	return 0;
+}
@@ -0,0 +1,125 @@
+'''
+Copyright (c) 2026 CTCaer
+
+This program is free software; you can redistribute it and/or modify it
+under the terms and conditions of the GNU General Public License,
+version 2, as published by the Free Software Foundation.
+
+This program is distributed in the hope it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+'''
+
+from keystone import *
+
+# Assembled at CCPLEX_WORKER_ADDR. Page table at +0x1000, job ring at +0x2000.
+# Output goes to ccplex_worker_payload in bdk/soc/ccplex.c.
+CODE = b'''
+_start:
+	adr	x19, _start
+	add	x20, x19, #0x1000
+	add	x19, x19, #0x2000
+	msr	ttbr0_el3, x20
+	mov	x0, #0x4400
+	msr	mair_el3, x0
+	mov	x0, #0x20
+	movk	x0, #0x8080, lsl #16
+	msr	tcr_el3, x0
+	isb
+	tlbi	alle3
+	dsb	sy
+	isb
+	mrs	x0, sctlr_el3
+	orr	x0, x0, #1
+	bic	x0, x0, #2
+	bic	x0, x0, #0x80000
+	msr	sctlr_el3, x0
+	isb
+	ldr	w21, [x19, #0x40]
+poll:
+	ldar	w0, [x19]
+	cmp	w0, w21
+	b.eq	poll
+	and	w1, w21, #63
+	add	x2, x19, #0x80
+	add	x2, x2, x1, lsl #5
+	ldr	w3, [x2]
+	ldp	w5, w6, [x2, #8]
+	ldp	w7, w8, [x2, #16]
+	mov	w9, #0
+	cmp	w3, #1
+	b.eq	job_memcpy
+	cmp	w3, #2
+	b.eq	job_memset
+	cmp	w3, #3
+	b.eq	job_crc32
+	cbz	w3, job_done
+	mov	w9, #-1
+	b	job_done
+job_memcpy:
+	cmp	x7, #32
+	b.lo	memcpy_tail
+	ldp	x10, x11, [x6]
+	ldp	x12, x13, [x6, #16]
+	stp	x10, x11, [x5]
+	stp	x12, x13, [x5, #16]
+	add	x6, x6, #32
+	add	x5, x5, #32
+	sub	x7, x7, #32
+	b	job_memcpy
+memcpy_tail:
+	cbz	x7, job_done
+	ldrb	w10, [x6], #1
+	strb	w10, [x5], #1
+	sub	x7, x7, #1
+	b	memcpy_tail
+job_memset:
+	and	x8, x8, #0xFF
+	orr	x8, x8, x8, lsl #8
+	orr	x8, x8, x8, lsl #16
+	orr	x8, x8, x8, lsl #32
+memset_loop:
+	cmp	x7, #16
+	b.lo	memset_tail
+	stp	x8, x8, [x5], #16
+	sub	x7, x7, #16
+	b	memset_loop
+memset_tail:
+	cbz	x7, job_done
+	strb	w8, [x5], #1
+	sub	x7, x7, #1
+	b	memset_tail
+job_crc32:
+	mvn	w9, w8
+crc32_loop:
+	cmp	x7, #8
+	b.lo	crc32_tail
+	ldr	x10, [x6], #8
+	crc32x	w9, w9, x10
+	sub	x7, x7, #8
+	b	crc32_loop
+crc32_tail:
+	cbz	x7, crc32_end
+	ldrb	w10, [x6], #1
+	crc32b	w9, w9, w10
+	sub	x7, x7, #1
+	b	crc32_tail
+crc32_end:
+	mvn	w9, w9
+job_done:
+	str	w9, [x2, #4]
+	add	w21, w21, #1
+	dmb	sy
+	str	w21, [x19, #0x40]
+	b	poll
+'''
+try:
+	ks = Ks(KS_ARCH_ARM64, KS_MODE_LITTLE_ENDIAN)
+	encoding, count = ks.asm(CODE, 0x0)
+	print("%s = %s (number of statements: %u)" %(CODE, ', '.join([('0x%02x' % (x)) for x in encoding]), count))
+except KsError as e:
+	print("ERROR: %s" %e)
@@ -0,0 +1,234 @@
+/*
+ * Runs the CCPLEX worker job ring against a host worker.
+ * A pthread stands in for the AArch64 worker. The BPMP side is the real bdk code.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include "../../bdk/soc/ccplex.c"
+
+#define ARENA_SIZE SZ_1M
+#define JOBS_NUM   10000
+
+#define CCPLEX_JOB_HANG 0x7F // Host worker only. Never completes.
+
+static int _failed = 0;
+
+#define CHECK(cond, ...)             \
+	do {                             \
+		if (!(cond))                 \
+		{                            \
+			printf("FAIL: " __VA_ARGS__); \
+			printf("\n");            \
+			_failed++;               \
+		}                            \
+	} while (0)
+
+static u8 *arena;
+static volatile bool worker_reset = false;
+
+/* Host stand-ins for the BPMP side. */
+
+// Called on every ring poll. Yield, so single core hosts make progress.
+void bpmp_mmu_maintenance(u32 op, bool force)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	sched_yield();
+}
+
+// Runs 20x faster than real time, so the hang test does not take 10s.
+u32 get_tmr_ms()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (ts.tv_sec * 1000 + ts.tv_nsec / 1000000) * 20;
+}
+
+u32 crc32_calc(u32 crc, const u8 *buf, u32 len)
+{
+	crc = ~crc;
+	while (len--)
+	{
+		crc ^= *buf++;
+		for (u32 i = 0; i < 8; i++)
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+	}
+
+	return ~crc;
+}
+
+// Powergating CPU0 resets the host worker.
+int pmc_domain_pwrgate_set(pmc_power_rail_t part, u32 enable)
+{
+	if (part == POWER_RAIL_CE0 && !enable)
+		worker_reset = true;
+
+	return 0;
+}
+
+void clock_disable_coresight() {}
+u32  hw_get_chip_id() { return GP_HIDREV_MAJOR_T210B01; }
+int  max7762x_regulator_enable(u32 id, bool enable) { return 0; }
+int  i2c_send_byte(u32 i2c_idx, u32 dev_addr, u32 reg, u8 val) { return 0; }
+
+/* Host worker. Same dispatch as the AArch64 payload. */
+
+static void *_worker(void *arg)
+{
+	ccplex_ring_t *ring = _ccplex_worker_ring();
+	u32 tail = ring->tail;
+
+	while (!worker_reset)
+	{
+		if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail)
+		{
+			sched_yield();
+			continue;
+		}
+
+		ccplex_job_t *job = &ring->jobs[tail & (CCPLEX_WORKER_RING_SIZE - 1)];
+		u32 res = 0;
+
+		switch (job->op)
+		{
+		case CCPLEX_JOB_NOP:
+			break;
+		case CCPLEX_JOB_MEMCPY:
+			memcpy((void *)(uintptr_t)job->dst, (void *)(uintptr_t)job->src, job->size);
+			break;
+		case CCPLEX_JOB_MEMSET:
+			memset((void *)(uintptr_t)job->dst, job->arg, job->size);
+			break;
+		case CCPLEX_JOB_CRC32:
+			res = crc32_calc(job->arg, (u8 *)(uintptr_t)job->src, job->size);
+			break;
+		case CCPLEX_JOB_HANG:
+			while (!worker_reset)
+				sched_yield();
+			return NULL;
+		default:
+			res = 0xFFFFFFFF;
+			break;
+		}
+
+		job->res = res;
+		tail++;
+		__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+	}
+
+	return NULL;
+}
+
+static void _worker_start(pthread_t *worker, u32 idx)
+{
+	ccplex_ring_t *ring = _ccplex_worker_ring();
+
+	memset(ring, 0, sizeof(ccplex_ring_t));
+	ring->head = ring->tail = ccplex_worker_head = idx;
+
+	worker_reset = false;
+	ccplex_worker_on = true;
+	pthread_create(worker, NULL, _worker, NULL);
+}
+
+static void _check_jobs(u32 jobs_num)
+{
+	// Job i fills a chunk, copies it and checksums the copy. Chunks never overlap within a ring window.
+	const u32 chunk = ARENA_SIZE / (CCPLEX_WORKER_RING_SIZE * 2);
+	static u8 ref[ARENA_SIZE / (CCPLEX_WORKER_RING_SIZE * 2)];
+	u32 crc_job[JOBS_NUM];
+
+	for (u32 i = 0; i < jobs_num; i++)
+	{
+		u8 *slot = arena + (i % (CCPLEX_WORKER_RING_SIZE / 4)) * 2 * chunk;
+		u32 size = (i * 37) % chunk + 1;
+
+		ccplex_worker_post(CCPLEX_JOB_MEMSET, slot, NULL, size, i);
+		ccplex_worker_post(CCPLEX_JOB_MEMCPY, slot + chunk, slot, size, 0);
+		crc_job[i] = ccplex_worker_post(CCPLEX_JOB_CRC32, NULL, slot + chunk, size, i);
+
+		// Check the oldest job before its slot gets reused.
+		if (i >= CCPLEX_WORKER_RING_SIZE / 4 - 1)
+		{
+			u32 k = i - (CCPLEX_WORKER_RING_SIZE / 4 - 1);
+			u32 k_size = (k * 37) % chunk + 1;
+			memset(ref, k, k_size);
+			CHECK(ccplex_worker_wait(crc_job[k]) == crc32_calc(k, ref, k_size), "crc of job %u", k);
+		}
+	}
+
+	for (u32 k = jobs_num - (CCPLEX_WORKER_RING_SIZE / 4 - 1); k < jobs_num; k++)
+	{
+		u32 k_size = (k * 37) % chunk + 1;
+		memset(ref, k, k_size);
+		CHECK(ccplex_worker_wait(crc_job[k]) == crc32_calc(k, ref, k_size), "crc of job %u", k);
+	}
+
+	CHECK(ccplex_worker_wait(ccplex_worker_post(0x55, NULL, NULL, 0, 0)) == 0xFFFFFFFF, "unknown job result");
+}
+
+int main(int argc, char *argv[])
+{
+	pthread_t worker;
+
+	// Ring is at its real address. Job buffers must fit in 32 bits.
+	void *ring_mem = mmap((void *)CCPLEX_WORKER_ADDR, CCPLEX_WORKER_SZ, PROT_READ | PROT_WRITE,
+						  MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+	void *clk_mem  = mmap((void *)CLOCK_BASE, SZ_4K, PROT_READ | PROT_WRITE,
+						  MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+	arena = mmap(NULL, ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+	if (ring_mem != (void *)CCPLEX_WORKER_ADDR || clk_mem != (void *)CLOCK_BASE || arena == MAP_FAILED)
+	{
+		printf("Failed to map fixed host memory\n");
+		return 1;
+	}
+
+	// Worker running. Start from a non zero index to cover counter wrap.
+	_worker_start(&worker, 0xFFFFFF00);
+	_check_jobs(JOBS_NUM);
+	CHECK(ccplex_worker_running(), "worker stopped");
+	ccplex_worker_stop();
+	pthread_join(worker, NULL);
+
+	// Worker stopped. Jobs run inline.
+	_check_jobs(JOBS_NUM / 10);
+
+	// Worker hangs. Pending jobs fall back to BPMP.
+	_worker_start(&worker, 0x1000);
+	memset(arena, 0xA5, SZ_64K);
+	u32 crc = crc32_calc(0, arena, SZ_64K);
+	u32 job_a = ccplex_worker_post(CCPLEX_JOB_CRC32, NULL, arena, SZ_64K, 0);
+	ccplex_worker_post(CCPLEX_JOB_HANG, NULL, NULL, 0, 0);
+	ccplex_worker_post(CCPLEX_JOB_MEMCPY, arena + SZ_64K, arena, SZ_64K, 0);
+	u32 job_b = ccplex_worker_post(CCPLEX_JOB_CRC32, NULL, arena + SZ_64K, SZ_64K, 0);
+	CHECK(ccplex_worker_wait(job_b) == crc, "crc after hang");
+	CHECK(ccplex_worker_wait(job_a) == crc, "crc before hang");
+	CHECK(!ccplex_worker_running(), "hung worker still running");
+	pthread_join(worker, NULL);
+
+	printf("ring_check: %s\n", _failed ? "FAIL" : "ok");
+
+	return _failed ? 1 : 0;
+}
@@ -0,0 +1,435 @@
+/*
+ * Compiles bootloader/patches.ini into the bootloader/patches.bin patch database.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "pkg2_patch_db.h"
+
+#define KPS(x) ((u32)(x) << 29)
+
+#define LINE_MAX_LEN 511 // Bootloader line buffer is 512 bytes.
+
+typedef struct _patch_t
+{
+	char *name;
+	u32   offset;
+	u32   length;
+	u8   *src;
+	u8   *dst;
+} patch_t;
+
+typedef struct _patchset_t
+{
+	char    *name;
+	patch_t *patches;
+	u32      patches_num;
+} patchset_t;
+
+typedef struct _kip_t
+{
+	char       *name;
+	u8          hash[8];
+	patchset_t *patchsets;
+	u32         patchsets_num;
+} kip_t;
+
+typedef struct _ini_id_t
+{
+	u32 size;
+	u16 date;
+	u16 time;
+} ini_id_t;
+
+typedef struct _out_t
+{
+	u8 *buf;
+	u32 size;
+	u32 max;
+} out_t;
+
+static kip_t *_kips;
+static u32 _kips_num;
+
+static u32 _crc32_calc(u32 crc, const u8 *buf, u32 len)
+{
+	crc = ~crc;
+	while (len--)
+	{
+		crc ^= *buf++;
+		for (u32 i = 0; i < 8; i++)
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+	}
+
+	return ~crc;
+}
+
+// Same as the bootloader one. Invalid chars are parsed as 0.
+static void _htoa(u8 *dst, const char *ptr, u32 byte_len)
+{
+	while (*ptr == ' ' || *ptr == '\t')
+		ptr++;
+
+	for (u32 i = 0; i < byte_len * 2; i++)
+	{
+		char ch = *ptr;
+		u8 tmp = 0;
+		if (ch >= '0' && ch <= '9')
+			tmp = (ch - '0');
+		else if (ch >= 'A' && ch <= 'F')
+			tmp = (ch - 'A' + 10);
+		else if (ch >= 'a' && ch <= 'f')
+			tmp = (ch - 'a' + 10);
+
+		if (!(i & 1))
+			dst[i / 2] = tmp << 4;
+		else
+			dst[i / 2] |= tmp;
+
+		if (ch)
+			ptr++;
+	}
+}
+
+static u32 _find_patch_section_name(char *lbuf, u32 lblen, char schar)
+{
+	u32 i;
+	for (i = 0; i < lblen && lbuf[i] != schar; i++)
+		;
+	lbuf[i] = 0;
+
+	return i;
+}
+
+static kip_t *_get_kip(char *sec)
+{
+	u8 hash[8] = {0};
+	u32 len = strlen(sec);
+	u32 i = _find_patch_section_name(sec, len, ':');
+	if (i < len)
+		_htoa(hash, &sec[i + 1], 8);
+
+	// Sections with the same name and hash are merged.
+	for (u32 k = 0; k < _kips_num; k++)
+	{
+		if (!strcmp(_kips[k].name, sec) && !memcmp(_kips[k].hash, hash, 8))
+			return &_kips[k];
+	}
+
+	_kips = realloc(_kips, sizeof(kip_t) * (_kips_num + 1));
+	kip_t *kip = &_kips[_kips_num++];
+	memset(kip, 0, sizeof(kip_t));
+	kip->name = strdup(sec);
+	memcpy(kip->hash, hash, 8);
+
+	return kip;
+}
+
+static void _add_patch(kip_t *kip, bool new_set, char *lbuf, u32 lblen)
+{
+	patch_t pt = {0};
+	u32 pos = _find_patch_section_name(lbuf, lblen, '=');
+	pt.name = strdup(&lbuf[1]);
+
+	u8 kip_sidx = pos + 1 < lblen ? (u8)(lbuf[pos + 1] - '0') : 0xFF;
+	pos += 3;
+
+	if (kip_sidx < 6 && pos < lblen)
+	{
+		u32 str_start;
+
+		pt.offset = KPS(kip_sidx);
+		str_start = _find_patch_section_name(&lbuf[pos], lblen - pos, ':');
+		pt.offset |= (u32)strtoul(&lbuf[pos], NULL, 16);
+		pos += str_start + 1;
+
+		if (pos < lblen)
+		{
+			str_start = _find_patch_section_name(&lbuf[pos], lblen - pos, ':');
+			pt.length = (u32)strtoul(&lbuf[pos], NULL, 16);
+			pos += str_start + 1;
+		}
+
+		if (pt.length)
+		{
+			pt.src = calloc(1, pt.length);
+			pt.dst = calloc(1, pt.length);
+
+			if (pos < lblen)
+			{
+				str_start = _find_patch_section_name(&lbuf[pos], lblen - pos, ',');
+				_htoa(pt.src, &lbuf[pos], pt.length);
+				pos += str_start + 1;
+			}
+
+			if (pos < lblen)
+				_htoa(pt.dst, &lbuf[pos], pt.length);
+		}
+	}
+
+	// Consecutive patches with the same name form a patchset. Each section starts a new one.
+	patchset_t *ps = kip->patchsets_num ? &kip->patchsets[kip->patchsets_num - 1] : NULL;
+	if (new_set || !ps || strcmp(ps->name, pt.name))
+	{
+		kip->patchsets = realloc(kip->patchsets, sizeof(patchset_t) * (kip->patchsets_num + 1));
+		ps = &kip->patchsets[kip->patchsets_num++];
+		memset(ps, 0, sizeof(patchset_t));
+		ps->name = pt.name;
+	}
+
+	ps->patches = realloc(ps->patches, sizeof(patch_t) * (ps->patches_num + 1));
+	ps->patches[ps->patches_num++] = pt;
+}
+
+static int _parse_ini(char *ini, u32 size)
+{
+	kip_t *kip = NULL;
+	bool new_set = false;
+	u32 line = 0;
+
+	char *end = ini + size;
+	char *lbuf = malloc(size + 1);
+	while (ini < end)
+	{
+		// Fetch one line and remove \r like the bootloader.
+		u32 lblen = 0;
+		line++;
+		while (ini < end && *ini != '\n')
+		{
+			if (*ini != '\r')
+				lbuf[lblen++] = *ini;
+			ini++;
+		}
+		ini++;
+		lbuf[lblen] = 0;
+
+		if (lblen > LINE_MAX_LEN - 1)
+		{
+			fprintf(stderr, "Line %u is longer than %u chars!\n", line, LINE_MAX_LEN - 1);
+			free(lbuf);
+			return 1;
+		}
+
+		if (lblen > 2 && lbuf[0] == '[')
+		{
+			_find_patch_section_name(lbuf, lblen, ']');
+			kip = _get_kip(&lbuf[1]);
+			new_set = true;
+		}
+		else if (kip && lbuf[0] == '.')
+		{
+			_add_patch(kip, new_set, lbuf, lblen);
+			new_set = false;
+		}
+	}
+
+	free(lbuf);
+
+	return 0;
+}
+
+static u32 _out_alloc(out_t *out, u32 size, u32 align)
+{
+	u32 ofs = (out->size + align - 1) & ~(align - 1);
+	if (ofs + size > out->max)
+	{
+		out->max = (ofs + size) * 2;
+		out->buf = realloc(out->buf, out->max);
+	}
+
+	memset(out->buf + out->size, 0, ofs + size - out->size);
+	out->size = ofs + size;
+
+	return ofs;
+}
+
+static u32 _out_data(out_t *out, const void *data, u32 size)
+{
+	u32 ofs = _out_alloc(out, size, 1);
+	memcpy(out->buf + ofs, data, size);
+
+	return ofs;
+}
+
+static void _build_db(out_t *out, const ini_id_t *ini_id)
+{
+	// Header and all arrays first, so they stay word aligned.
+	_out_alloc(out, sizeof(kip_patch_db_hdr_t), 4);
+	u32 kips_ofs = _out_alloc(out, sizeof(kip_patch_db_kip_t) * _kips_num, 4);
+
+	u32 *ps_ofs = calloc(_kips_num, sizeof(u32));
+	for (u32 k = 0; k < _kips_num; k++)
+		ps_ofs[k] = _out_alloc(out, sizeof(kip_patch_db_patchset_t) * (_kips[k].patchsets_num + 1), 4);
+
+	u32 **pt_ofs = calloc(_kips_num, sizeof(u32 *));
+	for (u32 k = 0; k < _kips_num; k++)
+	{
+		pt_ofs[k] = calloc(_kips[k].patchsets_num, sizeof(u32));
+		for (u32 s = 0; s < _kips[k].patchsets_num; s++)
+			pt_ofs[k][s] = _out_alloc(out, sizeof(kip_patch_db_patch_t) * (_kips[k].patchsets[s].patches_num + 1), 4);
+	}
+
+	// Fill entries. The buffer can move, so pointers are taken after each data write.
+	const u8 empty = 0;
+	for (u32 k = 0; k < _kips_num; k++)
+	{
+		kip_t *kip = &_kips[k];
+
+		u32 name_ofs = _out_data(out, kip->name, strlen(kip->name) + 1);
+		kip_patch_db_kip_t *dkip = (kip_patch_db_kip_t *)(out->buf + kips_ofs) + k;
+		dkip->name_ofs = name_ofs;
+		memcpy(dkip->hash, kip->hash, 8);
+		dkip->patchsets_ofs = ps_ofs[k];
+
+		for (u32 s = 0; s < kip->patchsets_num; s++)
+		{
+			patchset_t *ps = &kip->patchsets[s];
+
+			name_ofs = _out_data(out, ps->name, strlen(ps->name) + 1);
+			kip_patch_db_patchset_t *dps = (kip_patch_db_patchset_t *)(out->buf + ps_ofs[k]) + s;
+			dps->name_ofs    = name_ofs;
+			dps->patches_ofs = pt_ofs[k][s];
+
+			for (u32 p = 0; p < ps->patches_num; p++)
+			{
+				patch_t *pt = &ps->patches[p];
+				u32 src_ofs, dst_ofs = 0;
+
+				if (pt->length)
+				{
+					src_ofs = _out_data(out, pt->src, pt->length);
+					dst_ofs = _out_data(out, pt->dst, pt->length);
+				}
+				else
+					src_ofs = _out_data(out, &empty, 1); // Empty patch. Keep everything else as 0.
+
+				kip_patch_db_patch_t *dpt = (kip_patch_db_patch_t *)(out->buf + pt_ofs[k][s]) + p;
+				dpt->offset  = pt->length ? pt->offset : 0;
+				dpt->length  = pt->length;
+				dpt->src_ofs = src_ofs;
+				dpt->dst_ofs = dst_ofs;
+			}
+		}
+
+		free(pt_ofs[k]);
+	}
+	free(pt_ofs);
+	free(ps_ofs);
+
+	_out_alloc(out, 0, 4);
+
+	kip_patch_db_hdr_t *hdr = (kip_patch_db_hdr_t *)out->buf;
+	hdr->magic     = KIP_PATCH_DB_MAGIC;
+	hdr->version   = KIP_PATCH_DB_VERSION;
+	hdr->size      = out->size;
+	hdr->ini_size  = ini_id->size;
+	hdr->ini_date  = ini_id->date;
+	hdr->ini_time  = ini_id->time;
+	hdr->kips_num  = _kips_num;
+	hdr->kips_ofs  = kips_ofs;
+	hdr->crc32     = _crc32_calc(0, out->buf + sizeof(kip_patch_db_hdr_t), out->size - sizeof(kip_patch_db_hdr_t));
+}
+
+// Same size and FAT date/time that the bootloader gets from f_stat.
+static int _ini_id_get(const char *path, ini_id_t *id)
+{
+	struct stat st;
+	if (stat(path, &st))
+		return 1;
+
+	// FAT timestamps are in local time with 2s resolution.
+	struct tm *tm = localtime(&st.st_mtime);
+	if (!tm || tm->tm_year < 80)
+		return 1;
+
+	id->size = st.st_size;
+	id->date = ((tm->tm_year - 80) << 9) | ((tm->tm_mon + 1) << 5) | tm->tm_mday;
+	id->time = (tm->tm_hour << 11) | (tm->tm_min << 5) | (tm->tm_sec / 2);
+
+	return 0;
+}
+
+static u8 *_read_file(const char *path, u32 *size)
+{
+	FILE *fp = fopen(path, "rb");
+	if (!fp)
+		return NULL;
+
+	fseek(fp, 0, SEEK_END);
+	*size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	u8 *buf = malloc(*size + 1);
+	if (fread(buf, 1, *size, fp) != *size)
+	{
+		free(buf);
+		buf = NULL;
+	}
+	fclose(fp);
+
+	return buf;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 3)
+	{
+		printf("Usage: %s <patches.ini> <patches.bin>\n", argv[0]);
+		return 1;
+	}
+
+	u32 ini_size;
+	u8 *ini = _read_file(argv[1], &ini_size);
+	if (!ini)
+	{
+		fprintf(stderr, "Failed to read %s!\n", argv[1]);
+		return 1;
+	}
+
+	ini_id_t ini_id;
+	if (_ini_id_get(argv[1], &ini_id) || ini_id.size != ini_size)
+	{
+		fprintf(stderr, "Failed to stat %s!\n", argv[1]);
+		return 1;
+	}
+
+	if (_parse_ini((char *)ini, ini_size))
+		return 1;
+
+	out_t out = {0};
+	_build_db(&out, &ini_id);
+
+	FILE *fp = fopen(argv[2], "wb");
+	if (!fp || fwrite(out.buf, 1, out.size, fp) != out.size)
+	{
+		fprintf(stderr, "Failed to write %s!\n", argv[2]);
+		return 1;
+	}
+	fclose(fp);
+
+	u32 patchsets_num = 0;
+	for (u32 k = 0; k < _kips_num; k++)
+		patchsets_num += _kips[k].patchsets_num;
+
+	printf("%s: %u KIPs, %u patchsets, %u bytes.\n", argv[2], _kips_num, patchsets_num, out.size);
+
+	return 0;
+}
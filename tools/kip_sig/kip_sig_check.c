@@ -0,0 +1,485 @@
+/*
+ * Checks for the KIP1 signature patcher against a naive masked search, plus
+ * applying signature patches to KIP1 TEXT sections.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libs/compr/blz.h>
+#include "pkg2_kip_sig.h"
+
+#define FUZZ_ROUNDS   500
+#define FUZZ_SIGS_MAX 32
+#define BENCH_SIZE    SZ_1M
+#define BENCH_SIGS    16
+#define SIGS_MAX      128
+
+#define KIP1_MAGIC        0x3150494B // "KIP1".
+#define KIP1_HDR_SIZE     0x100
+
+typedef struct _sig_buf_t
+{
+	kip_sig_t sig;
+	u8 pattern[KIP_SIG_MAX_SIZE];
+	u8 mask[KIP_SIG_MAX_SIZE];
+	u8 patch[KIP_SIG_MAX_SIZE];
+	char kip[16];
+	char name[64];
+} sig_buf_t;
+
+static void _sig_init(sig_buf_t *sb)
+{
+	memset(sb, 0, sizeof(sig_buf_t));
+	sb->sig.kip     = sb->kip;
+	sb->sig.name    = sb->name;
+	sb->sig.pattern = sb->pattern;
+	sb->sig.mask    = sb->mask;
+	sb->sig.patch   = sb->patch;
+}
+
+// Reference search. Returns matches and sets the first one.
+static u32 _naive_search(const kip_sig_t *sig, const u8 *data, u32 size, u32 *first)
+{
+	u32 matches = 0;
+
+	for (u32 pos = 0; pos + sig->size <= size; pos++)
+	{
+		u32 j;
+		for (j = 0; j < sig->size; j++)
+		{
+			if ((data[pos + j] & sig->mask[j]) != (sig->pattern[j] & sig->mask[j]))
+				break;
+		}
+
+		if (j == sig->size)
+		{
+			if (!matches)
+				*first = pos;
+			matches++;
+		}
+	}
+
+	return matches;
+}
+
+static int _check_parse()
+{
+	u8 data[8], mask[8];
+	int fail = 0;
+
+	fail |= kip_sig_parse_hex("1F2003D5", data, mask, sizeof(data)) != 4 ||
+			memcmp(data, "\x1F\x20\x03\xD5", 4) || memcmp(mask, "\xFF\xFF\xFF\xFF", 4);
+	fail |= kip_sig_parse_hex("E0 ?? 1? ?F", data, mask, sizeof(data)) != 4 ||
+			data[0] != 0xE0 || data[2] != 0x10 || data[3] != 0x0F ||
+			memcmp(mask, "\xFF\x00\xF0\x0F", 4);
+	fail |= kip_sig_parse_hex("ABC", data, mask, sizeof(data)) != 0;
+	fail |= kip_sig_parse_hex("AB?C", data, NULL, sizeof(data)) != 0;
+	fail |= kip_sig_parse_hex("XY", data, mask, sizeof(data)) != 0;
+	fail |= kip_sig_parse_hex("001122334455667788", data, mask, sizeof(data)) != 0;
+
+	printf("%-12s %s\n", "parse", fail ? "FAIL" : "ok");
+
+	return fail;
+}
+
+// Code like data. Few distinct words, so patterns repeat and anchors overlap.
+static void _gen_text(u8 *data, u32 size)
+{
+	static const u32 words[] = {
+		0xD503201F, 0xAA1303E0, 0x94000000, 0xF9400000, 0xB4000000, 0x52800000, 0xA9BF7BFD, 0xD65F03C0
+	};
+
+	for (u32 i = 0; i < size; i += 4)
+	{
+		u32 word = words[rand() % 8] | (rand() % 4 ? 0 : (rand() & 0xFFFF));
+		memcpy(&data[i], &word, sizeof(u32));
+	}
+}
+
+static void _gen_sig(sig_buf_t *sb, const u8 *data, u32 size)
+{
+	_sig_init(sb);
+
+	kip_sig_t *sig = &sb->sig;
+	sig->size = 2 + rand() % 30;
+
+	// Mostly taken from the data, so there are matches to find.
+	bool from_data = rand() % 4;
+	u32 pos = rand() % (size - sig->size);
+	for (u32 i = 0; i < sig->size; i++)
+	{
+		sb->pattern[i] = from_data ? data[pos + i] : rand();
+
+		u32 r = rand() % 10;
+		sb->mask[i] = r < 2 ? 0x00 : (r < 3 ? 0xF0 : 0xFF);
+	}
+	sb->mask[rand() % sig->size] = 0xFF;
+}
+
+static int _differential()
+{
+	u32 size = SZ_64K;
+	u8 *data = malloc(size);
+	sig_buf_t *sbs = malloc(sizeof(sig_buf_t) * FUZZ_SIGS_MAX);
+	kip_sig_t *sigs[FUZZ_SIGS_MAX];
+	u32 total_matches = 0;
+	int fail = 0;
+
+	for (u32 round = 0; round < FUZZ_ROUNDS && !fail; round++)
+	{
+		_gen_text(data, size);
+
+		u32 sigs_num = 1 + rand() % FUZZ_SIGS_MAX;
+		for (u32 i = 0; i < sigs_num; i++)
+		{
+			_gen_sig(&sbs[i], data, size);
+			sigs[i] = &sbs[i].sig;
+		}
+
+		// Duplicate patterns must be reported separately.
+		if (sigs_num > 1 && !(round % 8))
+		{
+			memcpy(sbs[1].pattern, sbs[0].pattern, KIP_SIG_MAX_SIZE);
+			memcpy(sbs[1].mask, sbs[0].mask, KIP_SIG_MAX_SIZE);
+			sbs[1].sig.size = sbs[0].sig.size;
+		}
+
+		kip_sig_ac_t *ac = kip_sig_compile(sigs, sigs_num);
+		if (!ac)
+		{
+			printf("round %u: compile failed\n", round);
+			fail = 1;
+			break;
+		}
+
+		kip_sig_scan(ac, data, size);
+		kip_sig_free(ac);
+
+		for (u32 i = 0; i < sigs_num; i++)
+		{
+			u32 first = 0;
+			u32 matches = _naive_search(sigs[i], data, size, &first);
+			total_matches += matches;
+
+			if (matches != sigs[i]->matches || (matches && first != sigs[i]->match_offset))
+			{
+				printf("round %u sig %u: %u matches @ 0x%X, expected %u @ 0x%X\n", round, i,
+					sigs[i]->matches, sigs[i]->match_offset, matches, first);
+				fail = 1;
+				break;
+			}
+		}
+	}
+
+	printf("%-12s %s (%u rounds, %u matches)\n", "differential", fail ? "FAIL" : "ok", FUZZ_ROUNDS, total_matches);
+
+	free(sbs);
+	free(data);
+
+	return fail;
+}
+
+static int _check_apply()
+{
+	u32 size = SZ_64K;
+	u8 *data = malloc(size);
+	sig_buf_t sb[3];
+	kip_sig_t *sigs[3] = { &sb[0].sig, &sb[1].sig, &sb[2].sig };
+	int fail = 0;
+
+	// Bytes that never show up in generated text.
+	memset(data, 0x11, size);
+
+	// Unique with a patch before the pattern.
+	_sig_init(&sb[0]);
+	sb[0].sig.size = kip_sig_parse_hex("EE ?? EE 7?", sb[0].pattern, sb[0].mask, KIP_SIG_MAX_SIZE);
+	sb[0].sig.offset = -8;
+	sb[0].sig.patch_size = kip_sig_parse_hex("1F2003D5", sb[0].patch, NULL, KIP_SIG_MAX_SIZE);
+	memcpy(&data[0x1000], "\xEE\x42\xEE\x73", 4);
+
+	// Ambiguous.
+	_sig_init(&sb[1]);
+	sb[1].sig.size = kip_sig_parse_hex("CCDD", sb[1].pattern, sb[1].mask, KIP_SIG_MAX_SIZE);
+	sb[1].sig.patch_size = kip_sig_parse_hex("00", sb[1].patch, NULL, KIP_SIG_MAX_SIZE);
+	memcpy(&data[0x2000], "\xCC\xDD", 2);
+	memcpy(&data[0x3000], "\xCC\xDD", 2);
+
+	// Not found.
+	_sig_init(&sb[2]);
+	sb[2].sig.size = kip_sig_parse_hex("AB??CD", sb[2].pattern, sb[2].mask, KIP_SIG_MAX_SIZE);
+	sb[2].sig.patch_size = kip_sig_parse_hex("00", sb[2].patch, NULL, KIP_SIG_MAX_SIZE);
+
+	kip_sig_ac_t *ac = kip_sig_compile(sigs, 3);
+	kip_sig_scan(ac, data, size);
+	kip_sig_free(ac);
+
+	fail |= kip_sig_apply(sigs[0], data, size) != 0 || memcmp(&data[0x1000 - 8], "\x1F\x20\x03\xD5", 4);
+	fail |= kip_sig_apply(sigs[1], data, size) == 0 || sigs[1]->matches != 2;
+	fail |= kip_sig_apply(sigs[2], data, size) == 0 || sigs[2]->matches != 0;
+
+	// Out of bounds patch.
+	sb[0].sig.offset = -0x2000;
+	fail |= kip_sig_apply(sigs[0], data, size) == 0;
+
+	// Fully masked pattern has no anchor.
+	sb[2].sig.size = kip_sig_parse_hex("????", sb[2].pattern, sb[2].mask, KIP_SIG_MAX_SIZE);
+	ac = kip_sig_compile(&sigs[2], 1);
+	fail |= ac != NULL;
+	kip_sig_free(ac);
+
+	printf("%-12s %s\n", "apply", fail ? "FAIL" : "ok");
+
+	free(data);
+
+	return fail;
+}
+
+static double _elapsed_us(struct timespec *start, struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) * 1e6 + (end->tv_nsec - start->tv_nsec) / 1e3;
+}
+
+static void _bench(kip_sig_t **sigs, u32 sigs_num, const u8 *data, u32 size, const char *name)
+{
+	struct timespec start, end;
+	u32 first;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (u32 i = 0; i < sigs_num; i++)
+		_naive_search(sigs[i], data, size, &first);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double naive_us = _elapsed_us(&start, &end);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	kip_sig_ac_t *ac = kip_sig_compile(sigs, sigs_num);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double compile_us = _elapsed_us(&start, &end);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	kip_sig_scan(ac, data, size);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double scan_us = _elapsed_us(&start, &end);
+	kip_sig_free(ac);
+
+	printf("%-16s %7u bytes, %2u sigs, naive %8.1f us, compile %6.1f us, scan %8.1f us (%.2fx)\n",
+		name, size, sigs_num, naive_us, compile_us, scan_us, naive_us / (compile_us + scan_us));
+}
+
+static char *_strip(char *str)
+{
+	while (*str == ' ' || *str == '\t')
+		str++;
+
+	u32 len = strlen(str);
+	while (len && (str[len - 1] == '\n' || str[len - 1] == '\r' || str[len - 1] == ' '))
+		str[--len] = 0;
+
+	return str;
+}
+
+// Same syntax as bootloader/patches_sig.ini.
+static u32 _load_sigs(const char *path, sig_buf_t *sbs)
+{
+	FILE *fp = fopen(path, "r");
+	if (!fp)
+		return 0;
+
+	char line[512];
+	char kip[16] = { 0 };
+	u32 sigs_num = 0;
+	while (fgets(line, sizeof(line), fp) && sigs_num < SIGS_MAX)
+	{
+		char *str = _strip(line);
+		if (str[0] == '[')
+		{
+			char *end = strchr(str, ']');
+			if (end)
+				*end = 0;
+			snprintf(kip, sizeof(kip), "%s", str + 1);
+		}
+		else if (str[0] == '.' && kip[0])
+		{
+			char *pattern = strchr(str, '=');
+			char *offset  = pattern ? strchr(pattern, ':') : NULL;
+			char *patch   = offset  ? strchr(offset + 1, ':') : NULL;
+			if (!patch)
+				continue;
+			*pattern++ = 0;
+			*offset++ = 0;
+			*patch++ = 0;
+
+			sig_buf_t *sb = &sbs[sigs_num];
+			_sig_init(sb);
+			snprintf(sb->kip, sizeof(sb->kip), "%s", kip);
+			snprintf(sb->name, sizeof(sb->name), "%s", str + 1);
+			sb->sig.size = kip_sig_parse_hex(pattern, sb->pattern, sb->mask, KIP_SIG_MAX_SIZE);
+			sb->sig.offset = strtol(offset, NULL, 16);
+			sb->sig.patch_size = kip_sig_parse_hex(patch, sb->patch, NULL, KIP_SIG_MAX_SIZE);
+
+			if (sb->sig.size && sb->sig.patch_size)
+				sigs_num++;
+			else
+				printf("Skipping broken line for '%s'\n", sb->name);
+		}
+	}
+	fclose(fp);
+
+	return sigs_num;
+}
+
+static int _apply_kip(const char *kip_path, const char *sigs_path)
+{
+	FILE *fp = fopen(kip_path, "rb");
+	if (!fp)
+	{
+		printf("Can't open %s\n", kip_path);
+		return 1;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	u32 size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	u8 *kip = malloc(size);
+	if (fread(kip, 1, size, fp) != size)
+		size = 0;
+	fclose(fp);
+
+	u32 magic;
+	memcpy(&magic, kip, sizeof(u32));
+	if (size < KIP1_HDR_SIZE || magic != KIP1_MAGIC)
+	{
+		printf("%s is not a KIP1\n", kip_path);
+		free(kip);
+		return 1;
+	}
+
+	// TEXT is the first section.
+	u32 sec[4];
+	memcpy(sec, &kip[0x20], sizeof(sec));
+	u32 size_decomp = sec[1];
+	u32 size_comp = sec[2];
+	if (KIP1_HDR_SIZE + size_comp > size)
+	{
+		printf("%s is truncated\n", kip_path);
+		free(kip);
+		return 1;
+	}
+
+	u8 *text = malloc(size_decomp + SZ_8K);
+	u32 text_size = size_comp;
+	if (kip[0x1F] & BIT(0))
+		text_size = blz_uncompress_srcdest(&kip[KIP1_HDR_SIZE], size_comp, text, size_decomp);
+	else
+		memcpy(text, &kip[KIP1_HDR_SIZE], size_comp);
+
+	if (!text_size)
+	{
+		printf("%s: failed to decompress TEXT\n", kip_path);
+		free(text);
+		free(kip);
+		return 1;
+	}
+
+	sig_buf_t *sbs = malloc(sizeof(sig_buf_t) * SIGS_MAX);
+	kip_sig_t *sigs[SIGS_MAX];
+	u32 sigs_loaded = _load_sigs(sigs_path, sbs);
+
+	char kip_name[13] = { 0 };
+	memcpy(kip_name, &kip[4], 12);
+
+	u32 sigs_num = 0;
+	for (u32 i = 0; i < sigs_loaded; i++)
+	{
+		if (!strcmp(sbs[i].kip, kip_name))
+			sigs[sigs_num++] = &sbs[i].sig;
+	}
+
+	int res = 0;
+	if (!sigs_num)
+		printf("%s: no signatures for %s\n", kip_path, kip_name);
+	else
+	{
+		_bench(sigs, sigs_num, text, text_size, kip_name);
+
+		kip_sig_ac_t *ac = kip_sig_compile(sigs, sigs_num);
+		if (!ac)
+		{
+			printf("%s: failed to compile signatures\n", kip_path);
+			res = 1;
+		}
+		else
+		{
+			kip_sig_scan(ac, text, text_size);
+			kip_sig_free(ac);
+
+			for (u32 i = 0; i < sigs_num; i++)
+			{
+				int failed = kip_sig_apply(sigs[i], text, text_size);
+				printf("  %-16s %u matches, first @ 0x%X -> %s\n", sigs[i]->name, sigs[i]->matches,
+					sigs[i]->match_offset, failed ? "FAIL" : "patched");
+				res |= failed;
+			}
+		}
+	}
+
+	free(sbs);
+	free(text);
+	free(kip);
+
+	return res;
+}
+
+int main(int argc, char *argv[])
+{
+	srand(1);
+
+	if (_check_parse() || _differential() || _check_apply())
+		return 1;
+
+	// Apply a signature file to real KIP1s when given, otherwise benchmark on synthetic text.
+	if (argc > 2)
+	{
+		int res = 0;
+		for (int i = 2; i < argc; i++)
+			res |= _apply_kip(argv[i], argv[1]);
+
+		return res;
+	}
+
+	u8 *data = malloc(BENCH_SIZE);
+	sig_buf_t *sbs = malloc(sizeof(sig_buf_t) * BENCH_SIGS);
+	kip_sig_t *sigs[BENCH_SIGS];
+
+	_gen_text(data, BENCH_SIZE);
+	for (u32 i = 0; i < BENCH_SIGS; i++)
+	{
+		_gen_sig(&sbs[i], data, BENCH_SIZE);
+		sigs[i] = &sbs[i].sig;
+	}
+
+	printf("\n");
+	_bench(sigs, 1, data, BENCH_SIZE, "synthetic");
+	_bench(sigs, BENCH_SIGS, data, BENCH_SIZE, "synthetic");
+
+	free(sbs);
+	free(data);
+
+	return 0;
+}
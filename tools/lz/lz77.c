@@ -19,33 +19,158 @@
 #include <stdint.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <time.h>
 #include "lz.h"
+#include "lz_opt.h"
+
+#include <libs/compr/lz4.h>
+#include <libs/compr/lz4_lite.h>
+
+#define BENCH_ITERATIONS 200
 
 char filename[1024];
 
+enum
+{
+	CODEC_LZ      = 0,
+	CODEC_LZ4     = 1,
+	CODEC_LZ_FAST = 2, // Original jump table encoder. Benchmark only.
+	CODEC_NUM
+};
+
+static const char *codec_names[CODEC_NUM] = { "lz", "lz4", "lz-fast" };
+
+static int _compress(int codec, uint8_t *in, uint8_t *out, uint32_t in_size, uint32_t out_size, uint32_t *work)
+{
+	switch (codec)
+	{
+	case CODEC_LZ4:
+		return LZ4_compress_default((const char *)in, (char *)out, in_size, out_size);
+	case CODEC_LZ_FAST:
+		return LZ_CompressFast(in, out, in_size, work);
+	default:
+		return LZ_CompressOptimal(in, out, in_size);
+	}
+}
+
+static uint32_t _uncompress(int codec, uint8_t *in, uint8_t *out, uint32_t in_size)
+{
+	if (codec == CODEC_LZ4)
+		return lz4_lite_uncompress(in, out, in_size);
+
+	return LZ_Uncompress(in, out, in_size);
+}
+
+static double _elapsed_us(struct timespec *start, struct timespec *end)
+{
+	return ((end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec)) / 1e3;
+}
+
+// Compresses both halves like the loader payload and times their encoding and decoding.
+static int _bench(uint8_t *in_buf, uint32_t in_size, uint8_t *out_buf, uint32_t out_size, uint32_t *work)
+{
+	uint8_t *dec_buf = (uint8_t *)malloc(in_size);
+
+	if (!dec_buf)
+		return 1;
+
+	for (int codec = 0; codec < CODEC_NUM; codec++)
+	{
+		struct timespec start, end;
+		uint32_t half = in_size / 2;
+		uint32_t sizes[2] = { half, in_size - half };
+		uint32_t csizes[2];
+		uint8_t *cbuf[2];
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (int i = 0; i < 2; i++)
+		{
+			int nbytes = _compress(codec, in_buf + half * i, out_buf, sizes[i], out_size, work);
+			if (nbytes < 0 || nbytes > out_size)
+				return 1;
+
+			csizes[i] = nbytes;
+			cbuf[i] = (uint8_t *)malloc(nbytes);
+			memcpy(cbuf[i], out_buf, nbytes);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		double enc_us = _elapsed_us(&start, &end);
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (int n = 0; n < BENCH_ITERATIONS; n++)
+		{
+			uint32_t pos = _uncompress(codec, cbuf[0], dec_buf, csizes[0]);
+			_uncompress(codec, cbuf[1], dec_buf + pos, csizes[1]);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		double dec_us = _elapsed_us(&start, &end) / BENCH_ITERATIONS;
+
+		int fail = memcmp(dec_buf, in_buf, in_size) != 0;
+		printf("%-7s %7u -> %7u bytes (%5.1f%%), encode %9.1f us, decode %8.1f us%s\n", codec_names[codec], in_size,
+			csizes[0] + csizes[1], (csizes[0] + csizes[1]) * 100.0 / in_size, enc_us, dec_us, fail ? ", MISMATCH" : "");
+
+		free(cbuf[0]);
+		free(cbuf[1]);
+
+		if (fail)
+			return 1;
+	}
+
+	free(dec_buf);
+
+	return 0;
+}
+
 int main(int argc, char *argv[])
 {
 	int nbytes;
 	int filename_len;
 	struct stat statbuf;
 	FILE *in_file, *out_file;
+	int codec = CODEC_LZ;
+	int bench = 0;
+	int arg = 1;
+
+	// Options: -c <lz|lz4> selects the codec, -b compares all encoders.
+	while (arg < argc - 1)
+	{
+		if (!strcmp(argv[arg], "-c") && arg + 1 < argc - 1)
+		{
+			codec = !strcmp(argv[arg + 1], "lz4") ? CODEC_LZ4 : CODEC_LZ;
+			arg += 2;
+		}
+		else if (!strcmp(argv[arg], "-b"))
+		{
+			bench = 1;
+			arg++;
+		}
+		else
+			break;
+	}
 
-	if(stat(argv[1], &statbuf))
+	if (arg != argc - 1)
+	{
+		fprintf(stderr, "Usage: %s [-c lz|lz4] [-b] <file>\n", argv[0]);
+		exit(1);
+	}
+
+	if(stat(argv[arg], &statbuf))
 		goto error;
 
-	if((in_file=fopen(argv[1], "rb")) == NULL)
+	if((in_file=fopen(argv[arg], "rb")) == NULL)
 		goto error;
 
-	strcpy(filename, argv[1]);
+	strcpy(filename, argv[arg]);
 	filename_len = strlen(filename);
 
 	uint32_t in_size = statbuf.st_size;
 	uint8_t *in_buf  = (uint8_t *)malloc(in_size);
 
-	uint32_t out_size = statbuf.st_size + 257;
+	uint32_t out_size = LZ4_compressBound(in_size) + 257;
 	uint8_t *out_buf = (uint8_t *)malloc(out_size);
+	uint8_t *dec_buf = (uint8_t *)malloc(in_size);
 
-	if(!(in_buf && out_buf))
+	if(!(in_buf && out_buf && dec_buf))
 		goto error;
 
 	if(fread(in_buf, 1, in_size, in_file) != in_size)
@@ -54,6 +179,17 @@ int main(int argc, char *argv[])
 	fclose(in_file);
 
 	uint32_t *work = (uint32_t*)malloc(sizeof(uint32_t) * (in_size + 65536));
+	if (!work)
+		goto error;
+
+	if (bench)
+	{
+		if (_bench(in_buf, in_size, out_buf, out_size, work))
+			goto error;
+
+		return 0;
+	}
+
 	for (int i = 0; i < 2; i++)
 	{
 		uint32_t in_size_tmp;
@@ -68,12 +204,14 @@ int main(int argc, char *argv[])
 			strcpy(filename + filename_len, ".01.lz");
 		}
 
-		if (work)
-			nbytes = LZ_CompressFast(in_buf + (in_size / 2) * i, out_buf, in_size_tmp, work);
-		else
+		nbytes = _compress(codec, in_buf + (in_size / 2) * i, out_buf, in_size_tmp, out_size, work);
+
+		if (nbytes < 0 || nbytes > out_size)
 			goto error;
 
-		if (nbytes > out_size)
+		// Verify with the same decoder the loader uses.
+		if (_uncompress(codec, out_buf, dec_buf, nbytes) != in_size_tmp ||
+			memcmp(dec_buf, in_buf + (in_size / 2) * i, in_size_tmp))
 			goto error;
 
 		if((out_file = fopen(filename,"wb")) == NULL)
@@ -88,6 +226,6 @@ int main(int argc, char *argv[])
 	return 0;
 
 error:
-	fprintf(stderr, "Failed to compress: %s\n", argv[1]);
+	fprintf(stderr, "Failed to compress: %s\n", argv[arg]);
 	exit(1);
 }
@@ -0,0 +1,213 @@
+/*
+ * Hash chain LZ77 encoder with optimal parsing.
+ *
+ * Produces the same bitstream as the Geelnard coder in lz.c, so LZ_Uncompress()
+ * and the loader are unchanged. Matches are found through hash chains and the
+ * cheapest path over all literal/match choices is picked, using the exact coded
+ * size of each choice. Unlike LZ_Compress(), matches may overlap themselves.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lz_opt.h"
+
+#define LZ_OPT_MAX_OFFSET  100000 // Same window as lz.c.
+#define LZ_OPT_MIN_MATCH   3
+#define LZ_OPT_NICE_MATCH  64     // Longer matches are taken as is.
+#define LZ_OPT_CHAIN_DEPTH 256
+#define LZ_OPT_HASH_BITS   16
+#define LZ_OPT_NONE        0xFFFFFFFF
+
+static uint32_t _lz_hash(const uint8_t *p)
+{
+	uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+
+	return (v * 2654435761U) >> (32 - LZ_OPT_HASH_BITS);
+}
+
+static uint32_t _lz_varsize_len(uint32_t x)
+{
+	uint32_t num_bytes = 1;
+
+	while (x >= 0x80)
+	{
+		x >>= 7;
+		num_bytes++;
+	}
+
+	return num_bytes;
+}
+
+static int _lz_write_varsize(uint32_t x, uint8_t *buf)
+{
+	int num_bytes = _lz_varsize_len(x);
+
+	for (int i = num_bytes - 1; i >= 0; i--)
+		*buf++ = ((x >> (i * 7)) & 0x7F) | (i ? 0x80 : 0);
+
+	return num_bytes;
+}
+
+int LZ_CompressOptimal(unsigned char *in, unsigned char *out, unsigned int insize)
+{
+	uint32_t histogram[256] = { 0 };
+	uint8_t marker = 0;
+
+	if (insize < 1)
+		return 0;
+
+	// Find the least common byte, and use it as the marker symbol.
+	for (uint32_t i = 0; i < insize; i++)
+		histogram[in[i]]++;
+	for (uint32_t i = 1; i < 256; i++)
+		if (histogram[i] < histogram[marker])
+			marker = i;
+
+	uint32_t *head  = malloc(sizeof(uint32_t) << LZ_OPT_HASH_BITS);
+	uint32_t *chain = malloc(sizeof(uint32_t) * insize);
+	uint32_t *price = malloc(sizeof(uint32_t) * (insize + 1));
+	uint32_t *len   = malloc(sizeof(uint32_t) * (insize + 1)); // Step that reached each position.
+	uint32_t *off   = malloc(sizeof(uint32_t) * (insize + 1));
+
+	if (!head || !chain || !price || !len || !off)
+	{
+		insize = 0;
+		goto out;
+	}
+
+	memset(head, 0xFF, sizeof(uint32_t) << LZ_OPT_HASH_BITS);
+	memset(price, 0xFF, sizeof(uint32_t) * (insize + 1));
+	price[0] = 0;
+
+	// Forward pass. Relax literal and match steps from every position.
+	uint32_t skip_until = 0;
+	for (uint32_t pos = 0; pos < insize; pos++)
+	{
+		uint32_t lit_price = price[pos] + (in[pos] == marker ? 2 : 1);
+		if (lit_price < price[pos + 1])
+		{
+			price[pos + 1] = lit_price;
+			len[pos + 1] = 1;
+			off[pos + 1] = 0;
+		}
+
+		if (insize - pos < LZ_OPT_MIN_MATCH)
+			continue;
+
+		uint32_t hash = _lz_hash(&in[pos]);
+		uint32_t cand = head[hash];
+		chain[pos] = cand;
+		head[hash] = pos;
+
+		// Inside a long match, only keep the chains up to date.
+		if (pos < skip_until)
+			continue;
+
+		uint32_t max_len = insize - pos;
+		uint32_t best_len = LZ_OPT_MIN_MATCH - 1;
+		for (uint32_t depth = 0; cand != LZ_OPT_NONE && depth < LZ_OPT_CHAIN_DEPTH; depth++, cand = chain[cand])
+		{
+			uint32_t offset = pos - cand;
+			if (offset > LZ_OPT_MAX_OFFSET)
+				break;
+
+			// Must beat the best length so far to matter.
+			if (in[cand + best_len] != in[pos + best_len])
+				continue;
+
+			uint32_t l = 0;
+			while (l < max_len && in[cand + l] == in[pos + l])
+				l++;
+
+			if (l <= best_len)
+				continue;
+
+			// Every new length is reachable with this offset, the closest one found for it.
+			uint32_t off_price = price[pos] + 1 + _lz_varsize_len(offset);
+			for (uint32_t k = best_len + 1; k <= l; k++)
+			{
+				uint32_t p = off_price + _lz_varsize_len(k);
+				if (p < price[pos + k])
+				{
+					price[pos + k] = p;
+					len[pos + k] = k;
+					off[pos + k] = offset;
+				}
+			}
+
+			best_len = l;
+			if (best_len >= LZ_OPT_NICE_MATCH || best_len == max_len)
+				break;
+		}
+
+		if (best_len >= LZ_OPT_NICE_MATCH)
+			skip_until = pos + best_len;
+	}
+
+	// Walk back the cheapest path, reversing the steps in place.
+	uint32_t pos = insize;
+	uint32_t next_len = 0, next_off = 0;
+	while (pos)
+	{
+		uint32_t l = len[pos];
+		uint32_t o = off[pos];
+		len[pos] = next_len;
+		off[pos] = next_off;
+		next_len = l;
+		next_off = o;
+		pos -= l;
+	}
+	len[0] = next_len;
+	off[0] = next_off;
+
+	// Emit.
+	uint32_t outpos = 0;
+	out[outpos++] = marker;
+	pos = 0;
+	while (pos < insize)
+	{
+		uint32_t l = len[pos];
+		uint32_t o = off[pos];
+
+		if (o)
+		{
+			out[outpos++] = marker;
+			outpos += _lz_write_varsize(l, &out[outpos]);
+			outpos += _lz_write_varsize(o, &out[outpos]);
+		}
+		else
+		{
+			out[outpos++] = in[pos];
+			if (in[pos] == marker)
+				out[outpos++] = 0;
+		}
+
+		pos += l;
+	}
+	insize = outpos;
+
+out:
+	free(head);
+	free(chain);
+	free(price);
+	free(len);
+	free(off);
+
+	return insize;
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LZ_OPT_H_
+#define _LZ_OPT_H_
+
+// Same bitstream as LZ_Compress(). Output buffer must be (257/256)*insize + 1 bytes.
+int LZ_CompressOptimal(unsigned char *in, unsigned char *out, unsigned int insize);
+
+#endif
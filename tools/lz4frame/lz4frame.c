@@ -0,0 +1,383 @@
+/*
+ * LZ4 frame compressor and decoder benchmark for the L4T/Android flasher.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libs/compr/lz4.h>
+#include <libs/compr/lz4_frame.h>
+
+#define SPLIT_SIZE 0xFFC00000ULL // 4GB - 4MB, for FAT32 parts.
+
+typedef struct _split_t
+{
+	FILE *fp;
+	const char *base;
+	u32 part_idx;
+	bool split;
+	u64 part_size;
+} split_t;
+
+static int _open_part(split_t *s, const char *mode)
+{
+	char path[4096];
+
+	if (s->split)
+		snprintf(path, sizeof(path), "%s.%02d", s->base, s->part_idx);
+	else
+		snprintf(path, sizeof(path), "%s", s->base);
+
+	s->fp = fopen(path, mode);
+	s->part_size = 0;
+
+	return !s->fp;
+}
+
+static char *_split_base(const char *name, bool *split)
+{
+	u32 len = strlen(name);
+	char *base = strdup(name);
+
+	*split = len > 3 && !strcmp(&base[len - 3], ".00");
+	if (*split)
+		base[len - 3] = 0;
+
+	return base;
+}
+
+static int _out_write(split_t *s, const void *buf, u32 size)
+{
+	while (size)
+	{
+		if (s->split && s->part_size == SPLIT_SIZE)
+		{
+			fclose(s->fp);
+			s->part_idx++;
+			if (_open_part(s, "wb"))
+				return 1;
+		}
+
+		u32 chunk = size;
+		if (s->split && s->part_size + chunk > SPLIT_SIZE)
+			chunk = SPLIT_SIZE - s->part_size;
+
+		if (fwrite(buf, 1, chunk, s->fp) != chunk)
+			return 1;
+
+		s->part_size += chunk;
+		buf += chunk;
+		size -= chunk;
+	}
+
+	return 0;
+}
+
+static int _in_read(void *priv, void *buf, u32 size)
+{
+	split_t *s = (split_t *)priv;
+
+	while (size)
+	{
+		size_t br = fread(buf, 1, size, s->fp);
+		buf += br;
+		size -= br;
+
+		// Continue from the next split part, like l4t.NN.
+		if (size)
+		{
+			if (!s->split)
+				return 1;
+
+			fclose(s->fp);
+			s->part_idx++;
+			if (_open_part(s, "rb"))
+				return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int _compress(const char *in_name, const char *out_name, bool linked, int accel)
+{
+	split_t out = { 0 };
+	bool split;
+
+	FILE *in = fopen(in_name, "rb");
+	if (!in)
+	{
+		fprintf(stderr, "Can't open %s\n", in_name);
+		return 1;
+	}
+
+	fseeko(in, 0, SEEK_END);
+	u64 in_size = ftello(in);
+	fseeko(in, 0, SEEK_SET);
+
+	char *base = _split_base(out_name, &split);
+	out.base  = base;
+	out.split = split;
+	if (_open_part(&out, "wb"))
+	{
+		fprintf(stderr, "Can't create %s\n", out_name);
+		return 1;
+	}
+
+	// Frame descriptor. Version 1, content size and checksum, 4MB blocks.
+	u8 hdr[4 + 2 + 8 + 1];
+	u32 magic = LZ4F_MAGIC;
+	memcpy(hdr, &magic, 4);
+	hdr[4] = 0x40 | BIT(3) | BIT(2) | (linked ? 0 : BIT(5));
+	hdr[5] = 7 << 4;
+	memcpy(&hdr[6], &in_size, 8);
+	hdr[14] = (lz4f_xxh32(&hdr[4], 10) >> 8) & 0xFF;
+
+	lz4f_xxh32_t xxh;
+	lz4f_xxh32_init(&xxh);
+
+	// Linked blocks keep the previous block in front of the current one.
+	u8 *ibuf = malloc(LZ4F_BLOCK_MAX * 2);
+	u8 *cbuf = malloc(LZ4_compressBound(LZ4F_BLOCK_MAX));
+	LZ4_stream_t *stream = LZ4_createStream();
+	u32 bidx = 0;
+	u64 out_size = sizeof(hdr);
+
+	int res = _out_write(&out, hdr, sizeof(hdr));
+	while (!res)
+	{
+		u8 *src = ibuf + bidx * LZ4F_BLOCK_MAX;
+		u32 size = fread(src, 1, LZ4F_BLOCK_MAX, in);
+		if (!size)
+			break;
+
+		lz4f_xxh32_update(&xxh, src, size);
+
+		int csize;
+		if (linked)
+			csize = LZ4_compress_fast_continue(stream, (const char *)src, (char *)cbuf, size, LZ4_compressBound(LZ4F_BLOCK_MAX), accel);
+		else
+			csize = LZ4_compress_fast((const char *)src, (char *)cbuf, size, LZ4_compressBound(LZ4F_BLOCK_MAX), accel);
+
+		// Store blocks that don't compress.
+		u32 blk_hdr;
+		const u8 *data;
+		if (csize <= 0 || (u32)csize >= size)
+		{
+			blk_hdr = size | BIT(31);
+			data = src;
+		}
+		else
+		{
+			blk_hdr = csize;
+			data = cbuf;
+		}
+
+		res = _out_write(&out, &blk_hdr, sizeof(u32)) || _out_write(&out, data, blk_hdr & ~BIT(31));
+		out_size += sizeof(u32) + (blk_hdr & ~BIT(31));
+		bidx ^= linked;
+	}
+
+	// End mark and content checksum.
+	u32 end[2] = { 0, lz4f_xxh32_digest(&xxh) };
+	if (!res)
+		res = _out_write(&out, end, sizeof(end));
+	out_size += sizeof(end);
+
+	if (!res)
+		printf("%llu -> %llu bytes (%.1f%%), %d part(s)\n", (unsigned long long)in_size, (unsigned long long)out_size,
+			in_size ? out_size * 100.0 / in_size : 0.0, out.part_idx + 1);
+
+	LZ4_freeStream(stream);
+	free(cbuf);
+	free(ibuf);
+	free(base);
+	fclose(in);
+	if (fclose(out.fp))
+		res = 1;
+
+	return res;
+}
+
+static int _decompress(const char *in_name, const char *out_name)
+{
+	split_t in = { 0 };
+	lz4f_ctxt_t lz4f;
+	bool split;
+
+	char *base = _split_base(in_name, &split);
+	in.base  = base;
+	in.split = split;
+	if (_open_part(&in, "rb"))
+	{
+		fprintf(stderr, "Can't open %s\n", in_name);
+		return 1;
+	}
+
+	FILE *out = fopen(out_name, "wb");
+	if (!out)
+	{
+		fprintf(stderr, "Can't create %s\n", out_name);
+		return 1;
+	}
+
+	void *work = malloc(LZ4F_WORK_SIZE);
+	lz4f.read = _in_read;
+	lz4f.priv = &in;
+
+	int res = lz4f_init(&lz4f, work);
+	while (!res)
+	{
+		u8 *blk;
+		u32 size;
+
+		res = lz4f_next_block(&lz4f, &blk, &size);
+		if (res || !size)
+			break;
+
+		res = fwrite(blk, 1, size, out) != size;
+	}
+
+	if (res)
+		fprintf(stderr, "Failed to decode %s\n", in_name);
+
+	free(work);
+	free(base);
+	fclose(in.fp);
+	if (fclose(out))
+		res = 1;
+
+	return res;
+}
+
+typedef struct _mem_t
+{
+	const u8 *buf;
+	u64 size;
+	u64 pos;
+} mem_t;
+
+static int _mem_read(void *priv, void *buf, u32 size)
+{
+	mem_t *m = (mem_t *)priv;
+
+	if (size > m->size - m->pos)
+		return 1;
+
+	memcpy(buf, m->buf + m->pos, size);
+	m->pos += size;
+
+	return 0;
+}
+
+static int _bench(const char *in_name)
+{
+	struct timespec start, end;
+	lz4f_ctxt_t lz4f;
+	mem_t mem = { 0 };
+
+	FILE *in = fopen(in_name, "rb");
+	if (!in)
+	{
+		fprintf(stderr, "Can't open %s\n", in_name);
+		return 1;
+	}
+
+	fseeko(in, 0, SEEK_END);
+	mem.size = ftello(in);
+	fseeko(in, 0, SEEK_SET);
+	u8 *buf = malloc(mem.size);
+	if (!buf || fread(buf, 1, mem.size, in) != mem.size)
+		return 1;
+	fclose(in);
+	mem.buf = buf;
+
+	void *work = malloc(LZ4F_WORK_SIZE);
+	lz4f.read = _mem_read;
+	lz4f.priv = &mem;
+
+	// Same path as the flasher, minus the storage writes.
+	u64 out_size = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	int res = lz4f_init(&lz4f, work);
+	while (!res)
+	{
+		u8 *blk;
+		u32 size;
+
+		res = lz4f_next_block(&lz4f, &blk, &size);
+		if (res || !size)
+			break;
+		out_size += size;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	double secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	if (!res)
+		printf("%llu -> %llu bytes in %.3fs, %.1f MiB/s output\n", (unsigned long long)mem.size,
+			(unsigned long long)out_size, secs, out_size / (double)SZ_1M / secs);
+	else
+		fprintf(stderr, "Failed to decode %s\n", in_name);
+
+	free(work);
+	free(buf);
+
+	return res;
+}
+
+static void _usage(const char *name)
+{
+	printf("Usage:\n");
+	printf("  %s c [-l] [-a <accel>] <in.img> <out.lz4 | l4t.00>\n", name);
+	printf("  %s d <in.lz4 | l4t.00> <out.img>\n", name);
+	printf("  %s b <in.lz4>\n", name);
+	printf("Outputs ending in .00 are split into FAT32 sized parts.\n");
+	printf("-l links blocks for better ratio. -a trades ratio for speed (default 1).\n");
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc >= 4 && !strcmp(argv[1], "c"))
+	{
+		bool linked = false;
+		int accel = 1;
+		int i = 2;
+
+		for (; i < argc - 2; i++)
+		{
+			if (!strcmp(argv[i], "-l"))
+				linked = true;
+			else if (!strcmp(argv[i], "-a") && i + 1 < argc - 2)
+				accel = atoi(argv[++i]);
+			else
+				break;
+		}
+
+		if (i == argc - 2)
+			return _compress(argv[i], argv[i + 1], linked, accel);
+	}
+	else if (argc == 4 && !strcmp(argv[1], "d"))
+		return _decompress(argv[2], argv[3]);
+	else if (argc == 3 && !strcmp(argv[1], "b"))
+		return _bench(argv[2]);
+
+	_usage(argv[0]);
+
+	return 1;
+}
@@ -0,0 +1,290 @@
+/*
+ * Converts eMMC backups between raw and indexed LZ4 frame images.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libs/compr/lz4.h>
+#include <libs/compr/lz4_img.h>
+
+#define BLOCK_SECTORS 8192 // Same as Nyx backups.
+#define BLOCK_SIZE    (BLOCK_SECTORS * 512)
+
+static int _is_zero(const u8 *buf, u32 size)
+{
+	for (u32 i = 0; i < size; i++)
+		if (buf[i])
+			return 0;
+
+	return 1;
+}
+
+static int _compress(const char *in_name, const char *out_name)
+{
+	FILE *in = fopen(in_name, "rb");
+	if (!in)
+	{
+		fprintf(stderr, "Can't open %s\n", in_name);
+		return 1;
+	}
+
+	fseeko(in, 0, SEEK_END);
+	off_t in_size = ftello(in);
+	fseeko(in, 0, SEEK_SET);
+	if (in_size % 512 || !in_size || (in_size / 512) > 0xFFFFFFFF)
+	{
+		fprintf(stderr, "Image size must be a non zero multiple of 512 bytes\n");
+		fclose(in);
+		return 1;
+	}
+
+	FILE *out = fopen(out_name, "wb");
+	if (!out)
+	{
+		fprintf(stderr, "Can't create %s\n", out_name);
+		fclose(in);
+		return 1;
+	}
+
+	static const lz4_img_frame_hdr_t frame = { LZ4F_MAGIC, LZ4_IMG_FRAME_FLG, LZ4_IMG_FRAME_BD, LZ4_IMG_FRAME_HC };
+
+	lz4_img_ftr_t ftr = { 0 };
+	ftr.block_sectors = BLOCK_SECTORS;
+	ftr.sectors       = in_size / 512;
+	ftr.total_sectors = ftr.sectors;
+	ftr.block_num     = (ftr.sectors + BLOCK_SECTORS - 1) / BLOCK_SECTORS;
+	ftr.version       = LZ4_IMG_VERSION;
+	ftr.magic         = LZ4_IMG_MAGIC;
+
+	lz4_img_blk_t *index = calloc(ftr.block_num, sizeof(lz4_img_blk_t));
+	u8 *buf = malloc(BLOCK_SIZE);
+	u8 *cbuf = malloc(LZ4_compressBound(BLOCK_SIZE));
+	int res = fwrite(&frame, sizeof(frame), 1, out) != 1;
+
+	u64 pos = sizeof(frame);
+	for (u32 i = 0; !res && i < ftr.block_num; i++)
+	{
+		u32 size = (ftr.sectors - i * BLOCK_SECTORS) < BLOCK_SECTORS ? (ftr.sectors - i * BLOCK_SECTORS) * 512 : BLOCK_SIZE;
+		if (fread(buf, size, 1, in) != 1)
+		{
+			res = 1;
+			break;
+		}
+
+		u8 *data = cbuf;
+		u32 csize = LZ4_compress_default((const char *)buf, (char *)cbuf, size, LZ4_compressBound(size));
+		if (!csize || csize >= size)
+		{
+			csize = size | LZ4_IMG_BLK_STORED;
+			data = buf;
+		}
+		u32 csize_data = csize & ~LZ4_IMG_BLK_STORED;
+
+		index[i].offset = pos + sizeof(u32);
+		index[i].csize  = csize;
+		index[i].flags  = _is_zero(buf, size) ? LZ4_IMG_BLK_ZERO : 0;
+		if (fwrite(&csize, sizeof(u32), 1, out) != 1 || fwrite(data, csize_data, 1, out) != 1)
+			res = 1;
+		pos += sizeof(u32) + csize_data;
+	}
+
+	if (!res)
+	{
+		u32 end_mark = 0;
+		lz4_img_skip_hdr_t skip = { LZ4_IMG_SKIP_MAGIC, ftr.block_num * sizeof(lz4_img_blk_t) + sizeof(lz4_img_ftr_t) };
+
+		if (fwrite(&end_mark, sizeof(u32), 1, out) != 1 ||
+			fwrite(&skip, sizeof(skip), 1, out) != 1 ||
+			fwrite(index, sizeof(lz4_img_blk_t), ftr.block_num, out) != ftr.block_num ||
+			fwrite(&ftr, sizeof(ftr), 1, out) != 1)
+			res = 1;
+		pos += sizeof(u32) + sizeof(skip) + skip.size;
+	}
+
+	if (!res)
+		printf("%s: %llu -> %llu bytes\n", out_name, (unsigned long long)in_size, (unsigned long long)pos);
+	else
+		fprintf(stderr, "I/O error\n");
+
+	free(cbuf);
+	free(buf);
+	free(index);
+	fclose(in);
+	if (fclose(out))
+		res = 1;
+
+	return res;
+}
+
+static int _index_read(FILE *in, lz4_img_ftr_t *ftr, lz4_img_blk_t **index)
+{
+	lz4_img_frame_hdr_t frame;
+	lz4_img_skip_hdr_t skip;
+
+	*index = NULL;
+
+	if (fread(&frame, sizeof(frame), 1, in) != 1 ||
+		frame.magic != LZ4F_MAGIC || frame.flg != LZ4_IMG_FRAME_FLG || frame.bd != LZ4_IMG_FRAME_BD)
+		return 1;
+
+	// Footer is at the end of the file and the index right before it.
+	if (fseeko(in, -(off_t)sizeof(lz4_img_ftr_t), SEEK_END) || fread(ftr, sizeof(lz4_img_ftr_t), 1, in) != 1 ||
+		ftr->magic != LZ4_IMG_MAGIC || ftr->version != LZ4_IMG_VERSION ||
+		!ftr->block_sectors || ftr->block_sectors > BLOCK_SECTORS ||
+		ftr->block_num != (ftr->sectors + ftr->block_sectors - 1) / ftr->block_sectors)
+		return 1;
+
+	u32 index_size = ftr->block_num * sizeof(lz4_img_blk_t);
+	if (fseeko(in, -(off_t)(sizeof(lz4_img_ftr_t) + index_size + sizeof(skip)), SEEK_END) ||
+		fread(&skip, sizeof(skip), 1, in) != 1 ||
+		skip.magic != LZ4_IMG_SKIP_MAGIC || skip.size != index_size + sizeof(lz4_img_ftr_t))
+		return 1;
+
+	*index = malloc(index_size);
+	if (fread(*index, sizeof(lz4_img_blk_t), ftr->block_num, in) != ftr->block_num)
+	{
+		free(*index);
+		*index = NULL;
+
+		return 1;
+	}
+
+	return 0;
+}
+
+static int _decompress_part(FILE *in, FILE *out, u32 lba_offset, lz4_img_ftr_t *ftr)
+{
+	lz4_img_blk_t *index;
+
+	if (_index_read(in, ftr, &index) ||
+		ftr->lba_offset != lba_offset || (ftr->lba_offset + ftr->sectors) > ftr->total_sectors)
+	{
+		free(index);
+		fprintf(stderr, "Invalid LZ4 image\n");
+		return 1;
+	}
+
+	u32 block_size = ftr->block_sectors * 512;
+	u8 *buf = malloc(block_size);
+	u8 *cbuf = malloc(block_size);
+	int res = 0;
+
+	for (u32 i = 0; !res && i < ftr->block_num; i++)
+	{
+		u32 sectors = ftr->sectors - i * ftr->block_sectors;
+		u32 size = sectors < ftr->block_sectors ? sectors * 512 : block_size;
+		u32 csize = index[i].csize & ~LZ4_IMG_BLK_STORED;
+
+		if (index[i].flags & LZ4_IMG_BLK_ZERO)
+			memset(buf, 0, size);
+		else if (fseeko(in, index[i].offset, SEEK_SET))
+			res = 1;
+		else if (index[i].csize & LZ4_IMG_BLK_STORED)
+			res = csize != size || fread(buf, size, 1, in) != 1;
+		else
+			res = !csize || csize >= size || fread(cbuf, csize, 1, in) != 1 ||
+				  LZ4_decompress_safe((const char *)cbuf, (char *)buf, csize, size) != (int)size;
+
+		if (!res && fwrite(buf, size, 1, out) != 1)
+			res = 1;
+	}
+
+	if (res)
+		fprintf(stderr, "Corrupted LZ4 image or I/O error\n");
+
+	free(cbuf);
+	free(buf);
+	free(index);
+
+	return res;
+}
+
+static int _decompress(const char *in_name, const char *out_name)
+{
+	// Split images are given by their first part, name.lz4.00.
+	u32 name_len = strlen(in_name);
+	int split = name_len > 3 && !strcmp(&in_name[name_len - 3], ".00");
+	char *part_name = strdup(in_name);
+	u32 lba_offset = 0;
+	int res = 0;
+
+	FILE *out = fopen(out_name, "wb");
+	if (!out)
+	{
+		fprintf(stderr, "Can't create %s\n", out_name);
+		free(part_name);
+		return 1;
+	}
+
+	for (u32 part = 0; ; part++)
+	{
+		if (split)
+			sprintf(&part_name[name_len - 2], "%02d", part);
+
+		FILE *in = fopen(part_name, "rb");
+		if (!in)
+		{
+			fprintf(stderr, "Can't open %s\n", part_name);
+			res = 1;
+			break;
+		}
+
+		lz4_img_ftr_t ftr;
+		res = _decompress_part(in, out, lba_offset, &ftr);
+		fclose(in);
+		if (res)
+			break;
+
+		lba_offset += ftr.sectors;
+		if (lba_offset >= ftr.total_sectors)
+			break;
+
+		if (!split)
+		{
+			fprintf(stderr, "Image is incomplete\n");
+			res = 1;
+			break;
+		}
+	}
+
+	if (fclose(out))
+		res = 1;
+	free(part_name);
+
+	if (!res)
+		printf("%s: %llu bytes\n", out_name, (unsigned long long)lba_offset * 512);
+
+	return res;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 4 || (strcmp(argv[1], "c") && strcmp(argv[1], "d")))
+	{
+		printf("Usage:\n");
+		printf("  lz4img c <raw image> <out.lz4>\n");
+		printf("  lz4img d <in.lz4 | in.lz4.00> <raw image>\n");
+		return 1;
+	}
+
+	if (argv[1][0] == 'c')
+		return _compress(argv[2], argv[3]);
+	else
+		return _decompress(argv[2], argv[3]);
+}
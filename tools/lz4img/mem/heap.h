@@ -0,0 +1,6 @@
+// Host heap for bdk/libs/compr/lz4.c.
+#include <stdlib.h>
+
+#include <utils/types.h>
+
+#define zalloc(size) calloc(1, size)
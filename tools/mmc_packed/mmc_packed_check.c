@@ -0,0 +1,133 @@
+/*
+ * Checks for the eMMC packed write command header.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <storage/mmc_def.h>
+#include <storage/sdmmc.h>
+
+static int _failed = 0;
+
+#define CHECK(cond, ...)             \
+	do {                             \
+		if (!(cond))                 \
+		{                            \
+			printf("FAIL: " __VA_ARGS__); \
+			printf("\n");            \
+			_failed++;               \
+		}                            \
+	} while (0)
+
+static u32 _get_le32(const u8 *buf)
+{
+	return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((u32)buf[3] << 24);
+}
+
+static void _check_hdr(bool sector_access, u32 count)
+{
+	sdmmc_storage_t storage;
+	mmc_packed_entry_t entries[MMC_PACKED_HDR_ENTRIES_MAX];
+	u8 hdr[SDMMC_DAT_BLOCKSIZE];
+
+	memset(&storage, 0, sizeof(storage));
+	storage.has_sector_access = sector_access;
+
+	for (u32 i = 0; i < count; i++)
+	{
+		entries[i].sector      = 0x100000 + i * 0x1234;
+		entries[i].num_sectors = 1 + i * 3;
+		entries[i].buf         = NULL;
+	}
+
+	memset(hdr, 0xAA, sizeof(hdr));
+	mmc_storage_packed_hdr_build(&storage, (u32 *)hdr, entries, count);
+
+	// Byte 0: version, byte 1: R/W flag, byte 2: number of entries, byte 3: reserved.
+	CHECK(hdr[0] == 0x01, "version is %02X", hdr[0]);
+	CHECK(hdr[1] == 0x02, "R/W flag is %02X, expected write", hdr[1]);
+	CHECK(hdr[2] == count, "entry count is %d, expected %d", hdr[2], count);
+	CHECK(hdr[3] == 0, "reserved byte is %02X", hdr[3]);
+	CHECK(!_get_le32(&hdr[4]), "reserved word is %08X", _get_le32(&hdr[4]));
+
+	// Entries start at byte 8. CMD23 argument, then CMD25 address.
+	for (u32 i = 0; i < count; i++)
+	{
+		u32 arg  = _get_le32(&hdr[8 + i * 8]);
+		u32 addr = _get_le32(&hdr[8 + i * 8 + 4]);
+		u32 expected_addr = sector_access ? entries[i].sector : entries[i].sector << 9;
+
+		CHECK(arg == entries[i].num_sectors, "entry %d CMD23 arg is %08X, expected %08X", i, arg, entries[i].num_sectors);
+		CHECK(!(arg & (MMC_CMD23_ARG_REL_WR | MMC_CMD23_ARG_PACKED)), "entry %d CMD23 arg has flags set", i);
+		CHECK(addr == expected_addr, "entry %d address is %08X, expected %08X", i, addr, expected_addr);
+	}
+
+	// Rest of the block is zero.
+	for (u32 i = 8 + count * 8; i < SDMMC_DAT_BLOCKSIZE; i++)
+	{
+		if (hdr[i])
+		{
+			CHECK(false, "byte %d after %d entries is %02X", i, count, hdr[i]);
+			break;
+		}
+	}
+}
+
+static void _check_max_entries()
+{
+	sdmmc_storage_t storage;
+	memset(&storage, 0, sizeof(storage));
+
+	storage.ext_csd.max_packed_wr = 0x20;
+	CHECK(!mmc_storage_packed_max_entries(&storage), "uninitialized storage allows packed writes");
+
+	storage.initialized = 1;
+	CHECK(mmc_storage_packed_max_entries(&storage) == 0x20, "max entries is %d, expected 32",
+		  mmc_storage_packed_max_entries(&storage));
+
+	storage.ext_csd.max_packed_wr = 0xFF;
+	CHECK(mmc_storage_packed_max_entries(&storage) == MMC_PACKED_HDR_ENTRIES_MAX, "max entries is not limited to header size");
+
+	storage.ext_csd.max_packed_wr = 0;
+	CHECK(!mmc_storage_packed_max_entries(&storage), "packed writes allowed without failure reporting");
+}
+
+int main()
+{
+	// The header must hold all entries in one block.
+	CHECK(8 + MMC_PACKED_HDR_ENTRIES_MAX * 8 <= SDMMC_DAT_BLOCKSIZE, "max entries do not fit in the header block");
+
+	u32 counts[] = { 2, 3, 32, MMC_PACKED_HDR_ENTRIES_MAX };
+	for (u32 i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+	{
+		_check_hdr(true, counts[i]);
+		_check_hdr(false, counts[i]);
+	}
+
+	_check_max_entries();
+
+	if (_failed)
+	{
+		printf("%d checks failed.\n", _failed);
+		return 1;
+	}
+
+	printf("All packed header checks passed.\n");
+
+	return 0;
+}
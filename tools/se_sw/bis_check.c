@@ -0,0 +1,238 @@
+/*
+ * Runs the eMMC BIS driver against the software SE backend.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <memory_map.h>
+
+#include "se_sw.h"
+
+#define PART_LBA_START 0x40
+#define PART_CLUSTERS  64
+#define PART_SECTORS   (PART_CLUSTERS * 32)
+#define PART_SIZE      (PART_SECTORS * 512)
+
+// BIS cache and lookup table live at fixed DRAM addresses. Use host memory that fits the test partition.
+static u8 bis_cache_mem[SZ_2M]  __attribute__((aligned(8)));
+static u8 bis_lookup_mem[SZ_4K] __attribute__((aligned(8)));
+
+#undef  NX_BIS_CACHE_ADDR
+#define NX_BIS_CACHE_ADDR bis_cache_mem
+#undef  NX_BIS_LOOKUP_ADDR
+#define NX_BIS_LOOKUP_ADDR bis_lookup_mem
+
+#include "../../bdk/storage/nx_emmc_bis.c"
+
+static int _failed = 0;
+
+#define CHECK(cond, ...)             \
+	do {                             \
+		if (!(cond))                 \
+		{                            \
+			printf("FAIL: " __VA_ARGS__); \
+			printf("\n");            \
+			_failed++;               \
+		}                            \
+	} while (0)
+
+sdmmc_storage_t emmc_storage;
+sdmmc_storage_t sd_storage;
+
+static u8 disk[(PART_LBA_START + PART_SECTORS) * EMMC_BLOCKSIZE];
+static u8 plain[PART_SIZE];
+static u8 expected[PART_SIZE];
+static u8 buf[PART_SIZE];
+
+static emmc_part_t part = { .lba_start = PART_LBA_START, .lba_end = PART_LBA_START + PART_SECTORS - 1, .name = "SYSTEM" };
+
+static u32 packed_max_entries = 0;
+static u32 packed_writes = 0;
+static u32 packed_fail = 0;
+
+int emmc_part_read(emmc_part_t *part, u32 sector_off, u32 num_sectors, void *buf)
+{
+	memcpy(buf, disk + (part->lba_start + sector_off) * EMMC_BLOCKSIZE, num_sectors * EMMC_BLOCKSIZE);
+
+	return 0;
+}
+
+int emmc_part_write(emmc_part_t *part, u32 sector_off, u32 num_sectors, void *buf)
+{
+	memcpy(disk + (part->lba_start + sector_off) * EMMC_BLOCKSIZE, buf, num_sectors * EMMC_BLOCKSIZE);
+
+	return 0;
+}
+
+int sdmmc_storage_read(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	return 1;
+}
+
+int sdmmc_storage_write(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	return 1;
+}
+
+u32 mmc_storage_packed_max_entries(sdmmc_storage_t *storage)
+{
+	return packed_max_entries;
+}
+
+int mmc_storage_write_packed(sdmmc_storage_t *storage, const mmc_packed_entry_t *entries, u32 count)
+{
+	if (packed_fail)
+	{
+		packed_fail--;
+		return 1;
+	}
+
+	for (u32 i = 0; i < count; i++)
+		memcpy(disk + entries[i].sector * EMMC_BLOCKSIZE, entries[i].buf, entries[i].num_sectors * EMMC_BLOCKSIZE);
+	packed_writes++;
+
+	return 0;
+}
+
+// Independent image of the partition, encrypted cluster by cluster.
+static void _expected_build()
+{
+	u8 tweak[SE_AES_BLOCK_SIZE];
+
+	for (u32 i = 0; i < PART_CLUSTERS; i++)
+		se_aes_crypt_xts_sec_nx(5, 4, ENCRYPT, i, tweak, true, 0,
+			expected + i * BIS_CLUSTER_SIZE, plain + i * BIS_CLUSTER_SIZE, BIS_CLUSTER_SIZE);
+}
+
+static bool _disk_matches()
+{
+	return !memcmp(disk + PART_LBA_START * EMMC_BLOCKSIZE, expected, PART_SIZE);
+}
+
+static void _plain_update(u32 sector, u32 count, u8 seed)
+{
+	for (u32 i = 0; i < count * EMMC_BLOCKSIZE; i++)
+		plain[sector * EMMC_BLOCKSIZE + i] = seed + i * 3;
+}
+
+// Unaligned, cluster crossing, backwards and skipping reads.
+static const u32 read_pattern[][2] = {
+	{ 0, 1 }, { 1, 2 }, { 5, 3 }, { 30, 40 }, { 31, 1 }, { 28, 2 }, { 100, 200 }, { 90, 5 }, { 0, PART_SECTORS }
+};
+
+static void _check_reads(const char *name)
+{
+	for (u32 i = 0; i < ARRAY_SIZE(read_pattern); i++)
+	{
+		u32 sector = read_pattern[i][0];
+		u32 count  = read_pattern[i][1];
+
+		memset(buf, 0, count * EMMC_BLOCKSIZE);
+		CHECK(!nx_emmc_bis_read(sector, count, buf), "%s: read %d+%d failed", name, sector, count);
+		CHECK(!memcmp(buf, plain + sector * EMMC_BLOCKSIZE, count * EMMC_BLOCKSIZE),
+			"%s: read %d+%d returned wrong data", name, sector, count);
+	}
+}
+
+static void _check_cached_writes(const char *name, u32 max_entries)
+{
+	packed_max_entries = max_entries;
+	packed_writes = 0;
+
+	// Only clusters that were read get cached.
+	nx_emmc_bis_init(&part, true, 0);
+	_check_reads(name);
+
+	// Partial and full cluster writes over 20 clusters.
+	for (u32 i = 0; i < 20; i++)
+	{
+		u32 sector = i * 3 * BIS_CLUSTER_SECTORS + (i % 5) * 4;
+		u32 count  = (i % 3) ? 4 : BIS_CLUSTER_SECTORS - (i % 5) * 4;
+
+		_plain_update(sector, count, max_entries + i);
+		CHECK(!nx_emmc_bis_write(sector, count, plain + sector * EMMC_BLOCKSIZE), "%s: write %d failed", name, sector);
+	}
+	_expected_build();
+
+	CHECK(!_disk_matches(), "%s: writes were not cached", name);
+	_check_reads(name);
+
+	// Failed packed write keeps the dirty clusters in plaintext, so a retry succeeds.
+	if (max_entries)
+	{
+		packed_fail = 1;
+		CHECK(nx_emmc_bis_flush(), "%s: flush did not report write failure", name);
+		_check_reads(name);
+	}
+
+	CHECK(!nx_emmc_bis_flush(), "%s: flush failed", name);
+	CHECK(_disk_matches(), "%s: flushed image differs from expected", name);
+	CHECK(!max_entries || packed_writes, "%s: packed writes were not used", name);
+
+	CHECK(!nx_emmc_bis_end(), "%s: end failed", name);
+}
+
+int main()
+{
+	u8 key_crypt[SE_KEY_128_SIZE], key_tweak[SE_KEY_128_SIZE];
+
+	for (u32 i = 0; i < SE_KEY_128_SIZE; i++)
+	{
+		key_crypt[i] = i * 0x11;
+		key_tweak[i] = 0xF0 - i;
+	}
+	se_aes_key_set(4, key_crypt, SE_KEY_128_SIZE);
+	se_aes_key_set(5, key_tweak, SE_KEY_128_SIZE);
+
+	for (u32 i = 0; i < PART_SIZE; i++)
+		plain[i] = i ^ (i >> 9);
+	_expected_build();
+	memcpy(disk + PART_LBA_START * EMMC_BLOCKSIZE, expected, PART_SIZE);
+
+	// Uncached reads run the async decrypt path. Slow queue so reads overlap decryption.
+	se_sw_async_latency_set(16);
+	nx_emmc_bis_init(&part, false, 0);
+	_check_reads("async-read");
+
+	// Uncached writes encrypt directly to eMMC.
+	_plain_update(33, 7, 0x5A);
+	CHECK(!nx_emmc_bis_write(33, 7, plain + 33 * EMMC_BLOCKSIZE), "direct-write: write failed");
+	_expected_build();
+	CHECK(_disk_matches(), "direct-write: image differs from expected");
+	_check_reads("direct-write");
+	CHECK(!nx_emmc_bis_end(), "direct-write: end failed");
+
+	nx_emmc_bis_init(&part, true, 0);
+	_check_reads("cached-read");
+	CHECK(!nx_emmc_bis_end(), "cached-read: end failed");
+
+	_check_cached_writes("cached-write", 0);
+	_check_cached_writes("packed-write", 8);
+
+	CHECK(!se_sw_async_violations(), "SE was used while an async operation was queued");
+
+	if (_failed)
+	{
+		printf("%d checks failed.\n", _failed);
+		return 1;
+	}
+
+	printf("All BIS checks passed.\n");
+
+	return 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * Runs the package2 build and decrypt paths against the software SE backend.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "se_sw.h"
+
+// Patch db structs hold pointers, so their size checks only hold on the 32-bit target.
+#define _Static_assert(cond, msg)
+
+#include "../../bootloader/hos/pkg2.c"
+
+#define KERNEL_SIZE 0x3000
+#define KIP_NUM     2
+
+static int _failed = 0;
+
+#define CHECK(cond, ...)             \
+	do {                             \
+		if (!(cond))                 \
+		{                            \
+			printf("FAIL: " __VA_ARGS__); \
+			printf("\n");            \
+			_failed++;               \
+		}                            \
+	} while (0)
+
+hekate_config h_cfg;
+const u8 package2_keyseed[SE_KEY_128_SIZE] = { 0 };
+
+static const pkg1_id_t pkg1_id = { .id = "20181107105943", .mkey = HOS_MKEY_VER_600 };
+
+static const u32 kip_sizes[KIP_NUM] = { 0x280, 0x1C4 };
+
+static u8 kernel[KERNEL_SIZE];
+static u8 kips[KIP_NUM][SZ_1K] __attribute__((aligned(4)));
+static pkg2_kip1_info_t kips_info[KIP_NUM];
+
+static u8 pkg2[SZ_64K]      __attribute__((aligned(4)));
+static u8 pkg2_enc[SZ_64K]  __attribute__((aligned(4)));
+static u8 expected[SZ_64K];
+
+static void _kips_init(link_t *info)
+{
+	list_init(info);
+
+	for (u32 i = 0; i < KIP_NUM; i++)
+	{
+		pkg2_kip1_t *kip1 = (pkg2_kip1_t *)kips[i];
+
+		for (u32 j = 0; j < kip_sizes[i]; j++)
+			kips[i][j] = j * (i + 3);
+		kip1->tid = 0x0100000000000000 + i;
+
+		kips_info[i].kip1 = kip1;
+		kips_info[i].size = kip_sizes[i];
+		list_append(info, &kips_info[i].link);
+	}
+}
+
+// Expected INI1 as merged by the package2 builder.
+static u32 _ini1_build(u8 *dst)
+{
+	pkg2_ini1_t *ini1 = (pkg2_ini1_t *)dst;
+	u32 size = sizeof(pkg2_ini1_t);
+
+	memset(ini1, 0, sizeof(pkg2_ini1_t));
+	for (u32 i = 0; i < KIP_NUM; i++)
+	{
+		memcpy(dst + size, kips[i], kip_sizes[i]);
+		size += kip_sizes[i];
+	}
+
+	ini1->magic     = INI1_MAGIC;
+	ini1->size      = ALIGN(size, 4);
+	ini1->num_procs = KIP_NUM;
+
+	return ini1->size;
+}
+
+static void _check_pkg2(const char *name, bool new_pkg2, bool is_exo)
+{
+	u8 hash[SE_SHA_256_SIZE];
+	launch_ctxt_t ctxt = { 0 };
+	link_t info;
+
+	_kips_init(&info);
+
+	ctxt.pkg1_id     = &pkg1_id;
+	ctxt.kernel      = kernel;
+	ctxt.kernel_size = KERNEL_SIZE;
+	ctxt.new_pkg2    = new_pkg2;
+
+	// Build.
+	pkg2_keyslot = 8;
+	memset(pkg2, 0, sizeof(pkg2));
+	pkg2_build_encrypt(pkg2, &ctxt, &info, is_exo);
+	memcpy(pkg2_enc, pkg2, sizeof(pkg2));
+
+	// Decrypt and check header.
+	pkg2_hdr_t *hdr = pkg2_decrypt(pkg2, pkg1_id.mkey, is_exo);
+	CHECK(hdr, "%s: header did not decrypt", name);
+	if (!hdr)
+		return;
+
+	CHECK(hdr->sec_off[PKG2_SEC_KERNEL] == (new_pkg2 ? 0x60000 : 0x10000000), "%s: wrong kernel offset", name);
+
+	// New Package2 embeds INI1 after the kernel and points the kernel to it.
+	memcpy(expected, kernel, KERNEL_SIZE);
+	u32 kernel_size = KERNEL_SIZE;
+	u32 ini1_size   = _ini1_build(expected + KERNEL_SIZE);
+	if (new_pkg2)
+	{
+		*(u32 *)(expected + pkg2_newkern_ini1_info) = KERNEL_SIZE - pkg2_newkern_ini1_rela;
+		kernel_size += ini1_size;
+		ini1_size = 0;
+	}
+
+	CHECK(hdr->sec_size[PKG2_SEC_KERNEL] == kernel_size, "%s: wrong kernel size", name);
+	CHECK(hdr->sec_size[PKG2_SEC_INI1] == ini1_size, "%s: wrong INI1 size", name);
+	CHECK(!memcmp(hdr->data, expected, kernel_size + ini1_size), "%s: sections differ after decryption", name);
+
+	// Section hashes are over the encrypted data.
+	u8 *sec = pkg2_enc + 0x100 + sizeof(pkg2_hdr_t);
+	for (u32 i = PKG2_SEC_KERNEL; i <= PKG2_SEC_UNUSED; i++)
+	{
+		if (is_exo)
+			break;
+
+		se_sha_hash_256_oneshot(hash, sec, hdr->sec_size[i]);
+		CHECK(!memcmp(hash, hdr->sec_sha256[i], SE_SHA_256_SIZE), "%s: section %d hash mismatch", name, i);
+		sec += hdr->sec_size[i];
+	}
+
+	// Kernel was encrypted through the async queue. Check it against a sync encryption.
+	u8 ctr[SE_AES_IV_SIZE] = { 0 };
+	se_aes_crypt_ctr(8, expected, expected, kernel_size, ctr);
+	CHECK(!memcmp(pkg2_enc + 0x100 + sizeof(pkg2_hdr_t), expected, kernel_size), "%s: async kernel encryption differs", name);
+}
+
+int main()
+{
+	u8 key[SE_KEY_128_SIZE];
+
+	for (u32 i = 0; i < SE_KEY_128_SIZE; i++)
+		key[i] = 0xA0 ^ (i * 13);
+	se_aes_key_set(8, key, SE_KEY_128_SIZE);
+
+	for (u32 i = 0; i < KERNEL_SIZE; i++)
+		kernel[i] = i ^ (i >> 8) ^ 0x5C;
+
+	// Slow queue so INI1 merging overlaps the kernel encryption.
+	se_sw_async_latency_set(16);
+
+	_check_pkg2("old-pkg2", false, false);
+	_check_pkg2("old-pkg2-exo", false, true);
+	_check_pkg2("new-pkg2", true, false);
+
+	CHECK(!se_sw_async_violations(), "SE was used while an async operation was queued");
+
+	if (_failed)
+	{
+		printf("%d checks failed.\n", _failed);
+		return 1;
+	}
+
+	printf("All package2 crypto checks passed.\n");
+
+	return 0;
+}
@@ -0,0 +1,261 @@
+/*
+ * Known answer checks and throughput benchmark for the software SE backend.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <sec/se.h>
+
+#define BENCH_SIZE SZ_16M
+
+static const u8 aes_key[SE_KEY_128_SIZE] = {
+	0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+};
+
+static const u8 aes_msg[SE_AES_BLOCK_SIZE] = {
+	0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A
+};
+
+// SP 800-38A F.1.1.
+static const u8 ecb_res[SE_AES_BLOCK_SIZE] = {
+	0x3A, 0xD7, 0x7B, 0xB4, 0x0D, 0x7A, 0x36, 0x60, 0xA8, 0x9E, 0xCA, 0xF3, 0x24, 0x66, 0xEF, 0x97
+};
+
+// SP 800-38A F.5.1.
+static const u8 ctr_iv[SE_AES_IV_SIZE] = {
+	0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF
+};
+static const u8 ctr_res[SE_AES_BLOCK_SIZE] = {
+	0x87, 0x4D, 0x61, 0x91, 0xB6, 0x20, 0xE3, 0x26, 0x1B, 0xEF, 0x68, 0x64, 0x99, 0x0D, 0xB6, 0xCE
+};
+
+// SP 800-38A F.2.1.
+static const u8 cbc_iv[SE_AES_IV_SIZE] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
+};
+static const u8 cbc_res[SE_AES_BLOCK_SIZE] = {
+	0x76, 0x49, 0xAB, 0xAC, 0x81, 0x19, 0xB2, 0x46, 0xCE, 0xE9, 0x8E, 0x9B, 0x12, 0xE9, 0x19, 0x7D
+};
+
+// RFC 4493 example 2.
+static const u8 cmac_res[SE_AES_CMAC_DIGEST_SIZE] = {
+	0x07, 0x0A, 0x16, 0xB4, 0x6B, 0x4D, 0x41, 0x44, 0xF7, 0x9B, 0xDD, 0x9D, 0xD0, 0x4A, 0x28, 0x7C
+};
+
+// IEEE P1619 XTS-AES-128 vector 1. Sector 0 encodes the same in both tweak endianness.
+static const u8 xts_ieee_res[SE_AES_BLOCK_SIZE * 2] = {
+	0x91, 0x7C, 0xF6, 0x9E, 0xBD, 0x68, 0xB2, 0xEC, 0x9B, 0x9F, 0xE9, 0xA3, 0xEA, 0xDD, 0xA6, 0x92,
+	0xCD, 0x43, 0xD2, 0xF5, 0x95, 0x98, 0xED, 0x85, 0x8C, 0x02, 0xC2, 0x65, 0x2F, 0xBF, 0x92, 0x2E
+};
+
+// Nintendo XTS of bytes 00-FF repeated, key crypt: aes_key, key tweak: cbc_iv, cluster 0x12345.
+// First and last block of each of the first 5 sectors.
+#define XTS_NX_CLUSTER 0x12345
+#define XTS_NX_SECTORS 5
+#define XTS_NX_SECTOR_SIZE 512
+static const u8 xts_nx_res[XTS_NX_SECTORS][2][SE_AES_BLOCK_SIZE] = {
+	{
+		{ 0x43, 0xD0, 0x33, 0x9F, 0x70, 0x17, 0xD5, 0x14, 0x60, 0x87, 0x1D, 0xB6, 0xDE, 0x47, 0x64, 0x86 },
+		{ 0x52, 0x9E, 0x0B, 0xD9, 0x07, 0xF2, 0xCC, 0x07, 0x17, 0xEC, 0x42, 0x8F, 0x26, 0x2E, 0x59, 0x24 }
+	},
+	{
+		{ 0x6F, 0x7D, 0xDB, 0x98, 0x70, 0xB6, 0xE2, 0xEE, 0xB2, 0x5B, 0xCC, 0x3B, 0x0A, 0xD4, 0xAB, 0x44 },
+		{ 0x35, 0xD3, 0x5B, 0xC8, 0xE3, 0xEF, 0xC5, 0x64, 0x06, 0xB9, 0x6D, 0x6A, 0x98, 0x22, 0x41, 0xFD }
+	},
+	{
+		{ 0xF8, 0xC6, 0x42, 0x17, 0xFB, 0x3E, 0x14, 0xDA, 0x7F, 0x09, 0x84, 0x45, 0x87, 0xF9, 0x30, 0x23 },
+		{ 0x4F, 0xAB, 0x14, 0xFC, 0xDC, 0x74, 0x65, 0x08, 0x04, 0x05, 0x03, 0xD1, 0x48, 0x24, 0x86, 0x02 }
+	},
+	{
+		{ 0xB2, 0xEE, 0x45, 0xC3, 0x28, 0xBC, 0x1A, 0x36, 0xF2, 0x66, 0x65, 0x1F, 0xE1, 0xFE, 0xC3, 0xE6 },
+		{ 0xBE, 0x65, 0xE1, 0x06, 0x44, 0x70, 0x49, 0x20, 0xFA, 0x71, 0x6D, 0x99, 0x40, 0xA0, 0xE7, 0xBA }
+	},
+	{
+		{ 0x50, 0xA4, 0xA3, 0xDC, 0xC0, 0x03, 0xF4, 0xA2, 0x87, 0x88, 0x46, 0xA7, 0x60, 0xBD, 0xE9, 0x82 },
+		{ 0x57, 0xB8, 0x98, 0x11, 0x8E, 0x7F, 0xB0, 0xC1, 0x2F, 0x07, 0xCC, 0x19, 0x87, 0x20, 0xE4, 0xC4 }
+	}
+};
+
+// FIPS 180-2 "abc".
+static const u8 sha_res[SE_SHA_256_SIZE] = {
+	0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA, 0x41, 0x41, 0x40, 0xDE, 0x5D, 0xAE, 0x22, 0x23,
+	0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17, 0x7A, 0x9C, 0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD
+};
+
+static int _check(const char *name, const void *res, const void *expected, u32 size)
+{
+	int fail = memcmp(res, expected, size) != 0;
+
+	printf("%-12s %s\n", name, fail ? "FAIL" : "ok");
+
+	return fail;
+}
+
+static int _check_xts_nx_sectors(const char *name, const u8 *buf, u32 first, u32 count)
+{
+	int fail = 0;
+
+	for (u32 i = 0; i < count; i++)
+	{
+		const u8 *sec = buf + i * XTS_NX_SECTOR_SIZE;
+
+		fail |= memcmp(sec, xts_nx_res[first + i][0], SE_AES_BLOCK_SIZE);
+		fail |= memcmp(sec + XTS_NX_SECTOR_SIZE - SE_AES_BLOCK_SIZE, xts_nx_res[first + i][1], SE_AES_BLOCK_SIZE);
+	}
+
+	printf("%-12s %s\n", name, fail ? "FAIL" : "ok");
+
+	return fail;
+}
+
+static int _known_answer_checks()
+{
+	u8 buf[SE_AES_BLOCK_SIZE * 4];
+	u8 ctr[SE_AES_IV_SIZE];
+	u8 tweak[SE_AES_BLOCK_SIZE];
+	u8 zeros[SE_AES_BLOCK_SIZE * 2] = { 0 };
+	static u8 src[XTS_NX_SECTOR_SIZE * XTS_NX_SECTORS];
+	static u8 enc[XTS_NX_SECTOR_SIZE * XTS_NX_SECTORS];
+	static u8 dec[XTS_NX_SECTOR_SIZE * XTS_NX_SECTORS];
+	int fail = 0;
+
+	se_aes_key_set(0, aes_key, SE_KEY_128_SIZE);
+	se_aes_key_set(1, cbc_iv, SE_KEY_128_SIZE);
+
+	se_aes_crypt_ecb(0, ENCRYPT, buf, aes_msg, SE_AES_BLOCK_SIZE);
+	fail |= _check("aes-ecb", buf, ecb_res, SE_AES_BLOCK_SIZE);
+	se_aes_crypt_ecb(0, DECRYPT, buf, buf, SE_AES_BLOCK_SIZE);
+	fail |= _check("aes-ecb-dec", buf, aes_msg, SE_AES_BLOCK_SIZE);
+
+	se_aes_iv_set(0, cbc_iv, SE_AES_IV_SIZE);
+	se_aes_crypt_cbc(0, ENCRYPT, buf, aes_msg, SE_AES_BLOCK_SIZE);
+	fail |= _check("aes-cbc", buf, cbc_res, SE_AES_BLOCK_SIZE);
+
+	memcpy(ctr, ctr_iv, SE_AES_IV_SIZE);
+	se_aes_crypt_ctr(0, buf, aes_msg, SE_AES_BLOCK_SIZE, ctr);
+	fail |= _check("aes-ctr", buf, ctr_res, SE_AES_BLOCK_SIZE);
+
+	se_aes_hash_cmac(0, buf, aes_msg, SE_AES_BLOCK_SIZE);
+	fail |= _check("aes-cmac", buf, cmac_res, SE_AES_CMAC_DIGEST_SIZE);
+
+	se_sha_hash_256_oneshot(buf, "abc", 3);
+	fail |= _check("sha256", buf, sha_res, SE_SHA_256_SIZE);
+
+	// Nintendo XTS. Zero keys with sector 0 match the standard XTS vector.
+	se_aes_key_set(2, zeros, SE_KEY_128_SIZE);
+	se_aes_crypt_xts_sec_nx(2, 2, ENCRYPT, 0, tweak, true, 0, buf, zeros, sizeof(zeros));
+	fail |= _check("aes-xts-ieee", buf, xts_ieee_res, sizeof(xts_ieee_res));
+
+	for (u32 i = 0; i < sizeof(src); i++)
+		src[i] = i;
+
+	se_aes_crypt_xts_sec_nx(1, 0, ENCRYPT, XTS_NX_CLUSTER, tweak, true, 0, enc, src, sizeof(src));
+	fail |= _check_xts_nx_sectors("aes-xts-nx", enc, 0, XTS_NX_SECTORS);
+
+	// Sector inside a cluster, tweak advanced by tweak_exp sectors.
+	se_aes_crypt_xts_sec_nx(1, 0, ENCRYPT, XTS_NX_CLUSTER, tweak, true, 3, dec, src + XTS_NX_SECTOR_SIZE * 3, XTS_NX_SECTOR_SIZE);
+	fail |= _check_xts_nx_sectors("xts-nx-exp", dec, 3, 1);
+
+	// Saved tweak continuation, like BIS reads. Sectors 1, 2 and then 4.
+	se_aes_crypt_xts_sec_nx(1, 0, DECRYPT, XTS_NX_CLUSTER, tweak, true, 1, dec + XTS_NX_SECTOR_SIZE, enc + XTS_NX_SECTOR_SIZE, XTS_NX_SECTOR_SIZE);
+	se_aes_crypt_xts_sec_nx(1, 0, DECRYPT, XTS_NX_CLUSTER, tweak, false, 0, dec + XTS_NX_SECTOR_SIZE * 2, enc + XTS_NX_SECTOR_SIZE * 2, XTS_NX_SECTOR_SIZE);
+	se_aes_crypt_xts_sec_nx(1, 0, DECRYPT, XTS_NX_CLUSTER, tweak, false, 1, dec + XTS_NX_SECTOR_SIZE * 4, enc + XTS_NX_SECTOR_SIZE * 4, XTS_NX_SECTOR_SIZE);
+	fail |= _check("xts-nx-cont", dec + XTS_NX_SECTOR_SIZE, src + XTS_NX_SECTOR_SIZE, XTS_NX_SECTOR_SIZE * 2);
+	fail |= _check("xts-nx-skip", dec + XTS_NX_SECTOR_SIZE * 4, src + XTS_NX_SECTOR_SIZE * 4, XTS_NX_SECTOR_SIZE);
+
+	// Same through the async queue.
+	memset(dec, 0, sizeof(dec));
+	se_aes_crypt_xts_sec_nx_async(1, 0, DECRYPT, XTS_NX_CLUSTER, tweak, true, 0, dec, enc, sizeof(enc));
+	while (!se_aes_async_done())
+		;
+	se_aes_finalize();
+	fail |= _check("xts-nx-async", dec, src, sizeof(src));
+
+	return fail;
+}
+
+static void _bench(const char *name, int (*op)(u8 *buf, u32 size), u8 *buf)
+{
+	struct timespec start, end;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	op(buf, BENCH_SIZE);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	double secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("%-12s %8.1f MiB/s\n", name, (BENCH_SIZE / (double)SZ_1M) / secs);
+}
+
+static int _bench_ecb(u8 *buf, u32 size)
+{
+	return se_aes_crypt_ecb(0, ENCRYPT, buf, buf, size);
+}
+
+static int _bench_ecb_dec(u8 *buf, u32 size)
+{
+	return se_aes_crypt_ecb(0, DECRYPT, buf, buf, size);
+}
+
+static int _bench_ctr(u8 *buf, u32 size)
+{
+	u8 ctr[SE_AES_IV_SIZE] = { 0 };
+
+	return se_aes_crypt_ctr(0, buf, buf, size, ctr);
+}
+
+static int _bench_xts_nx(u8 *buf, u32 size)
+{
+	u8 tweak[SE_AES_BLOCK_SIZE];
+
+	// BIS clusters.
+	for (u32 i = 0; i < size / SZ_16K; i++)
+		se_aes_crypt_xts_sec_nx(1, 0, DECRYPT, i, tweak, true, 0, buf + i * SZ_16K, buf + i * SZ_16K, SZ_16K);
+
+	return 0;
+}
+
+static int _bench_sha256(u8 *buf, u32 size)
+{
+	u8 hash[SE_SHA_256_SIZE];
+
+	return se_sha_hash_256_oneshot(hash, buf, size);
+}
+
+int main(int argc, char *argv[])
+{
+	if (_known_answer_checks())
+		return 1;
+
+	u8 *buf = malloc(BENCH_SIZE);
+	if (!buf)
+		return 1;
+	se_rng_pseudo(buf, BENCH_SIZE);
+
+	printf("\n");
+	_bench("aes-ecb", _bench_ecb, buf);
+	_bench("aes-ecb-dec", _bench_ecb_dec, buf);
+	_bench("aes-ctr", _bench_ctr, buf);
+	_bench("aes-xts-nx", _bench_xts_nx, buf);
+	_bench("sha256", _bench_sha256, buf);
+
+	free(buf);
+
+	return 0;
+}
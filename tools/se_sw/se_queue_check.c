@@ -0,0 +1,208 @@
+/*
+ * Checks for the async AES queue of the software SE backend.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sec/se.h>
+
+#include "se_sw.h"
+
+#define KS_CRYPT 0
+#define KS_TWEAK 1
+
+#define MSG_SIZE     (SE_AES_BLOCK_SIZE * 8 + 5) // Includes a partial last block.
+#define CLUSTER_SIZE SZ_16K
+#define CLUSTERS     4
+
+static int _failed = 0;
+
+#define CHECK(cond, ...)             \
+	do {                             \
+		if (!(cond))                 \
+		{                            \
+			printf("FAIL: " __VA_ARGS__); \
+			printf("\n");            \
+			_failed++;               \
+		}                            \
+	} while (0)
+
+static const u8 key_crypt[SE_KEY_128_SIZE] = {
+	0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+};
+
+static const u8 key_tweak[SE_KEY_128_SIZE] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
+};
+
+static u8 msg[MSG_SIZE];
+static u8 expected[MSG_SIZE];
+static u8 out[MSG_SIZE];
+
+static u8 disk[CLUSTER_SIZE * CLUSTERS];
+static u8 plain[CLUSTER_SIZE * CLUSTERS];
+static u8 dma_buff[CLUSTER_SIZE];
+static u8 read_buff[CLUSTER_SIZE * CLUSTERS];
+
+static void _check_poll(const char *name)
+{
+	CHECK(!se_aes_async_done(), "%s: done before latency elapsed", name);
+	CHECK(se_aes_async_done(), "%s: not done after latency elapsed", name);
+}
+
+static void _check_modes()
+{
+	u8 ctr[SE_AES_IV_SIZE] = { 0xF0, 0xF1, 0xF2, 0xF3 };
+
+	// ECB.
+	se_aes_crypt_ecb(KS_CRYPT, ENCRYPT, expected, msg, MSG_SIZE);
+	memset(out, 0, MSG_SIZE);
+	CHECK(!se_aes_crypt_ecb_async(KS_CRYPT, ENCRYPT, out, msg, MSG_SIZE), "ecb: submit failed");
+	_check_poll("ecb");
+	CHECK(!se_aes_finalize(), "ecb: finalize failed");
+	CHECK(!memcmp(out, expected, MSG_SIZE), "ecb: async result differs from sync");
+
+	// CBC, both directions.
+	se_aes_iv_set(KS_CRYPT, key_tweak, SE_AES_IV_SIZE);
+	se_aes_crypt_cbc(KS_CRYPT, ENCRYPT, expected, msg, MSG_SIZE);
+	memset(out, 0, MSG_SIZE);
+	CHECK(!se_aes_crypt_cbc_async(KS_CRYPT, ENCRYPT, out, msg, MSG_SIZE), "cbc: submit failed");
+	_check_poll("cbc");
+	CHECK(!se_aes_finalize(), "cbc: finalize failed");
+	CHECK(!memcmp(out, expected, MSG_SIZE), "cbc: async result differs from sync");
+
+	u32 aligned = ALIGN_DOWN(MSG_SIZE, SE_AES_BLOCK_SIZE);
+	CHECK(!se_aes_crypt_cbc_async(KS_CRYPT, DECRYPT, out, expected, aligned), "cbc-dec: submit failed");
+	CHECK(!se_aes_finalize(), "cbc-dec: finalize failed");
+	CHECK(!memcmp(out, msg, aligned), "cbc-dec: async decrypt does not restore message");
+
+	// CTR. Counter is latched on submit, so the caller can reuse it right away.
+	se_aes_crypt_ctr(KS_CRYPT, expected, msg, MSG_SIZE, ctr);
+	memset(out, 0, MSG_SIZE);
+	CHECK(!se_aes_crypt_ctr_async(KS_CRYPT, out, msg, MSG_SIZE, ctr), "ctr: submit failed");
+	memset(ctr, 0, SE_AES_IV_SIZE);
+	_check_poll("ctr");
+	CHECK(!se_aes_finalize(), "ctr: finalize failed");
+	CHECK(!memcmp(out, expected, MSG_SIZE), "ctr: async result differs from sync");
+}
+
+static void _check_xts_nx()
+{
+	u8 tweak[SE_AES_BLOCK_SIZE];
+	u8 src[CLUSTER_SIZE];
+	u8 dst[CLUSTER_SIZE];
+
+	memcpy(src, disk, CLUSTER_SIZE);
+	se_aes_crypt_xts_sec_nx(KS_TWEAK, KS_CRYPT, DECRYPT, 0, tweak, true, 0, dst, src, CLUSTER_SIZE);
+
+	// Output tweak is only applied on finalize.
+	CHECK(!se_aes_crypt_xts_sec_nx_async(KS_TWEAK, KS_CRYPT, DECRYPT, 0, tweak, true, 0, out, src, SE_AES_BLOCK_SIZE * 4),
+		"xts-nx: submit failed");
+	CHECK(memcmp(out, dst, SE_AES_BLOCK_SIZE * 4), "xts-nx: output ready before finalize");
+	CHECK(!se_aes_finalize(), "xts-nx: finalize failed");
+	CHECK(!memcmp(out, dst, SE_AES_BLOCK_SIZE * 4), "xts-nx: async result differs from sync");
+
+	// Source is consumed on submit, so it can be overwritten while the cluster is queued.
+	CHECK(!se_aes_crypt_xts_sec_nx_async(KS_TWEAK, KS_CRYPT, DECRYPT, 0, tweak, true, 0, out, src, SE_AES_BLOCK_SIZE * 4),
+		"xts-nx: submit failed");
+	memset(src, 0xA5, SE_AES_BLOCK_SIZE * 4);
+	CHECK(!se_aes_finalize(), "xts-nx: finalize failed");
+	CHECK(!memcmp(out, dst, SE_AES_BLOCK_SIZE * 4), "xts-nx: reused source corrupted result");
+}
+
+static void _check_exclusive()
+{
+	u8 hash[SE_SHA_256_SIZE];
+	u8 ctr[SE_AES_IV_SIZE] = { 0 };
+	u32 violations = se_sw_async_violations();
+
+	// Finalize with nothing queued is a no-op.
+	CHECK(!se_aes_finalize(), "idle finalize failed");
+	CHECK(se_aes_async_done(), "idle queue reports busy");
+
+	CHECK(!se_aes_crypt_ctr_async(KS_CRYPT, out, msg, MSG_SIZE, ctr), "busy: submit failed");
+	CHECK(se_aes_crypt_ecb(KS_CRYPT, ENCRYPT, expected, msg, SE_AES_BLOCK_SIZE), "busy: sync aes was allowed");
+	CHECK(se_aes_crypt_ecb_async(KS_CRYPT, ENCRYPT, expected, msg, SE_AES_BLOCK_SIZE), "busy: second async was allowed");
+	CHECK(se_sha_hash_256_oneshot(hash, msg, MSG_SIZE), "busy: sha was allowed");
+	CHECK(se_sw_async_violations() == violations + 3, "busy: violations not counted");
+	CHECK(!se_aes_finalize(), "busy: finalize failed");
+
+	// Engine reads the source while running, so reusing it before finalize corrupts the result.
+	u8 src[MSG_SIZE];
+	memcpy(src, msg, MSG_SIZE);
+	se_aes_crypt_ctr(KS_CRYPT, expected, msg, MSG_SIZE, ctr);
+	CHECK(!se_aes_crypt_ctr_async(KS_CRYPT, out, src, MSG_SIZE, ctr), "reuse: submit failed");
+	memset(src, 0, MSG_SIZE);
+	CHECK(!se_aes_finalize(), "reuse: finalize failed");
+	CHECK(memcmp(out, expected, MSG_SIZE), "reuse: source reuse before finalize was not caught");
+}
+
+// Same flow as nx_emmc_bis_read with the cluster cache disabled. One DMA buffer is reused for all reads.
+static void _check_bis_read_flow()
+{
+	static u8 tweak[SE_AES_BLOCK_SIZE];
+	u8 enc_tweak[SE_AES_BLOCK_SIZE];
+
+	for (u32 i = 0; i < CLUSTERS; i++)
+		se_aes_crypt_xts_sec_nx(KS_TWEAK, KS_CRYPT, ENCRYPT, i, enc_tweak, true, 0,
+			disk + i * CLUSTER_SIZE, plain + i * CLUSTER_SIZE, CLUSTER_SIZE);
+
+	se_sw_async_latency_set(8);
+	memset(read_buff, 0, sizeof(read_buff));
+
+	for (u32 i = 0; i < CLUSTERS; i++)
+	{
+		// Read next cluster while the previous one is decrypting.
+		memcpy(dma_buff, disk + i * CLUSTER_SIZE, CLUSTER_SIZE);
+
+		CHECK(!se_aes_finalize(), "bis: finalize failed");
+		CHECK(!se_aes_crypt_xts_sec_nx_async(KS_TWEAK, KS_CRYPT, DECRYPT, i, tweak, true, 0,
+			read_buff + i * CLUSTER_SIZE, dma_buff, CLUSTER_SIZE), "bis: submit failed");
+	}
+	CHECK(!se_aes_finalize(), "bis: finalize failed");
+
+	CHECK(!memcmp(read_buff, plain, sizeof(plain)), "bis: single DMA buffer read flow corrupted data");
+
+	se_sw_async_latency_set(1);
+}
+
+int main()
+{
+	for (u32 i = 0; i < MSG_SIZE; i++)
+		msg[i] = i * 7;
+	for (u32 i = 0; i < sizeof(plain); i++)
+		plain[i] = i ^ (i >> 8);
+
+	se_aes_key_set(KS_CRYPT, key_crypt, SE_KEY_128_SIZE);
+	se_aes_key_set(KS_TWEAK, key_tweak, SE_KEY_128_SIZE);
+
+	_check_bis_read_flow();
+	_check_modes();
+	_check_xts_nx();
+	_check_exclusive();
+
+	if (_failed)
+	{
+		printf("%d checks failed.\n", _failed);
+		return 1;
+	}
+
+	printf("All SE queue checks passed.\n");
+
+	return 0;
+}
@@ -0,0 +1,879 @@
+/*
+ * Software implementation of the BDK SE API for host builds.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sec/se.h>
+
+#include "se_sw.h"
+
+#define AES_128_ROUNDS 10
+#define AES_128_RK_WORDS (4 * (AES_128_ROUNDS + 1))
+
+#define GET_U32_BE(p) (((u32)(p)[0] << 24) | ((u32)(p)[1] << 16) | ((u32)(p)[2] << 8) | (u32)(p)[3])
+#define PUT_U32_BE(p, v) do { (p)[0] = (v) >> 24; (p)[1] = (v) >> 16; (p)[2] = (v) >> 8; (p)[3] = (v); } while (0)
+#define ROR32(v, n) (((v) >> (n)) | ((v) << (32 - (n))))
+
+typedef struct _se_sw_keyslot_t
+{
+	u8  key[SE_AES_MAX_KEY_SIZE];
+	u8  iv[SE_AES_IV_SIZE];
+	u32 erk[AES_128_RK_WORDS]; // Encryption round keys.
+	u32 drk[AES_128_RK_WORDS]; // Decryption round keys.
+	u32 acc_flags;
+} se_sw_keyslot_t;
+
+typedef struct _se_sw_aes_async_t
+{
+	bool pending;
+	bool done;
+	bool xts;
+	u32  polls;
+	u32  ks;
+	int  enc;
+	int  mode;
+	u8  *dst;
+	const u8 *src;
+	u32  size;
+	u8   iv[SE_AES_IV_SIZE];
+	u8   tweak[SE_AES_BLOCK_SIZE];
+} se_sw_aes_async_t;
+
+typedef struct _se_sw_sha_ctx_t
+{
+	u32 state[SE_SHA_256_SIZE / sizeof(u32)];
+} se_sw_sha_ctx_t;
+
+static se_sw_keyslot_t keyslots[SE_AES_KEYSLOT_COUNT];
+static u32 rsa_acc_flags[2];
+static se_sw_sha_ctx_t sha_ctx;
+static se_sw_aes_async_t aes_async;
+static u32 async_latency = 1;
+static u32 async_violations = 0;
+
+static bool tables_init = false;
+static u8  sbox[256];
+static u8  inv_sbox[256];
+static u32 te[4][256];
+static u32 td[4][256];
+
+static const u32 sha256_k[64] = {
+	0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+	0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+	0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+	0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+	0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+	0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+	0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+	0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+static const u32 sha256_h0[8] = {
+	0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+};
+
+static u8 _gf_mul(u8 a, u8 b)
+{
+	u8 res = 0;
+
+	while (b)
+	{
+		if (b & 1)
+			res ^= a;
+		a = (a << 1) ^ ((a & 0x80) ? 0x1B : 0);
+		b >>= 1;
+	}
+
+	return res;
+}
+
+static void _aes_tables_init()
+{
+	if (tables_init)
+		return;
+
+	// Generate S-Box from multiplicative inverse and affine transform.
+	for (u32 i = 0; i < 256; i++)
+	{
+		u8 inv = 0;
+		for (u32 j = 1; i && j < 256; j++)
+		{
+			if (_gf_mul(i, j) == 1)
+			{
+				inv = j;
+				break;
+			}
+		}
+
+		u8 s = inv;
+		for (u32 j = 1; j < 5; j++)
+			s ^= (inv << j) | (inv >> (8 - j));
+		s ^= 0x63;
+
+		sbox[i] = s;
+		inv_sbox[s] = i;
+	}
+
+	// Generate round tables. Rows 1-3 are rotations of row 0.
+	for (u32 i = 0; i < 256; i++)
+	{
+		u8 s  = sbox[i];
+		u8 is = inv_sbox[i];
+
+		te[0][i] = ((u32)_gf_mul(s, 2) << 24) | ((u32)s << 16) | ((u32)s << 8) | _gf_mul(s, 3);
+		td[0][i] = ((u32)_gf_mul(is, 14) << 24) | ((u32)_gf_mul(is, 9) << 16) |
+				   ((u32)_gf_mul(is, 13) << 8) | _gf_mul(is, 11);
+
+		for (u32 j = 1; j < 4; j++)
+		{
+			te[j][i] = ROR32(te[0][i], 8 * j);
+			td[j][i] = ROR32(td[0][i], 8 * j);
+		}
+	}
+
+	tables_init = true;
+}
+
+static void _aes_key_expand(se_sw_keyslot_t *slot)
+{
+	u32 *rk = slot->erk;
+	u8 rcon = 1;
+
+	_aes_tables_init();
+
+	for (u32 i = 0; i < 4; i++)
+		rk[i] = GET_U32_BE(slot->key + i * sizeof(u32));
+
+	for (u32 i = 4; i < AES_128_RK_WORDS; i++)
+	{
+		u32 tmp = rk[i - 1];
+		if (!(i % 4))
+		{
+			tmp = ((u32)sbox[(tmp >> 16) & 0xFF] << 24) | ((u32)sbox[(tmp >> 8) & 0xFF] << 16) |
+				  ((u32)sbox[tmp & 0xFF] << 8) | sbox[tmp >> 24];
+			tmp ^= (u32)rcon << 24;
+			rcon = _gf_mul(rcon, 2);
+		}
+		rk[i] = rk[i - 4] ^ tmp;
+	}
+
+	// Decryption keys are in reverse round order with InvMixColumns applied to inner rounds.
+	for (u32 r = 0; r <= AES_128_ROUNDS; r++)
+	{
+		for (u32 i = 0; i < 4; i++)
+		{
+			u32 w = rk[(AES_128_ROUNDS - r) * 4 + i];
+			if (r && r < AES_128_ROUNDS)
+				w = td[0][sbox[w >> 24]] ^ td[1][sbox[(w >> 16) & 0xFF]] ^
+					td[2][sbox[(w >> 8) & 0xFF]] ^ td[3][sbox[w & 0xFF]];
+			slot->drk[r * 4 + i] = w;
+		}
+	}
+}
+
+static void _aes_encrypt_block(const u32 *rk, u8 *dst, const u8 *src)
+{
+	u32 s0 = GET_U32_BE(src)      ^ rk[0];
+	u32 s1 = GET_U32_BE(src + 4)  ^ rk[1];
+	u32 s2 = GET_U32_BE(src + 8)  ^ rk[2];
+	u32 s3 = GET_U32_BE(src + 12) ^ rk[3];
+	u32 t0, t1, t2, t3;
+
+	for (u32 r = 1; r < AES_128_ROUNDS; r++)
+	{
+		rk += 4;
+		t0 = te[0][s0 >> 24] ^ te[1][(s1 >> 16) & 0xFF] ^ te[2][(s2 >> 8) & 0xFF] ^ te[3][s3 & 0xFF] ^ rk[0];
+		t1 = te[0][s1 >> 24] ^ te[1][(s2 >> 16) & 0xFF] ^ te[2][(s3 >> 8) & 0xFF] ^ te[3][s0 & 0xFF] ^ rk[1];
+		t2 = te[0][s2 >> 24] ^ te[1][(s3 >> 16) & 0xFF] ^ te[2][(s0 >> 8) & 0xFF] ^ te[3][s1 & 0xFF] ^ rk[2];
+		t3 = te[0][s3 >> 24] ^ te[1][(s0 >> 16) & 0xFF] ^ te[2][(s1 >> 8) & 0xFF] ^ te[3][s2 & 0xFF] ^ rk[3];
+		s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+	}
+
+	// Last round has no MixColumns.
+	rk += 4;
+	t0 = ((u32)sbox[s0 >> 24] << 24) ^ ((u32)sbox[(s1 >> 16) & 0xFF] << 16) ^ ((u32)sbox[(s2 >> 8) & 0xFF] << 8) ^ sbox[s3 & 0xFF] ^ rk[0];
+	t1 = ((u32)sbox[s1 >> 24] << 24) ^ ((u32)sbox[(s2 >> 16) & 0xFF] << 16) ^ ((u32)sbox[(s3 >> 8) & 0xFF] << 8) ^ sbox[s0 & 0xFF] ^ rk[1];
+	t2 = ((u32)sbox[s2 >> 24] << 24) ^ ((u32)sbox[(s3 >> 16) & 0xFF] << 16) ^ ((u32)sbox[(s0 >> 8) & 0xFF] << 8) ^ sbox[s1 & 0xFF] ^ rk[2];
+	t3 = ((u32)sbox[s3 >> 24] << 24) ^ ((u32)sbox[(s0 >> 16) & 0xFF] << 16) ^ ((u32)sbox[(s1 >> 8) & 0xFF] << 8) ^ sbox[s2 & 0xFF] ^ rk[3];
+
+	PUT_U32_BE(dst, t0);
+	PUT_U32_BE(dst + 4, t1);
+	PUT_U32_BE(dst + 8, t2);
+	PUT_U32_BE(dst + 12, t3);
+}
+
+static void _aes_decrypt_block(const u32 *rk, u8 *dst, const u8 *src)
+{
+	u32 s0 = GET_U32_BE(src)      ^ rk[0];
+	u32 s1 = GET_U32_BE(src + 4)  ^ rk[1];
+	u32 s2 = GET_U32_BE(src + 8)  ^ rk[2];
+	u32 s3 = GET_U32_BE(src + 12) ^ rk[3];
+	u32 t0, t1, t2, t3;
+
+	for (u32 r = 1; r < AES_128_ROUNDS; r++)
+	{
+		rk += 4;
+		t0 = td[0][s0 >> 24] ^ td[1][(s3 >> 16) & 0xFF] ^ td[2][(s2 >> 8) & 0xFF] ^ td[3][s1 & 0xFF] ^ rk[0];
+		t1 = td[0][s1 >> 24] ^ td[1][(s0 >> 16) & 0xFF] ^ td[2][(s3 >> 8) & 0xFF] ^ td[3][s2 & 0xFF] ^ rk[1];
+		t2 = td[0][s2 >> 24] ^ td[1][(s1 >> 16) & 0xFF] ^ td[2][(s0 >> 8) & 0xFF] ^ td[3][s3 & 0xFF] ^ rk[2];
+		t3 = td[0][s3 >> 24] ^ td[1][(s2 >> 16) & 0xFF] ^ td[2][(s1 >> 8) & 0xFF] ^ td[3][s0 & 0xFF] ^ rk[3];
+		s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+	}
+
+	// Last round has no InvMixColumns.
+	rk += 4;
+	t0 = ((u32)inv_sbox[s0 >> 24] << 24) ^ ((u32)inv_sbox[(s3 >> 16) & 0xFF] << 16) ^ ((u32)inv_sbox[(s2 >> 8) & 0xFF] << 8) ^ inv_sbox[s1 & 0xFF] ^ rk[0];
+	t1 = ((u32)inv_sbox[s1 >> 24] << 24) ^ ((u32)inv_sbox[(s0 >> 16) & 0xFF] << 16) ^ ((u32)inv_sbox[(s3 >> 8) & 0xFF] << 8) ^ inv_sbox[s2 & 0xFF] ^ rk[1];
+	t2 = ((u32)inv_sbox[s2 >> 24] << 24) ^ ((u32)inv_sbox[(s1 >> 16) & 0xFF] << 16) ^ ((u32)inv_sbox[(s0 >> 8) & 0xFF] << 8) ^ inv_sbox[s3 & 0xFF] ^ rk[2];
+	t3 = ((u32)inv_sbox[s3 >> 24] << 24) ^ ((u32)inv_sbox[(s2 >> 16) & 0xFF] << 16) ^ ((u32)inv_sbox[(s1 >> 8) & 0xFF] << 8) ^ inv_sbox[s0 & 0xFF] ^ rk[3];
+
+	PUT_U32_BE(dst, t0);
+	PUT_U32_BE(dst + 4, t1);
+	PUT_U32_BE(dst + 8, t2);
+	PUT_U32_BE(dst + 12, t3);
+}
+
+static void _xor_block(u8 *dst, const u8 *a, const u8 *b)
+{
+	for (u32 i = 0; i < SE_AES_BLOCK_SIZE; i++)
+		dst[i] = a[i] ^ b[i];
+}
+
+static void _ctr_increment(u8 *ctr)
+{
+	for (int i = SE_AES_BLOCK_SIZE - 1; i >= 0; i--)
+		if (++ctr[i])
+			break;
+}
+
+static void _se_ls_1bit(void *buf)
+{
+	u8 *block = (u8 *)buf;
+	u32 carry = 0;
+
+	for (int i = SE_AES_BLOCK_SIZE - 1; i >= 0; i--)
+	{
+		u8 b = block[i];
+		block[i] = (b << 1) | carry;
+		carry = b >> 7;
+	}
+
+	if (carry)
+		block[SE_AES_BLOCK_SIZE - 1] ^= 0x87;
+}
+
+static void _se_ls_1bit_le(void *buf)
+{
+	u8 *block = (u8 *)buf;
+	u32 carry = 0;
+
+	for (u32 i = 0; i < SE_AES_BLOCK_SIZE; i++)
+	{
+		u8 b = block[i];
+		block[i] = (b << 1) | carry;
+		carry = b >> 7;
+	}
+
+	if (carry)
+		block[0] ^= 0x87;
+}
+
+// No other SE operation is allowed while an async one is queued.
+static bool _se_sw_busy()
+{
+	if (!aes_async.pending)
+		return false;
+
+	async_violations++;
+
+	return true;
+}
+
+void se_rsa_acc_ctrl(u32 rs, u32 flags)
+{
+	rsa_acc_flags[rs & 1] = flags;
+}
+
+void se_key_acc_ctrl(u32 ks, u32 flags)
+{
+	keyslots[ks].acc_flags = flags;
+}
+
+u32 se_key_acc_ctrl_get(u32 ks)
+{
+	return keyslots[ks].acc_flags;
+}
+
+void se_aes_key_set(u32 ks, const void *key, u32 size)
+{
+	memcpy(keyslots[ks].key, key, size);
+	_aes_key_expand(&keyslots[ks]);
+}
+
+void se_aes_iv_set(u32 ks, const void *iv, u32 size)
+{
+	memcpy(keyslots[ks].iv, iv, size);
+}
+
+void se_aes_key_get(u32 ks, void *key, u32 size)
+{
+	memcpy(key, keyslots[ks].key, size);
+}
+
+void se_aes_key_clear(u32 ks)
+{
+	memset(keyslots[ks].key, 0, SE_AES_MAX_KEY_SIZE);
+	_aes_key_expand(&keyslots[ks]);
+}
+
+void se_aes_iv_clear(u32 ks)
+{
+	memset(keyslots[ks].iv, 0, SE_AES_IV_SIZE);
+}
+
+int se_aes_unwrap_key(u32 ks_dst, u32 ks_src, const void *seed)
+{
+	u8 key[SE_KEY_128_SIZE];
+
+	if (_se_sw_busy())
+		return 1;
+
+	_aes_decrypt_block(keyslots[ks_src].drk, key, seed);
+	se_aes_key_set(ks_dst, key, SE_KEY_128_SIZE);
+
+	return 0;
+}
+
+void se_aes_ctx_get_keys(u8 *buf, u8 *keys, u32 keysize)
+{
+	for (u32 i = 0; i < SE_AES_KEYSLOT_COUNT; i++)
+		memcpy(keys + i * keysize, keyslots[i].key, keysize);
+}
+
+// Partial last blocks are zero padded and truncated, same as hardware.
+static void _aes_crypt_blocks(u32 ks, int enc, int mode, u8 *dst, const u8 *src, u32 size, u8 *iv)
+{
+	se_sw_keyslot_t *slot = &keyslots[ks];
+	u8 block[SE_AES_BLOCK_SIZE];
+	u8 out[SE_AES_BLOCK_SIZE];
+
+	for (u32 off = 0; off < size; off += SE_AES_BLOCK_SIZE)
+	{
+		u32 len = MIN(size - off, SE_AES_BLOCK_SIZE);
+
+		memset(block, 0, SE_AES_BLOCK_SIZE);
+		memcpy(block, src + off, len);
+
+		switch (mode)
+		{
+		case 0: // ECB.
+			if (enc)
+				_aes_encrypt_block(slot->erk, out, block);
+			else
+				_aes_decrypt_block(slot->drk, out, block);
+			break;
+		case 1: // CBC.
+			if (enc)
+			{
+				_xor_block(block, block, iv);
+				_aes_encrypt_block(slot->erk, out, block);
+				memcpy(iv, out, SE_AES_BLOCK_SIZE);
+			}
+			else
+			{
+				_aes_decrypt_block(slot->drk, out, block);
+				_xor_block(out, out, iv);
+				memcpy(iv, block, SE_AES_BLOCK_SIZE);
+			}
+			break;
+		case 2: // OFB.
+			_aes_encrypt_block(slot->erk, iv, iv);
+			_xor_block(out, block, iv);
+			break;
+		case 3: // CTR.
+			_aes_encrypt_block(slot->erk, out, iv);
+			_xor_block(out, out, block);
+			_ctr_increment(iv);
+			break;
+		}
+
+		memcpy(dst + off, out, len);
+	}
+}
+
+int se_aes_crypt_ecb(u32 ks, int enc, void *dst, const void *src, u32 size)
+{
+	if (_se_sw_busy())
+		return 1;
+
+	_aes_crypt_blocks(ks, enc, 0, dst, src, size, NULL);
+
+	return 0;
+}
+
+int se_aes_crypt_cbc(u32 ks, int enc, void *dst, const void *src, u32 size)
+{
+	if (_se_sw_busy())
+		return 1;
+
+	u8 iv[SE_AES_IV_SIZE];
+	memcpy(iv, keyslots[ks].iv, SE_AES_IV_SIZE);
+
+	_aes_crypt_blocks(ks, enc, 1, dst, src, size, iv);
+
+	return 0;
+}
+
+int se_aes_crypt_ofb(u32 ks, void *dst, const void *src, u32 size)
+{
+	if (_se_sw_busy())
+		return 1;
+
+	u8 iv[SE_AES_IV_SIZE];
+	memcpy(iv, keyslots[ks].iv, SE_AES_IV_SIZE);
+
+	_aes_crypt_blocks(ks, ENCRYPT, 2, dst, src, size, iv);
+
+	return 0;
+}
+
+int se_aes_crypt_ctr(u32 ks, void *dst, const void *src, u32 size, void *ctr)
+{
+	if (_se_sw_busy())
+		return 1;
+
+	u8 iv[SE_AES_IV_SIZE];
+	memcpy(iv, ctr, SE_AES_IV_SIZE);
+
+	_aes_crypt_blocks(ks, ENCRYPT, 3, dst, src, size, iv);
+
+	return 0;
+}
+
+int se_aes_crypt_xts_sec(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, void *dst, void *src, u32 secsize)
+{
+	u8 tweak[SE_AES_BLOCK_SIZE];
+	u8 *pdst = (u8 *)dst;
+	u8 *psrc = (u8 *)src;
+
+	if (_se_sw_busy())
+		return 1;
+
+	// Generate tweak.
+	for (int i = SE_AES_BLOCK_SIZE - 1; i >= 0; i--)
+	{
+		tweak[i] = sec & 0xFF;
+		sec >>= 8;
+	}
+	_aes_encrypt_block(keyslots[tweak_ks].erk, tweak, tweak);
+
+	// We are assuming a 0x10-aligned sector size in this implementation.
+	for (u32 i = 0; i < secsize / SE_AES_BLOCK_SIZE; i++)
+	{
+		_xor_block(pdst, psrc, tweak);
+		if (enc)
+			_aes_encrypt_block(keyslots[crypt_ks].erk, pdst, pdst);
+		else
+			_aes_decrypt_block(keyslots[crypt_ks].drk, pdst, pdst);
+		_xor_block(pdst, pdst, tweak);
+
+		_se_ls_1bit(tweak);
+		psrc += SE_AES_BLOCK_SIZE;
+		pdst += SE_AES_BLOCK_SIZE;
+	}
+
+	return 0;
+}
+
+static void _se_aes_xts_nx_tweak_pre(u32 tweak_ks, u64 sec, u8 *tweak, bool regen_tweak, u32 tweak_exp, u8 *orig_tweak, void *dst, void *src, u32 sec_size)
+{
+	u8 *pdst = (u8 *)dst;
+	u8 *psrc = (u8 *)src;
+
+	if (regen_tweak)
+	{
+		for (int i = SE_AES_BLOCK_SIZE - 1; i >= 0; i--)
+		{
+			tweak[i] = sec & 0xFF;
+			sec >>= 8;
+		}
+		_aes_encrypt_block(keyslots[tweak_ks].erk, tweak, tweak);
+	}
+
+	// tweak_exp allows using a saved tweak to reduce _se_ls_1bit_le calls.
+	for (u32 i = 0; i < (tweak_exp << 5); i++)
+		_se_ls_1bit_le(tweak);
+
+	memcpy(orig_tweak, tweak, SE_KEY_128_SIZE);
+
+	// We are assuming a 16 sector aligned size in this implementation.
+	for (u32 i = 0; i < (sec_size >> 4); i++)
+	{
+		_xor_block(pdst, psrc, tweak);
+
+		_se_ls_1bit_le(tweak);
+		psrc += SE_AES_BLOCK_SIZE;
+		pdst += SE_AES_BLOCK_SIZE;
+	}
+}
+
+static void _se_aes_xts_nx_tweak_post(u8 *orig_tweak, void *dst, u32 sec_size)
+{
+	u8 *pdst = (u8 *)dst;
+
+	for (u32 i = 0; i < (sec_size >> 4); i++)
+	{
+		_xor_block(pdst, pdst, orig_tweak);
+
+		_se_ls_1bit_le(orig_tweak);
+		pdst += SE_AES_BLOCK_SIZE;
+	}
+}
+
+int se_aes_crypt_xts_sec_nx(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, u8 *tweak, bool regen_tweak, u32 tweak_exp, void *dst, void *src, u32 sec_size)
+{
+	u8 orig_tweak[SE_KEY_128_SIZE];
+
+	if (_se_sw_busy())
+		return 1;
+
+	_se_aes_xts_nx_tweak_pre(tweak_ks, sec, tweak, regen_tweak, tweak_exp, orig_tweak, dst, src, sec_size);
+	_aes_crypt_blocks(crypt_ks, enc, 0, dst, dst, sec_size, NULL);
+	_se_aes_xts_nx_tweak_post(orig_tweak, dst, sec_size);
+
+	return 0;
+}
+
+int se_aes_crypt_xts(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, void *dst, void *src, u32 secsize, u32 num_secs)
+{
+	u8 *pdst = (u8 *)dst;
+	u8 *psrc = (u8 *)src;
+
+	for (u32 i = 0; i < num_secs; i++)
+		if (se_aes_crypt_xts_sec(tweak_ks, crypt_ks, enc, sec + i, pdst + secsize * i, psrc + secsize * i, secsize))
+			return 1;
+
+	return 0;
+}
+
+// Engine queue model. Async AES runs once polled enough or on finalize, so callers see hardware timing.
+static int _se_aes_async_submit(u32 ks, int enc, int mode, void *dst, const void *src, u32 size, const void *iv)
+{
+	if (_se_sw_busy())
+		return 1;
+
+	aes_async.pending = true;
+	aes_async.done    = false;
+	aes_async.xts     = false;
+	aes_async.polls   = 0;
+	aes_async.ks      = ks;
+	aes_async.enc     = enc;
+	aes_async.mode    = mode;
+	aes_async.dst     = (u8 *)dst;
+	aes_async.src     = (const u8 *)src;
+	aes_async.size    = size;
+	if (iv)
+		memcpy(aes_async.iv, iv, SE_AES_IV_SIZE);
+
+	return 0;
+}
+
+// Source is read on completion, same as the DMA engine. Sources reused before that get caught.
+static void _se_aes_async_complete()
+{
+	if (aes_async.done)
+		return;
+
+	_aes_crypt_blocks(aes_async.ks, aes_async.enc, aes_async.mode, aes_async.dst, aes_async.src, aes_async.size, aes_async.iv);
+	aes_async.done = true;
+}
+
+int se_aes_crypt_ecb_async(u32 ks, int enc, void *dst, const void *src, u32 size)
+{
+	return _se_aes_async_submit(ks, enc, 0, dst, src, size, NULL);
+}
+
+int se_aes_crypt_cbc_async(u32 ks, int enc, void *dst, const void *src, u32 size)
+{
+	return _se_aes_async_submit(ks, enc, 1, dst, src, size, keyslots[ks].iv);
+}
+
+int se_aes_crypt_ctr_async(u32 ks, void *dst, const void *src, u32 size, void *ctr)
+{
+	return _se_aes_async_submit(ks, ENCRYPT, 3, dst, src, size, ctr);
+}
+
+int se_aes_crypt_xts_sec_nx_async(u32 tweak_ks, u32 crypt_ks, int enc, u64 sec, u8 *tweak, bool regen_tweak, u32 tweak_exp, void *dst, void *src, u32 sec_size)
+{
+	if (_se_sw_busy())
+		return 1;
+
+	// Input tweak is applied on submit, same as hardware path. Source is free after this.
+	_se_aes_xts_nx_tweak_pre(tweak_ks, sec, tweak, regen_tweak, tweak_exp, aes_async.tweak, dst, src, sec_size);
+
+	_se_aes_async_submit(crypt_ks, enc, 0, dst, dst, sec_size, NULL);
+
+	// Output tweak is applied on finalize.
+	aes_async.xts = true;
+
+	return 0;
+}
+
+bool se_aes_async_done()
+{
+	if (!aes_async.pending)
+		return true;
+
+	if (aes_async.polls < async_latency)
+	{
+		aes_async.polls++;
+		return false;
+	}
+
+	_se_aes_async_complete();
+
+	return true;
+}
+
+int se_aes_finalize()
+{
+	if (!aes_async.pending)
+		return 0;
+
+	_se_aes_async_complete();
+
+	if (aes_async.xts)
+		_se_aes_xts_nx_tweak_post(aes_async.tweak, aes_async.dst, aes_async.size);
+
+	aes_async.pending = false;
+	aes_async.xts     = false;
+
+	return 0;
+}
+
+void se_sw_async_latency_set(u32 polls)
+{
+	async_latency = polls;
+}
+
+u32 se_sw_async_violations()
+{
+	return async_violations;
+}
+
+static void _sha256_block(u32 *state, const u8 *data)
+{
+	u32 w[64];
+	u32 a, b, c, d, e, f, g, h;
+
+	for (u32 i = 0; i < 16; i++)
+		w[i] = GET_U32_BE(data + i * sizeof(u32));
+
+	for (u32 i = 16; i < 64; i++)
+	{
+		u32 s0 = ROR32(w[i - 15], 7) ^ ROR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+		u32 s1 = ROR32(w[i - 2], 17) ^ ROR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	a = state[0]; b = state[1]; c = state[2]; d = state[3];
+	e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+	for (u32 i = 0; i < 64; i++)
+	{
+		u32 t1 = h + (ROR32(e, 6) ^ ROR32(e, 11) ^ ROR32(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+		u32 t2 = (ROR32(a, 2) ^ ROR32(a, 13) ^ ROR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+		h = g; g = f; f = e; e = d + t1;
+		d = c; c = b; b = a; a = t1 + t2;
+	}
+
+	state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+	state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+static void _se_sha_hash_256_get_hash(void *hash)
+{
+	u8 *phash = (u8 *)hash;
+
+	for (u32 i = 0; i < (SE_SHA_256_SIZE / sizeof(u32)); i++)
+		PUT_U32_BE(phash + i * sizeof(u32), sha_ctx.state[i]);
+}
+
+// Same size semantics as hardware. total_size smaller than src_size means more data follow.
+static int _se_sha_hash_256(void *hash, u64 total_size, const void *src, u32 src_size, bool is_oneshot)
+{
+	const u8 *psrc = (const u8 *)src;
+
+	if (_se_sw_busy())
+		return 1;
+
+	// Src size of 0 is not supported, so return null string sha256.
+	if (!src_size)
+	{
+		memcpy(sha_ctx.state, sha256_h0, sizeof(sha256_h0));
+
+		u8 block[SE_SHA2_MIN_BLOCK_SIZE] = { 0x80 };
+		_sha256_block(sha_ctx.state, block);
+		_se_sha_hash_256_get_hash(hash);
+
+		return 0;
+	}
+
+	if (total_size == src_size || !total_size)
+		memcpy(sha_ctx.state, sha256_h0, sizeof(sha256_h0));
+
+	u32 full = ALIGN_DOWN(src_size, SE_SHA2_MIN_BLOCK_SIZE);
+	for (u32 off = 0; off < full; off += SE_SHA2_MIN_BLOCK_SIZE)
+		_sha256_block(sha_ctx.state, psrc + off);
+
+	// Pad and add message length if last message.
+	if (total_size >= src_size)
+	{
+		u8 block[SE_SHA2_MIN_BLOCK_SIZE * 2] = { 0 };
+		u32 left = src_size - full;
+		u32 pad_size = left < (SE_SHA2_MIN_BLOCK_SIZE - sizeof(u64)) ? SE_SHA2_MIN_BLOCK_SIZE : SE_SHA2_MIN_BLOCK_SIZE * 2;
+		u64 bits = total_size << 3;
+
+		memcpy(block, psrc + full, left);
+		block[left] = 0x80;
+		PUT_U32_BE(block + pad_size - 8, (u32)(bits >> 32));
+		PUT_U32_BE(block + pad_size - 4, (u32)bits);
+
+		for (u32 off = 0; off < pad_size; off += SE_SHA2_MIN_BLOCK_SIZE)
+			_sha256_block(sha_ctx.state, block + off);
+	}
+
+	if (is_oneshot)
+		_se_sha_hash_256_get_hash(hash);
+
+	return 0;
+}
+
+int se_sha_hash_256_async(void *hash, const void *src, u32 size)
+{
+	return _se_sha_hash_256(hash, size, src, size, false);
+}
+
+int se_sha_hash_256_oneshot(void *hash, const void *src, u32 size)
+{
+	return _se_sha_hash_256(hash, size, src, size, true);
+}
+
+int se_sha_hash_256_partial_start(void *hash, const void *src, u32 size, bool is_oneshot)
+{
+	// Check if aligned SHA256 block size.
+	if (size % SE_SHA2_MIN_BLOCK_SIZE)
+		return 1;
+
+	return _se_sha_hash_256(hash, 0, src, size, is_oneshot);
+}
+
+int se_sha_hash_256_partial_update(void *hash, const void *src, u32 size, bool is_oneshot)
+{
+	// Check if aligned to SHA256 block size.
+	if (size % SE_SHA2_MIN_BLOCK_SIZE)
+		return 1;
+
+	return _se_sha_hash_256(hash, size - 1, src, size, is_oneshot);
+}
+
+int se_sha_hash_256_partial_end(void *hash, u64 total_size, const void *src, u32 src_size, bool is_oneshot)
+{
+	return _se_sha_hash_256(hash, total_size, src, src_size, is_oneshot);
+}
+
+int se_sha_hash_256_finalize(void *hash)
+{
+	_se_sha_hash_256_get_hash(hash);
+
+	return 0;
+}
+
+int se_sha_hash_256_batch(se_sha_job_t *jobs, u32 count)
+{
+	for (u32 i = 0; i < count; i++)
+		_se_sha_hash_256(jobs[i].hash, jobs[i].size, jobs[i].src, jobs[i].size, true);
+
+	return 0;
+}
+
+int se_aes_hash_cmac(u32 ks, void *hash, const void *src, u32 size)
+{
+	const u8 *psrc = (const u8 *)src;
+	u8 subkey[SE_KEY_128_SIZE] = { 0 };
+	u8 last_block[SE_AES_BLOCK_SIZE] = { 0 };
+	u8 mac[SE_AES_BLOCK_SIZE] = { 0 };
+
+	if (_se_sw_busy())
+		return 1;
+
+	// Hardware path clears the IV for subkey generation.
+	se_aes_iv_clear(ks);
+
+	// Generate K1 subkey and convert to K2 if partial.
+	_aes_encrypt_block(keyslots[ks].erk, subkey, subkey);
+	_se_ls_1bit(subkey);
+	if (size & 0xF)
+		_se_ls_1bit(subkey);
+
+	// Initial blocks.
+	u32 num_blocks = (size + 0xF) >> 4;
+	for (u32 i = 0; i + 1 < num_blocks; i++)
+	{
+		_xor_block(mac, mac, psrc + i * SE_AES_BLOCK_SIZE);
+		_aes_encrypt_block(keyslots[ks].erk, mac, mac);
+	}
+
+	// Last block.
+	if (size & 0xF)
+	{
+		memcpy(last_block, psrc + (size & (~0xF)), size & 0xF);
+		last_block[size & 0xF] = 0x80;
+	}
+	else if (size >= SE_AES_BLOCK_SIZE)
+		memcpy(last_block, psrc + size - SE_AES_BLOCK_SIZE, SE_AES_BLOCK_SIZE);
+
+	_xor_block(last_block, last_block, subkey);
+	_xor_block(mac, mac, last_block);
+	_aes_encrypt_block(keyslots[ks].erk, hash, mac);
+
+	return 0;
+}
+
+int se_rng_pseudo(void *dst, u32 size)
+{
+	if (_se_sw_busy())
+		return 1;
+
+	FILE *fp = fopen("/dev/urandom", "rb");
+	if (fp)
+	{
+		u32 res = fread(dst, 1, size, fp);
+		fclose(fp);
+		if (res == size)
+			return 0;
+	}
+
+	u8 *pdst = (u8 *)dst;
+	for (u32 i = 0; i < size; i++)
+		pdst[i] = rand();
+
+	return 0;
+}
@@ -0,0 +1,29 @@
+/*
+ * Host controls for the software SE backend.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SE_SW_H_
+#define _SE_SW_H_
+
+#include <utils/types.h>
+
+// Number of se_aes_async_done() polls that report busy before a queued operation completes.
+void se_sw_async_latency_set(u32 polls);
+// Count of SE operations that were issued while an async one was still queued.
+u32  se_sw_async_violations();
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * Android sparse image to raw image converter.
+ * Runs the flasher's decoder on the host, so its output can be compared with simg2img.
+ *
+ * Copyright (c) 2026 CTCaer
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <soc/ccplex.h>
+#include <utils/simg.h>
+
+typedef struct _simg_io_t
+{
+	FILE *in;
+	FILE *out;
+	const char *base;
+	u32 part_idx;
+	bool split;
+} simg_io_t;
+
+static u32 _crc32(u32 crc, const u8 *buf, u32 len)
+{
+	static u32 table[256];
+
+	if (!table[1])
+	{
+		for (u32 i = 0; i < 256; i++)
+		{
+			u32 rem = i;
+			for (u32 j = 0; j < 8; j++)
+				rem = (rem & 1) ? (rem >> 1) ^ 0xEDB88320 : rem >> 1;
+			table[i] = rem;
+		}
+	}
+
+	crc = ~crc;
+	for (u32 i = 0; i < len; i++)
+		crc = (crc >> 8) ^ table[(crc & 0xFF) ^ buf[i]];
+
+	return ~crc;
+}
+
+// Host stand-ins for the CCPLEX worker. Only CRC32 jobs are posted and they run inline.
+static u32 _job_res;
+
+u32 ccplex_worker_post(u32 op, void *dst, const void *src, u32 size, u32 arg)
+{
+	_job_res = op == CCPLEX_JOB_CRC32 ? _crc32(arg, src, size) : 0xFFFFFFFF;
+
+	return 0;
+}
+
+u32 ccplex_worker_wait(u32 job)
+{
+	return _job_res;
+}
+
+static int _open_part(simg_io_t *io)
+{
+	char path[4096];
+
+	if (io->split)
+		snprintf(path, sizeof(path), "%s.%02d", io->base, io->part_idx);
+	else
+		snprintf(path, sizeof(path), "%s", io->base);
+
+	io->in = fopen(path, "rb");
+
+	return !io->in;
+}
+
+static int _read(void *priv, void *buf, u32 size)
+{
+	simg_io_t *io = (simg_io_t *)priv;
+
+	while (size)
+	{
+		size_t br = fread(buf, 1, size, io->in);
+		buf += br;
+		size -= br;
+
+		// Continue from the next split part, like l4t.NN.
+		if (size)
+		{
+			if (!io->split)
+				return 1;
+
+			fclose(io->in);
+			io->part_idx++;
+			if (_open_part(io))
+				return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int _write(void *priv, u32 sct_off, u32 num, const void *buf)
+{
+	simg_io_t *io = (simg_io_t *)priv;
+
+	if (fseeko(io->out, (off_t)sct_off << 9, SEEK_SET))
+		return 1;
+
+	return fwrite(buf, 512, num, io->out) != num;
+}
+
+int main(int argc, char *argv[])
+{
+	simg_io_t io = { 0 };
+	simg_ctxt_t simg;
+	simg_hdr_t hdr;
+
+	if (argc != 3)
+	{
+		printf("Usage: %s <in.img | in.00> <out.img>\n", argv[0]);
+		printf("Split inputs (l4t.00, l4t.01, ...) are joined when the first part ends in .00.\n");
+		return 1;
+	}
+
+	u32 len = strlen(argv[1]);
+	char *base = strdup(argv[1]);
+	if (len > 3 && !strcmp(&base[len - 3], ".00"))
+	{
+		base[len - 3] = 0;
+		io.split = true;
+	}
+	io.base = base;
+
+	if (_open_part(&io))
+	{
+		printf("Failed to open %s\n", argv[1]);
+		return 1;
+	}
+
+	if (fread(&hdr, sizeof(hdr), 1, io.in) != 1 || !simg_is_sparse(&hdr) || !simg_image_sectors(&hdr))
+	{
+		printf("Not a valid sparse image\n");
+		return 1;
+	}
+	rewind(io.in);
+
+	io.out = fopen(argv[2], "wb");
+	if (!io.out)
+	{
+		printf("Failed to create %s\n", argv[2]);
+		return 1;
+	}
+
+	simg.read     = _read;
+	simg.write    = _write;
+	simg.rpriv    = &io;
+	simg.wpriv    = &io;
+	simg.buf_size = SZ_4M;
+	simg.buf      = malloc(simg.buf_size);
+
+	if (simg_flash(&simg))
+	{
+		printf("Failed to decode sparse image\n");
+		return 1;
+	}
+
+	// DONT_CARE chunks read back as zeros, same as simg2img.
+	u32 total_sct = simg_image_sectors(&hdr);
+	if (fflush(io.out) || ftruncate(fileno(io.out), (off_t)total_sct << 9))
+		return 1;
+
+	printf("%u sectors, %u skipped\n", total_sct, simg.skipped_sct);
+
+	fclose(io.out);
+	fclose(io.in);
+	free(simg.buf);
+	free(base);
+
+	return 0;
+}